@@ -4,6 +4,7 @@ in vec3 v_position;
 in vec3 v_normal;
 in vec2 v_texCoord;
 in float v_occlusion;
+in vec2 v_light;        // Sunlight and block light levels in [0, 1]
 
 uniform vec3 u_cameraPosition;
 uniform mat4 u_viewProjection;
@@ -21,7 +22,7 @@ vec3 applyFog( in vec3  rgb,      // original color of the pixel
     const float a = 0.0025;
     const float b = .1;
 
-    float fogAmount = (a/b) * exp(-rayOri.y*b) * (1.0-exp( -dist*rayDir.y*b ))/rayDir.y;
+    float fogAmount = clamp((a/b) * exp(-rayOri.y*b) * (1.0-exp( -dist*rayDir.y*b ))/rayDir.y, 0.0, 1.0);
     float sunAmount = max( dot( rayDir, sunDir ), 0.0 );
     vec3  fogColor  = mix( vec3(0.5,0.6,0.7), // bluish
                            vec3(1.0,0.9,0.7), // yellowish
@@ -29,18 +30,29 @@ vec3 applyFog( in vec3  rgb,      // original color of the pixel
     return mix( rgb, fogColor, fogAmount );
 }
 
+// Every light level is a bit darker than the one above it
+float lightLevelBrightness(float level)
+{
+    return pow(0.8, 15.0 * (1.0 - level));
+}
+
 void main()
 {
+    // Direction of the sun only shades the faces, how much light reaches them comes from the light levels
     vec3 lightPos = vec3(3, 10, 3);
     vec3 lightDirection = normalize(lightPos);
 
+    float sunLight = lightLevelBrightness(v_light.x);
+    float blockLight = lightLevelBrightness(v_light.y);
+    float ambient = max(sunLight, blockLight);
+
     float lightIntensity = 0.2;
 
-    float dirLight = lightIntensity * max(dot(lightDirection, v_normal), 0);
+    float dirLight = lightIntensity * max(dot(lightDirection, v_normal), 0) * sunLight;
     float maxAmbient = 0.5;
     float minAmbient = 0.2;
 
-    float light = min((dirLight + (maxAmbient - minAmbient)) * v_occlusion + minAmbient, 1);
+    float light = min((dirLight + (maxAmbient - minAmbient) * ambient) * v_occlusion + minAmbient * ambient, 1);
 
     vec4 tex = texture(u_atlas, v_texCoord);
     color = u_color * light * tex;
@@ -4,6 +4,7 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoord;
 layout(location = 3) in float occlusion;
+layout(location = 4) in vec2 light;
 
 uniform vec3 u_cameraPosition;
 uniform mat4 u_viewProjection;
@@ -14,6 +15,7 @@ out vec3 v_position;
 out vec3 v_normal;
 out vec2 v_texCoord;
 out float v_occlusion;
+out vec2 v_light;
 
 void main()
 {
@@ -22,4 +24,5 @@ void main()
     v_normal = normal;
     v_texCoord = texCoord;
     v_occlusion = occlusion;
+    v_light = light;
 }
\ No newline at end of file
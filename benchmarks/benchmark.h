@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+
+Helpers shared by the benchmarks.
+
+Benchmarks are small programs that run without a window, so they time
+themselves with std::chrono instead of PlatformGetTime (which is only
+set up by PlatformWindowStartup). Results are printed with printf, one
+line per measurement.
+
+*/
+
+#include "core/types.h"
+
+#include <chrono>
+#include <cstdio>
+
+inline f64 BenchmarkTime()
+{
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration<f64>(Clock::now().time_since_epoch()).count();
+}
+
+// Keeps the compiler from throwing away work whose result is never used
+inline void BenchmarkKeep(u64 value)
+{
+    static volatile u64 sink;
+    sink = sink ^ value;
+}
\ No newline at end of file
@@ -0,0 +1,396 @@
+/*
+
+Quality and throughput of the hashes in containers/hash.h over the kinds
+of keys the game actually puts in tables.
+
+    Chunk coordinates   Packed with PackChunkCoord, hashed as u64
+    Texture paths       Paths under assets/ like the ones textures are cached by
+    JSON keys           Short camelCase names like the ones in the font files
+
+Quality is measured the way HashTable uses the hash. H1 (hash >> 7) picks
+the group a probe starts at and H2 (the low 7 bits) is the control byte, so
+both are bucketed and compared against a uniform distribution with a
+chi-squared test. A score close to 1 is uniform, anything much larger
+means keys are clustering. Avalanche flips every bit of every key and
+checks how often each output bit changes, which should be half the time.
+
+FNV-1a is measured next to HashCharBuffer as a reference.
+
+*/
+
+#include "benchmark.h"
+
+#include "core/types.h"
+#include "containers/hash.h"
+#include "containers/hashtable.h"
+#include "containers/stringview.h"
+#include "game/chunk_map.h"
+#include "math/math.h"
+#include "platform/platform.h"
+
+#include <cstdio>
+#include <cstring>
+
+static constexpr u64 groupWidth = 16;          // Same as HashTable::GROUP_WIDTH
+static constexpr u64 avalancheSampleCount = 1024;
+static constexpr u64 maxKeyLength = 64;
+
+struct KeySet
+{
+    const char* name;
+    u64 count;
+
+    u64* integers;                              // Only set for integer keys
+    StringView* strings;                        // Only set for string keys
+    char* arena;
+};
+
+static Hash HashFNV1a(const char* buffer, u64 length)
+{
+    Hash hash = 0xCBF29CE484222325ull;
+    for (u64 i = 0; i < length; i++)
+        hash = (hash ^ (u8) buffer[i]) * 0x100000001B3ull;
+
+    return hash;
+}
+
+using StringHashFunction = Hash (*)(const char* buffer, u64 length);
+
+static Hash HashProjectString(const char* buffer, u64 length)
+{
+    return HashCharBuffer(buffer, length);
+}
+
+static KeySet MakeChunkCoordKeys()
+{
+    // A loaded area around the player, the shape the chunk map actually holds
+    constexpr s32 radius = 48, height = 8;
+
+    KeySet keys = {};
+    keys.name = "chunk coords";
+    keys.count = (2 * radius) * (2 * radius) * (2 * height);
+    keys.integers = (u64*) PlatformAllocate(keys.count * sizeof(u64));
+
+    u64 index = 0;
+    for (s32 y = -height; y < height; y++)
+    {
+        for (s32 z = -radius; z < radius; z++)
+        {
+            for (s32 x = -radius; x < radius; x++)
+                keys.integers[index++] = PackChunkCoord(Vector3Int { x, y, z });
+        }
+    }
+
+    return keys;
+}
+
+static void AddStringKey(KeySet& keys, u64& arenaOffset, const char* key, s32 length)
+{
+    keys.strings[keys.count++] = StringView(keys.arena + arenaOffset, (u64) length);
+    PlatformCopyMemory(keys.arena + arenaOffset, key, length);
+    arenaOffset += length;
+}
+
+static KeySet MakeTexturePathKeys()
+{
+    const char* folders[] = {
+        "assets/art/atlas/", "assets/art/ui/", "assets/art/skybox/default/", "assets/art/skybox/simple/",
+        "assets/art/blocks/", "assets/art/items/", "assets/art/entities/", "assets/fonts/",
+    };
+
+    const char* names[] = {
+        "grass", "dirt", "stone", "sand", "water", "log", "leaves", "planks",
+        "coal_ore", "iron_ore", "gold_ore", "bedrock", "crosshair", "button", "right", "left",
+    };
+
+    constexpr u64 folderCount = sizeof(folders) / sizeof(folders[0]);
+    constexpr u64 nameCount = sizeof(names) / sizeof(names[0]);
+    constexpr u64 variantCount = 128;
+
+    KeySet keys = {};
+    keys.name = "texture paths";
+    keys.strings = (StringView*) PlatformAllocate(folderCount * nameCount * variantCount * sizeof(StringView));
+    keys.arena = (char*) PlatformAllocate(folderCount * nameCount * variantCount * maxKeyLength);
+
+    u64 arenaOffset = 0;
+    for (u64 folder = 0; folder < folderCount; folder++)
+    {
+        for (u64 name = 0; name < nameCount; name++)
+        {
+            for (u64 variant = 0; variant < variantCount; variant++)
+            {
+                char key[maxKeyLength];
+                const s32 length = snprintf(key, maxKeyLength, "%s%s_%llu.png", folders[folder], names[name], (unsigned long long) variant);
+                AddStringKey(keys, arenaOffset, key, length);
+            }
+        }
+    }
+
+    return keys;
+}
+
+static KeySet MakeJsonKeys()
+{
+    const char* words[] = {
+        "unicode", "advance", "plane", "atlas", "bounds", "left", "bottom", "right",
+        "top", "line", "height", "width", "ascender", "descender", "underline", "thickness",
+        "em", "size", "distance", "range", "origin", "name", "type", "glyphs",
+        "metrics", "kerning", "x", "y",
+    };
+
+    constexpr u64 wordCount = sizeof(words) / sizeof(words[0]);
+    constexpr u64 suffixCount = 21;            // No suffix and then 0 to 19
+
+    KeySet keys = {};
+    keys.name = "json keys";
+    keys.strings = (StringView*) PlatformAllocate(wordCount * wordCount * suffixCount * sizeof(StringView));
+    keys.arena = (char*) PlatformAllocate(wordCount * wordCount * suffixCount * maxKeyLength);
+
+    u64 arenaOffset = 0;
+    for (u64 first = 0; first < wordCount; first++)
+    {
+        for (u64 second = 0; second < wordCount; second++)
+        {
+            for (u64 suffix = 0; suffix < suffixCount; suffix++)
+            {
+                // camelCase: "planeBounds", "lineHeight3" etc.
+                char key[maxKeyLength];
+                s32 length = snprintf(key, maxKeyLength, "%s%s", words[first], words[second]);
+                key[strlen(words[first])] -= 'a' - 'A';
+
+                if (suffix > 0)
+                    length += snprintf(key + length, maxKeyLength - length, "%llu", (unsigned long long) (suffix - 1));
+
+                AddStringKey(keys, arenaOffset, key, length);
+            }
+        }
+    }
+
+    return keys;
+}
+
+static void FreeKeySet(KeySet& keys)
+{
+    if (keys.integers) PlatformFree(keys.integers);
+    if (keys.strings)  PlatformFree(keys.strings);
+    if (keys.arena)    PlatformFree(keys.arena);
+}
+
+static Hash HashKey(const KeySet& keys, u64 index, StringHashFunction hashString)
+{
+    if (keys.integers)
+        return Hasher<u64>()(keys.integers[index]);
+
+    const StringView key = keys.strings[index];
+    return hashString(key.cstr(), key.size());
+}
+
+// Chi-squared of the counts divided by its degrees of freedom, 1 for a uniform hash
+static f64 ChiSquaredScore(const u64* counts, u64 bucketCount, u64 total)
+{
+    const f64 expected = (f64) total / (f64) bucketCount;
+
+    f64 chiSquared = 0.0;
+    for (u64 i = 0; i < bucketCount; i++)
+    {
+        const f64 difference = (f64) counts[i] - expected;
+        chiSquared += difference * difference / expected;
+    }
+
+    return chiSquared / (f64) (bucketCount - 1);
+}
+
+static void MeasureDistribution(const KeySet& keys, StringHashFunction hashString, f64& groupScore, f64& controlScore)
+{
+    // Smallest capacity the table would grow to for this many keys (7/8 max load)
+    u64 capacity = groupWidth;
+    while (capacity * 7 / 8 < keys.count)
+        capacity *= 2;
+
+    const u64 groupCount = capacity / groupWidth;
+    u64* groups = (u64*) PlatformAllocate(groupCount * sizeof(u64));
+    PlatformZeroMemory(groups, groupCount * sizeof(u64));
+
+    u64 controls[128] = {};
+
+    for (u64 i = 0; i < keys.count; i++)
+    {
+        const Hash hash = HashKey(keys, i, hashString);
+        groups[(hash >> 7) & (groupCount - 1)]++;
+        controls[hash & 0x7F]++;
+    }
+
+    groupScore = ChiSquaredScore(groups, groupCount, keys.count);
+    controlScore = ChiSquaredScore(controls, 128, keys.count);
+
+    PlatformFree(groups);
+}
+
+// Worst distance from 0.5 of the chance that an output bit flips when one input bit does
+static f64 MeasureAvalanche(const KeySet& keys, StringHashFunction hashString)
+{
+    u64 flips[64] = {};
+    u64 trials = 0;
+
+    const u64 step = (keys.count > avalancheSampleCount) ? keys.count / avalancheSampleCount : 1;
+    for (u64 i = 0; i < keys.count; i += step)
+    {
+        if (keys.integers)
+        {
+            const u64 key = keys.integers[i];
+            const Hash hash = Hasher<u64>()(key);
+
+            for (u32 bit = 0; bit < 64; bit++)
+            {
+                const Hash changed = hash ^ Hasher<u64>()(key ^ (1ull << bit));
+                for (u32 out = 0; out < 64; out++)
+                    flips[out] += (changed >> out) & 1;
+
+                trials++;
+            }
+        }
+        else
+        {
+            const StringView key = keys.strings[i];
+            const Hash hash = hashString(key.cstr(), key.size());
+
+            char buffer[maxKeyLength];
+            PlatformCopyMemory(buffer, key.cstr(), key.size());
+
+            for (u64 bit = 0; bit < 8 * key.size(); bit++)
+            {
+                buffer[bit / 8] ^= (char) (1 << (bit % 8));
+                const Hash changed = hash ^ hashString(buffer, key.size());
+                buffer[bit / 8] ^= (char) (1 << (bit % 8));
+
+                for (u32 out = 0; out < 64; out++)
+                    flips[out] += (changed >> out) & 1;
+
+                trials++;
+            }
+        }
+    }
+
+    f64 worstBias = 0.0;
+    for (u32 out = 0; out < 64; out++)
+    {
+        const f64 bias = (f64) flips[out] / (f64) trials - 0.5;
+        worstBias = Max(worstBias, (bias < 0.0) ? -bias : bias);
+    }
+
+    return worstBias;
+}
+
+static f64 MeasureHashTime(const KeySet& keys, StringHashFunction hashString)
+{
+    constexpr u32 repeats = 20;
+
+    u64 combined = 0;
+    const f64 start = BenchmarkTime();
+
+    for (u32 repeat = 0; repeat < repeats; repeat++)
+    {
+        for (u64 i = 0; i < keys.count; i++)
+            combined += HashKey(keys, i, hashString);
+    }
+
+    const f64 elapsed = BenchmarkTime() - start;
+    BenchmarkKeep(combined);
+
+    return elapsed * 1e9 / (f64) (repeats * keys.count);
+}
+
+// Inserting every key into a HashTable and then finding each one, the best of a few runs
+template <typename Key>
+static void MeasureTableTime(const Key* keys, u64 count, f64& insertTime, f64& findTime)
+{
+    constexpr u32 runs = 5;
+
+    insertTime = findTime = 1e9;
+    for (u32 run = 0; run < runs; run++)
+    {
+        HashTable<Key, u32> table;
+
+        f64 start = BenchmarkTime();
+        for (u64 i = 0; i < count; i++)
+            table.Place(keys[i], (u32) i);
+
+        insertTime = Min(insertTime, (BenchmarkTime() - start) * 1e9 / (f64) count);
+
+        u64 found = 0;
+        start = BenchmarkTime();
+        for (u64 i = 0; i < count; i++)
+            found += (table.Find(keys[i]) != table.end());
+
+        findTime = Min(findTime, (BenchmarkTime() - start) * 1e9 / (f64) count);
+        BenchmarkKeep(found);
+    }
+}
+
+static void RunKeySet(const KeySet& keys)
+{
+    u64 totalLength = 0;
+    if (keys.strings)
+    {
+        for (u64 i = 0; i < keys.count; i++)
+            totalLength += keys.strings[i].size();
+    }
+
+    printf("%s: %llu keys", keys.name, (unsigned long long) keys.count);
+    if (keys.strings)
+        printf(", %.1f bytes on average", (f64) totalLength / (f64) keys.count);
+    printf("\n");
+
+    struct
+    {
+        const char* name;
+        StringHashFunction function;
+    } hashes[] = {
+        { "HashCharBuffer", HashProjectString },
+        { "FNV-1a",         HashFNV1a },
+    };
+
+    // Integer keys only have the one hash
+    const u32 hashCount = keys.strings ? 2 : 1;
+
+    for (u32 i = 0; i < hashCount; i++)
+    {
+        f64 groupScore, controlScore;
+        MeasureDistribution(keys, hashes[i].function, groupScore, controlScore);
+
+        const f64 avalanche = MeasureAvalanche(keys, hashes[i].function);
+        const f64 hashTime = MeasureHashTime(keys, hashes[i].function);
+
+        printf("    %-16s groups chi2 %.3f, H2 chi2 %.3f, worst avalanche bias %.4f, %.2f ns/key",
+               keys.strings ? hashes[i].name : "Hasher<u64>", groupScore, controlScore, avalanche, hashTime);
+
+        if (keys.strings)
+            printf(" (%.2f GB/s)", (f64) totalLength / (hashTime * (f64) keys.count));
+        printf("\n");
+    }
+
+    f64 insertTime, findTime;
+    if (keys.integers)
+        MeasureTableTime(keys.integers, keys.count, insertTime, findTime);
+    else
+        MeasureTableTime(keys.strings, keys.count, insertTime, findTime);
+
+    printf("    HashTable        insert %.2f ns/key, find %.2f ns/key\n", insertTime, findTime);
+}
+
+int main()
+{
+    KeySet keySets[] = {
+        MakeChunkCoordKeys(),
+        MakeTexturePathKeys(),
+        MakeJsonKeys(),
+    };
+
+    for (KeySet& keys : keySets)
+    {
+        RunKeySet(keys);
+        FreeKeySet(keys);
+    }
+
+    return 0;
+}
\ No newline at end of file
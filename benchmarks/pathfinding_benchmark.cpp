@@ -0,0 +1,221 @@
+/*
+
+Pathfinding over a generated world at a fixed seed.
+
+The chunk area is loaded the same way the game loads it (a band of chunks
+with coarser rings further out) and generated with the game's world seed.
+The abstract graph is built over the frames after loading, then random
+pairs of standing spots in the full resolution chunks are queried, first
+all at once and then one at a time. Finally a wall is built across the
+area and the graph is updated for the chunks it touched.
+
+Queries are picked with a fixed seed too, so runs can be compared.
+
+*/
+
+#include "benchmark.h"
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "engine/job_system.h"
+#include "game/chunk_area.h"
+#include "game/pathfinding.h"
+#include "game/voxel_physics.h"
+#include "game/world_gen.h"
+#include "math/math.h"
+#include "platform/platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr u64 worldSeed = 20230815;     // Same seed as the game
+static constexpr u32 graphFrames = 100;
+static constexpr u32 queryCount = 200;
+static constexpr s32 queryExtent = 90;          // Queries stay within the full resolution chunks around the origin
+static constexpr s32 wallLength = 81;
+
+static VoxelChunkArea area;
+static WorldGenerator worldGen;
+
+static bool CanStandAt(VoxelQuery& query, s32 x, s32 y, s32 z)
+{
+    return query.IsSolid(x, y - 1, z) && !query.IsSolid(x, y, z) && !query.IsSolid(x, y + 1, z);
+}
+
+// Highest spot an agent can stand at in the block column, false if there isn't one
+static bool FindSurface(s32 x, s32 z, Vector3Int& position)
+{
+    VoxelQuery query(area);
+
+    // Chunks above the band aren't loaded and count as solid, so start below them
+    for (s32 y = CHUNK_SIZE - 2; y > -2 * (s32) CHUNK_SIZE; y--)
+    {
+        if (CanStandAt(query, x, y, z))
+        {
+            position = Vector3Int { x, y, z };
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static s32 RandomCoordinate()
+{
+    return (rand() % (2 * queryExtent + 1)) - queryExtent;
+}
+
+static void PlaceBlock(const Vector3Int& position, BlockType type)
+{
+    const Vector3Int chunkIndex = {
+        (s32) Math::Floor((f32) position.x / CHUNK_SIZE),
+        (s32) Math::Floor((f32) position.y / CHUNK_SIZE),
+        (s32) Math::Floor((f32) position.z / CHUNK_SIZE)
+    };
+
+    const Vector3Int blockIndex = {
+        position.x - chunkIndex.x * (s32) CHUNK_SIZE,
+        position.y - chunkIndex.y * (s32) CHUNK_SIZE,
+        position.z - chunkIndex.z * (s32) CHUNK_SIZE
+    };
+
+    PlaceBlockAtPosition(area, chunkIndex, blockIndex, type);
+}
+
+int main()
+{
+    JobSystem::Init();
+    srand(11);
+
+    {   // Same load shape as the game
+        ChunkLoadShape shape;
+        shape.type = ChunkLoadShape::Type::CYLINDER;
+        shape.radius = 12;
+        shape.useBand = true;
+        shape.bandMinY = -2;
+        shape.bandMaxY = 0;
+
+        shape.lodDistances[0] = 4;
+        shape.lodDistances[1] = 7;
+        shape.lodDistances[2] = 10;
+
+        const f64 start = BenchmarkTime();
+
+        worldGen.Create(worldSeed);
+        area.Create(shape);
+        area.InitializeChunkArea(worldGen, Vector3(0.0f));
+
+        printf("world: generated and meshed in %.1f ms (seed %llu)\n", (BenchmarkTime() - start) * 1e3, (unsigned long long) worldSeed);
+    }
+
+    {   // Abstract graph
+        f64 total = 0.0, worst = 0.0;
+        for (u32 frame = 0; frame < graphFrames; frame++)
+        {
+            const f64 start = BenchmarkTime();
+            UpdatePathfinding(area);
+
+            const f64 elapsed = BenchmarkTime() - start;
+            total += elapsed;
+            worst = Max(worst, elapsed);
+        }
+
+        printf("graph: %.1f ms over %u frames, worst frame %.2f ms\n", total * 1e3, graphFrames, worst * 1e3);
+    }
+
+    Vector3Int starts[queryCount], goals[queryCount];
+    for (u32 i = 0; i < queryCount; i++)
+    {
+        while (!FindSurface(RandomCoordinate(), RandomCoordinate(), starts[i]));
+        while (!FindSurface(RandomCoordinate(), RandomCoordinate(), goals[i]));
+    }
+
+    u32 invalid = 0;
+    DynamicArray<Vector3Int> path;
+
+    {   // All queries in the same frame
+        PathQuery queries[queryCount];
+        for (u32 i = 0; i < queryCount; i++)
+            queries[i] = RequestPath(starts[i], goals[i]);
+
+        // The first update starts the queries and the second one waits for them
+        UpdatePathfinding(area);
+
+        const f64 start = BenchmarkTime();
+        UpdatePathfinding(area);
+        const f64 elapsed = BenchmarkTime() - start;
+
+        u32 found = 0;
+        u64 totalLength = 0;
+
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            const PathStatus status = GetPathStatus(queries[i]);
+            if (status == PathStatus::FOUND && GetPath(queries[i], path))
+            {
+                found++;
+                totalLength += path.size();
+
+                // Paths have to start and end where they were asked to
+                invalid += (path[0] != starts[i]) || (path[path.size() - 1] != goals[i]);
+            }
+            else if (status != PathStatus::NOT_FOUND)
+                invalid++;
+
+            ReleasePath(queries[i]);
+        }
+
+        printf("%u queries at once: %.2f ms waiting for the results, %u found, %.1f voxels per path\n",
+               queryCount, elapsed * 1e3, found, (found > 0) ? (f64) totalLength / found : 0.0);
+    }
+
+    {   // One query at a time, so this is the latency of a single query
+        const f64 start = BenchmarkTime();
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            const PathQuery query = RequestPath(starts[i], goals[i]);
+            UpdatePathfinding(area);
+            UpdatePathfinding(area);
+
+            invalid += (GetPathStatus(query) == PathStatus::PENDING);
+            ReleasePath(query);
+        }
+
+        printf("one query at a time: %.3f ms per query (two updates each)\n", (BenchmarkTime() - start) * 1e3 / queryCount);
+    }
+
+    {   // Wall across the middle of the area, 4 blocks high
+        f64 start = BenchmarkTime();
+        u32 columns = 0;
+
+        for (s32 z = -wallLength / 2; z <= wallLength / 2; z++)
+        {
+            Vector3Int surface;
+            if (!FindSurface(3, z, surface))
+                continue;
+
+            for (s32 height = 0; height < 4; height++)
+                PlaceBlock(surface + Vector3Int { 0, height, 0 }, BlockType::STONE);
+
+            columns++;
+        }
+
+        const f64 placeTime = BenchmarkTime() - start;
+
+        start = BenchmarkTime();
+        UpdatePathfinding(area);
+        const f64 updateTime = BenchmarkTime() - start;
+
+        printf("wall of %u columns: placed in %.1f ms, graph updated in %.2f ms\n", columns, placeTime * 1e3, updateTime * 1e3);
+    }
+
+    if (invalid > 0)
+        printf("FAILED: %u queries gave an invalid result\n", invalid);
+
+    FreePathfindingData();
+    area.Free();
+    worldGen.Free();
+    JobSystem::Shutdown();
+
+    return (int) invalid;
+}
\ No newline at end of file
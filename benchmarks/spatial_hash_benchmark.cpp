@@ -0,0 +1,193 @@
+/*
+
+SpatialHash with 10k entities spread over a 400 x 50 x 400 block area.
+
+Most entities are about mob sized and every 50th one is a lot bigger so some
+of them span several cells. The hash is rebuilt after moving the entities
+each tick, the same way the game does it, and the queries are timed against
+checking every entity one by one. The number of results of both has to match,
+otherwise the benchmark fails.
+
+The entities are placed with a fixed seed so runs can be compared.
+
+*/
+
+#include "benchmark.h"
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "engine/job_system.h"
+#include "game/aabb.h"
+#include "game/entities.h"
+#include "game/intersections.h"
+#include "game/spatial_hash.h"
+#include "math/math.h"
+#include "platform/platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr u32 entityCount = 10000;
+static constexpr u32 queryCount = 1000;
+static constexpr u32 buildTicks = 100;
+static constexpr f32 cellSize = 8.0f;
+static constexpr f32 queryRadius = 16.0f;
+static constexpr f32 queryHalfSize = 5.0f;
+
+static f32 RandomRange(f32 min, f32 max)
+{
+    return min + (max - min) * Math::Random();
+}
+
+static Vector3 RandomPosition()
+{
+    return Vector3(RandomRange(-200.0f, 200.0f), RandomRange(-10.0f, 40.0f), RandomRange(-200.0f, 200.0f));
+}
+
+static AABB WorldBox(EntityWorld& world, EntityHandle entity)
+{
+    const Vector3 position = *world.GetPosition(entity);
+    const AABB bounds = *world.GetBounds(entity);
+
+    return AABB { position + bounds.min, position + bounds.max };
+}
+
+int main()
+{
+    JobSystem::Init();
+    srand(7);
+
+    EntityWorld world;
+    world.Create();
+
+    DynamicArray<EntityHandle> entities;
+    for (u32 i = 0; i < entityCount; i++)
+    {
+        const EntityHandle entity = world.CreateEntity(ENTITY_COMPONENT_POSITION | ENTITY_COMPONENT_VELOCITY | ENTITY_COMPONENT_BOUNDS);
+        const f32 halfWidth = (i % 50 == 0) ? RandomRange(2.0f, 9.0f) : RandomRange(0.25f, 0.9f);
+
+        *world.GetPosition(entity) = RandomPosition();
+        *world.GetVelocity(entity) = Vector3(RandomRange(-4.0f, 4.0f), 0.0f, RandomRange(-4.0f, 4.0f));
+        *world.GetBounds(entity) = AABB { Vector3(-halfWidth, 0.0f, -halfWidth), Vector3(halfWidth, 2.0f * halfWidth, halfWidth) };
+
+        entities.PushBack(entity);
+    }
+
+    SpatialHash hash;
+    hash.Create(cellSize);
+
+    u32 mismatches = 0;
+
+    {   // Rebuilding every tick
+        f64 buildTime = 0.0;
+        for (u32 tick = 0; tick < buildTicks; tick++)
+        {
+            IntegrateEntityVelocities(world, 1.0f / 60.0f);
+
+            const f64 start = BenchmarkTime();
+            hash.Build(world);
+            buildTime += BenchmarkTime() - start;
+        }
+
+        printf("build: %.3f ms per tick (%u entities, %.0f block cells)\n", buildTime * 1e3 / buildTicks, entityCount, cellSize);
+    }
+
+    DynamicArray<u32> resultStarts;
+    DynamicArray<EntityHandle> results;
+
+    {   // Radius queries
+        Vector3* centers = (Vector3*) PlatformAllocate(queryCount * sizeof(Vector3));
+        f32* radii = (f32*) PlatformAllocate(queryCount * sizeof(f32));
+
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            centers[i] = RandomPosition();
+            radii[i] = queryRadius;
+        }
+
+        f64 start = BenchmarkTime();
+        hash.QueryRadii(centers, radii, queryCount, resultStarts, results);
+        const f64 hashTime = BenchmarkTime() - start;
+
+        u64 bruteForceCount = 0;
+        start = BenchmarkTime();
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            for (u64 j = 0; j < entities.size(); j++)
+                bruteForceCount += Intersection(WorldBox(world, entities[j]), centers[i], radii[i]);
+        }
+        const f64 bruteForceTime = BenchmarkTime() - start;
+
+        printf("radius %.0f: %.2f us per query, brute force %.2f us, %.1f results per query\n",
+               queryRadius, hashTime * 1e6 / queryCount, bruteForceTime * 1e6 / queryCount, (f64) results.size() / queryCount);
+
+        mismatches += (results.size() != bruteForceCount);
+
+        PlatformFree(centers);
+        PlatformFree(radii);
+    }
+
+    {   // Box queries
+        AABB* boxes = (AABB*) PlatformAllocate(queryCount * sizeof(AABB));
+
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            const Vector3 center = RandomPosition();
+            boxes[i] = AABB { center - Vector3(queryHalfSize), center + Vector3(queryHalfSize) };
+        }
+
+        results.Clear(false);
+
+        f64 start = BenchmarkTime();
+        hash.QueryAABBs(boxes, queryCount, resultStarts, results);
+        const f64 hashTime = BenchmarkTime() - start;
+
+        u64 bruteForceCount = 0;
+        start = BenchmarkTime();
+        for (u32 i = 0; i < queryCount; i++)
+        {
+            for (u64 j = 0; j < entities.size(); j++)
+                bruteForceCount += Intersection(WorldBox(world, entities[j]), boxes[i]);
+        }
+        const f64 bruteForceTime = BenchmarkTime() - start;
+
+        printf("box %.0f: %.2f us per query, brute force %.2f us, %.1f results per query\n",
+               2.0f * queryHalfSize, hashTime * 1e6 / queryCount, bruteForceTime * 1e6 / queryCount, (f64) results.size() / queryCount);
+
+        mismatches += (results.size() != bruteForceCount);
+
+        PlatformFree(boxes);
+    }
+
+    {   // Overlapping pairs
+        DynamicArray<SpatialHashPair> pairs;
+
+        f64 start = BenchmarkTime();
+        hash.FindOverlappingPairs(pairs);
+        const f64 hashTime = BenchmarkTime() - start;
+
+        u64 bruteForceCount = 0;
+        start = BenchmarkTime();
+        for (u64 i = 0; i < entities.size(); i++)
+        {
+            const AABB box = WorldBox(world, entities[i]);
+            for (u64 j = i + 1; j < entities.size(); j++)
+                bruteForceCount += Intersection(box, WorldBox(world, entities[j]));
+        }
+        const f64 bruteForceTime = BenchmarkTime() - start;
+
+        printf("pairs: %.3f ms, brute force %.1f ms, %llu overlapping pairs\n",
+               hashTime * 1e3, bruteForceTime * 1e3, (unsigned long long) pairs.size());
+
+        mismatches += (pairs.size() != bruteForceCount);
+    }
+
+    if (mismatches > 0)
+        printf("FAILED: %u kinds of queries didn't match the brute force results\n", mismatches);
+
+    hash.Free();
+    world.Free();
+    JobSystem::Shutdown();
+
+    return (int) mismatches;
+}
\ No newline at end of file
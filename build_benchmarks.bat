@@ -0,0 +1,42 @@
+@echo off
+
+rem Benchmarks link against the release engine library, run "build_engine_lib.bat release" first
+
+set includes= /I src ^
+              /I benchmarks ^
+              /I dependencies\glad\include ^
+              /I dependencies\stb\include ^
+              /I dependencies\SimplexNoise\src
+
+set libs= Shell32.lib                     ^
+          User32.lib                      ^
+          Gdi32.lib                       ^
+          OpenGL32.lib                    ^
+          msvcrt.lib                      ^
+          Comdlg32.lib                    ^
+          lib\engine.lib                  ^
+          lib\game.lib                    ^
+          dependencies\glad\lib\glad.lib  ^
+          dependencies\stb\lib\stb.lib    ^
+          dependencies\SimplexNoise\lib\SimplexNoise.lib
+
+set defines= /DGN_USE_OPENGL /DGN_PLATFORM_WINDOWS /DGN_RELEASE /DNDEBUG /DGN_COMPILER_MSVC
+set compile_flags= /O2 /EHsc /std:c++17 /cgthreads8 /MP7 /GL
+set link_flags= /NODEFAULTLIB:LIBCMT /SUBSYSTEM:CONSOLE /LTCG
+
+rem Game code, as a library so each benchmark only links what it uses
+cl /c %compile_flags% src/game/*.cpp %defines% %includes%
+
+if not exist lib md lib
+lib *.obj /OUT:lib\game.lib
+del *.obj
+
+if not exist bin md bin
+
+rem One executable per benchmark
+for %%f in (benchmarks\*.cpp) do (
+    cl %compile_flags% %%f %defines% %includes% /Fe:bin\%%~nf.exe /link %libs% %link_flags%
+)
+
+rem Delete Intermediate Files
+del *.obj *.exp
\ No newline at end of file
@@ -0,0 +1,46 @@
+@echo off
+
+rem Tests link against the debug engine library, run "build_engine_lib.bat" first
+
+set includes= /I src ^
+              /I tests ^
+              /I dependencies\glad\include ^
+              /I dependencies\stb\include ^
+              /I dependencies\SimplexNoise\src
+
+set libs= Shell32.lib                     ^
+          User32.lib                      ^
+          Gdi32.lib                       ^
+          OpenGL32.lib                    ^
+          msvcrt.lib                      ^
+          Comdlg32.lib                    ^
+          lib\engine.lib                  ^
+          lib\game.lib                    ^
+          dependencies\glad\lib\glad.lib  ^
+          dependencies\stb\lib\stb.lib    ^
+          dependencies\SimplexNoise\lib\SimplexNoise.lib
+
+set defines= /DGN_USE_OPENGL /DGN_PLATFORM_WINDOWS /DGN_DEBUG /DGN_COMPILER_MSVC
+set compile_flags= /Zi /EHsc /std:c++17 /cgthreads8 /MP7
+set link_flags= /DEBUG /NODEFAULTLIB:LIBCMT /SUBSYSTEM:CONSOLE
+
+rem Game code, as a library so each test only links what it uses
+cl /c %compile_flags% src/game/*.cpp %defines% %includes%
+
+if not exist lib md lib
+lib *.obj /OUT:lib\game.lib
+del *.obj
+
+if not exist bin md bin
+
+rem One executable per test, each one is run right after it's built
+set failed=0
+for %%f in (tests\*.cpp) do (
+    cl %compile_flags% %%f %defines% %includes% /Fe:bin\%%~nf.exe /link %libs% %link_flags%
+    bin\%%~nf.exe || set failed=1
+)
+
+rem Delete Intermediate Files
+del *.obj *.exp *.ilk
+
+exit /b %failed%
\ No newline at end of file
@@ -472,4 +472,589 @@ float SimplexNoise::fractal(size_t octaves, float x, float y, float z) const {
     }
 
     return (output / denom);
+}
+
+/*
+ * Batch evaluation
+ *
+ * The grid functions evaluate the noise on every point of a grid given by the coordinates along each axis:
+ * sample (i, j, k) is written to out[i + j * countX + k * countX * countY] (2D grids leave out k).
+ *
+ * The points are flattened into short streams and handed to a kernel picked once at runtime from the
+ * instruction sets the CPU supports: AVX2 (8 points at a time), SSE4.1 (4 points at a time) or the
+ * scalar functions above. Only the gradient hashing is done per lane on SSE4.1, AVX2 gathers it.
+ *
+ * The SIMD kernels do the same floating point operations in the same order as the scalar functions,
+ * so with the default floating point model (no contraction into FMA instructions) their results match
+ * noise() and fractal() bit for bit on every path. Builds that let the compiler contract the scalar code
+ * (like /fp:contract with /arch:AVX2) can differ by up to 1e-4, and by up to 1e-2 at the few points that
+ * sit right on the border of a 3D simplex cell, where the 3D noise itself jumps because of its 0.6 falloff.
+ */
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMPLEX_NOISE_SIMD 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMPLEX_TARGET(isa)
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define SIMPLEX_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define SIMPLEX_NOISE_SIMD 0
+#endif
+
+/// Points handed to a kernel at once
+static const size_t BATCH_SIZE = 256;
+
+typedef void (*NoiseKernel2D)(const float* x, const float* y, float* out, size_t count);
+typedef void (*NoiseKernel3D)(const float* x, const float* y, const float* z, float* out, size_t count);
+
+static void noise2DScalar(const float* x, const float* y, float* out, size_t count) {
+    for (size_t p = 0; p < count; p++) {
+        out[p] = SimplexNoise::noise(x[p], y[p]);
+    }
+}
+
+static void noise3DScalar(const float* x, const float* y, const float* z, float* out, size_t count) {
+    for (size_t p = 0; p < count; p++) {
+        out[p] = SimplexNoise::noise(x[p], y[p], z[p]);
+    }
+}
+
+#if SIMPLEX_NOISE_SIMD
+
+/// Permutation table widened to 32 bits for the AVX2 gathers, filled in before the AVX2 kernels are picked
+static int32_t perm32[256];
+
+/*
+ * SSE4.1 kernels
+ */
+
+SIMPLEX_TARGET("sse4.1") static inline __m128i fastfloorSSE41(__m128 fp) {
+    const __m128i i = _mm_cvttps_epi32(fp);
+    // Adding the all ones mask subtracts 1 where truncation rounded up
+    return _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(fp, _mm_cvtepi32_ps(i))));
+}
+
+SIMPLEX_TARGET("sse4.1") static inline __m128i hashSSE41(__m128i i) {
+    return _mm_setr_epi32(perm[static_cast<uint8_t>(_mm_extract_epi32(i, 0))],
+                          perm[static_cast<uint8_t>(_mm_extract_epi32(i, 1))],
+                          perm[static_cast<uint8_t>(_mm_extract_epi32(i, 2))],
+                          perm[static_cast<uint8_t>(_mm_extract_epi32(i, 3))]);
+}
+
+/// Flips the sign of v in the lanes where the bit of h is set
+SIMPLEX_TARGET("sse4.1") static inline __m128 flipSignSSE41(__m128 v, __m128i h, int bit) {
+    const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1 << bit)), 31 - bit);
+    return _mm_xor_ps(v, _mm_castsi128_ps(sign));
+}
+
+SIMPLEX_TARGET("sse4.1") static inline __m128 gradSSE41(__m128i hash, __m128 x, __m128 y) {
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0x3F));
+    const __m128 low = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    const __m128 u = _mm_blendv_ps(y, x, low);
+    const __m128 v = _mm_blendv_ps(x, y, low);
+    return _mm_add_ps(flipSignSSE41(u, h, 0), flipSignSSE41(_mm_mul_ps(_mm_set1_ps(2.0f), v), h, 1));
+}
+
+SIMPLEX_TARGET("sse4.1") static inline __m128 gradSSE41(__m128i hash, __m128 x, __m128 y, __m128 z) {
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+    const __m128 u = _mm_blendv_ps(y, x, _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8))));
+    const __m128i useX = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+    const __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, _mm_castsi128_ps(useX)), y,
+                                   _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4))));
+    return _mm_add_ps(flipSignSSE41(u, h, 0), flipSignSSE41(v, h, 1));
+}
+
+/// Contribution of a corner, t is its falloff before squaring
+SIMPLEX_TARGET("sse4.1") static inline __m128 cornerSSE41(__m128 t, __m128 grad) {
+    const __m128 t2 = _mm_mul_ps(t, t);
+    return _mm_andnot_ps(_mm_cmplt_ps(t, _mm_setzero_ps()), _mm_mul_ps(_mm_mul_ps(t2, t2), grad));
+}
+
+SIMPLEX_TARGET("sse4.1") static void noise2DSSE41(const float* xs, const float* ys, float* out, size_t count) {
+    static const float F2 = 0.366025403f;
+    static const float G2 = 0.211324865f;
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    size_t p = 0;
+    for (; p + 4 <= count; p += 4) {
+        const __m128 x = _mm_loadu_ps(xs + p);
+        const __m128 y = _mm_loadu_ps(ys + p);
+
+        // Skew the input space to determine which simplex cell we're in
+        const __m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+        const __m128i i = fastfloorSSE41(_mm_add_ps(x, s));
+        const __m128i j = fastfloorSSE41(_mm_add_ps(y, s));
+
+        // Unskew the cell origin back to (x,y) space
+        const __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), _mm_set1_ps(G2));
+        const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        const __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+        // Lower triangle where x0 > y0, the offsets of the middle corner are (1,0) there and (0,1) elsewhere
+        const __m128 lower = _mm_cmpgt_ps(x0, y0);
+        const __m128 i1 = _mm_and_ps(lower, one);
+        const __m128 j1 = _mm_andnot_ps(lower, one);
+
+        const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), _mm_set1_ps(G2));
+        const __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), _mm_set1_ps(G2));
+        const __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(2.0f * G2));
+        const __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(2.0f * G2));
+
+        // Work out the hashed gradient indices of the three simplex corners, subtracting a mask adds 1
+        const __m128i i1i = _mm_castps_si128(lower);
+        const __m128i j1i = _mm_castps_si128(_mm_andnot_ps(lower, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+        const __m128i gi0 = hashSSE41(_mm_add_epi32(i, hashSSE41(j)));
+        const __m128i gi1 = hashSSE41(_mm_add_epi32(_mm_sub_epi32(i, i1i), hashSSE41(_mm_sub_epi32(j, j1i))));
+        const __m128i gi2 = hashSSE41(_mm_add_epi32(_mm_add_epi32(i, _mm_set1_epi32(1)),
+                                                    hashSSE41(_mm_add_epi32(j, _mm_set1_epi32(1)))));
+
+        const __m128 t0 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0));
+        const __m128 t1 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1));
+        const __m128 t2 = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2));
+
+        const __m128 n0 = cornerSSE41(t0, gradSSE41(gi0, x0, y0));
+        const __m128 n1 = cornerSSE41(t1, gradSSE41(gi1, x1, y1));
+        const __m128 n2 = cornerSSE41(t2, gradSSE41(gi2, x2, y2));
+
+        _mm_storeu_ps(out + p, _mm_mul_ps(_mm_set1_ps(45.23065f), _mm_add_ps(_mm_add_ps(n0, n1), n2)));
+    }
+
+    noise2DScalar(xs + p, ys + p, out + p, count - p);
+}
+
+SIMPLEX_TARGET("sse4.1") static void noise3DSSE41(const float* xs, const float* ys, const float* zs, float* out, size_t count) {
+    static const float F3 = 1.0f / 3.0f;
+    static const float G3 = 1.0f / 6.0f;
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 falloff = _mm_set1_ps(0.6f);
+    const __m128 ones = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+    size_t p = 0;
+    for (; p + 4 <= count; p += 4) {
+        const __m128 x = _mm_loadu_ps(xs + p);
+        const __m128 y = _mm_loadu_ps(ys + p);
+        const __m128 z = _mm_loadu_ps(zs + p);
+
+        // Skew the input space to determine which simplex cell we're in
+        const __m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(F3));
+        const __m128i i = fastfloorSSE41(_mm_add_ps(x, s));
+        const __m128i j = fastfloorSSE41(_mm_add_ps(y, s));
+        const __m128i k = fastfloorSSE41(_mm_add_ps(z, s));
+
+        // Unskew the cell origin back to (x,y,z) space
+        const __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i, j), k)), _mm_set1_ps(G3));
+        const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        const __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+        const __m128 z0 = _mm_sub_ps(z, _mm_sub_ps(_mm_cvtepi32_ps(k), t));
+
+        // The branches of the scalar rank ordering as masks
+        const __m128 xy = _mm_cmpge_ps(x0, y0);
+        const __m128 yz = _mm_cmpge_ps(y0, z0);
+        const __m128 xz = _mm_cmpge_ps(x0, z0);
+        const __m128 i1 = _mm_and_ps(xy, _mm_or_ps(yz, xz));
+        const __m128 j1 = _mm_andnot_ps(xy, yz);
+        const __m128 k1 = _mm_andnot_ps(yz, _mm_xor_ps(_mm_and_ps(xy, xz), ones));
+        const __m128 i2 = _mm_or_ps(xy, _mm_and_ps(yz, xz));
+        const __m128 j2 = _mm_or_ps(_mm_xor_ps(xy, ones), yz);
+        const __m128 k2 = _mm_blendv_ps(_mm_xor_ps(_mm_and_ps(yz, xz), ones), _mm_xor_ps(yz, ones), xy);
+
+        const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i1, one)), _mm_set1_ps(G3));
+        const __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j1, one)), _mm_set1_ps(G3));
+        const __m128 z1 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k1, one)), _mm_set1_ps(G3));
+        const __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i2, one)), _mm_set1_ps(2.0f * G3));
+        const __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j2, one)), _mm_set1_ps(2.0f * G3));
+        const __m128 z2 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k2, one)), _mm_set1_ps(2.0f * G3));
+        const __m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(3.0f * G3));
+        const __m128 y3 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(3.0f * G3));
+        const __m128 z3 = _mm_add_ps(_mm_sub_ps(z0, one), _mm_set1_ps(3.0f * G3));
+
+        // Work out the hashed gradient indices of the four simplex corners, subtracting a mask adds 1
+        const __m128i inc = _mm_set1_epi32(1);
+        const __m128i gi0 = hashSSE41(_mm_add_epi32(i, hashSSE41(_mm_add_epi32(j, hashSSE41(k)))));
+        const __m128i gi1 = hashSSE41(_mm_add_epi32(_mm_sub_epi32(i, _mm_castps_si128(i1)),
+                                      hashSSE41(_mm_add_epi32(_mm_sub_epi32(j, _mm_castps_si128(j1)),
+                                      hashSSE41(_mm_sub_epi32(k, _mm_castps_si128(k1)))))));
+        const __m128i gi2 = hashSSE41(_mm_add_epi32(_mm_sub_epi32(i, _mm_castps_si128(i2)),
+                                      hashSSE41(_mm_add_epi32(_mm_sub_epi32(j, _mm_castps_si128(j2)),
+                                      hashSSE41(_mm_sub_epi32(k, _mm_castps_si128(k2)))))));
+        const __m128i gi3 = hashSSE41(_mm_add_epi32(_mm_add_epi32(i, inc),
+                                      hashSSE41(_mm_add_epi32(_mm_add_epi32(j, inc),
+                                      hashSSE41(_mm_add_epi32(k, inc))))));
+
+        const __m128 t0 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(falloff, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0)), _mm_mul_ps(z0, z0));
+        const __m128 t1 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(falloff, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1)), _mm_mul_ps(z1, z1));
+        const __m128 t2 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(falloff, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2)), _mm_mul_ps(z2, z2));
+        const __m128 t3 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(falloff, _mm_mul_ps(x3, x3)), _mm_mul_ps(y3, y3)), _mm_mul_ps(z3, z3));
+
+        const __m128 n0 = cornerSSE41(t0, gradSSE41(gi0, x0, y0, z0));
+        const __m128 n1 = cornerSSE41(t1, gradSSE41(gi1, x1, y1, z1));
+        const __m128 n2 = cornerSSE41(t2, gradSSE41(gi2, x2, y2, z2));
+        const __m128 n3 = cornerSSE41(t3, gradSSE41(gi3, x3, y3, z3));
+
+        _mm_storeu_ps(out + p, _mm_mul_ps(_mm_set1_ps(32.0f), _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3)));
+    }
+
+    noise3DScalar(xs + p, ys + p, zs + p, out + p, count - p);
+}
+
+
+/*
+ * AVX2 kernels, the same as the SSE4.1 ones on 8 lanes with gathers for the hashing
+ */
+
+SIMPLEX_TARGET("avx2") static inline __m256i fastfloorAVX2(__m256 fp) {
+    const __m256i i = _mm256_cvttps_epi32(fp);
+    return _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(fp, _mm256_cvtepi32_ps(i), _CMP_LT_OQ)));
+}
+
+SIMPLEX_TARGET("avx2") static inline __m256i hashAVX2(__m256i i) {
+    return _mm256_i32gather_epi32(perm32, _mm256_and_si256(i, _mm256_set1_epi32(0xFF)), 4);
+}
+
+SIMPLEX_TARGET("avx2") static inline __m256 flipSignAVX2(__m256 v, __m256i h, int bit) {
+    const __m256i sign = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1 << bit)), 31 - bit);
+    return _mm256_xor_ps(v, _mm256_castsi256_ps(sign));
+}
+
+SIMPLEX_TARGET("avx2") static inline __m256 gradAVX2(__m256i hash, __m256 x, __m256 y) {
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(0x3F));
+    const __m256 low = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    const __m256 u = _mm256_blendv_ps(y, x, low);
+    const __m256 v = _mm256_blendv_ps(x, y, low);
+    return _mm256_add_ps(flipSignAVX2(u, h, 0), flipSignAVX2(_mm256_mul_ps(_mm256_set1_ps(2.0f), v), h, 1));
+}
+
+SIMPLEX_TARGET("avx2") static inline __m256 gradAVX2(__m256i hash, __m256 x, __m256 y, __m256 z) {
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    const __m256 u = _mm256_blendv_ps(y, x, _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h)));
+    const __m256i useX = _mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)), _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14)));
+    const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, _mm256_castsi256_ps(useX)), y,
+                                      _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h)));
+    return _mm256_add_ps(flipSignAVX2(u, h, 0), flipSignAVX2(v, h, 1));
+}
+
+SIMPLEX_TARGET("avx2") static inline __m256 cornerAVX2(__m256 t, __m256 grad) {
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    return _mm256_andnot_ps(_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_mul_ps(_mm256_mul_ps(t2, t2), grad));
+}
+
+SIMPLEX_TARGET("avx2") static void noise2DAVX2(const float* xs, const float* ys, float* out, size_t count) {
+    static const float F2 = 0.366025403f;
+    static const float G2 = 0.211324865f;
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i inc = _mm256_set1_epi32(1);
+
+    size_t p = 0;
+    for (; p + 8 <= count; p += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + p);
+        const __m256 y = _mm256_loadu_ps(ys + p);
+
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(F2));
+        const __m256i i = fastfloorAVX2(_mm256_add_ps(x, s));
+        const __m256i j = fastfloorAVX2(_mm256_add_ps(y, s));
+
+        const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), _mm256_set1_ps(G2));
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+
+        const __m256 lower = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+        const __m256 i1 = _mm256_and_ps(lower, one);
+        const __m256 j1 = _mm256_andnot_ps(lower, one);
+
+        const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), _mm256_set1_ps(G2));
+        const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), _mm256_set1_ps(G2));
+        const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, one), _mm256_set1_ps(2.0f * G2));
+        const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, one), _mm256_set1_ps(2.0f * G2));
+
+        const __m256i i1i = _mm256_castps_si256(lower);
+        const __m256i j1i = _mm256_xor_si256(i1i, _mm256_set1_epi32(-1));
+        const __m256i gi0 = hashAVX2(_mm256_add_epi32(i, hashAVX2(j)));
+        const __m256i gi1 = hashAVX2(_mm256_add_epi32(_mm256_sub_epi32(i, i1i), hashAVX2(_mm256_sub_epi32(j, j1i))));
+        const __m256i gi2 = hashAVX2(_mm256_add_epi32(_mm256_add_epi32(i, inc), hashAVX2(_mm256_add_epi32(j, inc))));
+
+        const __m256 t0 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0));
+        const __m256 t1 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1));
+        const __m256 t2 = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x2, x2)), _mm256_mul_ps(y2, y2));
+
+        const __m256 n0 = cornerAVX2(t0, gradAVX2(gi0, x0, y0));
+        const __m256 n1 = cornerAVX2(t1, gradAVX2(gi1, x1, y1));
+        const __m256 n2 = cornerAVX2(t2, gradAVX2(gi2, x2, y2));
+
+        _mm256_storeu_ps(out + p, _mm256_mul_ps(_mm256_set1_ps(45.23065f), _mm256_add_ps(_mm256_add_ps(n0, n1), n2)));
+    }
+
+    // Avoids the penalty of switching back to the legacy SSE encoding
+    _mm256_zeroupper();
+    noise2DScalar(xs + p, ys + p, out + p, count - p);
+}
+
+SIMPLEX_TARGET("avx2") static void noise3DAVX2(const float* xs, const float* ys, const float* zs, float* out, size_t count) {
+    static const float F3 = 1.0f / 3.0f;
+    static const float G3 = 1.0f / 6.0f;
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 falloff = _mm256_set1_ps(0.6f);
+    const __m256 ones = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    const __m256i inc = _mm256_set1_epi32(1);
+
+    size_t p = 0;
+    for (; p + 8 <= count; p += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + p);
+        const __m256 y = _mm256_loadu_ps(ys + p);
+        const __m256 z = _mm256_loadu_ps(zs + p);
+
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(F3));
+        const __m256i i = fastfloorAVX2(_mm256_add_ps(x, s));
+        const __m256i j = fastfloorAVX2(_mm256_add_ps(y, s));
+        const __m256i k = fastfloorAVX2(_mm256_add_ps(z, s));
+
+        const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(i, j), k)), _mm256_set1_ps(G3));
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+        const __m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(_mm256_cvtepi32_ps(k), t));
+
+        const __m256 xy = _mm256_cmp_ps(x0, y0, _CMP_GE_OQ);
+        const __m256 yz = _mm256_cmp_ps(y0, z0, _CMP_GE_OQ);
+        const __m256 xz = _mm256_cmp_ps(x0, z0, _CMP_GE_OQ);
+        const __m256 i1 = _mm256_and_ps(xy, _mm256_or_ps(yz, xz));
+        const __m256 j1 = _mm256_andnot_ps(xy, yz);
+        const __m256 k1 = _mm256_andnot_ps(yz, _mm256_xor_ps(_mm256_and_ps(xy, xz), ones));
+        const __m256 i2 = _mm256_or_ps(xy, _mm256_and_ps(yz, xz));
+        const __m256 j2 = _mm256_or_ps(_mm256_xor_ps(xy, ones), yz);
+        const __m256 k2 = _mm256_blendv_ps(_mm256_xor_ps(_mm256_and_ps(yz, xz), ones), _mm256_xor_ps(yz, ones), xy);
+
+        const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i1, one)), _mm256_set1_ps(G3));
+        const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j1, one)), _mm256_set1_ps(G3));
+        const __m256 z1 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k1, one)), _mm256_set1_ps(G3));
+        const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i2, one)), _mm256_set1_ps(2.0f * G3));
+        const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j2, one)), _mm256_set1_ps(2.0f * G3));
+        const __m256 z2 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k2, one)), _mm256_set1_ps(2.0f * G3));
+        const __m256 x3 = _mm256_add_ps(_mm256_sub_ps(x0, one), _mm256_set1_ps(3.0f * G3));
+        const __m256 y3 = _mm256_add_ps(_mm256_sub_ps(y0, one), _mm256_set1_ps(3.0f * G3));
+        const __m256 z3 = _mm256_add_ps(_mm256_sub_ps(z0, one), _mm256_set1_ps(3.0f * G3));
+
+        const __m256i gi0 = hashAVX2(_mm256_add_epi32(i, hashAVX2(_mm256_add_epi32(j, hashAVX2(k)))));
+        const __m256i gi1 = hashAVX2(_mm256_add_epi32(_mm256_sub_epi32(i, _mm256_castps_si256(i1)),
+                                     hashAVX2(_mm256_add_epi32(_mm256_sub_epi32(j, _mm256_castps_si256(j1)),
+                                     hashAVX2(_mm256_sub_epi32(k, _mm256_castps_si256(k1)))))));
+        const __m256i gi2 = hashAVX2(_mm256_add_epi32(_mm256_sub_epi32(i, _mm256_castps_si256(i2)),
+                                     hashAVX2(_mm256_add_epi32(_mm256_sub_epi32(j, _mm256_castps_si256(j2)),
+                                     hashAVX2(_mm256_sub_epi32(k, _mm256_castps_si256(k2)))))));
+        const __m256i gi3 = hashAVX2(_mm256_add_epi32(_mm256_add_epi32(i, inc),
+                                     hashAVX2(_mm256_add_epi32(_mm256_add_epi32(j, inc),
+                                     hashAVX2(_mm256_add_epi32(k, inc))))));
+
+        const __m256 t0 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(falloff, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0)), _mm256_mul_ps(z0, z0));
+        const __m256 t1 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(falloff, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1)), _mm256_mul_ps(z1, z1));
+        const __m256 t2 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(falloff, _mm256_mul_ps(x2, x2)), _mm256_mul_ps(y2, y2)), _mm256_mul_ps(z2, z2));
+        const __m256 t3 = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(falloff, _mm256_mul_ps(x3, x3)), _mm256_mul_ps(y3, y3)), _mm256_mul_ps(z3, z3));
+
+        const __m256 n0 = cornerAVX2(t0, gradAVX2(gi0, x0, y0, z0));
+        const __m256 n1 = cornerAVX2(t1, gradAVX2(gi1, x1, y1, z1));
+        const __m256 n2 = cornerAVX2(t2, gradAVX2(gi2, x2, y2, z2));
+        const __m256 n3 = cornerAVX2(t3, gradAVX2(gi3, x3, y3, z3));
+
+        _mm256_storeu_ps(out + p, _mm256_mul_ps(_mm256_set1_ps(32.0f), _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), n3)));
+    }
+
+    _mm256_zeroupper();
+    noise3DScalar(xs + p, ys + p, zs + p, out + p, count - p);
+}
+
+/*
+ * Runtime dispatch
+ */
+
+static void cpuid(int32_t regs[4], int32_t leaf) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, 0);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/// Register state the OS saves on context switches
+static uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+#endif // SIMPLEX_NOISE_SIMD
+
+struct NoiseKernels {
+    NoiseKernel2D noise2D;
+    NoiseKernel3D noise3D;
+};
+
+static NoiseKernels selectNoiseKernels() {
+    NoiseKernels kernels = { noise2DScalar, noise3DScalar };
+
+#if SIMPLEX_NOISE_SIMD
+    int32_t regs[4];
+    cpuid(regs, 0);
+    const int32_t maxLeaf = regs[0];
+
+    cpuid(regs, 1);
+    const bool sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (xgetbv0() & 0x6) == 0x6) {
+        cpuid(regs, 7);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+
+    if (avx2) {
+        for (int32_t i = 0; i < 256; i++) {
+            perm32[i] = perm[i];
+        }
+        kernels.noise2D = noise2DAVX2;
+        kernels.noise3D = noise3DAVX2;
+    } else if (sse41) {
+        kernels.noise2D = noise2DSSE41;
+        kernels.noise3D = noise3DSSE41;
+    }
+#endif
+
+    return kernels;
+}
+
+static const NoiseKernels& noiseKernels() {
+    static const NoiseKernels kernels = selectNoiseKernels();
+    return kernels;
+}
+
+/**
+ * Evaluates the noise over a grid in batches, zs is nullptr for 2D grids
+ *
+ * Fractal samples go through the same steps as fractal(): the octaves are summed in order and divided by the
+ * sum of amplitudes at the end. Without fractal the plain noise is written and the other parameters are unused.
+ */
+static void evaluateGrid(bool fractal, size_t octaves, float frequency, float amplitude, float lacunarity, float persistence,
+                         const float* xs, size_t countX, const float* ys, size_t countY,
+                         const float* zs, size_t countZ, float* out) {
+    const NoiseKernels& kernels = noiseKernels();
+
+    float px[BATCH_SIZE], py[BATCH_SIZE], pz[BATCH_SIZE];
+    float sx[BATCH_SIZE], sy[BATCH_SIZE], sz[BATCH_SIZE];
+    float n[BATCH_SIZE];
+
+    const size_t total = countX * countY * countZ;
+    size_t xi = 0, yi = 0, zi = 0;
+
+    for (size_t start = 0; start < total; start += BATCH_SIZE) {
+        const size_t count = (total - start < BATCH_SIZE) ? (total - start) : BATCH_SIZE;
+        float* batchOut = out + start;
+
+        // Flatten the next points of the grid, x first
+        for (size_t p = 0; p < count; p++) {
+            px[p] = xs[xi];
+            py[p] = ys[yi];
+            pz[p] = zs ? zs[zi] : 0.0f;
+
+            if (++xi == countX) {
+                xi = 0;
+                if (++yi == countY) {
+                    yi = 0;
+                    zi++;
+                }
+            }
+        }
+
+        if (!fractal) {
+            if (zs) kernels.noise3D(px, py, pz, batchOut, count);
+            else    kernels.noise2D(px, py, batchOut, count);
+            continue;
+        }
+
+        float denom = 0.f;
+        float octaveFrequency = frequency;
+        float octaveAmplitude = amplitude;
+
+        for (size_t p = 0; p < count; p++) {
+            batchOut[p] = 0.f;
+        }
+
+        for (size_t i = 0; i < octaves; i++) {
+            for (size_t p = 0; p < count; p++) {
+                sx[p] = px[p] * octaveFrequency;
+                sy[p] = py[p] * octaveFrequency;
+                sz[p] = pz[p] * octaveFrequency;
+            }
+
+            if (zs) kernels.noise3D(sx, sy, sz, n, count);
+            else    kernels.noise2D(sx, sy, n, count);
+
+            for (size_t p = 0; p < count; p++) {
+                batchOut[p] += (octaveAmplitude * n[p]);
+            }
+            denom += octaveAmplitude;
+
+            octaveFrequency *= lacunarity;
+            octaveAmplitude *= persistence;
+        }
+
+        for (size_t p = 0; p < count; p++) {
+            batchOut[p] = (batchOut[p] / denom);
+        }
+    }
+}
+
+/**
+ * 2D Perlin simplex noise on every point of a grid
+ *
+ * @param[in] xs        x coordinates of the grid columns
+ * @param[in] countX    number of x coordinates
+ * @param[in] ys        y coordinates of the grid rows
+ * @param[in] countY    number of y coordinates
+ * @param[out] out      countX * countY values, out[i + j * countX] is noise(xs[i], ys[j])
+ */
+void SimplexNoise::noiseGrid(const float* xs, size_t countX, const float* ys, size_t countY, float* out) {
+    evaluateGrid(false, 0, 1.0f, 1.0f, 1.0f, 1.0f, xs, countX, ys, countY, nullptr, 1, out);
+}
+
+/**
+ * 3D Perlin simplex noise on every point of a grid
+ *
+ * @param[out] out      countX * countY * countZ values, out[i + j * countX + k * countX * countY] is noise(xs[i], ys[j], zs[k])
+ */
+void SimplexNoise::noiseGrid(const float* xs, size_t countX, const float* ys, size_t countY,
+                             const float* zs, size_t countZ, float* out) {
+    evaluateGrid(false, 0, 1.0f, 1.0f, 1.0f, 1.0f, xs, countX, ys, countY, zs, countZ, out);
+}
+
+/**
+ * Fractal/Fractional Brownian Motion (fBm) summation of 2D Perlin Simplex noise on every point of a grid
+ *
+ * @param[in] octaves   number of fraction of noise to sum
+ * @param[out] out      countX * countY values, out[i + j * countX] is fractal(octaves, xs[i], ys[j])
+ */
+void SimplexNoise::fractalGrid(size_t octaves, const float* xs, size_t countX, const float* ys, size_t countY, float* out) const {
+    evaluateGrid(true, octaves, mFrequency, mAmplitude, mLacunarity, mPersistence, xs, countX, ys, countY, nullptr, 1, out);
+}
+
+/**
+ * Fractal/Fractional Brownian Motion (fBm) summation of 3D Perlin Simplex noise on every point of a grid
+ *
+ * @param[in] octaves   number of fraction of noise to sum
+ * @param[out] out      countX * countY * countZ values, out[i + j * countX + k * countX * countY] is fractal(octaves, xs[i], ys[j], zs[k])
+ */
+void SimplexNoise::fractalGrid(size_t octaves, const float* xs, size_t countX, const float* ys, size_t countY,
+                               const float* zs, size_t countZ, float* out) const {
+    evaluateGrid(true, octaves, mFrequency, mAmplitude, mLacunarity, mPersistence, xs, countX, ys, countY, zs, countZ, out);
 }
\ No newline at end of file
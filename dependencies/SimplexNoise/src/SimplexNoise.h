@@ -28,6 +28,14 @@ public:
     float fractal(size_t octaves, float x, float y) const;
     float fractal(size_t octaves, float x, float y, float z) const;
 
+    // Batch versions sampling every point of a grid, see SimplexNoise.cpp for the layout of out
+    static void noiseGrid(const float* xs, size_t countX, const float* ys, size_t countY, float* out);
+    static void noiseGrid(const float* xs, size_t countX, const float* ys, size_t countY,
+                          const float* zs, size_t countZ, float* out);
+    void fractalGrid(size_t octaves, const float* xs, size_t countX, const float* ys, size_t countY, float* out) const;
+    void fractalGrid(size_t octaves, const float* xs, size_t countX, const float* ys, size_t countY,
+                     const float* zs, size_t countZ, float* out) const;
+
     /**
      * Constructor of to initialize a fractal noise summation
      *
@@ -1,11 +1,152 @@
 #pragma once
 
+/*
+
+Hashing functions used by the HashTable and HashSet.
+
+Byte buffers are hashed with a wyhash style core. It reads 8 bytes at
+a time, mixes them using a 64x64 -> 128 bit multiply and never reads
+past the end of the buffer.
+
+Integers are run through the same multiply-mix so that sequential keys
+(like chunk coordinates) end up spread across the whole table instead
+of clustering together.
+
+*/
+
+#include <cstring>
 #include "core/types.h"
+#include "core/compiler_utils.h"
+#include "core/utils.h"
 
 #include "string.h"
 #include "stringview.h"
 
-using Hash = u32;
+using Hash = u64;
+
+namespace HashInternal
+{
+
+constexpr u64 secret[4] = {
+    0xA0761D6478BD642Full,
+    0xE7037ED1A0B428DBull,
+    0x8EBC6AF09C88C6E3ull,
+    0x589965CC75374CC3ull
+};
+
+// Full 64x64 bit multiply in place. a gets the low bits and b gets the high bits.
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE void Multiply128InPlace(u64& a, u64& b)
+{
+    u64 high;
+    a = Multiply128(a, b, high);
+    b = high;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u64 Mix(u64 a, u64 b)
+{
+    Multiply128InPlace(a, b);
+    return a ^ b;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u64 Read8(const u8* ptr)
+{
+    u64 value;
+    memcpy(&value, ptr, sizeof(u64));
+    return value;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u64 Read4(const u8* ptr)
+{
+    u32 value;
+    memcpy(&value, ptr, sizeof(u32));
+    return value;
+}
+
+// Reads 1 to 3 bytes without branching on the length
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u64 Read3(const u8* ptr, u64 length)
+{
+    return ((u64) ptr[0] << 16) | ((u64) ptr[length >> 1] << 8) | ptr[length - 1];
+}
+
+} // namespace HashInternal
+
+static inline Hash HashCharBuffer(char const* buffer, const u64 length, u64 seed = 0)
+{
+    using namespace HashInternal;
+
+    const u8* ptr = (const u8*) buffer;
+    seed ^= Mix(seed ^ secret[0], secret[1]);
+
+    u64 a, b;
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            // Two overlapping reads of 4 bytes from each end
+            const u64 offset = (length >> 3) << 2;
+            a = (Read4(ptr) << 32) | Read4(ptr + offset);
+            b = (Read4(ptr + length - 4) << 32) | Read4(ptr + length - 4 - offset);
+        }
+        else if (length > 0)
+        {
+            a = Read3(ptr, length);
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        u64 remaining = length;
+
+        if (remaining > 48)
+        {
+            // 3 independent lanes so the multiplies can run in parallel
+            u64 seed1 = seed, seed2 = seed;
+            do
+            {
+                seed  = Mix(Read8(ptr)      ^ secret[1], Read8(ptr + 8)  ^ seed);
+                seed1 = Mix(Read8(ptr + 16) ^ secret[2], Read8(ptr + 24) ^ seed1);
+                seed2 = Mix(Read8(ptr + 32) ^ secret[3], Read8(ptr + 40) ^ seed2);
+
+                ptr += 48;
+                remaining -= 48;
+            }
+            while (remaining > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = Mix(Read8(ptr) ^ secret[1], Read8(ptr + 8) ^ seed);
+
+            ptr += 16;
+            remaining -= 16;
+        }
+
+        // Last 16 bytes (may overlap with bytes that were already mixed)
+        a = Read8(ptr + remaining - 16);
+        b = Read8(ptr + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    Multiply128InPlace(a, b);
+
+    return Mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+static inline Hash HashInteger(u64 key)
+{
+    using namespace HashInternal;
+
+    u64 a = key ^ secret[0];
+    u64 b = secret[1];
+    Multiply128InPlace(a, b);
+
+    return Mix(a ^ secret[0], b ^ secret[1]);
+}
 
 template<typename T>
 struct Hasher
@@ -13,22 +154,17 @@ struct Hasher
     inline Hash operator()(T const& key);
 };
 
-constexpr Hash bytes[4] = {
-    0x000000FF,
-    0x0000FF00,
-    0x00FF0000,
-    0xFF000000
-};
-
 template <>
 struct Hasher<f32>
 {
     inline Hash operator()(f32 const& key) const
     {
-        Hash hash = *(Hash*)(&key);
-        Hash shuffled = (hash >> 16) | (hash << 16);
+        // 0.0f and -0.0f should have the same hash
+        u32 bits = 0;
+        if (key != 0.0f)
+            memcpy(&bits, &key, sizeof(f32));
 
-        return shuffled ^ 0xE8BF6CDF;
+        return HashInteger(bits);
     }
 };
 
@@ -37,94 +173,45 @@ struct Hasher<s32>
 {
     inline Hash operator()(s32 const& key) const
     {
-        Hash hash = *(Hash*)(&key);
-
-        // 00 00 00 FF -> 00 FF 00 00   << 16
-        // 00 00 FF 00 -> 00 00 00 FF   >> 8
-        // 00 FF 00 00 -> FF 00 00 00   << 8
-        // FF 00 00 00 -> 00 00 FF 00   >> 16
-        
-        Hash shuffled = ((hash & bytes[0]) << 16) |
-                        ((hash & bytes[1]) >>  8) |
-                        ((hash & bytes[2]) <<  8) |
-                        ((hash & bytes[3]) >> 16);
-
-        return shuffled;
+        return HashInteger((u64) (u32) key);
     }
 };
 
-template<>
-struct Hasher<u64>
+template <>
+struct Hasher<u32>
 {
-    inline Hash operator()(u64 const& key) const
+    inline Hash operator()(u32 const& key) const
     {
-        Hash hash1 = (((Hash*)(&key))[0]);
-        Hash hash2 = (((Hash*)(&key))[1]);
-
-        // 00 00 00 FF -> 00 FF 00 00   << 16
-        // 00 00 FF 00 -> 00 00 00 FF   >> 8
-        // 00 FF 00 00 -> FF 00 00 00   << 8
-        // FF 00 00 00 -> 00 00 FF 00   >> 16
-        
-        Hash shuffled1 = ((hash1 & bytes[0]) << 16) |
-                         ((hash1 & bytes[1]) >>  8) |
-                         ((hash1 & bytes[2]) <<  8) |
-                         ((hash1 & bytes[3]) >> 16);
-
-        Hash shuffled2 = ((hash2 & bytes[0]) << 16) |
-                         ((hash2 & bytes[1]) >>  8) |
-                         ((hash2 & bytes[2]) <<  8) |
-                         ((hash2 & bytes[3]) >> 16);
-
-        return shuffled1 ^ shuffled2;
+        return HashInteger(key);
     }
 };
 
 template<>
-struct Hasher<void*>
+struct Hasher<s64>
 {
-    inline Hash operator()(void* const& key) const
+    inline Hash operator()(s64 const& key) const
     {
-        u64 asU64 = (u64) key;
-        return Hasher<u64>()(asU64);
+        return HashInteger((u64) key);
     }
 };
 
-static inline Hash HashCharBuffer(char const* buffer, const u64 length)
+template<>
+struct Hasher<u64>
 {
-    Hash const* ptr = (Hash*) buffer;
-    u64 count = length / 4 + 1;
-    u32 rem = length % 4;
-
-    Hash hash = 0x8BDC195DF;
-    while (count > 1)
+    inline Hash operator()(u64 const& key) const
     {
-        Hash val = *ptr;
-        
-        hash = hash + hash * val * val * count * count;
-        hash = ((hash & bytes[0]) << 16) |
-               ((hash & bytes[1]) >>  8) |
-               ((hash & bytes[2]) <<  8) |
-               ((hash & bytes[3]) >> 16);
-
-        count--;
-        ptr++;
+        return HashInteger(key);
     }
+};
 
-    {   // Remaining chars
-        Hash val = *ptr;
-        u32 mask = 0xFFFFFFFF >> ((4 - rem) * 8);
-        val &= mask;
-        
-        hash = hash + hash * val * val;
-        hash = ((hash & bytes[0]) << 16) |
-               ((hash & bytes[1]) >>  8) |
-               ((hash & bytes[2]) <<  8) |
-               ((hash & bytes[3]) >> 16);
+template<>
+struct Hasher<void*>
+{
+    inline Hash operator()(void* const& key) const
+    {
+        return HashInteger((u64) key);
     }
-
-    return hash;
-}
+};
 
 template<>
 struct Hasher<StringView>
@@ -135,10 +222,12 @@ struct Hasher<StringView>
     }
 };
 
+// Takes a StringView so that tables with String keys
+// can be queried without creating a String
 template<>
 struct Hasher<String>
 {
-    inline Hash operator()(String const& key) const
+    inline Hash operator()(StringView const& key) const
     {
         return HashCharBuffer(key.cstr(), key.length());
     }
@@ -1,41 +1,63 @@
 #pragma once
 
-#include <cstdint>
-#include <cstdlib>
+/*
+
+Custom Hash Table.
+
+This is an open addressing table with a swiss table style layout.
+Every slot has a 1 byte control tag which is either EMPTY, DELETED
+(tombstone) or the lower 7 bits of the key's hash (H2).
+
+Control tags are grouped in batches of 16 bytes so that a whole group
+can be checked against a hash with a single SSE compare. The upper
+bits of the hash (H1) pick the group the probe starts at, and groups
+are probed using triangular numbers so every group is visited once.
+
+Lookups can be heterogeneous. Any type the hasher can hash and the key
+can be compared with can be used to query the table, which means a
+HashTable<String, ...> can be queried with a StringView without having
+to build a String first.
+
+*/
+
+#include <emmintrin.h>
+#include <new>
+#include <utility>
 #include "hash.h"
 #include "core/logging.h"
+#include "core/types.h"
+#include "core/utils.h"
+#include "platform/platform.h"
 
 template <typename Key, typename Value, typename Hasher = Hasher<Key>>
 class HashTable
 {
 private:
     static constexpr u64 START_CAP = 16;
-    static constexpr f32 GROWTH_RATE = 2.0f;
-    static constexpr f32 MAX_LOAD_FACTOR = 0.8f;
+    static constexpr u64 GROUP_WIDTH = 16;
+
+    // Max load factor is 7/8 (counting tombstones)
+    static constexpr u64 MAX_LOAD_NUMERATOR   = 7;
+    static constexpr u64 MAX_LOAD_DENOMINATOR = 8;
 
-    enum struct State
+    enum Control : u8
     {
-        EMPTY,
-        TOMBSTONE,
-        FILLED
+        EMPTY   = 0x80,     // 0b10000000
+        DELETED = 0xFE,     // 0b11111110
+
+        // Filled slots store H2 which always has the top bit as 0
     };
 
-    struct TableData
+    struct Slot
     {
-        State* states { nullptr };
-        Hash*  hashes { nullptr };
-        Key*   keys   { nullptr };
-        Value* values { nullptr };
-
-        inline TableData& operator=(const TableData& other)
-        {
-            states = other.states;
-            hashes = other.hashes;
-            keys   = other.keys;
-            values = other.values;
+        Key   key;
+        Value value;
+    };
 
-            return *this;
-        }
+    struct TableData
+    {
+        u8*   controls { nullptr };
+        Slot* slots    { nullptr };
     };
 
 public:
@@ -77,14 +99,16 @@ public:
 
         inline KeyValuePair operator*()
         {
-            AssertWithMessage(_index <= _table->_last, "Trying to dereference a non existant value!");
-            return KeyValuePair(_table->_table.keys[_index], _table->_table.values[_index]);
+            AssertWithMessage(_index < _table->_capacity, "Trying to dereference a non existant value!");
+            Slot& slot = _table->_table.slots[_index];
+            return KeyValuePair(slot.key, slot.value);
         }
 
         inline const KeyValuePair operator*() const
         {
-            AssertWithMessage(_index <= _table->_last, "Trying to dereference a non existant value!");
-            return KeyValuePair(_table->_table.keys[_index], _table->_table.values[_index]);
+            AssertWithMessage(_index < _table->_capacity, "Trying to dereference a non existant value!");
+            Slot& slot = _table->_table.slots[_index];
+            return KeyValuePair(slot.key, slot.value);
         }
 
         inline bool operator==(const iterator& other) const
@@ -104,7 +128,7 @@ public:
         {
             return *this != _table->end();
         }
-        
+
         // Getters
         inline u64 index() const
         {
@@ -113,12 +137,12 @@ public:
 
         inline Key& key() const
         {
-            return _table->_table.keys[_index];
+            return _table->_table.slots[_index].key;
         }
 
         inline Value& value() const
         {
-            return _table->_table.values[_index];
+            return _table->_table.slots[_index].value;
         }
 
         // Constructors
@@ -135,13 +159,10 @@ public:
     private:
         inline void advance()
         {
-            if (_index > _table->_last)
+            if (_index >= _table->_capacity)
                 return;
-            
-            _index++;
-            while (_table->_table.states[_index] != State::FILLED &&
-                   _index <= _table->_last)
-                _index++;
+
+            _index = _table->NextFilledSlot(_index + 1);
         }
 
     private:
@@ -149,11 +170,11 @@ public:
         u64 _index;
     };
 
-    inline const iterator begin() const { return iterator(this, _first); }
-    inline       iterator begin()       { return iterator(this, _first); }
+    inline const iterator begin() const { return iterator(this, NextFilledSlot(0)); }
+    inline       iterator begin()       { return iterator(this, NextFilledSlot(0)); }
 
-    inline const iterator end() const { return iterator(this, _last + 1); }
-    inline       iterator end()       { return iterator(this, _last + 1); }
+    inline const iterator end() const { return iterator(this, _capacity); }
+    inline       iterator end()       { return iterator(this, _capacity); }
 
 public:
     // Getters
@@ -161,12 +182,14 @@ public:
     inline u64 capacity() const { return _capacity; }
 
     // Operators
-    inline const Value& operator[](const Key& key) const
+    template <typename LookupKey>
+    inline const Value& operator[](const LookupKey& key) const
     {
         return Find(key).value();
     }
-    
-    inline Value& operator[](const Key& key)
+
+    template <typename LookupKey>
+    inline Value& operator[](const LookupKey& key)
     {
         return At(key).value();
     }
@@ -174,243 +197,145 @@ public:
     // Explicit Functions
     inline void ManualInit(u64 capacity = START_CAP)
     {
-        Allocate(_table, capacity);
-        
-        _capacity = capacity;
-        _size = 0;
+        _capacity = NormalizedCapacity(capacity);
+        Allocate(_table, _capacity);
 
-        _first = capacity;
-        _last = 0;
+        _size = 0;
+        _growthLeft = MaxFilledSlots(_capacity);
     }
 
     inline void Rehash(u64 capacity)
     {
+        capacity = NormalizedCapacity(capacity);
+        while (MaxFilledSlots(capacity) <= _size)
+            capacity *= 2;
+
         TableData newTable;
         Allocate(newTable, capacity);
 
-        u64 newFirst = capacity;
-        u64 newLast = 0;
-
-        for (u64 i = _first; i <= _last; i++)
+        for (u64 i = 0; i < _capacity; i++)
         {
-            if (_table.states[i] != State::FILLED)
+            if (!IsFilled(_table.controls[i]))
                 continue;
-            
-            const Hash& hash = _table.hashes[i];
-            u64 startIndex = hash % capacity;
 
-            for (u64 j = startIndex + 1; j != startIndex; j = (j + 1) % capacity)
-            {
-                if (newTable.states[j] == State::EMPTY)
-                {
-                    newTable.states[j] = State::FILLED;
-                    newTable.hashes[j] = hash;
-                    newTable.keys[j] = std::move(_table.keys[i]);
-                    newTable.values[j] = std::move(_table.values[i]);
-
-                    newFirst = std::min(newFirst, j);
-                    newLast = std::max(newLast, j);
-
-                    break;
-                }
-            }
-        }
+            Slot& slot = _table.slots[i];
+            const Hash hash = hasher(slot.key);
 
-        _capacity = capacity;
+            const u64 index = FindFirstNonFilled(newTable, capacity, hash);
+            newTable.controls[index] = H2(hash);
+            new (newTable.slots + index) Slot { std::move(slot.key), std::move(slot.value) };
 
-        _first = newFirst;
-        _last = newLast;
+            slot.~Slot();
+        }
 
         Deallocate(_table);
         _table = newTable;
+
+        _capacity = capacity;
+        _growthLeft = MaxFilledSlots(_capacity) - _size;
     }
 
     // Tries to find the element
     // If not found, returns end()
-    inline iterator Find(const Key& key) const
+    template <typename LookupKey>
+    inline iterator Find(const LookupKey& key) const
     {
-        u64 hash = hasher(key);
-        u64 startIndex = hash % _capacity;
+        const Hash hash = hasher(key);
 
-        for (u64 i = (startIndex + 1) % _capacity; i != startIndex; i = (i + 1) % _capacity)
+        const __m128i needle = _mm_set1_epi8((char) H2(hash));
+        const __m128i empty  = _mm_set1_epi8((char) EMPTY);
+
+        const u64 groupMask = (_capacity / GROUP_WIDTH) - 1;
+        u64 group = H1(hash) & groupMask;
+
+        for (u64 step = 1; step <= groupMask + 1; step++)
         {
-            const State& currentPairState = _table.states[i];
+            const __m128i controls = _mm_load_si128((const __m128i*)(_table.controls + group * GROUP_WIDTH));
+
+            u32 matches = (u32) _mm_movemask_epi8(_mm_cmpeq_epi8(controls, needle));
+            while (matches)
+            {
+                const u64 index = group * GROUP_WIDTH + LowestSetBitIndex(matches);
+                if (_table.slots[index].key == key)
+                    return iterator(this, index);
 
-            if (currentPairState == State::EMPTY)
+                matches &= matches - 1;
+            }
+
+            // The key would've been placed in this group if it had an empty slot
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(controls, empty)))
                 return end();
-            
-            if (currentPairState == State::TOMBSTONE)
-                continue;
-            
-            if (_table.hashes[i] == hash &&
-                _table.keys[i] == key)
-                return iterator(this, i);
+
+            group = (group + step) & groupMask;
         }
 
-        // Shouldn't reach this point
         return end();
     }
 
     // Tries to find the element
     // If not found, places an empty element and returns that
-    inline iterator At(const Key& key)
+    template <typename LookupKey>
+    inline iterator At(const LookupKey& key)
     {
-        if (GetLoadFactor() >= MAX_LOAD_FACTOR)
-            Rehash(_capacity * GROWTH_RATE);
-
-        u64 hash = hasher(key);
-        u64 startIndex = hash % _capacity;
-
-        for (u64 i = (startIndex + 1) % _capacity; i != startIndex; i = (i + 1) % _capacity)
-        {
-            const State& currentPairState = _table.states[i];
-
-            if (currentPairState != State::FILLED)
-            {
-                CopyKey(i, key);
-
-                _table.states[i] = State::FILLED;
-                _table.hashes[i] = hash;
-                _table.values[i] = Value();     // Represents empty value
-
-                _first = std::min(_first, i);
-                _last  = std::max(_last, i);
+        iterator it = Find(key);
+        if (it)
+            return it;
 
-                _size++;
+        const u64 index = PrepareInsert(hasher(key));
+        new (_table.slots + index) Slot { Key(key), Value() };     // Value() represents empty value
 
-                return iterator(this, i);
-            }
-            
-            if (_table.hashes[i] == hash &&
-                _table.keys[i] == key)
-                return iterator(this, i);
-        }
-
-        // Shouldn't reach this point
-        return end();
+        return iterator(this, index);
     }
 
     inline Value& Place(const Key& key, const Value& value)
     {
-        if (GetLoadFactor() >= MAX_LOAD_FACTOR)
-            Rehash(_capacity * GROWTH_RATE);
-
-        Hash hash = hasher(key);
-        u64 startIndex = hash % _capacity;
-
-        for (u64 i = (startIndex + 1) % _capacity; i != startIndex; i = (i + 1) % _capacity)
+        iterator it = Find(key);
+        if (it)
         {
-            State& currentPairState = _table.states[i];
-            if (currentPairState !=  State::FILLED)
-            {
-                CopyKey(i, key);
-
-                currentPairState = State::FILLED;
-                _table.hashes[i] = hash;
-                _table.values[i] = value;
-
-                _first = std::min(_first, i);
-                _last  = std::max(_last, i);
-
-                _size++;
-                return _table.values[i];
-            }
-
-            if (_table.hashes[i] == hash &&
-                _table.key[i] == key)
-            {
-                if (_table.values[i] != value)
-                    _table.values[i] = value;
-                
-                return _table.values[i];
-            }
+            it.value() = value;
+            return it.value();
         }
 
-        // Shouldn't reach this point
-        return _table.values[_capacity];
+        const u64 index = PrepareInsert(hasher(key));
+        new (_table.slots + index) Slot { key, value };
+
+        return _table.slots[index].value;
     }
 
     inline Value& Place(const Key& key, Value&& value)
     {
-        if (GetLoadFactor() >= MAX_LOAD_FACTOR)
-            Rehash(_capacity * GROWTH_RATE);
-
-        Hash hash = hasher(elem);
-        u64 startIndex = hash % _capacity;
-
-        for (u64 i = (startIndex + 1) % _capacity; i != startIndex; i = (i + 1) % _capacity)
+        iterator it = Find(key);
+        if (it)
         {
-            State& currentPairState = _table.states[i];
-            if (currentPairState != State::FILLED)
-            {
-                CopyKey(i, key);
-
-                currentPairState = State::FILLED;
-                _table.hashes[i] = hash;
-                _table.values[i] = std::move(value);
-
-                _first = std::min(_first, i);
-                _last = std::max(_last, i);
-
-                _size++;
-                return _table.values[i];
-            }
-
-            if (_table.hashes[i] == hash &&
-                _table.keys[i] == key)
-            {
-                _table.values[i] = std::move(value);
-
-                return _table.values[i];
-            }
+            it.value() = std::move(value);
+            return it.value();
         }
 
-        // Shouldn't reach this point
-        return _table.values[_capacity];
+        const u64 index = PrepareInsert(hasher(key));
+        new (_table.slots + index) Slot { key, std::move(value) };
+
+        return _table.slots[index].value;
     }
 
     template <typename... Args>
     inline Value& Emplace(const Key& key, Args&&... args)
     {
-        if (GetLoadFactor() >= MAX_LOAD_FACTOR)
-            Rehash(_capacity * GROWTH_RATE);
-
-        T elem(std::forward<Args>(args)...);
-
-        Hash hash = hasher(elem);
-        u64 startIndex = hash % _capacity;
-
-        for (u64 i = (startIndex + 1) % _capacity; i != startIndex; i = (i + 1) % _capacity)
+        iterator it = Find(key);
+        if (it)
         {
-            State& currentPairState = _table.states[i];
-            if (currentPairState != State::FILLED)
-            {
-                CopyKey(key);
-
-                currentPairState = State::FILLED;
-                _table.hashes[i] = hash;
-                new(&_table.values + i) Value(std::forward<Args>(args)...);
-
-                _first = std::min(_first, i);
-                _last = std::max(_last, i);
-
-                _size++;
-                return _table.elements[i];
-            }
-
-            if (_table.hashes[i]   == hash &&
-                _table.elements[i] == elem)
-            {
-                _table.values[i] = Value(std::forward<Args>(args)...);
-                return _table.values[i];
-            }
+            it.value() = Value(std::forward<Args>(args)...);
+            return it.value();
         }
 
-        // Shouldn't reach this point
-        return _table.values[_capacity];
+        const u64 index = PrepareInsert(hasher(key));
+        new (&_table.slots[index].key) Key(key);
+        new (&_table.slots[index].value) Value(std::forward<Args>(args)...);
+
+        return _table.slots[index].value;
     }
 
-    inline void Remove(const Key& key)
+    template <typename LookupKey>
+    inline void Remove(const LookupKey& key)
     {
         iterator it = Find(key);
 
@@ -420,109 +345,174 @@ public:
             return;
         }
 
-        u64 index = it.index();
+        const u64 index = it.index();
 
-        _table.states[index] = State::TOMBSTONE;
-        _table.keys[index].~Key();
-        _table.values[index].~Value();
+        _table.slots[index].~Slot();
         _size--;
 
-        // Update First and Last
-        if (_size == 0)
+        // If the group still has an empty slot then no probe could have
+        // gone past it, so the slot can be marked empty instead of deleted.
+        const u64 groupStart = index & ~(GROUP_WIDTH - 1);
+        const __m128i controls = _mm_load_si128((const __m128i*)(_table.controls + groupStart));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8((char) EMPTY))))
         {
-            _first = _capacity;
-            _last = 0;
+            _table.controls[index] = EMPTY;
+            _growthLeft++;
         }
-        else if (index == _first)
-        {
-            for (u64 i = _first + 1; i <= _last; i++)
-            {
-                if (_table.states[i] == State::FILLED)
-                {
-                    _first = i;
-                    break;
-                }
-            }
-        }
-        else if (index == _last)
+        else
+            _table.controls[index] = DELETED;
+    }
+
+    inline void Clear()
+    {
+        for (u64 i = 0; i < _capacity; i++)
         {
-            for (u64 i = _last - 1; i >= _first; i--)
-            {
-                if (_table.states[i] == State::FILLED)
-                {
-                    _last = i;
-                    break;
-                }
-            }
+            if (IsFilled(_table.controls[i]))
+                _table.slots[i].~Slot();
         }
+
+        PlatformSetMemory(_table.controls, EMPTY, _capacity);
+
+        _size = 0;
+        _growthLeft = MaxFilledSlots(_capacity);
     }
 
     // Constructors and Destructors
     HashTable(u64 capacity = START_CAP)
-    :   _size(0), _capacity(capacity)
-    ,   _first(capacity), _last(0)
+    :   _size(0), _capacity(NormalizedCapacity(capacity))
     {
-        Allocate(_table, capacity);
+        Allocate(_table, _capacity);
+        _growthLeft = MaxFilledSlots(_capacity);
     }
 
     ~HashTable()
     {
-        for (u64 i = _first; i < _last; i++)
+        if (!_table.controls)
+            return;
+
+        for (u64 i = 0; i < _capacity; i++)
         {
-            if (_table.states[i] == State::FILLED)
-            {
-                _table.keys[i].~Key();
-                _table.values[i].~Value();
-            }
+            if (IsFilled(_table.controls[i]))
+                _table.slots[i].~Slot();
         }
 
         Deallocate(_table);
     }
 
 private:
-    inline float GetLoadFactor() const
+    static inline u8  H2(Hash hash) { return (u8) (hash & 0x7F); }
+    static inline u64 H1(Hash hash) { return (u64) (hash >> 7); }
+
+    static inline bool IsFilled(u8 control)
     {
-        return (float) _size / (float) _capacity;
+        return (control & 0x80) == 0;
     }
 
-    inline void CopyKey(u64 index, const Key& key)
+    // Capacity is always a power of 2 and a multiple of the group width
+    static inline u64 NormalizedCapacity(u64 capacity)
     {
-        if (_table.states[index] == State::EMPTY)
-            new (_table.keys + index) Key(key);
-        else
-            _table.keys[index] = key;
+        u64 normalized = START_CAP;
+        while (normalized < capacity)
+            normalized *= 2;
+
+        return normalized;
+    }
+
+    static inline u64 MaxFilledSlots(u64 capacity)
+    {
+        return capacity * MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR;
+    }
+
+    // Returns capacity if no filled slot is found at or after the index
+    inline u64 NextFilledSlot(u64 index) const
+    {
+        u64 group = index / GROUP_WIDTH;
+        u32 skipMask = ~((1u << (index % GROUP_WIDTH)) - 1);
+
+        for (; group < _capacity / GROUP_WIDTH; group++)
+        {
+            const __m128i controls = _mm_load_si128((const __m128i*)(_table.controls + group * GROUP_WIDTH));
+
+            // Filled slots are the only ones with the top bit unset
+            const u32 filled = ~((u32) _mm_movemask_epi8(controls)) & 0xFFFF & skipMask;
+            if (filled)
+                return group * GROUP_WIDTH + LowestSetBitIndex(filled);
+
+            skipMask = 0xFFFFFFFF;
+        }
+
+        return _capacity;
+    }
+
+    static inline u64 FindFirstNonFilled(const TableData& table, u64 capacity, Hash hash)
+    {
+        const u64 groupMask = (capacity / GROUP_WIDTH) - 1;
+        u64 group = H1(hash) & groupMask;
+
+        for (u64 step = 1; ; step++)
+        {
+            const __m128i controls = _mm_load_si128((const __m128i*)(table.controls + group * GROUP_WIDTH));
+
+            // Empty and deleted slots have the top bit set
+            const u32 available = (u32) _mm_movemask_epi8(controls);
+            if (available)
+                return group * GROUP_WIDTH + LowestSetBitIndex(available);
+
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // Finds a slot for a key that isn't in the table yet and marks it as filled
+    inline u64 PrepareInsert(Hash hash)
+    {
+        u64 index = FindFirstNonFilled(_table, _capacity, hash);
+
+        // Reusing a tombstone doesn't use up any growth
+        if (_growthLeft == 0 && _table.controls[index] != DELETED)
+        {
+            // Too many tombstones, cleaning them up is enough
+            if (_size * 2 < MaxFilledSlots(_capacity))
+                Rehash(_capacity);
+            else
+                Rehash(_capacity * 2);
+
+            index = FindFirstNonFilled(_table, _capacity, hash);
+        }
+
+        _growthLeft -= (_table.controls[index] == EMPTY);
+        _table.controls[index] = H2(hash);
+        _size++;
+
+        return index;
     }
 
-    static inline void Allocate(TableData& table, u64 elements)
+    static inline void Allocate(TableData& table, u64 capacity)
     {
-        State* ptr = (State*) PlatformAllocate(elements * (sizeof(Key) + sizeof(Value) + sizeof(Hash) + sizeof(State)));
+        // Control bytes go first so that groups stay 16 byte aligned
+        u8* ptr = (u8*) PlatformAllocate(capacity * (sizeof(u8) + sizeof(Slot)));
         AssertWithMessage(ptr, "Couldn't allocate table.");
 
-        table.states = ptr;
-        table.hashes = (Hash*)(table.states + elements);
-        table.keys   = (Key*)(table.hashes + elements);
-        table.values = (Value*)(table.keys + elements);
+        table.controls = ptr;
+        table.slots = (Slot*)(table.controls + capacity);
 
-        PlatformSetMemory(table.states, (int) State::EMPTY, elements * sizeof(State));
+        PlatformSetMemory(table.controls, EMPTY, capacity * sizeof(u8));
     }
 
     static inline void Deallocate(TableData& table)
     {
-        if (table.states)
+        if (table.controls)
         {
-            PlatformFree(table.states);
+            PlatformFree(table.controls);
 
-            table.states = nullptr;
-            table.hashes = nullptr;
-            table.keys   = nullptr;
-            table.values = nullptr;
+            table.controls = nullptr;
+            table.slots = nullptr;
         }
     }
 
 private:
     TableData _table;
-    u64 _first, _last;
     u64 _size, _capacity;
+    u64 _growthLeft;
 
     Hasher hasher;
 };
\ No newline at end of file
@@ -254,7 +254,7 @@ public:
         sv._length = 0;
     }
 
-private:
+    // For buffers that aren't null terminated
     StringView(const char* _bufferPtr, u64 _length)
     :   _bufferPtr(_bufferPtr)
     ,   _length(_length)
@@ -266,6 +266,17 @@ private:
     u64 _length;
 };
 
+// Comparing with Strings without converting them
+inline bool operator==(const String& str, const StringView& sv)
+{
+    return StringView(str) == sv;
+}
+
+inline bool operator!=(const String& str, const StringView& sv)
+{
+    return StringView(str) != sv;
+}
+
 // Output
 inline std::ostream& operator<<(std::ostream& stream, const StringView& sv)
 {
@@ -14,4 +14,11 @@
 	#define GN_FORCE_INLINE __attribute__((always_inline)) inline
 #else
 	#define GN_FORCE_INLINE inline
+#endif
+
+// Lets a function use AVX2 intrinsics without building everything for AVX2, only call it after checking PlatformCpuSupportsAVX2
+#if defined(GN_COMPILER_GCC) || defined(GN_COMPILER_CLANG)
+	#define GN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define GN_TARGET_AVX2
 #endif
\ No newline at end of file
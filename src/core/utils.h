@@ -1,6 +1,11 @@
 #pragma once
 
 #include "compiler_utils.h"
+#include "types.h"
+
+#if defined(GN_COMPILER_MSVC)
+#include <intrin.h>
+#endif
 
 template <typename T>
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE void Swap(T& a, T& b)
@@ -8,4 +13,51 @@ GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE void Swap(T& a, T& b)
     T t = a;
     a = b;
     b = t;
+}
+
+// Index of the lowest set bit in the mask (mask must not be 0)
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u32 LowestSetBitIndex(u32 mask)
+{
+#if defined(GN_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (u32) index;
+#else
+    return (u32) __builtin_ctz(mask);
+#endif
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u32 LowestSetBitIndex64(u64 mask)
+{
+#if defined(GN_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (u32) index;
+#else
+    return (u32) __builtin_ctzll(mask);
+#endif
+}
+
+// Number of zero bits above the highest set bit (mask must not be 0)
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u32 LeadingZeroCount64(u64 mask)
+{
+#if defined(GN_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return 63 - (u32) index;
+#else
+    return (u32) __builtin_clzll(mask);
+#endif
+}
+
+// Full 128 bit product of a and b, returns the low half
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE u64 Multiply128(u64 a, u64 b, u64& high)
+{
+#if defined(GN_COMPILER_MSVC)
+    return _umul128(a, b, &high);
+#else
+    const unsigned __int128 product = (unsigned __int128) a * b;
+    high = (u64) (product >> 64);
+    return (u64) product;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "asset_loader.h"
+
+#include "core/logging.h"
+#include "graphics/texture_source.h"
+#include "platform/platform.h"
+#include "job_system.h"
+
+namespace AssetLoader
+{
+
+enum struct AssetType
+{
+    TEXTURE,
+    CUBEMAP,
+    FONT
+};
+
+struct AssetRequest
+{
+    AssetType  type;
+    AssetState state;
+
+    void* asset;                                // Texture, Cubemap or Imgui::Font
+
+    // Images of a texture or cubemap, a font's atlas and then its data
+    char filepaths[6][maxAssetPathLength];
+    char name[maxAssetPathLength];              // Only used by cubemaps
+
+    TextureSettings textureSettings;
+    CubemapSettings cubemapSettings;
+
+    // Written by the decoding job, only read once the counter is back to 0
+    JobSystem::JobCounter decoding;
+    bool decoded;
+    TextureSource source;
+};
+
+static struct
+{
+    AssetRequest requests[maxAssetRequests];
+    u32 requestCount;
+} alData;
+
+// Paths are copied since the views could be pointing at temporary strings
+static void CopyPath(char* destination, StringView path)
+{
+    AssertWithMessage(path.size() < maxAssetPathLength, "Asset path is too long!");
+
+    PlatformCopyMemory(destination, path.cstr(), path.size());
+    destination[path.size()] = '\0';
+}
+
+static AssetRequest& AddRequest(AssetType type, void* asset)
+{
+    AssertWithMessage(alData.requestCount < maxAssetRequests, "Too many assets are being loaded!");
+
+    AssetRequest& request = alData.requests[alData.requestCount++];
+    request.type = type;
+    request.state = AssetState::LOADING;
+    request.asset = asset;
+    request.decoding.value = 0;
+    request.decoded = false;
+
+    PlatformZeroMemory(&request.source, sizeof(TextureSource));
+    return request;
+}
+
+static AssetHandle GetHandle(const AssetRequest& request)
+{
+    return AssetHandle { (u32) (&request - alData.requests) };
+}
+
+// Runs on the job system, so nothing here can use OpenGL or the String pool
+static void DecodeAssetJob(void* data)
+{
+    AssetRequest& request = *(AssetRequest*) data;
+
+    switch (request.type)
+    {
+        case AssetType::TEXTURE:
+        {
+            const StringView filepath = request.filepaths[0];
+            request.decoded = DecodeTextureSource(request.source, &filepath, 1, true);
+        } break;
+
+        case AssetType::CUBEMAP:
+        {
+            const StringView filepaths[6] = {
+                request.filepaths[0], request.filepaths[1], request.filepaths[2],
+                request.filepaths[3], request.filepaths[4], request.filepaths[5],
+            };
+
+            request.decoded = DecodeTextureSource(request.source, filepaths, 6, false);
+        } break;
+
+        case AssetType::FONT:
+        {
+            // The font data needs the size of the atlas
+            const StringView atlaspath = request.filepaths[0];
+            request.decoded = DecodeTextureSource(request.source, &atlaspath, 1, true);
+
+            // A missing or broken data file fails the font the same as a missing atlas
+            if (request.decoded)
+            {
+                Imgui::Font& font = *(Imgui::Font*) request.asset;
+                request.decoded = font.LoadData(request.filepaths[1], request.source.info.width, request.source.info.height);
+            }
+        } break;
+
+        default:
+        {
+            AssertNotImplemented();
+        } break;
+    }
+}
+
+static void UploadAsset(AssetRequest& request)
+{
+    switch (request.type)
+    {
+        case AssetType::TEXTURE:
+        {
+            Texture& texture = *(Texture*) request.asset;
+            texture.LoadSource(request.filepaths[0], request.source, request.textureSettings);
+        } break;
+
+        case AssetType::CUBEMAP:
+        {
+            Cubemap& cubemap = *(Cubemap*) request.asset;
+            cubemap.LoadSource(request.name, request.source, request.cubemapSettings);
+        } break;
+
+        case AssetType::FONT:
+        {
+            Imgui::Font& font = *(Imgui::Font*) request.asset;
+            font.LoadAtlas(request.filepaths[0], request.source);
+        } break;
+
+        default:
+        {
+            AssertNotImplemented();
+        } break;
+    }
+}
+
+void Shutdown()
+{
+    // Jobs could still be writing to the requests
+    for (u32 i = 0; i < alData.requestCount; i++)
+    {
+        AssetRequest& request = alData.requests[i];
+        JobSystem::Wait(request.decoding);
+
+        if (request.state == AssetState::LOADING)
+            FreeTextureSource(request.source);
+    }
+
+    alData.requestCount = 0;
+}
+
+AssetHandle LoadTexture(Texture& texture, StringView filepath, const TextureSettings& settings)
+{
+    AssetRequest& request = AddRequest(AssetType::TEXTURE, &texture);
+    CopyPath(request.filepaths[0], filepath);
+    request.textureSettings = settings;
+
+    if (Texture::Exists(filepath, texture))
+        request.state = AssetState::READY;
+    else
+        JobSystem::Submit(DecodeAssetJob, &request, &request.decoding);
+
+    return GetHandle(request);
+}
+
+AssetHandle LoadCubemap(Cubemap& cubemap, StringView name, const StringView filepaths[6], const CubemapSettings& settings)
+{
+    AssetRequest& request = AddRequest(AssetType::CUBEMAP, &cubemap);
+    CopyPath(request.name, name);
+    request.cubemapSettings = settings;
+
+    for (u32 face = 0; face < 6; face++)
+        CopyPath(request.filepaths[face], filepaths[face]);
+
+    JobSystem::Submit(DecodeAssetJob, &request, &request.decoding);
+    return GetHandle(request);
+}
+
+AssetHandle LoadFont(Imgui::Font& font, StringView atlaspath, StringView datapath)
+{
+    AssetRequest& request = AddRequest(AssetType::FONT, &font);
+    CopyPath(request.filepaths[0], atlaspath);
+    CopyPath(request.filepaths[1], datapath);
+
+    JobSystem::Submit(DecodeAssetJob, &request, &request.decoding);
+    return GetHandle(request);
+}
+
+AssetState GetState(AssetHandle handle)
+{
+    AssertWithMessage(handle.index < alData.requestCount, "Invalid asset handle!");
+    return alData.requests[handle.index].state;
+}
+
+bool IsReady(AssetHandle handle)
+{
+    return GetState(handle) == AssetState::READY;
+}
+
+void Update()
+{
+    for (u32 i = 0; i < alData.requestCount; i++)
+    {
+        AssetRequest& request = alData.requests[i];
+
+        if (request.state != AssetState::LOADING || request.decoding.value > 0)
+            continue;
+
+        if (request.decoded)
+        {
+            UploadAsset(request);
+            request.state = AssetState::READY;
+        }
+        else
+        {
+            Warn("Asset couldn't be loaded!");
+            request.state = AssetState::FAILED;
+        }
+
+        FreeTextureSource(request.source);
+    }
+}
+
+void WaitAll()
+{
+    bool loading = true;
+    while (loading)
+    {
+        Update();
+
+        loading = false;
+        for (u32 i = 0; i < alData.requestCount; i++)
+            loading = loading || (alData.requests[i].state == AssetState::LOADING);
+
+        // Help decode instead of sitting idle
+        if (loading && !JobSystem::RunQueuedJob())
+            PlatformThreadYield();
+    }
+}
+
+void Clear()
+{
+    for (u32 i = 0; i < alData.requestCount; i++)
+        AssertWithMessage(alData.requests[i].state != AssetState::LOADING, "Can't clear assets that are still loading!");
+
+    alData.requestCount = 0;
+}
+
+} // namespace AssetLoader
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "graphics/texture.h"
+#include "graphics/cubemap.h"
+#include "imgui.h"
+
+/*
+
+Loads textures, cubemaps and fonts in the background, so loading all of
+them takes about as long as the slowest one instead of the sum.
+
+Each asset is loaded in two stages. Files are read and decoded by a job on
+the job system (images, texture caches and font data), then Update uploads
+whatever has finished to the GPU, since that has to happen on the thread
+with the OpenGL context. An asset can't be used until its handle is ready.
+
+The paths are copied, but the asset being loaded into has to stay where it
+is until it's done.
+
+*/
+
+namespace AssetLoader
+{
+
+enum struct AssetState
+{
+    LOADING,
+    READY,
+    FAILED
+};
+
+struct AssetHandle
+{
+    u32 index;
+};
+
+constexpr u32 maxAssetRequests = 32;
+constexpr u32 maxAssetPathLength = 256;
+
+void Shutdown();
+
+AssetHandle LoadTexture(Texture& texture, StringView filepath, const TextureSettings& settings);
+AssetHandle LoadCubemap(Cubemap& cubemap, StringView name, const StringView filepaths[6], const CubemapSettings& settings);
+AssetHandle LoadFont(Imgui::Font& font, StringView atlaspath, StringView datapath);
+
+AssetState GetState(AssetHandle handle);
+bool IsReady(AssetHandle handle);
+
+// Uploads the assets that have been decoded, only call this from the main thread
+void Update();
+
+// Keeps updating until every requested asset is ready or has failed
+void WaitAll();
+
+// Forgets every request so their slots can be used again, all of them have to be finished
+void Clear();
+
+} // namespace AssetLoader
\ No newline at end of file
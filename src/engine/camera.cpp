@@ -31,7 +31,7 @@ Camera Camera::Perspective(f32 fov, f32 aspectRatio, f32 near, f32 far)
 
 }
 
-static bool HandleMouseInput(Camera& camera, f32 lookSpeed, f32 time, bool freeLook)
+bool RotateCamera(Camera& camera, f32 lookSpeed, f32 time, bool freeLook)
 {
     if (!freeLook && !Input::GetMouseButton(MouseButton::RIGHT))
         return false;
@@ -120,7 +120,7 @@ static bool HandleKeyboardInput(Camera& camera, f32 moveSpeed, f32 time)
 
 bool MoveCamera(Camera& camera, f32 lookSpeed, f32 moveSpeed, f32 time, bool freeLook)
 {
-    const bool res1 = HandleMouseInput(camera, lookSpeed, time, freeLook);
+    const bool res1 = RotateCamera(camera, lookSpeed, time, freeLook);
     const bool res2 = HandleKeyboardInput(camera, moveSpeed, time);
     return res1 || res2;
 }
\ No newline at end of file
@@ -101,5 +101,8 @@ private:
     f32 _yaw, _pitch;
 };
 
+// Only turns the camera with the mouse. Returns true if the camera was turned.
+bool RotateCamera(Camera& camera, f32 lookSpeed, f32 time, bool freeLook = false);
+
 // Returns true if the camera was moved
 bool MoveCamera(Camera& camera, f32 lookSpeed, f32 moveSpeed, f32 time, bool freeLook = false);
\ No newline at end of file
@@ -2,9 +2,11 @@
 
 #include "core/application.h"
 #include "game/chunk_renderer.h"
+#include "asset_loader.h"
 #include "renderer2D.h"
 #include "renderer3d.h"
 #include "imgui.h"
+#include "job_system.h"
 #include "skybox.h"
 
 namespace Engine
@@ -14,6 +16,7 @@ void Init(const Application& app)
 {
     // R2D::Init();
     
+    JobSystem::Init();
     Imgui::Init(app);
     R3D::Init();
     ChunkRenderer::Init();
@@ -26,6 +29,8 @@ void Shutdown()
     Imgui::Shutdown();
     R3D::Shutdown();
     ChunkRenderer::Shutdown();
+    AssetLoader::Shutdown();
+    JobSystem::Shutdown();
 
     // R2D::Shutdown();
 }
@@ -7,11 +7,13 @@
 #include "math/math.h"
 #include "graphics/shader.h"
 #include "graphics/texture.h"
-#include "fileio/fileio.h"
 #include "shader_paths.h"
 #include "serialization/json.h"
+#include "fileio/fileio.h"
+#include "containers/string.h"
 #include "containers/stringview.h"
-#include "containers/hashtable.h"
+#include "containers/darray.h"
+#include "containers/hash.h"
 #include "batch.h"
 
 #include <glad/glad.h>
@@ -37,6 +39,48 @@ struct Vertex
 
 using ImguiBatchData = BatchData<Vertex, maxTexCount>;
 
+/*
+
+Text layouts are cached so text that doesn't change from frame to frame
+isn't laid out again. A layout is found by the text, font and size and
+keeps the size of the text once it's measured, and the vertices of its
+quads once it's rendered again. The vertices are copied straight into the
+font batch as long as the text is rendered at the same place with the
+same tint. Text that's only used once (like a frame counter) is laid out
+straight into the batch. When the cache is full, the least recently used
+layout is replaced.
+
+*/
+
+static constexpr u32 maxTextLayouts = 32;
+
+struct TextLayout
+{
+    // Key
+    Hash textHash;
+    const Font* font;
+    f32 size;
+
+    char* text;
+    u32 textLength, textCapacity;
+
+    u64 lastUsed;                   // 0 for slots that were never used
+    u32 useCount;
+
+    bool hasSize;
+    Vector2 renderedSize;
+
+    // Only valid for the values they were made with
+    bool hasVertices;
+    Vertex* vertices;
+    u32 quadCount, quadCapacity;
+
+    Vector3 topLeft;
+    Vector4 tint;
+    s32 refWidth, refHeight;
+    f32 textureSlot;
+};
+
 static struct
 {
     u32 vbo, ibo;
@@ -48,7 +92,12 @@ static struct
 
     ID hot, active;
 
+    UniformId texturesUniform;
+
     Vertex* batchSharedBuffer = nullptr;
+
+    TextLayout textLayouts[maxTextLayouts] = {};
+    u64 textLayoutClock = 0;
 } uidata;
 
 static void InitWhiteTexture(int width, int height)
@@ -77,18 +126,8 @@ static void InitBatches()
         
         // Compile Shaders
         AssertWithMessage(
-            uidata.quadBatch.shader.CompileFromFile(uiQuadVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile UI Quad Vertex Shader!"
-        );
-        
-        AssertWithMessage(
-            uidata.quadBatch.shader.CompileFromFile(uiQuadFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile UI Quad Fragment Shader!"
-        );
-
-        AssertWithMessage(
-            uidata.quadBatch.shader.Link(),
-            "Failed to link UI Quad Shader!"
+            uidata.quadBatch.shader.LoadFromFiles(uiQuadVertShaderPath, uiQuadFragShaderPath),
+            "Failed to load UI Quad Shader!"
         );
 
         uidata.quadBatch.elemVerticesBuffer = uidata.batchSharedBuffer;
@@ -99,18 +138,8 @@ static void InitBatches()
     
         // Compile Shaders
         AssertWithMessage(
-            uidata.fontBatch.shader.CompileFromFile(uiFontVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile UI Font Vertex Shader!"
-        );
-        
-        AssertWithMessage(
-            uidata.fontBatch.shader.CompileFromFile(uiFontFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile UI Font Fragment Shader!"
-        );
-
-        AssertWithMessage(
-            uidata.fontBatch.shader.Link(),
-            "Failed to link UI Font Shader!"
+            uidata.fontBatch.shader.LoadFromFiles(uiFontVertShaderPath, uiFontFragShaderPath),
+            "Failed to load UI Font Shader!"
         );
 
         uidata.fontBatch.elemVerticesBuffer = uidata.quadBatch.elemVerticesBuffer + batchSize;
@@ -124,6 +153,8 @@ void Init(const Application& app)
     AssertWithMessage(activeApp == nullptr, "Imgui was already initialized!");
     activeApp = &app;
 
+    uidata.texturesUniform = GetUniformId("u_textures");
+
     u32 vao;
 
     glGenBuffers(1, &uidata.vbo);
@@ -175,6 +206,12 @@ void Shutdown()
     uidata.whiteTexture.Free();
     PlatformFree(uidata.batchSharedBuffer);
 
+    for (u32 i = 0; i < maxTextLayouts; i++)
+    {
+        PlatformFree(uidata.textLayouts[i].text);
+        PlatformFree(uidata.textLayouts[i].vertices);
+    }
+
     // No need to reset other things since this will be called at the end of the program
 }
 
@@ -206,7 +243,7 @@ static void FlushBatch(ImguiBatchData& batch)
     for (int i = 0; i < batch.nextActiveTexSlot; i++)
         batch.textures[i].Bind(i);
 
-    batch.shader.SetUniform1iv("u_textures", batch.nextActiveTexSlot, activeSlots);
+    batch.shader.SetUniform1iv(uidata.texturesUniform, batch.nextActiveTexSlot, activeSlots);
 
     glBindVertexArray(batch.vao);
 
@@ -237,78 +274,506 @@ static inline s32 GetKerningIndex(s32 a, s32 b)
     return ((a << 8) | b);
 }
 
-void Font::Load(StringView atlaspath, StringView datapath)
+// Each of these reads the value after a key and returns false if it isn't what the font expects
+
+static bool ReadFontInteger(json::Reader& reader, s64& value)
 {
-    {   // Load font atlas
-        texture.Load(atlaspath, TextureSettings::Default());
+    if (reader.Next() != json::Reader::Event::INTEGER)
+        return false;
+
+    value = reader.int64();
+    return true;
+}
+
+static bool ReadFontNumber(json::Reader& reader, f32& value)
+{
+    const json::Reader::Event event = reader.Next();
+    if (event != json::Reader::Event::INTEGER && event != json::Reader::Event::FLOAT)
+        return false;
+
+    value = reader.float64();
+    return true;
+}
+
+// Only characters with a place in the glyph table
+static bool ReadFontCharacter(json::Reader& reader, s32& character)
+{
+    s64 value;
+    if (!ReadFontInteger(reader, value) || value < ' ' || value >= 127)
+        return false;
+
+    character = (s32) value;
+    return true;
+}
+
+// Reads an object with "left", "bottom", "right" and "top" into x, y, z and w
+static bool ReadFontBounds(json::Reader& reader, Vector4& bounds)
+{
+    if (reader.Next() != json::Reader::Event::OBJECT_START)
+        return false;
+
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        const StringView key = reader.string();
+
+        s32 index = -1;
+        if (key == "left")        index = 0;
+        else if (key == "bottom") index = 1;
+        else if (key == "right")  index = 2;
+        else if (key == "top")    index = 3;
+
+        if (index < 0)
+        {
+            reader.Skip();
+            continue;
+        }
+
+        if (!ReadFontNumber(reader, bounds.data[index]))
+            return false;
+    }
+
+    return reader.event == json::Reader::Event::OBJECT_END;
+}
+
+static bool ReadFontGlyph(json::Reader& reader, Font& font, s32 atlasWidth, s32 atlasHeight)
+{
+    // The unicode can come after the rest, so the glyph is only stored at the end
+    s32 unicode = -1;
+    Font::GlyphData glyphData = {};
+    bool hasPlaneBounds = false;
+    bool hasAtlasBounds = false;
+
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        const StringView key = reader.string();
+
+        bool valid = true;
+        if (key == "unicode")
+            valid = ReadFontCharacter(reader, unicode);
+        else if (key == "advance")
+            valid = ReadFontNumber(reader, glyphData.advance);
+        else if (key == "planeBounds")
+        {
+            valid = ReadFontBounds(reader, glyphData.planeBounds);
+            hasPlaneBounds = true;
+        }
+        else if (key == "atlasBounds")
+        {
+            Vector4 bounds;
+            valid = ReadFontBounds(reader, bounds);
+
+            glyphData.atlasBounds = Vector4(
+                bounds.x / atlasWidth,
+                bounds.w / atlasHeight,
+                bounds.z / atlasWidth,
+                bounds.y / atlasHeight
+            );
+            hasAtlasBounds = true;
+        }
+        else
+            reader.Skip();
+
+        if (!valid)
+            return false;
+    }
+
+    if (reader.event != json::Reader::Event::OBJECT_END || unicode < 0)
+        return false;
+
+    Font::GlyphData& stored = font.glyphs[unicode - ' '];
+    stored.advance = glyphData.advance;
+
+    if (hasPlaneBounds)
+        stored.planeBounds = glyphData.planeBounds;
+
+    if (hasAtlasBounds)
+        stored.atlasBounds = glyphData.atlasBounds;
+
+    return true;
+}
+
+static bool ReadFontKerning(json::Reader& reader, DynamicArray<Font::KerningPair>& kerningPairs)
+{
+    s32 unicode1 = -1, unicode2 = -1;
+    f32 advance = 0.0f;
+
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        const StringView key = reader.string();
+
+        bool valid = true;
+        if (key == "unicode1")      valid = ReadFontCharacter(reader, unicode1);
+        else if (key == "unicode2") valid = ReadFontCharacter(reader, unicode2);
+        else if (key == "advance")  valid = ReadFontNumber(reader, advance);
+        else
+            reader.Skip();
+
+        if (!valid)
+            return false;
+    }
+
+    if (reader.event != json::Reader::Event::OBJECT_END || unicode1 < 0 || unicode2 < 0)
+        return false;
+
+    Font::KerningPair& pair = kerningPairs.EmplaceBack();
+    pair.index = GetKerningIndex(unicode1, unicode2);
+    pair.advance = advance;
+    return true;
+}
+
+static bool ReadFontAtlas(json::Reader& reader, Font& font)
+{
+    if (reader.Next() != json::Reader::Event::OBJECT_START)
+        return false;
+
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        if (reader.string() != "size")
+        {
+            reader.Skip();
+            continue;
+        }
+
+        s64 size;
+        if (!ReadFontInteger(reader, size) || size <= 0)
+            return false;
+
+        font.size = (u32) size;
     }
 
-    {   // Load font data
-        String json;
-        LoadFileToString(datapath, json);
+    return reader.event == json::Reader::Event::OBJECT_END;
+}
+
+static bool ReadFontMetrics(json::Reader& reader, Font& font)
+{
+    if (reader.Next() != json::Reader::Event::OBJECT_START)
+        return false;
+
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        const StringView metric = reader.string();
+
+        f32* field = nullptr;
+        if (metric == "lineHeight")     field = &font.lineHeight;
+        else if (metric == "ascender")  field = &font.ascender;
+        else if (metric == "descender") field = &font.descender;
 
-        json::Document document;
-        json::ParseJsonString(json.cstr(), document);
+        if (!field)
+        {
+            reader.Skip();
+            continue;
+        }
+
+        if (!ReadFontNumber(reader, *field))
+            return false;
+    }
 
-        json::Value data = document.Start();
+    return reader.event == json::Reader::Event::OBJECT_END;
+}
+
+// Returns false if the data file couldn't be opened, isn't valid JSON or has values a font can't have
+static bool LoadFontData(Font& font, StringView datapath, s32 atlasWidth, s32 atlasHeight)
+{
+    DynamicArray<Font::KerningPair> kerningPairs;
 
-        size = data["atlas"]["size"].int64();
+    {   // Load font data, streamed so neither the file nor a document has to be in memory at once
+        json::Reader reader;
+        if (!reader.Open(datapath))
+            return false;
 
-        const json::Value& metrics = data["metrics"];
-        lineHeight = metrics["lineHeight"].float64();
-        ascender = metrics["ascender"].float64();
-        descender = metrics["descender"].float64();
+        if (reader.Next() != json::Reader::Event::OBJECT_START)
+            return false;
 
-        for (const auto& glyph : data["glyphs"].array())
+        while (reader.Next() == json::Reader::Event::KEY)
         {
-            u32 unicode = glyph["unicode"].int64();
-
-            GlyphData& glyphData = glyphs[unicode - ' '];
-            glyphData.advance = glyph["advance"].float64();
-
-            {   // Plane bounds
-                const json::Value& planeBounds = glyph["planeBounds"];
-                if (!planeBounds.IsNull())
-                {
-                    glyphData.planeBounds = Vector4(
-                        planeBounds["left"].float64(),
-                        planeBounds["bottom"].float64(),
-                        planeBounds["right"].float64(),
-                        planeBounds["top"].float64()
-                    );
-                }
+            const StringView key = reader.string();
+
+            bool valid = true;
+            if (key == "atlas")
+                valid = ReadFontAtlas(reader, font);
+            else if (key == "metrics")
+                valid = ReadFontMetrics(reader, font);
+            else if (key == "glyphs")
+            {
+                valid = (reader.Next() == json::Reader::Event::ARRAY_START);
+                while (valid && reader.Next() == json::Reader::Event::OBJECT_START)
+                    valid = ReadFontGlyph(reader, font, atlasWidth, atlasHeight);
+
+                valid = valid && (reader.event == json::Reader::Event::ARRAY_END);
             }
-            
-            {   // Atlas bounds
-                const json::Value& atlasBounds = glyph["atlasBounds"];
-                if (!atlasBounds.IsNull())
-                {
-                    glyphData.atlasBounds = Vector4(
-                        atlasBounds["left"].float64()   / texture.width(),
-                        atlasBounds["top"].float64()    / texture.height(),
-                        atlasBounds["right"].float64()  / texture.width(),
-                        atlasBounds["bottom"].float64() / texture.height()
-                    );
-                }
+            else if (key == "kerning")
+            {
+                valid = (reader.Next() == json::Reader::Event::ARRAY_START);
+                while (valid && reader.Next() == json::Reader::Event::OBJECT_START)
+                    valid = ReadFontKerning(reader, kerningPairs);
+
+                valid = valid && (reader.event == json::Reader::Event::ARRAY_END);
+            }
+            else
+                reader.Skip();
+
+            if (!valid)
+                return false;
+        }
+
+        // Stopping anywhere else means the file was cut short or isn't valid JSON
+        if (reader.event != json::Reader::Event::OBJECT_END)
+            return false;
+    }
+
+    {   // Sort the kerning pairs, insertion sort keeps pairs with the same index in file order
+        Font::KerningPair* pairs = kerningPairs.data();
+
+        for (u64 i = 1; i < kerningPairs.size(); i++)
+        {
+            const Font::KerningPair pair = pairs[i];
+
+            u64 j = i;
+            while (j > 0 && pairs[j - 1].index > pair.index)
+            {
+                pairs[j] = pairs[j - 1];
+                j--;
             }
+
+            pairs[j] = pair;
+        }
+    }
+
+    {   // Move them to the font, the last pair with the same index wins
+        font.kerningPairs = (Font::KerningPair*) PlatformAllocate(Max(kerningPairs.size(), (u64) 1) * sizeof(Font::KerningPair));
+        font.kerningCount = 0;
+
+        for (u64 i = 0; i < kerningPairs.size(); i++)
+        {
+            if (font.kerningCount > 0 && font.kerningPairs[font.kerningCount - 1].index == kerningPairs[i].index)
+                font.kerningCount--;
+
+            font.kerningPairs[font.kerningCount++] = kerningPairs[i];
         }
+    }
+
+    return true;
+}
+
+/*
+
+The font cache is the header followed by the glyph array and the sorted
+kerning pairs, exactly as they are in memory. It's only used if it was
+written from the same data file (by its write time), for an atlas of the
+same size (the atlas bounds are stored normalized) and by a build with the
+same layout.
+
+*/
+
+static constexpr u32 fontCacheMagic = 0x43464E47;     // "GNFC"
+static constexpr u32 fontCacheVersion = 1;
+
+struct FontCacheHeader
+{
+    u32 magic;
+    u32 version;
+    u32 glyphDataSize;
+    u32 kerningCount;
+
+    u64 sourceWriteTime;
+    s32 atlasWidth, atlasHeight;
+
+    Hash contentHash;                   // Of everything after the header
+
+    f32 lineHeight;
+    f32 ascender, descender;
+    u32 size;
+};
+
+static bool LoadFontCache(Font& font, StringView cachepath, u64 sourceWriteTime, s32 atlasWidth, s32 atlasHeight)
+{
+    PlatformMappedFile file;
+    if (!PlatformMapFile(file, cachepath.cstr()))
+        return false;
+
+    FontCacheHeader header;
+    bool valid = (file.size >= sizeof(FontCacheHeader));
+
+    if (valid)
+    {
+        PlatformCopyMemory(&header, file.data, sizeof(FontCacheHeader));
+
+        valid = header.magic == fontCacheMagic &&
+                header.version == fontCacheVersion &&
+                header.glyphDataSize == sizeof(Font::GlyphData) &&
+                header.sourceWriteTime == sourceWriteTime &&
+                header.atlasWidth == atlasWidth &&
+                header.atlasHeight == atlasHeight &&
+                file.size == sizeof(FontCacheHeader) + sizeof(font.glyphs) + header.kerningCount * sizeof(Font::KerningPair);
+    }
+
+    const char* content = (const char*) file.data + sizeof(FontCacheHeader);
+    const u64 contentSize = file.size - sizeof(FontCacheHeader);
+
+    if (valid)
+        valid = (HashCharBuffer(content, contentSize) == header.contentHash);
+
+    if (valid)
+    {
+        font.lineHeight = header.lineHeight;
+        font.ascender = header.ascender;
+        font.descender = header.descender;
+        font.size = header.size;
+
+        PlatformCopyMemory(font.glyphs, content, sizeof(font.glyphs));
+
+        font.kerningCount = header.kerningCount;
+        font.kerningPairs = (Font::KerningPair*) PlatformAllocate(Max(header.kerningCount, 1u) * sizeof(Font::KerningPair));
+        PlatformCopyMemory(font.kerningPairs, content + sizeof(font.glyphs), header.kerningCount * sizeof(Font::KerningPair));
+    }
+
+    PlatformUnmapFile(file);
+    return valid;
+}
+
+static void SaveFontCache(const Font& font, StringView cachepath, u64 sourceWriteTime, s32 atlasWidth, s32 atlasHeight)
+{
+    const u64 kerningSize = font.kerningCount * sizeof(Font::KerningPair);
+    const u64 contentSize = sizeof(font.glyphs) + kerningSize;
+    char* blob = (char*) PlatformAllocate(sizeof(FontCacheHeader) + contentSize);
+
+    char* content = blob + sizeof(FontCacheHeader);
+    PlatformCopyMemory(content, font.glyphs, sizeof(font.glyphs));
+    PlatformCopyMemory(content + sizeof(font.glyphs), font.kerningPairs, kerningSize);
+
+    FontCacheHeader header = {};
+    header.magic = fontCacheMagic;
+    header.version = fontCacheVersion;
+    header.glyphDataSize = sizeof(Font::GlyphData);
+    header.kerningCount = font.kerningCount;
+    header.sourceWriteTime = sourceWriteTime;
+    header.atlasWidth = atlasWidth;
+    header.atlasHeight = atlasHeight;
+    header.contentHash = HashCharBuffer(content, contentSize);
+    header.lineHeight = font.lineHeight;
+    header.ascender = font.ascender;
+    header.descender = font.descender;
+    header.size = font.size;
+
+    PlatformCopyMemory(blob, &header, sizeof(FontCacheHeader));
+
+    // Not being able to write the cache only means the data file is read again next time
+    bool saved = SaveBytesToFile(cachepath, blob, sizeof(FontCacheHeader) + contentSize);
+    WarnIf(!saved, "Couldn't write the font cache!");
+
+    PlatformFree(blob);
+}
+
+// Finds where the pairs of each character start in the sorted pairs
+static void FindKerningStarts(Font& font)
+{
+    AssertWithMessage(font.kerningCount <= 0xFFFF, "Font has too many kerning pairs!");
+
+    u32 pair = 0;
+    for (s32 ch = ' '; ch <= 127; ch++)
+    {
+        while (pair < font.kerningCount && (s32) (font.kerningPairs[pair].index >> 8) < ch)
+            pair++;
+
+        font.kerningStarts[ch - ' '] = pair;
+    }
+}
+
+// Returns 0 for pairs that don't have kerning
+static inline f32 GetKerning(const Font& font, char current, char previous)
+{
+    const u32 first = (u32) (current - ' ');
+    if (first >= 127 - ' ')
+        return 0.0f;
 
-        for (const auto& kerning : data["kerning"].array())
+    // Characters only have a few pairs each, and they're sorted so the scan can stop early
+    const u32 index = GetKerningIndex(current, previous);
+    for (u32 i = font.kerningStarts[first]; i < font.kerningStarts[first + 1]; i++)
+    {
+        const Font::KerningPair& pair = font.kerningPairs[i];
+
+        if (pair.index >= index)
+            return (pair.index == index) ? pair.advance : 0.0f;
+    }
+
+    return 0.0f;
+}
+
+// Layouts of a font that's being reloaded or freed can't be used anymore
+static void ForgetTextLayouts(const Font& font)
+{
+    for (u32 i = 0; i < maxTextLayouts; i++)
+    {
+        TextLayout& layout = uidata.textLayouts[i];
+
+        if (layout.font == &font)
         {
-            s32 kIndex = GetKerningIndex(kerning["unicode1"].int64(), kerning["unicode2"].int64());
-            kerningTable[kIndex] = kerning["advance"].float64();
+            layout.font = nullptr;
+            layout.lastUsed = 0;
         }
     }
 }
+
+void Font::Load(StringView atlaspath, StringView datapath)
+{
+    ForgetTextLayouts(*this);
+
+    {   // Load font atlas
+        texture.Load(atlaspath, TextureSettings::Default());
+    }
+
+    bool loaded = LoadData(datapath, texture.width(), texture.height());
+    AssertWithMessage(loaded, "Font data couldn't be loaded!");
+}
+
+void Font::LoadAtlas(StringView atlaspath, const TextureSource& source)
+{
+    ForgetTextLayouts(*this);
+    texture.LoadSource(atlaspath, source, TextureSettings::Default());
+}
+
+bool Font::LoadData(StringView datapath, s32 atlasWidth, s32 atlasHeight)
+{
+    PlatformFree(kerningPairs);
+    kerningPairs = nullptr;
+    kerningCount = 0;
+
+    u64 sourceWriteTime = 0;
+    if (!PlatformGetFileWriteTime(datapath.cstr(), sourceWriteTime))
+        return false;
+
+    // Built on the stack since the String pool can't be used from other threads
+    static constexpr char cacheExtension[] = ".cache";
+    char cachepath[maxFontPathLength + sizeof(cacheExtension)];
+
+    AssertWithMessage(datapath.size() <= maxFontPathLength, "Font data path is too long!");
+    PlatformCopyMemory(cachepath, datapath.cstr(), datapath.size());
+    PlatformCopyMemory(cachepath + datapath.size(), cacheExtension, sizeof(cacheExtension));
+
+    if (!LoadFontCache(*this, cachepath, sourceWriteTime, atlasWidth, atlasHeight))
+    {
+        if (!LoadFontData(*this, datapath, atlasWidth, atlasHeight))
+            return false;
+
+        SaveFontCache(*this, cachepath, sourceWriteTime, atlasWidth, atlasHeight);
+    }
+
+    FindKerningStarts(*this);
+    return true;
+}
+
 void Font::Free()
 {
+    ForgetTextLayouts(*this);
     texture.Free();
+
+    PlatformFree(kerningPairs);
+    kerningPairs = nullptr;
+    kerningCount = 0;
 }
 
-Vector2 GetRenderedTextSize(StringView text, Font& font, f32 size)
+static Vector2 MeasureText(StringView text, const Font& font, f32 size)
 {
-    size = (size < 0.0f) ? font.size : size;
-
     Vector2 position;
     position.y += size * (font.ascender);
 
@@ -343,13 +808,9 @@ Vector2 GetRenderedTextSize(StringView text, Font& font, f32 size)
         }
 
         if (i > 0)
-        {
-            s32 kerningIndex = GetKerningIndex(text[i], text[i - 1]);
-            if (font.kerningTable.Find(kerningIndex))
-                position.x += size * font.kerningTable[kerningIndex];
-        }
+            position.x += size * GetKerning(font, text[i], text[i - 1]);
 
-        Font::GlyphData& glyph = font.glyphs[text[i] - ' '];
+        const Font::GlyphData& glyph = font.glyphs[text[i] - ' '];
         position.x += size * glyph.advance;
     }
 
@@ -358,6 +819,71 @@ Vector2 GetRenderedTextSize(StringView text, Font& font, f32 size)
     return totalSize;
 }
 
+// Finds the layout of the text, the least recently used layout is replaced if it isn't cached
+static TextLayout& GetTextLayout(StringView text, const Font& font, f32 size)
+{
+    const Hash textHash = HashCharBuffer(text.cstr(), text.size());
+    const u64 now = ++uidata.textLayoutClock;
+
+    TextLayout* leastRecent = &uidata.textLayouts[0];
+
+    for (u32 i = 0; i < maxTextLayouts; i++)
+    {
+        TextLayout& layout = uidata.textLayouts[i];
+
+        if (layout.lastUsed != 0 &&
+            layout.textHash == textHash &&
+            layout.font == &font &&
+            layout.size == size &&
+            layout.textLength == text.size() &&
+            PlatformCompareMemory(layout.text, text.cstr(), text.size()))
+        {
+            layout.lastUsed = now;
+            layout.useCount++;
+            return layout;
+        }
+
+        if (layout.lastUsed < leastRecent->lastUsed)
+            leastRecent = &layout;
+    }
+
+    TextLayout& layout = *leastRecent;
+
+    if (layout.text == nullptr || layout.textCapacity < text.size())
+    {
+        layout.textCapacity = Max((u32) text.size(), 16u);
+        layout.text = (char*) PlatformReallocate(layout.text, layout.textCapacity);
+    }
+
+    PlatformCopyMemory(layout.text, text.cstr(), text.size());
+    layout.textLength = text.size();
+    layout.textHash = textHash;
+    layout.font = &font;
+    layout.size = size;
+    layout.lastUsed = now;
+    layout.useCount = 1;
+
+    layout.hasSize = false;
+    layout.hasVertices = false;
+
+    return layout;
+}
+
+Vector2 GetRenderedTextSize(StringView text, Font& font, f32 size)
+{
+    size = (size < 0.0f) ? font.size : size;
+
+    TextLayout& layout = GetTextLayout(text, font, size);
+
+    if (!layout.hasSize)
+    {
+        layout.renderedSize = MeasureText(text, font, size);
+        layout.hasSize = true;
+    }
+
+    return layout.renderedSize;
+}
+
 
 Vector2 GetRenderedCharSize(char ch, Font& font, f32 size)
 {
@@ -373,16 +899,9 @@ Vector2 GetRenderedCharSize(char ch, Font& font, f32 size)
     return Vector2(size * glyph.advance, size * font.lineHeight);
 }
 
-static void PushUIQuad(ImguiBatchData& batch, const Rect& rect, const Vector4& texCoords, const Texture& tex, const Vector4& color)
+// Returns the slot of the texture in the batch, the batch is ended if all the slots are occupied
+static s32 GetTextureSlot(ImguiBatchData& batch, const Texture& tex)
 {
-    AssertWithMessage(activeApp, "Imgui was never initialized!");
-
-    if (batch.elemCount >= maxQuadCount)
-    {
-        End();
-        Begin();
-    }
-
     // Find if texture has already been set to active
     int textureSlot = batch.nextActiveTexSlot;
     for (int i = 0; i < batch.nextActiveTexSlot; i++)
@@ -409,6 +928,12 @@ static void PushUIQuad(ImguiBatchData& batch, const Rect& rect, const Vector4& t
         batch.nextActiveTexSlot++;
     }
 
+    return textureSlot;
+}
+
+// Writes the 4 vertices of a quad to vertices
+static void WriteUIQuad(Vertex* vertices, const Rect& rect, const Vector4& texCoords, f32 textureSlot, const Vector4& color)
+{
     f32 top    = 1.0f - 2.0f * (rect.topLeft.y / activeApp->window.refHeight);
     f32 left   = 2.0f * (rect.topLeft.x / activeApp->window.refWidth) - 1.0f;
     f32 right  = 2.0f * ((rect.topLeft.x + rect.size.x) / activeApp->window.refWidth) - 1.0f;
@@ -416,30 +941,41 @@ static void PushUIQuad(ImguiBatchData& batch, const Rect& rect, const Vector4& t
 
     f32 z = rect.topLeft.z;
 
-    batch.elemVerticesPtr->position = Vector3(left, bottom, z);
-    batch.elemVerticesPtr->texCoord = Vector2(texCoords.s, texCoords.v);
-    batch.elemVerticesPtr->color = color;
-    batch.elemVerticesPtr->texIndex = (f32) textureSlot;
-    batch.elemVerticesPtr++;
-
-    batch.elemVerticesPtr->position = Vector3(right, bottom, z);
-    batch.elemVerticesPtr->texCoord = Vector2(texCoords.u, texCoords.v);
-    batch.elemVerticesPtr->color = color;
-    batch.elemVerticesPtr->texIndex = (f32) textureSlot;
-    batch.elemVerticesPtr++;
-
-    batch.elemVerticesPtr->position = Vector3(right, top, z);
-    batch.elemVerticesPtr->texCoord = Vector2(texCoords.u, texCoords.t);
-    batch.elemVerticesPtr->color = color;
-    batch.elemVerticesPtr->texIndex = (f32) textureSlot;
-    batch.elemVerticesPtr++;
-
-    batch.elemVerticesPtr->position = Vector3(left, top, z);
-    batch.elemVerticesPtr->texCoord = Vector2(texCoords.s, texCoords.t);
-    batch.elemVerticesPtr->color = color;
-    batch.elemVerticesPtr->texIndex = (f32) textureSlot;
-    batch.elemVerticesPtr++;
+    vertices[0].position = Vector3(left, bottom, z);
+    vertices[0].texCoord = Vector2(texCoords.s, texCoords.v);
+    vertices[0].color = color;
+    vertices[0].texIndex = textureSlot;
+
+    vertices[1].position = Vector3(right, bottom, z);
+    vertices[1].texCoord = Vector2(texCoords.u, texCoords.v);
+    vertices[1].color = color;
+    vertices[1].texIndex = textureSlot;
+
+    vertices[2].position = Vector3(right, top, z);
+    vertices[2].texCoord = Vector2(texCoords.u, texCoords.t);
+    vertices[2].color = color;
+    vertices[2].texIndex = textureSlot;
+
+    vertices[3].position = Vector3(left, top, z);
+    vertices[3].texCoord = Vector2(texCoords.s, texCoords.t);
+    vertices[3].color = color;
+    vertices[3].texIndex = textureSlot;
+}
+
+static void PushUIQuad(ImguiBatchData& batch, const Rect& rect, const Vector4& texCoords, const Texture& tex, const Vector4& color)
+{
+    AssertWithMessage(activeApp, "Imgui was never initialized!");
+
+    if (batch.elemCount >= maxQuadCount)
+    {
+        End();
+        Begin();
+    }
+
+    s32 textureSlot = GetTextureSlot(batch, tex);
 
+    WriteUIQuad(batch.elemVerticesPtr, rect, texCoords, (f32) textureSlot, color);
+    batch.elemVerticesPtr += 4;
     batch.elemCount++;
 }
 
@@ -494,10 +1030,31 @@ bool RenderButton(ID id, const Rect& rect, const Vector4& defaultColor, const Ve
     return clicked;
 }
 
-void RenderText(StringView text, Font& font, const Vector3& topLeft, f32 size, const Vector4& tint)
+// True if the layout's vertices were made for the text at the same place with the same tint
+static bool CanReuseVertices(const TextLayout& layout, const Vector3& topLeft, const Vector4& tint)
 {
-    size = (size < 0) ? font.size : size;
+    return layout.hasVertices &&
+           layout.topLeft.x == topLeft.x && layout.topLeft.y == topLeft.y && layout.topLeft.z == topLeft.z &&
+           layout.tint.x == tint.x && layout.tint.y == tint.y && layout.tint.z == tint.z && layout.tint.w == tint.w &&
+           layout.refWidth == activeApp->window.refWidth &&
+           layout.refHeight == activeApp->window.refHeight;
+}
+
+static u32 CountTextQuads(StringView text)
+{
+    u32 quadCount = 0;
+    for (u64 i = 0; i < text.length(); i++)
+    {
+        if (text[i] != '\n' && text[i] != '\r' && text[i] != '\t')
+            quadCount++;
+    }
 
+    return quadCount;
+}
+
+// Writes the quads of the text to vertices
+static void BuildTextVertices(Vertex* vertices, StringView text, const Font& font, const Vector3& topLeft, f32 size, const Vector4& tint, f32 textureSlot)
+{
     Vector3 position = topLeft;
     position.y += size * (font.ascender);
 
@@ -525,7 +1082,7 @@ void RenderText(StringView text, Font& font, const Vector3& topLeft, f32 size, c
             continue;
         }
 
-        Font::GlyphData& glyph = font.glyphs[text[i] - ' '];
+        const Font::GlyphData& glyph = font.glyphs[text[i] - ' '];
 
         Rect rect;
         rect.topLeft = position + Vector3(size * glyph.planeBounds.s, size * -glyph.planeBounds.v, 0.0f);
@@ -533,20 +1090,111 @@ void RenderText(StringView text, Font& font, const Vector3& topLeft, f32 size, c
 
         if (i > 0)
         {
-            s32 kerningIndex = GetKerningIndex(text[i], text[i-1]);
-            if (font.kerningTable.Find(kerningIndex))
-            {
-                rect.topLeft.x += size * font.kerningTable[kerningIndex];
-                position.x += size * font.kerningTable[kerningIndex];
-            }
+            const f32 kerning = size * GetKerning(font, text[i], text[i - 1]);
+            rect.topLeft.x += kerning;
+            position.x += kerning;
         }
 
-        PushUIQuad(uidata.fontBatch, rect, glyph.atlasBounds, font.texture, tint);
+        WriteUIQuad(vertices, rect, glyph.atlasBounds, textureSlot, tint);
+        vertices += 4;
 
         position.x += size * glyph.advance;
     }
 }
 
+void RenderText(StringView text, Font& font, const Vector3& topLeft, f32 size, const Vector4& tint)
+{
+    AssertWithMessage(activeApp, "Imgui was never initialized!");
+
+    size = (size < 0) ? font.size : size;
+
+    TextLayout& layout = GetTextLayout(text, font, size);
+
+    const bool reuse = CanReuseVertices(layout, topLeft, tint);
+    const u32 quadCount = (reuse) ? layout.quadCount : CountTextQuads(text);
+
+    if (quadCount == 0)
+        return;
+
+    ImguiBatchData& batch = uidata.fontBatch;
+
+    // Text that fits in a batch isn't split, longer text fills what's left and continues in the next ones
+    if (quadCount <= (u32) maxQuadCount && batch.elemCount + quadCount > (u32) maxQuadCount)
+    {
+        End();
+        Begin();
+    }
+
+    f32 textureSlot = (f32) GetTextureSlot(batch, font.texture);
+
+    if (!reuse && layout.useCount <= 1 && batch.elemCount + quadCount <= (u32) maxQuadCount)
+    {
+        BuildTextVertices(batch.elemVerticesPtr, text, font, topLeft, size, tint, textureSlot);
+
+        batch.elemVerticesPtr += 4 * quadCount;
+        batch.elemCount += quadCount;
+        return;
+    }
+
+    if (reuse)
+    {
+        if (layout.textureSlot != textureSlot)
+        {
+            for (u32 i = 0; i < 4 * quadCount; i++)
+                layout.vertices[i].texIndex = textureSlot;
+
+            layout.textureSlot = textureSlot;
+        }
+    }
+    else
+    {
+        // Text that was used before is likely to be used again, so its vertices are kept.
+        // Text longer than a batch is built here too so it can be copied in parts.
+        if (layout.quadCapacity < quadCount)
+        {
+            layout.quadCapacity = quadCount;
+            layout.vertices = (Vertex*) PlatformReallocate(layout.vertices, 4 * quadCount * sizeof(Vertex));
+        }
+
+        BuildTextVertices(layout.vertices, text, font, topLeft, size, tint, textureSlot);
+
+        layout.hasVertices = true;
+        layout.quadCount = quadCount;
+        layout.topLeft = topLeft;
+        layout.tint = tint;
+        layout.refWidth = activeApp->window.refWidth;
+        layout.refHeight = activeApp->window.refHeight;
+        layout.textureSlot = textureSlot;
+    }
+
+    u32 copied = 0;
+    while (true)
+    {
+        const u32 count = Min(quadCount - copied, (u32) maxQuadCount - batch.elemCount);
+        PlatformCopyMemory(batch.elemVerticesPtr, layout.vertices + 4 * copied, 4 * count * sizeof(Vertex));
+
+        batch.elemVerticesPtr += 4 * count;
+        batch.elemCount += count;
+        copied += count;
+
+        if (copied == quadCount)
+            break;
+
+        End();
+        Begin();
+
+        // The font can get another slot in the new batch. The parts already copied keep the
+        // old one, so the slot is forgotten and every vertex is fixed the next time it's used.
+        textureSlot = (f32) GetTextureSlot(batch, font.texture);
+        if (layout.textureSlot != textureSlot)
+        {
+            for (u32 i = 4 * copied; i < 4 * quadCount; i++)
+                layout.vertices[i].texIndex = textureSlot;
+
+            layout.textureSlot = -1.0f;
+        }
+    }
+}
 
 void RenderChar(char ch, Font& font, const Vector3& topLeft, f32 size, const Vector4& tint)
 {
@@ -4,7 +4,6 @@
 #include "math/math.h"
 #include "core/application.h"
 #include "containers/stringview.h"
-#include "containers/hashtable.h"
 #include "graphics/texture.h"
 
 namespace Imgui
@@ -45,6 +44,8 @@ struct Rect
 using Image = Texture;
 using ImageSettings = TextureSettings;
 
+constexpr u32 maxFontPathLength = 256;
+
 struct Font
 {
     struct GlyphData
@@ -54,6 +55,12 @@ struct Font
         Vector4 atlasBounds;
     };
 
+    struct KerningPair
+    {
+        u32 index;      // Both characters, see GetKerningIndex
+        f32 advance;
+    };
+
     Texture texture;
 
     f32 lineHeight;
@@ -61,10 +68,23 @@ struct Font
     u32 size;
 
     GlyphData glyphs[127 - ' '];
-    HashTable<s32, f32> kerningTable;
 
+    // Sorted by index, the pairs of a character are kerningPairs[kerningStarts[ch - ' ']] up to
+    // the start of the next character
+    KerningPair* kerningPairs = nullptr;
+    u32 kerningCount = 0;
+    u16 kerningStarts[127 - ' ' + 1];
+
+    // The font data is read from a binary cache next to the data file, which is
+    // written the first time and again whenever the data file changes
     void Load(StringView atlaspath, StringView datapath);
     void Free();
+
+    // The two halves of Load. LoadData doesn't need OpenGL so it can run on any thread,
+    // but the font can't be rendered with until both are done. LoadData returns false
+    // if the data file is missing or can't be read.
+    void LoadAtlas(StringView atlaspath, const TextureSource& source);
+    bool LoadData(StringView datapath, s32 atlasWidth, s32 atlasHeight);
 };
 
 Vector2 GetRenderedTextSize(StringView text, Font& font, f32 size = -1.0f);
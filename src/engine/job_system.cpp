@@ -0,0 +1,154 @@
+#include "job_system.h"
+
+#include "core/logging.h"
+#include "math/common.h"
+#include "platform/platform.h"
+
+namespace JobSystem
+{
+
+struct Job
+{
+    JobFunction function;
+    void*       data;
+    JobCounter* counter;
+};
+
+constexpr u32 maxQueuedJobs = 1024;     // Must be a power of 2
+constexpr u32 maxWorkerCount = 16;
+
+static struct
+{
+    Job queue[maxQueuedJobs];
+    u32 head, tail;                     // Jobs are popped from head and pushed at tail
+
+    PlatformMutex queueMutex;
+    PlatformSemaphore jobsAvailable;
+
+    PlatformThread workers[maxWorkerCount];
+    u32 workerCount;
+
+    volatile bool running;
+} jsData;
+
+static bool PopJob(Job& job)
+{
+    PlatformMutexLock(jsData.queueMutex);
+
+    const bool hasJob = jsData.head != jsData.tail;
+    if (hasJob)
+    {
+        job = jsData.queue[jsData.head];
+        jsData.head = (jsData.head + 1) & (maxQueuedJobs - 1);
+    }
+
+    PlatformMutexUnlock(jsData.queueMutex);
+    return hasJob;
+}
+
+static void RunJob(const Job& job)
+{
+    job.function(job.data);
+
+    if (job.counter)
+        PlatformAtomicDecrement(&job.counter->value);
+}
+
+static void WorkerMain(void*)
+{
+    while (true)
+    {
+        PlatformSemaphoreWait(jsData.jobsAvailable);
+
+        if (!jsData.running)
+            break;
+
+        // The job may have been taken by a thread that's waiting on a counter
+        Job job;
+        if (PopJob(job))
+            RunJob(job);
+    }
+}
+
+void Init()
+{
+    jsData.head = jsData.tail = 0;
+    jsData.running = true;
+
+    PlatformMutexCreate(jsData.queueMutex);
+    PlatformSemaphoreCreate(jsData.jobsAvailable, maxQueuedJobs + maxWorkerCount);
+
+    // Leave a core for the main thread
+    const u32 processorCount = PlatformGetProcessorCount();
+    jsData.workerCount = Clamp(processorCount - 1, 1u, maxWorkerCount);
+
+    for (u32 i = 0; i < jsData.workerCount; i++)
+    {
+        const bool created = PlatformThreadCreate(jsData.workers[i], WorkerMain, nullptr);
+        AssertWithMessage(created, "Couldn't create job system worker thread!");
+    }
+}
+
+void Shutdown()
+{
+    jsData.running = false;
+    PlatformSemaphoreSignal(jsData.jobsAvailable, jsData.workerCount);
+
+    for (u32 i = 0; i < jsData.workerCount; i++)
+        PlatformThreadJoin(jsData.workers[i]);
+
+    PlatformSemaphoreDestroy(jsData.jobsAvailable);
+    PlatformMutexDestroy(jsData.queueMutex);
+}
+
+u32 WorkerCount()
+{
+    return jsData.workerCount;
+}
+
+void Submit(JobFunction function, void* data, JobCounter* counter)
+{
+    const Job job = { function, data, counter };
+
+    if (counter)
+        PlatformAtomicIncrement(&counter->value);
+
+    PlatformMutexLock(jsData.queueMutex);
+
+    const u32 nextTail = (jsData.tail + 1) & (maxQueuedJobs - 1);
+    const bool queueIsFull = nextTail == jsData.head;
+    if (!queueIsFull)
+    {
+        jsData.queue[jsData.tail] = job;
+        jsData.tail = nextTail;
+    }
+
+    PlatformMutexUnlock(jsData.queueMutex);
+
+    if (queueIsFull)
+        RunJob(job);
+    else
+        PlatformSemaphoreSignal(jsData.jobsAvailable);
+}
+
+void Wait(JobCounter& counter)
+{
+    while (counter.value > 0)
+    {
+        // Help out instead of sitting idle
+        if (!RunQueuedJob())
+            PlatformThreadYield();
+    }
+}
+
+bool RunQueuedJob()
+{
+    Job job;
+    if (!PopJob(job))
+        return false;
+
+    RunJob(job);
+    return true;
+}
+
+} // namespace JobSystem
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/types.h"
+
+/*
+
+Small job system for work that can be split across cores (lighting chunks etc.)
+
+Jobs are plain function pointers with a data pointer, they are run by a
+fixed set of worker threads in the order they were submitted. Jobs that
+belong together share a JobCounter that the submitting thread can wait on.
+The waiting thread runs queued jobs itself instead of sleeping.
+
+*/
+
+namespace JobSystem
+{
+
+using JobFunction = void (*)(void* data);
+
+// Number of submitted jobs that haven't finished yet
+struct JobCounter
+{
+    volatile s32 value = 0;
+};
+
+void Init();
+void Shutdown();
+
+u32  WorkerCount();
+
+// Runs the job right away on the calling thread if the queue is full
+void Submit(JobFunction function, void* data, JobCounter* counter = nullptr);
+
+// Blocks until every job using the counter is done
+void Wait(JobCounter& counter);
+
+// Runs one queued job on the calling thread, false if there weren't any
+bool RunQueuedJob();
+
+} // namespace JobSystem
\ No newline at end of file
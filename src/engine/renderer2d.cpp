@@ -49,6 +49,8 @@ static struct
 
     u32 vbo, ibo;
 
+    UniformId viewProjectionUniform, texturesUniform;
+
     Texture whiteTexture;
 
     void* batchSharedBuffer = nullptr;
@@ -80,18 +82,8 @@ static void InitBatches()
 
         // Compile Shaders
         AssertWithMessage(
-            r2dData.spriteBatch.shader.CompileFromFile(r2dSpriteVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile Sprite Vertex Shader"
-        );
-
-        AssertWithMessage(
-            r2dData.spriteBatch.shader.CompileFromFile(r2dSpriteFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile Sprite Fragment Shader"
-        );
-
-        AssertWithMessage(
-            r2dData.spriteBatch.shader.Link(),
-            "Failed to link Sprite Shader"
+            r2dData.spriteBatch.shader.LoadFromFiles(r2dSpriteVertShaderPath, r2dSpriteFragShaderPath),
+            "Failed to load Sprite Shader"
         );
 
         r2dData.spriteBatch.elemVerticesBuffer = (SpriteVertex*) r2dData.batchSharedBuffer;
@@ -102,18 +94,8 @@ static void InitBatches()
 
         // Compile Shaders
         AssertWithMessage(
-            r2dData.circleBatch.shader.CompileFromFile(r2dCircleVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile Sprite Vertex Shader"
-        );
-
-        AssertWithMessage(
-            r2dData.circleBatch.shader.CompileFromFile(r2dCircleFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile Sprite Fragment Shader"
-        );
-
-        AssertWithMessage(
-            r2dData.circleBatch.shader.Link(),
-            "Failed to link Sprite Shader"
+            r2dData.circleBatch.shader.LoadFromFiles(r2dCircleVertShaderPath, r2dCircleFragShaderPath),
+            "Failed to load Sprite Shader"
         );
 
         r2dData.circleBatch.elemVerticesBuffer = (CircleVertex*) (r2dData.spriteBatch.elemVerticesBuffer + spriteBatchSize);
@@ -123,6 +105,9 @@ static void InitBatches()
 
 void Init()
 {
+    r2dData.viewProjectionUniform = GetUniformId("u_viewProjection");
+    r2dData.texturesUniform = GetUniformId("u_textures");
+
     // Setup OpenGL Buffers and Arrays
 
     constexpr u32 maxBufferSize = Max(sizeof(SpriteVertex) * maxSpriteCount, sizeof(CircleVertex) * maxCircleCount) * 4;
@@ -219,13 +204,13 @@ void FlushBatch(BatchType& batch)
     shader.Bind();
 
     // Set View Projection for the batch
-    shader.SetUniformMatrix4("u_viewProjection", r2dData.currentCamera->viewProjection());    
+    shader.SetUniformMatrix4(r2dData.viewProjectionUniform, r2dData.currentCamera->viewProjection());    
 
     // Set all textures for the batch
     for (int i = 0; i < batch.nextActiveTexSlot; i++)
         batch.textures[i].Bind(i);
 
-    shader.SetUniform1iv("u_textures", batch.nextActiveTexSlot, activeSlots);    
+    shader.SetUniform1iv(r2dData.texturesUniform, batch.nextActiveTexSlot, activeSlots);    
 
     glBindVertexArray(batch.vao);
 
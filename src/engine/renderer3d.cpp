@@ -14,10 +14,17 @@ namespace R3D
 struct
 {
     Camera* renderCamera = nullptr;
+
+    UniformId viewProjectionUniform, transformUniform;
+    UniformId skyboxUniform, skyboxMatrixUniform;
 } r3dData;
 
 void Init()
 {
+    r3dData.viewProjectionUniform = GetUniformId("u_viewProjection");
+    r3dData.transformUniform = GetUniformId("u_transform");
+    r3dData.skyboxUniform = GetUniformId("u_skybox");
+    r3dData.skyboxMatrixUniform = GetUniformId("u_matrix");
 }
 
 void Shutdown()
@@ -41,8 +48,8 @@ void RenderMesh(const Mesh& mesh, Transform& transform)
     mesh.shader->Bind();
     for (auto& submesh : mesh.submeshes)
     {
-        mesh.shader->SetUniformMatrix4("u_viewProjection", r3dData.renderCamera->viewProjection());
-        mesh.shader->SetUniformMatrix4("u_transform", transform.worldMatrix() * submesh.transform.worldMatrix());
+        mesh.shader->SetUniformMatrix4(r3dData.viewProjectionUniform, r3dData.renderCamera->viewProjection());
+        mesh.shader->SetUniformMatrix4(r3dData.transformUniform, transform.worldMatrix() * submesh.transform.worldMatrix());
 
         glBindVertexArray(submesh.vao);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, submesh.ibo);
@@ -60,7 +67,7 @@ void RenderSkybox(const Skybox& skybox)
     shader.Bind();
 
     skybox.cubemap.Bind(0);
-    shader.SetUniform1i("u_skybox", 0);
+    shader.SetUniform1i(r3dData.skyboxUniform, 0);
 
     {
         Matrix4 viewWithoutTranslation = r3dData.renderCamera->view();
@@ -73,7 +80,7 @@ void RenderSkybox(const Skybox& skybox)
         viewWithoutTranslation.data[2][3] = 0.0f;
         viewWithoutTranslation.data[3][3] = 1.0f;
 
-        shader.SetUniformMatrix4("u_matrix", r3dData.renderCamera->projection() * viewWithoutTranslation);
+        shader.SetUniformMatrix4(r3dData.skyboxMatrixUniform, r3dData.renderCamera->projection() * viewWithoutTranslation);
     }
 
     glBindVertexArray(Skybox::vao());
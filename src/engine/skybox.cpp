@@ -70,18 +70,8 @@ void Skybox::Init()
 
     {   // Compile Shader
         AssertWithMessage(
-            skyboxData.shader.CompileFromFile(skyboxVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile Skybox Vertex Shader"
-        );
-
-        AssertWithMessage(
-            skyboxData.shader.CompileFromFile(skyboxFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile Skybox Fragment Shader"
-        );
-
-        AssertWithMessage(
-            skyboxData.shader.Link(),
-            "Failed to link Skybox Shader"
+            skyboxData.shader.LoadFromFiles(skyboxVertShaderPath, skyboxFragShaderPath),
+            "Failed to load Skybox Shader"
         );
     }
 }
@@ -14,10 +14,15 @@ void LoadFileToString(const StringView& filepath, String& output)
     int length = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    output.Resize(length + 1, true);
-    fread(output.cstr(), sizeof(char), length, file);
+    char* buffer = (char*) PlatformAllocate(length + 1);
+    fread(buffer, sizeof(char), length, file);
+    buffer[length] = '\0';
 
     fclose(file);
+
+    // Assigning a C string sets the length, Resize would only make room for the characters
+    output = buffer;
+    PlatformFree(buffer);
 }
 
 void LoadFileToBytes(const StringView& filepath, DynamicArray<u8>& output)
@@ -33,4 +38,16 @@ void LoadFileToBytes(const StringView& filepath, DynamicArray<u8>& output)
     fread(output.data(), sizeof(u8), length, file);
 
     fclose(file);
+}
+
+bool SaveBytesToFile(const StringView& filepath, const void* data, u64 size)
+{
+    FILE* file = fopen(filepath.cstr(), "wb");
+    if (file == nullptr)
+        return false;
+
+    const u64 written = fwrite(data, sizeof(u8), size, file);
+    fclose(file);
+
+    return written == size;
 }
\ No newline at end of file
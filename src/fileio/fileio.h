@@ -6,4 +6,5 @@
 #include "containers/darray.h"
 
 void LoadFileToString(const StringView& filepath, String& output);
-void LoadFileToBytes(const StringView& filepath, DynamicArray<u8>& output);
\ No newline at end of file
+void LoadFileToBytes(const StringView& filepath, DynamicArray<u8>& output);
+bool SaveBytesToFile(const StringView& filepath, const void* data, u64 size);
\ No newline at end of file
@@ -1,5 +1,25 @@
 #include "chunk_area.h"
 #include "chunk_renderer.h"
+#include "platform/platform.h"
+#include "pathfinding.h"
+#include "voxel_ticks.h"
+
+// Chunks that need to be remeshed after placing a block
+static DynamicArray<Vector3Int> changedChunks;
+
+// Chunks whose light changed after setting a block
+static DynamicArray<Vector3Int> lightChangedChunks;
+
+void AddIfNotPresent(DynamicArray<Vector3Int>& array, const Vector3Int& coord)
+{
+    for (u64 i = 0; i < array.size(); i++)
+    {
+        if (array[i] == coord)
+            return;
+    }
+
+    array.PushBack(coord);
+}
 
 void CorrectBlockIndex(Vector3Int& chunkIndex, Vector3Int& blockIndex)
 {
@@ -9,7 +29,7 @@ void CorrectBlockIndex(Vector3Int& chunkIndex, Vector3Int& blockIndex)
         chunkIndex.x--;
     }
 
-    if (blockIndex.x > CHUNK_SIZE - 1)
+    if (blockIndex.x > (s32) CHUNK_SIZE - 1)
     {
         blockIndex.x = 0;
         chunkIndex.x++;
@@ -21,7 +41,7 @@ void CorrectBlockIndex(Vector3Int& chunkIndex, Vector3Int& blockIndex)
         chunkIndex.y--;
     }
 
-    if (blockIndex.y > CHUNK_SIZE - 1)
+    if (blockIndex.y > (s32) CHUNK_SIZE - 1)
     {
         blockIndex.y = 0;
         chunkIndex.y++;
@@ -33,35 +53,91 @@ void CorrectBlockIndex(Vector3Int& chunkIndex, Vector3Int& blockIndex)
         chunkIndex.z--;
     }
 
-    if (blockIndex.z > CHUNK_SIZE - 1)
+    if (blockIndex.z > (s32) CHUNK_SIZE - 1)
     {
         blockIndex.z = 0;
         chunkIndex.z++;
     }
 };
 
-void PlaceBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType)
+BlockType GetBlockAtPosition(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
 {
-    u32 index = area.chunkIndices.at(chunkIndex.x, chunkIndex.y, chunkIndex.z);
+    const u32 index = area.chunkMap.Find(chunkIndex);
+    if (!IsValidChunkSlot(index))
+        return BlockType::NONE;
+
+    const VoxelChunk& chunk = area.chunks[index];
+    const u32 lod = GetChunkLOD(chunk);
+    return chunk.at(blockIndex.x >> lod, blockIndex.y >> lod, blockIndex.z >> lod);
+}
+
+bool SetBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType, DynamicArray<Vector3Int>& changedChunks)
+{
+    u32 index = area.chunkMap.Find(chunkIndex);
+
+    // Can't place blocks in chunks that aren't loaded
+    if (index == NO_CHUNK_SLOT)
+        return false;
+
+    // Chunks at lower levels of detail are regenerated when they change rings so they can't be edited
+    if (area.loadShape.LODAt(area.centerChunk, chunkIndex) != 0)
+        return false;
+
+    if (index == AIR_CHUNK_SLOT)
+    {
+        if (blockType == BlockType::NONE)
+            return false;
+
+        // Chunk was only air so it needs storage now
+        index = area.AcquireAirChunk(chunkIndex);
+    }
+
     area.chunks[index].at(blockIndex.x, blockIndex.y, blockIndex.z) = blockType;
-    area.UpdateChunkMesh(chunkIndex.x, chunkIndex.y, chunkIndex.z);
+
+    // Water placed by the player is a source, anything else pushes the water out
+    area.fluids[index].at(blockIndex.x, blockIndex.y, blockIndex.z) = (blockType == BlockType::WATER) ? FLUID_SOURCE_LEVEL : 0;
+    ActivateFluidAroundBlock(area, chunkIndex, blockIndex);
+
+    ScheduleTicksAroundBlock(area, chunkIndex, blockIndex);
+    InvalidatePathsAroundBlock(chunkIndex, blockIndex);
+
+    lightChangedChunks.Clear(false);
+    UpdateLightAfterBlockChange(area, chunkIndex, blockIndex, lightChangedChunks);
+
+    // Chunks whose light changed have to be remeshed as well
+    for (u64 i = 0; i < lightChangedChunks.size(); i++)
+        AddIfNotPresent(changedChunks, lightChangedChunks[i]);
 
     {   // Update neighbouring chunk meshs if block is at any edge
 
+        AddIfNotPresent(changedChunks, chunkIndex);
+
         if (blockIndex.x == 0)
-            area.UpdateChunkMesh(chunkIndex.x - 1, chunkIndex.y, chunkIndex.z);
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { -1, 0, 0 });
         if (blockIndex.x == CHUNK_SIZE - 1)
-            area.UpdateChunkMesh(chunkIndex.x + 1, chunkIndex.y, chunkIndex.z);
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { 1, 0, 0 });
 
         if (blockIndex.y == 0)
-            area.UpdateChunkMesh(chunkIndex.x, chunkIndex.y - 1, chunkIndex.z);
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { 0, -1, 0 });
         if (blockIndex.y == CHUNK_SIZE - 1)
-            area.UpdateChunkMesh(chunkIndex.x, chunkIndex.y + 1, chunkIndex.z);
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { 0, 1, 0 });
 
         if (blockIndex.z == 0)
-            area.UpdateChunkMesh(chunkIndex.x, chunkIndex.y, chunkIndex.z - 1);
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { 0, 0, -1 });
         if (blockIndex.z == CHUNK_SIZE - 1)
-            area.UpdateChunkMesh(chunkIndex.x, chunkIndex.y, chunkIndex.z + 1);
-            
+            AddIfNotPresent(changedChunks, chunkIndex + Vector3Int { 0, 0, 1 });
     }
+
+    return true;
+}
+
+void PlaceBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType)
+{
+    changedChunks.Clear(false);
+
+    if (!SetBlockAtPosition(area, chunkIndex, blockIndex, blockType, changedChunks))
+        return;
+
+    for (u64 i = 0; i < changedChunks.size(); i++)
+        area.UpdateChunkMesh(changedChunks[i]);
 };
\ No newline at end of file
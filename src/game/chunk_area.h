@@ -1,25 +1,109 @@
 #pragma once
 
 #include "core/types.h"
+#include "core/utils.h"
 #include "containers/array_3d.h"
 #include "containers/darray.h"
-#include "math/vecs/vector3.h"
+#include "math/math.h"
 #include "aabb.h"
+#include "chunk_map.h"
 #include "voxel.h"
-
-#include <SimplexNoise.h>
+#include "voxel_fluid.h"
+#include "voxel_light.h"
 
 constexpr u32 CHUNK_SIZE = 32;
 
 struct VoxelVertex;
+struct WorldGenerator;
 
 using VoxelChunk = Array3D<BlockType>;
 
+// Number of voxels along each axis of a chunk at a level of detail
+inline u32 ChunkLODDimension(u32 lod)
+{
+    return CHUNK_SIZE >> lod;
+}
+
+// Chunks at lower levels of detail store fewer, bigger voxels
+inline u32 GetChunkLOD(const VoxelChunk& chunk)
+{
+    return LowestSetBitIndex(CHUNK_SIZE / chunk.dimension());
+}
+
+// Chunk coordinate of the chunk containing position
+inline Vector3Int PositionToChunkCoord(const Vector3& position)
+{
+    return Vector3Int {
+        (s32) Math::Floor(position.x / CHUNK_SIZE),
+        (s32) Math::Floor(position.y / CHUNK_SIZE),
+        (s32) Math::Floor(position.z / CHUNK_SIZE)
+    };
+}
+
+// World position of the minimum corner of a chunk
+inline Vector3 ChunkCoordToPosition(const Vector3Int& coord)
+{
+    return Vector3((f32) coord.x * CHUNK_SIZE, (f32) coord.y * CHUNK_SIZE, (f32) coord.z * CHUNK_SIZE);
+}
+
+// Chunk and its 26 neighbours, used to look up blocks across chunk borders while meshing
+struct ChunkNeighbourhood
+{
+    const VoxelChunk* chunks[27];               // nullptr if the chunk is only air or not loaded
+    const VoxelLightChunk* lights[27];          // nullptr if the chunk doesn't store light
+    bool loaded[27];
+    u8 lods[27];                                // Level of detail of each chunk (0 if there's no chunk)
+
+    static inline u32 Index(s32 dx, s32 dy, s32 dz)
+    {
+        return (dx + 1) + 3 * (dy + 1) + 9 * (dz + 1);
+    }
+
+    inline bool IsLoaded(s32 dx, s32 dy, s32 dz) const
+    {
+        return loaded[Index(dx, dy, dz)];
+    }
+
+    // Block position is relative to the center chunk and can be at most 1 chunk outside it.
+    // The position is in full resolution blocks even if the chunks are at a lower level of detail.
+    inline BlockType BlockAt(s32 x, s32 y, s32 z) const
+    {
+        const s32 dx = (x < 0) ? -1 : ((x >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dy = (y < 0) ? -1 : ((y >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dz = (z < 0) ? -1 : ((z >= (s32) CHUNK_SIZE) ? 1 : 0);
+
+        const u32 index = Index(dx, dy, dz);
+        const VoxelChunk* chunk = chunks[index];
+        if (!chunk)
+            return BlockType::NONE;
+
+        const u32 lod = lods[index];
+        return chunk->at((x - dx * (s32) CHUNK_SIZE) >> lod, (y - dy * (s32) CHUNK_SIZE) >> lod, (z - dz * (s32) CHUNK_SIZE) >> lod);
+    }
+
+    // Same as BlockAt but for light, chunks that don't store light are in full sunlight
+    inline u8 LightAt(s32 x, s32 y, s32 z) const
+    {
+        const s32 dx = (x < 0) ? -1 : ((x >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dy = (y < 0) ? -1 : ((y >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dz = (z < 0) ? -1 : ((z >= (s32) CHUNK_SIZE) ? 1 : 0);
+
+        const VoxelLightChunk* light = lights[Index(dx, dy, dz)];
+        if (!light)
+            return FULL_SUNLIGHT;
+
+        return light->at(x - dx * (s32) CHUNK_SIZE, y - dy * (s32) CHUNK_SIZE, z - dz * (s32) CHUNK_SIZE);
+    }
+};
+
 struct VoxelChunkArea
 {
-    DynamicArray<VoxelChunk> chunks;            // Data of the chunks in no particular order
+    DynamicArray<VoxelChunk> chunks;            // Data of the chunks in no particular order (indexed by slot)
+    DynamicArray<VoxelLightChunk> lights;       // Light levels of the chunks (indexed by slot)
+    DynamicArray<VoxelFluidChunk> fluids;       // Flow levels of the water in the chunks (indexed by slot)
+    Vector3Int* chunkCoords;                    // Chunk coordinate of the chunk stored in each slot
     AABB* chunkBounds;                          // AABBs for each chunk (used for frustum culling)
-    bool* isOnlyAir;                            // If the chunk is only air
+    bool* isOnlyAir;                            // If the chunk is only air (or the slot is free)
 
     u32* opaqueFaceCounts;                      // Number of faces in each chunk's opaque mesh
     VoxelVertex** opaqueMeshData;               // Buffer containing opaque mesh data for a chunk
@@ -27,25 +111,49 @@ struct VoxelChunkArea
     u32* transparentFaceCounts;                 // Number of faces in each chunk's transparent mesh
     VoxelVertex** transparentMeshData;          // Buffer containing transparent mesh data for a chunk
 
-    Array3D<u32> chunkIndices;                  // Index pointing to respective chunk data
-    Array3D<u32> tempIndices;                   // Temporary Indices used for updating indices
+    DynamicArray<u32> freeSlots;                // Slots that were allocated but don't hold a chunk anymore
+    u32 maxChunkSlots;                          // Max number of slots needed for the load shape
 
-    Vector3 areaPosition;                       // Position of center chunk in area
-    f32 areaRadius;                             // Manhattan radius of area around player
+    ChunkMap chunkMap;                          // Chunk coordinate -> slot of every loaded chunk
+    ChunkLoadShape loadShape;                   // Which chunks around the player are loaded
+    Vector3Int centerChunk;                     // Chunk coordinate of the chunk the player is in
 
     u32 newUpdatesLeft;                         // Number of new chunk mesh updates left
     u32 surrUpdatesLeft;                        // Number of surrounding chunk mesh updates left
 
-    // Allocates the amount of data required for visible chunks
-    void Create(f32 radius);
+    // Allocates the bookkeeping for the chunks in the load shape.
+    // Chunk data and mesh buffers are only allocated once a slot is needed.
+    void Create(const ChunkLoadShape& shape);
     void Free();
 
-    void UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ);
+    // Returns a slot to store the chunk at coord in at a level of detail. Doesn't add it to the chunk map.
+    u32  AcquireSlot(const Vector3Int& coord, u32 lod);
+    void ReleaseSlot(u32 slot);
 
-    void InitializeChunkArea(const SimplexNoise& noise, const Vector3& position);
-    void UpdateChunkArea(const SimplexNoise& noise, const Vector3& position);
+    // Gives a chunk that's only air a slot so its blocks or light can be changed and adds it to the chunk map.
+    // Returns NO_CHUNK_SLOT if the chunk isn't at full resolution.
+    u32  AcquireAirChunk(const Vector3Int& coord);
+
+    void GetNeighbourhood(const Vector3Int& coord, ChunkNeighbourhood& neighbours) const;
+
+    void UpdateChunkMesh(const Vector3Int& coord);
+    void UpdateChunkMeshLOD(const Vector3Int& coord, u32 chunkIndex, const ChunkNeighbourhood& neighbours);
+
+    void InitializeChunkArea(WorldGenerator& generator, const Vector3& position);
+    void UpdateChunkArea(WorldGenerator& generator, const Vector3& position);
 };
 
 void CorrectBlockIndex(Vector3Int& chunkIndex, Vector3Int& blockIndex);
 
-void PlaceBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType);
\ No newline at end of file
+// Returns BlockType::NONE if the chunk isn't loaded
+BlockType GetBlockAtPosition(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex);
+
+// Changes a block and updates the light, water and block ticks around it but doesn't remesh anything.
+// Chunks whose meshes have to be rebuilt are added to changedChunks. Returns false if the block can't be changed.
+bool SetBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType, DynamicArray<Vector3Int>& changedChunks);
+
+// Sets the block and remeshes the chunks that changed right away
+void PlaceBlockAtPosition(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType blockType);
+
+// Adds the chunk coordinate to the array if it isn't in it yet
+void AddIfNotPresent(DynamicArray<Vector3Int>& array, const Vector3Int& coord);
\ No newline at end of file
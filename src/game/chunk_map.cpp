@@ -0,0 +1,81 @@
+#include "chunk_map.h"
+
+#include "math/math.h"
+
+bool ChunkLoadShape::Contains(const Vector3Int& center, const Vector3Int& coord) const
+{
+    const s32 dx = coord.x - center.x;
+    const s32 dz = coord.z - center.z;
+    s32 dy = coord.y - center.y;
+
+    if (useBand)
+    {
+        if (coord.y < bandMinY || coord.y > bandMaxY)
+            return false;
+
+        dy = 0;
+    }
+    else if (Abs(dy) > verticalRadius)
+        return false;
+
+    switch (type)
+    {
+        case Type::CUBE:
+            return Abs(dx) <= radius && Abs(dz) <= radius;
+
+        case Type::CYLINDER:
+            return dx * dx + dz * dz <= radius * radius;
+
+        case Type::SPHERE:
+        {
+            // Squash the vertical axis so the sphere can be flatter than it is wide
+            const s32 scaledDy = (verticalRadius > 0) ? (dy * radius) / verticalRadius : 0;
+            return dx * dx + scaledDy * scaledDy + dz * dz <= radius * radius;
+        }
+    }
+
+    return false;
+}
+
+bool ChunkLoadShape::ContainsColumn(const Vector3Int& center, s32 x, s32 z) const
+{
+    // Shapes are widest at the player's height, bands are the same at every height
+    const s32 y = useBand ? bandMinY : center.y;
+    return Contains(center, Vector3Int { x, y, z });
+}
+
+u32 ChunkLoadShape::LODAt(const Vector3Int& center, const Vector3Int& coord) const
+{
+    s32 ringDistance = Max(Abs(coord.x - center.x), Abs(coord.z - center.z));
+    if (!useBand)
+        ringDistance = Max(ringDistance, Abs(coord.y - center.y));
+
+    u32 lod = 0;
+    while (lod < MAX_CHUNK_LOD && ringDistance >= lodDistances[lod])
+        lod++;
+
+    return lod;
+}
+
+s32 ChunkLoadShape::MinY(const Vector3Int& center) const
+{
+    return useBand ? bandMinY : center.y - verticalRadius;
+}
+
+s32 ChunkLoadShape::MaxY(const Vector3Int& center) const
+{
+    return useBand ? bandMaxY : center.y + verticalRadius;
+}
+
+u32 ChunkLoadShape::MaxChunkCount() const
+{
+    const Vector3Int center = { 0, 0, 0 };
+
+    u32 count = 0;
+    for (s32 z = -radius; z <= radius; z++)
+    for (s32 y = MinY(center); y <= MaxY(center); y++)
+    for (s32 x = -radius; x <= radius; x++)
+        count += Contains(center, Vector3Int { x, y, z });
+
+    return count;
+}
\ No newline at end of file
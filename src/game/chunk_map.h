@@ -0,0 +1,119 @@
+#pragma once
+
+/*
+
+Sparse map of the chunks that are loaded in the world.
+
+Chunks are keyed by their chunk coordinate (world position / CHUNK_SIZE)
+packed into a 64 bit integer with 21 bits per axis. Only loaded chunks get
+an entry and chunks that are only air don't get any storage at all, they
+are marked with AIR_CHUNK_SLOT instead of pointing to a slot.
+
+Which chunks get loaded around the player is decided by a ChunkLoadShape.
+Using a cylinder with a flat vertical band means the horizontal view
+distance can be pushed out without loading the sky above the terrain.
+The load shape also decides the level of detail of each chunk based on
+its ring distance (the Chebyshev distance) from the player's chunk.
+
+*/
+
+#include "core/types.h"
+#include "containers/hashtable.h"
+#include "voxel.h"
+
+using ChunkKey = u64;
+
+constexpr u32 AIR_CHUNK_SLOT = 0xFFFFFFFF;      // Chunk is loaded but only has air, so it has no storage
+constexpr u32 NO_CHUNK_SLOT  = 0xFFFFFFFE;      // Chunk is not loaded
+
+constexpr u32 MAX_CHUNK_LOD = 3;                 // Level of detail i merges 2^i x 2^i x 2^i voxels into one
+
+constexpr u32 CHUNK_KEY_AXIS_BITS = 21;
+constexpr u64 CHUNK_KEY_AXIS_MASK = (1ull << CHUNK_KEY_AXIS_BITS) - 1;
+
+inline bool IsValidChunkSlot(u32 slot)
+{
+    return slot < NO_CHUNK_SLOT;
+}
+
+inline ChunkKey PackChunkCoord(const Vector3Int& coord)
+{
+    return  ((u64) coord.x & CHUNK_KEY_AXIS_MASK) |
+           (((u64) coord.y & CHUNK_KEY_AXIS_MASK) << CHUNK_KEY_AXIS_BITS) |
+           (((u64) coord.z & CHUNK_KEY_AXIS_MASK) << (2 * CHUNK_KEY_AXIS_BITS));
+}
+
+inline Vector3Int UnpackChunkCoord(ChunkKey key)
+{
+    // Shift each axis to the top of an s64 and back down to sign extend it
+    constexpr u32 shift = 64 - CHUNK_KEY_AXIS_BITS;
+
+    return Vector3Int {
+        (s32) ((s64) (key << shift) >> shift),
+        (s32) ((s64) ((key >> CHUNK_KEY_AXIS_BITS) << shift) >> shift),
+        (s32) ((s64) ((key >> (2 * CHUNK_KEY_AXIS_BITS)) << shift) >> shift)
+    };
+}
+
+struct ChunkLoadShape
+{
+    enum struct Type : u8
+    {
+        CUBE,
+        CYLINDER,
+        SPHERE,
+    };
+
+    Type type = Type::CUBE;
+    s32 radius = 4;                 // Horizontal radius in chunks
+    s32 verticalRadius = 4;         // Vertical radius in chunks, not used with a band
+
+    // Only load chunks with y coordinates in [bandMinY, bandMaxY] regardless of the player's height.
+    // A sphere with a band acts like a cylinder.
+    bool useBand = false;
+    s32 bandMinY = 0;
+    s32 bandMaxY = 0;
+
+    // Ring distance at which each level of detail starts, lodDistances[i] is where level i + 1 starts.
+    // Levels that start further than the radius are never used.
+    s32 lodDistances[MAX_CHUNK_LOD] = { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF };
+
+    bool Contains(const Vector3Int& center, const Vector3Int& coord) const;
+
+    // If any chunk in the column at chunk coordinates (x, z) can be loaded
+    bool ContainsColumn(const Vector3Int& center, s32 x, s32 z) const;
+
+    // Level of detail the chunk at coord should be loaded at
+    u32 LODAt(const Vector3Int& center, const Vector3Int& coord) const;
+
+    // Range of chunk y coordinates that can be loaded around center
+    s32 MinY(const Vector3Int& center) const;
+    s32 MaxY(const Vector3Int& center) const;
+
+    // Max number of chunks that can be loaded at the same time
+    u32 MaxChunkCount() const;
+};
+
+struct ChunkMap
+{
+    HashTable<ChunkKey, u32> slots;
+
+    // Returns NO_CHUNK_SLOT if the chunk isn't loaded
+    inline u32 Find(const Vector3Int& coord) const
+    {
+        auto it = slots.Find(PackChunkCoord(coord));
+        return it ? it.value() : NO_CHUNK_SLOT;
+    }
+
+    inline void Place(const Vector3Int& coord, u32 slot)
+    {
+        slots[PackChunkCoord(coord)] = slot;
+    }
+
+    inline void Remove(const Vector3Int& coord)
+    {
+        slots.Remove(PackChunkCoord(coord));
+    }
+
+    inline u64 size() const { return slots.size(); }
+};
\ No newline at end of file
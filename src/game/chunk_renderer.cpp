@@ -10,20 +10,17 @@
 #include "platform/platform.h"
 #include "aabb.h"
 #include "chunk_area.h"
+#include "pathfinding.h"
 #include "voxel.h"
 #include "voxel_ao.h"
+#include "voxel_fluid.h"
+#include "voxel_light.h"
 #include "voxel_renderdata.h"
+#include "voxel_ticks.h"
+#include "world_gen.h"
 
 #include <glad/glad.h>
 
-struct VoxelVertex
-{
-    Vector3 position;
-    Vector3 normal;
-    Vector2 texCoord;
-    float occlusion;
-};
-
 using VoxelFace = VoxelVertex[4];
 
 template<>
@@ -44,16 +41,24 @@ struct TransparentBlock
 struct ChunkUpdateData
 {
     u32 index;
-    u32 x, y, z;
+    Vector3Int coord;
 
     bool operator==(const ChunkUpdateData& other)
     {
-        return x == other.x &&
-               y == other.y &&
-               z == other.z;
+        return coord == other.coord;
     }
 };
 
+struct ChunkLoadRequest
+{
+    Vector3Int coord;
+    u32 lod;
+    u32 slot;                   // Set once it's loaded
+
+    u32 replacedSlot;           // Slot of the chunk that was at coord before, NO_CHUNK_SLOT if there was none
+    bool replacedGaveLight;
+};
+
 constexpr u32 maxVoxelFaceCount = 1 * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
 constexpr u32 maxVerticesInBatch = 4 * maxVoxelFaceCount;
 constexpr u64 maxChunkBatchSize = maxVerticesInBatch * sizeof(VoxelVertex);
@@ -72,8 +77,16 @@ struct
 
     Camera* camera = nullptr;
 
+    UniformId viewProjectionUniform, textureUniform, cameraPositionUniform, colorUniform;
+
     DynamicArray<ChunkUpdateData> surroundingChunkUpdateList;
     DynamicArray<ChunkUpdateData> newChunkUpdateList;
+    DynamicArray<ChunkKey> unloadChunkList;
+    DynamicArray<Vector3Int> lightChunkList;
+    DynamicArray<Vector3Int> unlitChunkList;
+    DynamicArray<Vector3Int> changedLightList;
+    DynamicArray<ChunkLoadRequest> loadRequestList;
+    DynamicArray<WorldGenChunk> worldGenChunkList;
 
     s32 aoXOffsets[((6 << 4) | 8)][3];
     s32 aoYOffsets[((6 << 4) | 8)][3];
@@ -103,45 +116,44 @@ constexpr u32 WORLD_MAX_CHUNKS_Z = 5;
 
 */
 
-void VoxelChunkArea::Create(f32 radius)
+void VoxelChunkArea::Create(const ChunkLoadShape& shape)
 {
-    const u32 maxChunksAxis = 2 * Math::Ceil(radius / CHUNK_SIZE); 
-    const u32 maxChunks = maxChunksAxis * maxChunksAxis * maxChunksAxis;
+    // Ray casts and block placement only look at the chunks right around the player
+    AssertWithMessage(shape.lodDistances[0] >= 2, "Chunks next to the player must be at full resolution!");
 
-    chunks.Resize(maxChunks);
-    chunkBounds = (AABB*) PlatformAllocate(maxChunks * sizeof(AABB));
-    isOnlyAir = (bool*) PlatformAllocate(maxChunks * sizeof(bool));
+    loadShape = shape;
+    maxChunkSlots = shape.MaxChunkCount();
 
-    opaqueFaceCounts = (u32*) PlatformAllocate(maxChunks * sizeof(u32));
-    opaqueMeshData      = (VoxelVertex**) PlatformAllocate(maxChunks * sizeof(VoxelVertex*));
+    chunks.Reserve(maxChunkSlots);
+    lights.Reserve(maxChunkSlots);
+    fluids.Reserve(maxChunkSlots);
+    chunkCoords = (Vector3Int*) PlatformAllocate(maxChunkSlots * sizeof(Vector3Int));
+    chunkBounds = (AABB*) PlatformAllocate(maxChunkSlots * sizeof(AABB));
+    isOnlyAir = (bool*) PlatformAllocate(maxChunkSlots * sizeof(bool));
 
-    transparentFaceCounts = (u32*) PlatformAllocate(maxChunks * sizeof(u32));
-    transparentMeshData = (VoxelVertex**) PlatformAllocate(maxChunks * sizeof(VoxelVertex*));
+    opaqueFaceCounts = (u32*) PlatformAllocate(maxChunkSlots * sizeof(u32));
+    opaqueMeshData      = (VoxelVertex**) PlatformAllocate(maxChunkSlots * sizeof(VoxelVertex*));
 
-    chunkIndices.Allocate(maxChunksAxis);
-    tempIndices.Allocate(maxChunksAxis);
+    transparentFaceCounts = (u32*) PlatformAllocate(maxChunkSlots * sizeof(u32));
+    transparentMeshData = (VoxelVertex**) PlatformAllocate(maxChunkSlots * sizeof(VoxelVertex*));
 
-    // A max of 3 faces of the area will be updated
-    u32 neededCapacity = maxChunksAxis * maxChunksAxis * 3;
-    if (crData.newChunkUpdateList.capacity() < neededCapacity)
-    {
-        crData.newChunkUpdateList.Reserve(neededCapacity);
-        crData.surroundingChunkUpdateList.Reserve(neededCapacity);
-    }
-
-    // Allocate chunk data
-    for (u32 i = 0; i < maxChunksAxis * maxChunksAxis * maxChunksAxis; i++)
-    {
-        chunks[i].Allocate(CHUNK_SIZE);
+    freeSlots.Reserve(maxChunkSlots);
+    chunkMap.slots.Rehash(maxChunkSlots);
 
-        opaqueFaceCounts[i] = 0;
-        opaqueMeshData[i]      = (VoxelVertex*) PlatformAllocate(4 * maxVoxelFaceCount * sizeof(VoxelVertex));
+    // Ambient occlusion and smooth light offsets, filled here since meshing doesn't need OpenGL
+    FillOcclusionOffsetTables(crData.aoXOffsets, crData.aoYOffsets, crData.aoZOffsets);
 
-        transparentFaceCounts[i] = 0;
-        transparentMeshData[i] = (VoxelVertex*) PlatformAllocate(4 * maxVoxelFaceCount * sizeof(VoxelVertex));
+    // Worst case every chunk in the load shape changes
+    if (crData.newChunkUpdateList.capacity() < maxChunkSlots)
+    {
+        crData.newChunkUpdateList.Reserve(maxChunkSlots);
+        crData.surroundingChunkUpdateList.Reserve(maxChunkSlots);
+        crData.unloadChunkList.Reserve(maxChunkSlots);
+        crData.lightChunkList.Reserve(maxChunkSlots);
+        crData.unlitChunkList.Reserve(maxChunkSlots);
+        crData.loadRequestList.Reserve(maxChunkSlots);
+        crData.worldGenChunkList.Reserve(maxChunkSlots);
     }
-
-    areaRadius = radius;
 }
 
 void VoxelChunkArea::Free()
@@ -150,11 +162,16 @@ void VoxelChunkArea::Free()
     for (u32 i = 0; i < chunks.size(); i++)
     {
         chunks[i].Free();
+        lights[i].Free();
+        fluids[i].Free();
         PlatformFree(opaqueMeshData[i]);
         PlatformFree(transparentMeshData[i]);
     }
 
     chunks.Free();
+    lights.Free();
+    fluids.Free();
+    PlatformFree(chunkCoords);
     PlatformFree(chunkBounds);
     PlatformFree(isOnlyAir);
 
@@ -164,85 +181,123 @@ void VoxelChunkArea::Free()
     PlatformFree(transparentFaceCounts);
     PlatformFree(transparentMeshData);
 
-    chunkIndices.Free();
-    tempIndices.Free();
+    freeSlots.Free();
+    chunkMap.slots.Clear();
+
+    FreeVoxelLightData();
+    FreeVoxelFluidData();
+    FreeBlockTickData();
+    FreePathfindingData();
 }
 
-inline BlockType GetBlockAt(const VoxelChunkArea& area,
-                            u32 chunkX, u32 chunkY, u32 chunkZ,
-                            s32 x, s32 y, s32 z)
+u32 VoxelChunkArea::AcquireSlot(const Vector3Int& coord, u32 lod)
 {
-    if (x < 0)
-    {
-        if (chunkX == 0)
-            return BlockType::NONE;
+    const u32 dimension = ChunkLODDimension(lod);
+    const u64 meshBufferSize = 4 * (u64) (dimension * dimension * dimension) * sizeof(VoxelVertex);
 
-        x = CHUNK_SIZE - 1;
-        chunkX--;
-    }
+    u32 slot;
 
-    if (x >= CHUNK_SIZE)
+    if (freeSlots.size() > 0)
     {
-        if (chunkX == area.chunkIndices.dimension() - 1)
-            return BlockType::NONE;
+        slot = freeSlots.PopBack();
 
-        x = 0;
-        chunkX++;
-    }
+        // Buffers are sized for the level of detail the slot was last used at
+        if (chunks[slot].dimension() != dimension)
+        {
+            chunks[slot].Free();
+            chunks[slot].Allocate(dimension);
 
-    if (y < 0)
-    {
-        if (chunkY == 0)
-            return BlockType::NONE;
+            lights[slot].Free();
+            lights[slot].Allocate(dimension);
 
-        y = CHUNK_SIZE - 1;
-        chunkY--;
-    }
+            fluids[slot].Free();
+            fluids[slot].Allocate(dimension);
 
-    if (y >= CHUNK_SIZE)
+            PlatformFree(opaqueMeshData[slot]);
+            PlatformFree(transparentMeshData[slot]);
+            opaqueMeshData[slot]      = (VoxelVertex*) PlatformAllocate(meshBufferSize);
+            transparentMeshData[slot] = (VoxelVertex*) PlatformAllocate(meshBufferSize);
+        }
+    }
+    else
     {
-        if (chunkY == area.chunkIndices.dimension() - 1)
-            return BlockType::NONE;
-
-        y = 0;
-        chunkY++;
+        AssertWithMessage(chunks.size() < maxChunkSlots, "Ran out of chunk slots!");
+
+        // Chunk data and mesh buffers are allocated the first time a slot is used
+        slot = chunks.size();
+        chunks.EmplaceBack().Allocate(dimension);
+        lights.EmplaceBack().Allocate(dimension);
+        fluids.EmplaceBack().Allocate(dimension);
+        opaqueMeshData[slot]      = (VoxelVertex*) PlatformAllocate(meshBufferSize);
+        transparentMeshData[slot] = (VoxelVertex*) PlatformAllocate(meshBufferSize);
     }
 
-    if (z < 0)
-    {
-        if (chunkZ == 0)
-            return BlockType::NONE;
+    AssertWithMessage(opaqueMeshData[slot] && transparentMeshData[slot], "Couldn't allocate chunk mesh buffers!");
 
-        z = CHUNK_SIZE - 1;
-        chunkZ--;
-    }
+    // Chunk stays dark till it's lit, old light in the slot would leak into the chunks next to it
+    PlatformZeroMemory(lights[slot].data(), lights[slot].totalSize());
+
+    // New chunks don't have any water in them
+    PlatformZeroMemory(fluids[slot].data(), fluids[slot].totalSize());
+
+    chunkCoords[slot] = coord;
+    isOnlyAir[slot] = true;
+    opaqueFaceCounts[slot] = 0;
+    transparentFaceCounts[slot] = 0;
+
+    return slot;
+}
+
+void VoxelChunkArea::ReleaseSlot(u32 slot)
+{
+    // Free slots are skipped while rendering since they're marked as only air
+    isOnlyAir[slot] = true;
+    opaqueFaceCounts[slot] = 0;
+    transparentFaceCounts[slot] = 0;
+
+    freeSlots.PushBack(slot);
+}
+
+u32 VoxelChunkArea::AcquireAirChunk(const Vector3Int& coord)
+{
+    if (loadShape.LODAt(centerChunk, coord) != 0)
+        return NO_CHUNK_SLOT;
+
+    const u32 slot = AcquireSlot(coord, 0);
+
+    VoxelChunk& chunk = chunks[slot];
+    PlatformSetMemory(chunk.data(), (s32) BlockType::NONE, chunk.totalSize() * sizeof(BlockType));
+    PlatformSetMemory(lights[slot].data(), FULL_SUNLIGHT, lights[slot].totalSize());
+
+    chunkMap.Place(coord, slot);
+    return slot;
+}
 
-    if (z >= CHUNK_SIZE)
+void VoxelChunkArea::GetNeighbourhood(const Vector3Int& coord, ChunkNeighbourhood& neighbours) const
+{
+    for (s32 dz = -1; dz <= 1; dz++)
+    for (s32 dy = -1; dy <= 1; dy++)
+    for (s32 dx = -1; dx <= 1; dx++)
     {
-        if (chunkZ == area.chunkIndices.dimension() - 1)
-            return BlockType::NONE;
+        const u32 index = ChunkNeighbourhood::Index(dx, dy, dz);
+        const u32 slot = chunkMap.Find(coord + Vector3Int { dx, dy, dz });
 
-        z = 0;
-        chunkZ++;
+        neighbours.loaded[index] = (slot != NO_CHUNK_SLOT);
+        neighbours.chunks[index] = IsValidChunkSlot(slot) ? &chunks[slot] : nullptr;
+        neighbours.lods[index]   = IsValidChunkSlot(slot) ? (u8) GetChunkLOD(chunks[slot]) : 0;
+        neighbours.lights[index] = (IsValidChunkSlot(slot) && neighbours.lods[index] == 0) ? &lights[slot] : nullptr;
     }
-
-    const u32 index = area.chunkIndices.at(chunkX, chunkY, chunkZ);
-    return area.chunks[index].at(x, y, z);
 }
 
-inline f32 GetOcclusion(const VoxelChunkArea& area, VoxelFaceDirection direction, u32 positionIndex,
-                        u32 chunkX, u32 chunkY, u32 chunkZ,
+inline f32 GetOcclusion(const ChunkNeighbourhood& neighbours, VoxelFaceDirection direction, u32 positionIndex,
                         u32 x, u32 y, u32 z)
 {
     // positionIndex -> [0, 7] and direction -> [0, 5]
     u32 offsetIndex = ((u32) direction << 4) | positionIndex;
 
-    u32 chunkIndex = area.chunkIndices.at(chunkX, chunkY, chunkZ);
-    const VoxelChunk& chunk = area.chunks[chunkIndex];
-
-    bool side1  = !VoxelBlockHasTransparency(GetBlockAt(area, chunkX, chunkY, chunkZ, (s32) x + crData.aoXOffsets[offsetIndex][0], (s32) y + crData.aoYOffsets[offsetIndex][0], (s32) z + crData.aoZOffsets[offsetIndex][0]));
-    bool side2  = !VoxelBlockHasTransparency(GetBlockAt(area, chunkX, chunkY, chunkZ, (s32) x + crData.aoXOffsets[offsetIndex][2], (s32) y + crData.aoYOffsets[offsetIndex][2], (s32) z + crData.aoZOffsets[offsetIndex][2]));
-    bool corner = !VoxelBlockHasTransparency(GetBlockAt(area, chunkX, chunkY, chunkZ, (s32) x + crData.aoXOffsets[offsetIndex][1], (s32) y + crData.aoYOffsets[offsetIndex][1], (s32) z + crData.aoZOffsets[offsetIndex][1]));
+    bool side1  = !VoxelBlockHasTransparency(neighbours.BlockAt((s32) x + crData.aoXOffsets[offsetIndex][0], (s32) y + crData.aoYOffsets[offsetIndex][0], (s32) z + crData.aoZOffsets[offsetIndex][0]));
+    bool side2  = !VoxelBlockHasTransparency(neighbours.BlockAt((s32) x + crData.aoXOffsets[offsetIndex][2], (s32) y + crData.aoYOffsets[offsetIndex][2], (s32) z + crData.aoZOffsets[offsetIndex][2]));
+    bool corner = !VoxelBlockHasTransparency(neighbours.BlockAt((s32) x + crData.aoXOffsets[offsetIndex][1], (s32) y + crData.aoYOffsets[offsetIndex][1], (s32) z + crData.aoZOffsets[offsetIndex][1]));
 
     if (side1 && side2)
         return 0;
@@ -250,6 +305,52 @@ inline f32 GetOcclusion(const VoxelChunkArea& area, VoxelFaceDirection direction
     return (3 - (side1 + side2 + corner)) / 3.0f;
 }
 
+// Smooth lighting, averages the light of the blocks in front of the face that touch the vertex
+inline Vector2 GetVertexLight(const ChunkNeighbourhood& neighbours, VoxelFaceDirection direction, u32 positionIndex,
+                              u32 x, u32 y, u32 z)
+{
+    // Indexed by VoxelFaceDirection
+    const s32 faceOffsets[6][3] = {
+        {  0,  0,  1 }, {  0,  1,  0 }, {  1,  0,  0 },
+        { -1,  0,  0 }, {  0, -1,  0 }, {  0,  0, -1 },
+    };
+
+    const u32 offsetIndex = ((u32) direction << 4) | positionIndex;
+
+    // In front of the face, side 1, side 2 and the corner
+    const s32 samples[4][3] = {
+        { (s32) x + faceOffsets[(u32) direction][0], (s32) y + faceOffsets[(u32) direction][1], (s32) z + faceOffsets[(u32) direction][2] },
+        { (s32) x + crData.aoXOffsets[offsetIndex][0], (s32) y + crData.aoYOffsets[offsetIndex][0], (s32) z + crData.aoZOffsets[offsetIndex][0] },
+        { (s32) x + crData.aoXOffsets[offsetIndex][2], (s32) y + crData.aoYOffsets[offsetIndex][2], (s32) z + crData.aoZOffsets[offsetIndex][2] },
+        { (s32) x + crData.aoXOffsets[offsetIndex][1], (s32) y + crData.aoYOffsets[offsetIndex][1], (s32) z + crData.aoZOffsets[offsetIndex][1] },
+    };
+
+    u32 sunLight = 0, blockLight = 0, count = 0;
+    bool sideIsOpaque[2] = {};
+
+    for (u32 i = 0; i < 4; i++)
+    {
+        const bool passesLight = VoxelBlockPassesLight(neighbours.BlockAt(samples[i][0], samples[i][1], samples[i][2]));
+        if (i == 1 || i == 2)
+            sideIsOpaque[i - 1] = !passesLight;
+
+        // Light can't reach the corner around two blocks
+        if (!passesLight || (i == 3 && sideIsOpaque[0] && sideIsOpaque[1]))
+            continue;
+
+        const u8 light = neighbours.LightAt(samples[i][0], samples[i][1], samples[i][2]);
+        sunLight += GetSunLight(light);
+        blockLight += GetBlockLight(light);
+        count++;
+    }
+
+    if (count == 0)
+        return Vector2(1.0f, 0.0f);
+
+    const f32 scale = 1.0f / (count * MAX_LIGHT_LEVEL);
+    return Vector2(sunLight * scale, blockLight * scale);
+}
+
 static inline bool AddFaceBasedOnAdjacentBlockType(BlockType myType, BlockType adjacentType)
 {
     // Generate face if adjacent block is transparent unless
@@ -260,16 +361,50 @@ static inline bool AddFaceBasedOnAdjacentBlockType(BlockType myType, BlockType a
     return (myTypeIsTransparent) ? (myType != adjacentType) : adjacentTypeIsTransparent;
 }
 
-void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
+// Increase size of transparent batch buffer if more transparent blocks have been added
+static void GrowTransparentBatch(const VoxelChunkArea& area)
+{
+    s64 totalTransparentFaces = 0;
+    for (int i = 0; i < area.chunks.size(); i++)
+        totalTransparentFaces += area.transparentFaceCounts[i];
+
+    if (totalTransparentFaces > crData.transparentBatchSize)
+    {
+        {
+            VoxelVertex* newBuffer = (VoxelVertex*) PlatformReallocate(crData.transparentBatchBuffer, totalTransparentFaces * sizeof(VoxelFace));
+            AssertWithMessage(newBuffer, "Could not reallocate buffer for transparent batch!");
+            crData.transparentBatchBuffer = newBuffer;
+        }
+
+        {
+            f32* newBuffer = (f32*) PlatformReallocate(crData.transparentFaceDistances, totalTransparentFaces * sizeof(f32));
+            AssertWithMessage(newBuffer, "Could not reallocate buffer for transparent face distance batch!");
+            crData.transparentFaceDistances = newBuffer;
+        }
+
+        crData.transparentBatchSize = totalTransparentFaces;
+    }
+}
+
+void VoxelChunkArea::UpdateChunkMesh(const Vector3Int& coord)
 {
-    const f32 halfDim = chunkIndices.dimension() / 2.0f;
-    f32 sx = ((f32) chunkX - halfDim);
-    f32 sy = ((f32) chunkY - halfDim);
-    f32 sz = ((f32) chunkZ - halfDim);
+    const u32 chunkIndex = chunkMap.Find(coord);
+
+    // Chunks that aren't loaded or are only air don't have a mesh
+    if (!IsValidChunkSlot(chunkIndex))
+        return;
 
-    const Vector3 chunkPosition = areaPosition + Vector3(sx * CHUNK_SIZE, sy * CHUNK_SIZE, sz * CHUNK_SIZE);
+    ChunkNeighbourhood neighbours;
+    GetNeighbourhood(coord, neighbours);
+
+    if (chunks[chunkIndex].dimension() != CHUNK_SIZE)
+    {
+        UpdateChunkMeshLOD(coord, chunkIndex, neighbours);
+        return;
+    }
+
+    const Vector3 chunkPosition = ChunkCoordToPosition(coord);
 
-    u32 chunkIndex = chunkIndices.at(chunkX, chunkY, chunkZ);
     VoxelChunk& chunk = chunks[chunkIndex];
 
     u32& opaqueFaceCount = opaqueFaceCounts[chunkIndex];
@@ -327,8 +462,26 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
         constexpr f32 texCoordDimension = 1.0f / TEX_PACK_DIMENSION;
 
+        // Water that isn't under more water only fills the cell up to its flow level
+        const Vector3* blockCorners = positions;
+        Vector3 fluidCorners[8];
+
+        if (type == BlockType::WATER && neighbours.BlockAt(x, y + 1, z) != BlockType::WATER)
+        {
+            const f32 height = GetFluidSurfaceHeight(fluids[chunkIndex].at(x, y, z));
+
+            for (u32 i = 0; i < 8; i++)
+            {
+                fluidCorners[i] = positions[i];
+                if (positions[i].y > 0.0f)
+                    fluidCorners[i].y = height;
+            }
+
+            blockCorners = fluidCorners;
+        }
+
         // Add Front Face if needed
-        if  (z == CHUNK_SIZE - 1 && (chunkZ < chunkIndices.dimension() - 1 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX, chunkY, chunkZ + 1)].at(x, y, 0))) ||
+        if  (z == CHUNK_SIZE - 1 && (neighbours.IsLoaded(0, 0, 1) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(x, y, CHUNK_SIZE))) ||
             (z != CHUNK_SIZE - 1 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x, y, z + 1))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::FRONT;
@@ -337,17 +490,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
 
-            VoxelVertex v0 = { positions[0] + position, Vector3::forward, { texCoords.u, texCoords.v }, 1.0f };
-            VoxelVertex v1 = { positions[1] + position, Vector3::forward, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v2 = { positions[2] + position, Vector3::forward, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v3 = { positions[3] + position, Vector3::forward, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v0 = { blockCorners[0] + position, Vector3::forward, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v1 = { blockCorners[1] + position, Vector3::forward, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v2 = { blockCorners[2] + position, Vector3::forward, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v3 = { blockCorners[3] + position, Vector3::forward, { texCoords.u, texCoords.t }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 0, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 1, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 2, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 3, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 0, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 1, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 2, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 3, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 0, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 1, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 2, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 3, x, y, z);
 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -356,10 +514,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
                 if (a00 + a11 > a01 + a10)
                 {
-                    v3 = { positions[0] + position, Vector3::forward, { texCoords.u, texCoords.v }, a00 };
-                    v0 = { positions[1] + position, Vector3::forward, { texCoords.s, texCoords.v }, a01 };
-                    v1 = { positions[2] + position, Vector3::forward, { texCoords.s, texCoords.t }, a11 };
-                    v2 = { positions[3] + position, Vector3::forward, { texCoords.u, texCoords.t }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -373,7 +533,7 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
 
         // Add Up Face if needed
-        if  (y == CHUNK_SIZE - 1 && (chunkY < chunkIndices.dimension() - 1 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX, chunkY + 1, chunkZ)].at(x, 0, z))) ||
+        if  (y == CHUNK_SIZE - 1 && (neighbours.IsLoaded(0, 1, 0) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(x, CHUNK_SIZE, z))) ||
             (y != CHUNK_SIZE - 1 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x, y + 1, z))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::UP;
@@ -382,17 +542,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
             
-            VoxelVertex v0 = { positions[3] + position, Vector3::up, { texCoords.u, texCoords.v }, 1.0f };
-            VoxelVertex v1 = { positions[2] + position, Vector3::up, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v2 = { positions[7] + position, Vector3::up, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v3 = { positions[6] + position, Vector3::up, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v0 = { blockCorners[3] + position, Vector3::up, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v1 = { blockCorners[2] + position, Vector3::up, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v2 = { blockCorners[7] + position, Vector3::up, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v3 = { blockCorners[6] + position, Vector3::up, { texCoords.u, texCoords.t }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 3, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 2, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 7, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 6, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 3, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 2, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 7, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 6, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 3, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 2, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 7, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 6, x, y, z);
 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -401,10 +566,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
                 
                 if (a01 + a10 > a00 + a11)
                 {
-                    v3 = { positions[3] + position, Vector3::up, { texCoords.u, texCoords.v }, a00 };
-                    v0 = { positions[2] + position, Vector3::up, { texCoords.s, texCoords.v }, a01 };
-                    v1 = { positions[7] + position, Vector3::up, { texCoords.s, texCoords.t }, a11 };
-                    v2 = { positions[6] + position, Vector3::up, { texCoords.u, texCoords.t }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -418,7 +585,7 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
 
         // Add Right Face if needed
-        if  (x == CHUNK_SIZE - 1 && (chunkX < chunkIndices.dimension() - 1 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX + 1, chunkY, chunkZ)].at(0, y, z))) ||
+        if  (x == CHUNK_SIZE - 1 && (neighbours.IsLoaded(1, 0, 0) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(CHUNK_SIZE, y, z))) ||
             (x != CHUNK_SIZE - 1 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x + 1, y, z))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::RIGHT;
@@ -427,17 +594,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
 
-            VoxelVertex v0 = { positions[7] + position, Vector3::right, { texCoords.u, texCoords.t }, 1.0f };
-            VoxelVertex v1 = { positions[2] + position, Vector3::right, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v2 = { positions[1] + position, Vector3::right, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v3 = { positions[4] + position, Vector3::right, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v0 = { blockCorners[7] + position, Vector3::right, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v1 = { blockCorners[2] + position, Vector3::right, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v2 = { blockCorners[1] + position, Vector3::right, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v3 = { blockCorners[4] + position, Vector3::right, { texCoords.u, texCoords.v }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 7, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 2, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 1, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 4, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 7, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 2, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 1, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 4, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 7, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 2, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 1, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 4, x, y, z);
 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -446,10 +618,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
                 if (a01 + a10 > a00 + a11)
                 {
-                    v3 = { positions[7] + position, Vector3::right, { texCoords.u, texCoords.t }, a00 };
-                    v0 = { positions[2] + position, Vector3::right, { texCoords.s, texCoords.t }, a01 };
-                    v1 = { positions[1] + position, Vector3::right, { texCoords.s, texCoords.v }, a11 };
-                    v2 = { positions[4] + position, Vector3::right, { texCoords.u, texCoords.v }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -463,7 +637,7 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
 
         // Add Left Face if needed
-        if  (x == 0 && (chunkX > 0 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX - 1, chunkY, chunkZ)].at(CHUNK_SIZE - 1, y, z))) ||
+        if  (x == 0 && (neighbours.IsLoaded(-1, 0, 0) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(-1, y, z))) ||
             (x != 0 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x - 1, y, z))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::LEFT;
@@ -472,17 +646,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
             
-            VoxelVertex v0 = { positions[3] + position, Vector3::left, { texCoords.u, texCoords.t }, 1.0f };
-            VoxelVertex v1 = { positions[6] + position, Vector3::left, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v2 = { positions[5] + position, Vector3::left, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v3 = { positions[0] + position, Vector3::left, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v0 = { blockCorners[3] + position, Vector3::left, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v1 = { blockCorners[6] + position, Vector3::left, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v2 = { blockCorners[5] + position, Vector3::left, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v3 = { blockCorners[0] + position, Vector3::left, { texCoords.u, texCoords.v }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 3, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 6, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 5, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 0, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 3, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 6, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 5, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 0, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 3, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 6, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 5, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 0, x, y, z);
                 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -491,10 +670,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
                 if (a01 + a10 > a00 + a11)
                 {
-                    v3 = { positions[3] + position, Vector3::left, { texCoords.u, texCoords.t }, a00 };
-                    v0 = { positions[6] + position, Vector3::left, { texCoords.s, texCoords.t }, a01 };
-                    v1 = { positions[5] + position, Vector3::left, { texCoords.s, texCoords.v }, a11 };
-                    v2 = { positions[0] + position, Vector3::left, { texCoords.u, texCoords.v }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -508,7 +689,7 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
 
         // Add Down Face if needed
-        if  (y == 0 && (chunkY > 0 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX, chunkY - 1, chunkZ)].at(x, CHUNK_SIZE - 1, z))) ||
+        if  (y == 0 && (neighbours.IsLoaded(0, -1, 0) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(x, -1, z))) ||
             (y != 0 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x, y - 1, z))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::DOWN;
@@ -517,17 +698,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
 
-            VoxelVertex v0 = { positions[1] + position, Vector3::down, { texCoords.u, texCoords.v }, 1.0f };
-            VoxelVertex v1 = { positions[0] + position, Vector3::down, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v2 = { positions[5] + position, Vector3::down, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v3 = { positions[4] + position, Vector3::down, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v0 = { blockCorners[1] + position, Vector3::down, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v1 = { blockCorners[0] + position, Vector3::down, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v2 = { blockCorners[5] + position, Vector3::down, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v3 = { blockCorners[4] + position, Vector3::down, { texCoords.u, texCoords.t }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 1, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 0, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 5, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 4, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 1, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 0, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 5, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 4, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 1, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 0, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 5, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 4, x, y, z);
                 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -536,10 +722,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
                 if (a01 + a10 > a00 + a11)
                 {
-                    v3 = { positions[1] + position, Vector3::down, { texCoords.u, texCoords.v }, a00 };
-                    v0 = { positions[0] + position, Vector3::down, { texCoords.s, texCoords.v }, a01 };
-                    v1 = { positions[5] + position, Vector3::down, { texCoords.s, texCoords.t }, a11 };
-                    v2 = { positions[4] + position, Vector3::down, { texCoords.u, texCoords.t }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -553,7 +741,7 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
 
         // Add Back Face if needed
-        if  (z == 0 && (chunkZ > 0 && AddFaceBasedOnAdjacentBlockType(type, chunks[chunkIndices.at(chunkX, chunkY, chunkZ - 1)].at(x, y, CHUNK_SIZE - 1))) ||
+        if  (z == 0 && (neighbours.IsLoaded(0, 0, -1) && AddFaceBasedOnAdjacentBlockType(type, neighbours.BlockAt(x, y, -1))) ||
             (z != 0 && AddFaceBasedOnAdjacentBlockType(type, chunk.at(x, y, z - 1))))
         {
             constexpr VoxelFaceDirection direction = VoxelFaceDirection::BACK;
@@ -562,17 +750,22 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
             const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[(u32) direction] / TEX_PACK_DIMENSION);
             const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
             
-            VoxelVertex v0 = { positions[6] + position, Vector3::back, { texCoords.u, texCoords.t }, 1.0f };
-            VoxelVertex v1 = { positions[7] + position, Vector3::back, { texCoords.s, texCoords.t }, 1.0f };
-            VoxelVertex v2 = { positions[4] + position, Vector3::back, { texCoords.s, texCoords.v }, 1.0f };
-            VoxelVertex v3 = { positions[5] + position, Vector3::back, { texCoords.u, texCoords.v }, 1.0f };
+            VoxelVertex v0 = { blockCorners[6] + position, Vector3::back, { texCoords.u, texCoords.t }, 1.0f };
+            VoxelVertex v1 = { blockCorners[7] + position, Vector3::back, { texCoords.s, texCoords.t }, 1.0f };
+            VoxelVertex v2 = { blockCorners[4] + position, Vector3::back, { texCoords.s, texCoords.v }, 1.0f };
+            VoxelVertex v3 = { blockCorners[5] + position, Vector3::back, { texCoords.u, texCoords.v }, 1.0f };
+
+            v0.light = GetVertexLight(neighbours, direction, 6, x, y, z);
+            v1.light = GetVertexLight(neighbours, direction, 7, x, y, z);
+            v2.light = GetVertexLight(neighbours, direction, 4, x, y, z);
+            v3.light = GetVertexLight(neighbours, direction, 5, x, y, z);
 
             if (!blockIsTransparent)
             {
-                f32 a00 = GetOcclusion(*this, direction, 6, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a01 = GetOcclusion(*this, direction, 7, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a11 = GetOcclusion(*this, direction, 4, chunkX, chunkY, chunkZ, x, y, z);
-                f32 a10 = GetOcclusion(*this, direction, 5, chunkX, chunkY, chunkZ, x, y, z);
+                f32 a00 = GetOcclusion(neighbours, direction, 6, x, y, z);
+                f32 a01 = GetOcclusion(neighbours, direction, 7, x, y, z);
+                f32 a11 = GetOcclusion(neighbours, direction, 4, x, y, z);
+                f32 a10 = GetOcclusion(neighbours, direction, 5, x, y, z);
                 
                 v0.occlusion = a00;
                 v1.occlusion = a01;
@@ -581,10 +774,12 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
 
                 if (a01 + a10 > a00 + a11)
                 {
-                    v3 = { positions[6] + position, Vector3::back, { texCoords.u, texCoords.t }, a00 };
-                    v0 = { positions[7] + position, Vector3::back, { texCoords.s, texCoords.t }, a01 };
-                    v1 = { positions[4] + position, Vector3::back, { texCoords.s, texCoords.v }, a11 };
-                    v2 = { positions[5] + position, Vector3::back, { texCoords.u, texCoords.v }, a10 };
+                    // Rotate the vertices so the quad is split along the other diagonal
+                    const VoxelVertex first = v0;
+                    v0 = v1;
+                    v1 = v2;
+                    v2 = v3;
+                    v3 = first;
                 }
             }
 
@@ -598,28 +793,148 @@ void VoxelChunkArea::UpdateChunkMesh(u32 chunkX, u32 chunkY, u32 chunkZ)
         }
     }
 
-    {   // Increase size of transparent batch buffer if more transparent blocks have been added
-        s64 totalTransparentFaces = 0;
-        for (int i = 0; i < chunks.size(); i++)
-            totalTransparentFaces += transparentFaceCounts[i];
+    GrowTransparentBatch(*this);
+}
+
+// Lower level of detail chunks are meshed with bigger voxels and without ambient occlusion.
+// Towards chunks at a different level of detail, the border faces of surface voxels are always
+// added so they hang down like skirts and cover the cracks between the two resolutions.
+void VoxelChunkArea::UpdateChunkMeshLOD(const Vector3Int& coord, u32 chunkIndex, const ChunkNeighbourhood& neighbours)
+{
+    const VoxelChunk& chunk = chunks[chunkIndex];
+    const u32 lod = GetChunkLOD(chunk);
+    const s32 dimension = (s32) chunk.dimension();
+    const s32 voxelSize = 1 << lod;
+
+    const Vector3 chunkPosition = ChunkCoordToPosition(coord);
+
+    u32& opaqueFaceCount = opaqueFaceCounts[chunkIndex];
+    VoxelVertex* opaqueVertexBuffer = opaqueMeshData[chunkIndex];
+
+    u32& transparentFaceCount = transparentFaceCounts[chunkIndex];
+    VoxelVertex* transparentVertexBuffer = transparentMeshData[chunkIndex];
+
+    bool& onlyAir = isOnlyAir[chunkIndex];
+
+    AABB& chunkAABB = chunkBounds[chunkIndex];
+    chunkAABB.min = chunkPosition + Vector3(CHUNK_SIZE + 1);
+    chunkAABB.max = chunkPosition;
+
+    const Vector3 positions[] = {
+        Vector3(0.0f, 0.0f, 1.0f),
+        Vector3(1.0f, 0.0f, 1.0f),
+        Vector3(1.0f, 1.0f, 1.0f),
+        Vector3(0.0f, 1.0f, 1.0f),
+
+        Vector3(1.0f, 0.0f, 0.0f),
+        Vector3(0.0f, 0.0f, 0.0f),
+        Vector3(0.0f, 1.0f, 0.0f),
+        Vector3(1.0f, 1.0f, 0.0f),
+    };
+
+    // Everything below is indexed by VoxelFaceDirection
+    const s32 offsets[6][3] = {
+        {  0,  0,  1 },     // Front
+        {  0,  1,  0 },     // Up
+        {  1,  0,  0 },     // Right
+        { -1,  0,  0 },     // Left
+        {  0, -1,  0 },     // Down
+        {  0,  0, -1 },     // Back
+    };
+
+    const u32 corners[6][4] = {
+        { 0, 1, 2, 3 },
+        { 3, 2, 7, 6 },
+        { 7, 2, 1, 4 },
+        { 3, 6, 5, 0 },
+        { 1, 0, 5, 4 },
+        { 6, 7, 4, 5 },
+    };
+
+    const Vector3 normals[6] = {
+        Vector3::forward, Vector3::up, Vector3::right, Vector3::left, Vector3::down, Vector3::back
+    };
+
+    // Side faces have their texture coordinates flipped vertically
+    const bool flipTexCoords[6] = { false, false, true, true, false, true };
+
+    opaqueFaceCount = transparentFaceCount = 0;
+    onlyAir = true;
 
-        if (totalTransparentFaces > crData.transparentBatchSize)
+    for (s32 z = 0; z < dimension; z++)
+    for (s32 y = 0; y < dimension; y++)
+    for (s32 x = 0; x < dimension; x++)
+    {
+        BlockType type = chunk.at(x, y, z);
+
+        if (type == BlockType::NONE)
+            continue;
+
+        onlyAir = false;
+
+        const Vector3 position = Vector3(x * voxelSize, y * voxelSize, z * voxelSize) + chunkPosition;
+        const u32* texIndices = voxelTypeTextureIndices + ((u32) type * 6);
+
+        chunkAABB.min.x = Min(chunkAABB.min.x, position.x);
+        chunkAABB.min.y = Min(chunkAABB.min.y, position.y);
+        chunkAABB.min.z = Min(chunkAABB.min.z, position.z);
+
+        chunkAABB.max.x = Max(chunkAABB.max.x, position.x + voxelSize);
+        chunkAABB.max.y = Max(chunkAABB.max.y, position.y + voxelSize);
+        chunkAABB.max.z = Max(chunkAABB.max.z, position.z + voxelSize);
+
+        const bool blockIsTransparent = VoxelBlockHasTransparency(type);
+        u32& faceCount = blockIsTransparent ? transparentFaceCount : opaqueFaceCount;
+        VoxelVertex* voxelVertexPtr = (blockIsTransparent ? transparentVertexBuffer : opaqueVertexBuffer) + faceCount * 4;
+
+        constexpr f32 texCoordDimension = 1.0f / TEX_PACK_DIMENSION;
+
+        for (u32 direction = 0; direction < 6; direction++)
         {
+            const s32 nx = x + offsets[direction][0];
+            const s32 ny = y + offsets[direction][1];
+            const s32 nz = z + offsets[direction][2];
+
+            bool addFace;
+            if (nx >= 0 && nx < dimension && ny >= 0 && ny < dimension && nz >= 0 && nz < dimension)
+                addFace = AddFaceBasedOnAdjacentBlockType(type, chunk.at(nx, ny, nz));
+            else if (!neighbours.IsLoaded(offsets[direction][0], offsets[direction][1], offsets[direction][2]))
+                addFace = false;
+            else
             {
-                VoxelVertex* newBuffer = (VoxelVertex*) PlatformReallocate(crData.transparentBatchBuffer, totalTransparentFaces * sizeof(VoxelFace));
-                AssertWithMessage(newBuffer, "Could not reallocate buffer for transparent batch!");
-                crData.transparentBatchBuffer = newBuffer;
-            }
+                // Neighbour may be at a different level of detail so look it up in full resolution blocks
+                const BlockType adjacentType = neighbours.BlockAt(nx * voxelSize, ny * voxelSize, nz * voxelSize);
+                addFace = AddFaceBasedOnAdjacentBlockType(type, adjacentType);
 
-            {
-                f32* newBuffer = (f32*) PlatformReallocate(crData.transparentFaceDistances, totalTransparentFaces * sizeof(f32));
-                AssertWithMessage(newBuffer, "Could not reallocate buffer for transparent face distance batch!");
-                crData.transparentFaceDistances = newBuffer;
+                const u32 neighbourIndex = ChunkNeighbourhood::Index(offsets[direction][0], offsets[direction][1], offsets[direction][2]);
+                if (!addFace && neighbours.chunks[neighbourIndex] && neighbours.lods[neighbourIndex] != lod)
+                {
+                    const BlockType aboveType = (y + 1 < dimension) ? chunk.at(x, y + 1, z) : neighbours.BlockAt(x * voxelSize, CHUNK_SIZE, z * voxelSize);
+                    addFace = VoxelBlockHasTransparency(aboveType);
+                }
             }
 
-            crData.transparentBatchSize = totalTransparentFaces;
+            if (!addFace)
+                continue;
+
+            const u32 atlasX = texIndices[direction] % TEX_PACK_DIMENSION;
+            const u32 atlasY = TEX_PACK_DIMENSION - (texIndices[direction] / TEX_PACK_DIMENSION);
+            const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
+
+            const f32 bottom = flipTexCoords[direction] ? texCoords.t : texCoords.v;
+            const f32 top    = flipTexCoords[direction] ? texCoords.v : texCoords.t;
+
+            voxelVertexPtr[0] = { positions[corners[direction][0]] * voxelSize + position, normals[direction], { texCoords.u, bottom }, 1.0f };
+            voxelVertexPtr[1] = { positions[corners[direction][1]] * voxelSize + position, normals[direction], { texCoords.s, bottom }, 1.0f };
+            voxelVertexPtr[2] = { positions[corners[direction][2]] * voxelSize + position, normals[direction], { texCoords.s, top }, 1.0f };
+            voxelVertexPtr[3] = { positions[corners[direction][3]] * voxelSize + position, normals[direction], { texCoords.u, top }, 1.0f };
+
+            voxelVertexPtr += 4;
+            faceCount++;
         }
     }
+
+    GrowTransparentBatch(*this);
 }
 
 template<typename T>
@@ -634,78 +949,91 @@ static inline void AddToArrayIfNotPresent(DynamicArray<T>& array, const T& value
     array.EmplaceBack(value);
 }
 
-constexpr f32 maxHeightAmplitude = 16.0f;
-static inline f32 GetHeightAtPosition(const SimplexNoise& noise, f32 x, f32 z)
+// Chunks that are only air or store light can light up the chunks next to them
+static inline bool ChunkGivesLight(const VoxelChunkArea& area, u32 slot)
 {
-    constexpr f32 mult = 0.0078125f;
-    return maxHeightAmplitude * noise.fractal(4, x * mult, z * mult);
+    return slot == AIR_CHUNK_SLOT || (IsValidChunkSlot(slot) && area.chunks[slot].dimension() == CHUNK_SIZE);
 }
 
-inline BlockType GetBlockTypeFromHeight(f32 maxHeight, f32 blockHeight)
+// Generates the requested chunks and adds them to the chunk map.
+// Each request's slot is set to the slot it was stored in or AIR_CHUNK_SLOT if it's only air.
+static void LoadChunks(VoxelChunkArea& area, WorldGenerator& generator, ChunkLoadRequest* requests, u32 count)
 {
-    const f32 diff = maxHeight - blockHeight;
-    return (diff < 0.0f) ? BlockType::NONE : ((diff < 1.0f) ? BlockType::GRASS : ((diff < 4.0f) ? BlockType::DIRT : BlockType::STONE));
-}
-
-void VoxelChunkArea::InitializeChunkArea(const SimplexNoise& noise, const Vector3& position)
-{
-    const s32 px = position.x / CHUNK_SIZE;
-    const s32 py = position.y / CHUNK_SIZE;
-    const s32 pz = position.z / CHUNK_SIZE;
-
-    u32 index = 0;
+    crData.worldGenChunkList.Clear(false);
 
-    for (u32 z = 0; z < chunkIndices.dimension(); z++)
-    for (u32 y = 0; y < chunkIndices.dimension(); y++)
-    for (u32 x = 0; x < chunkIndices.dimension(); x++)
+    for (u32 i = 0; i < count; i++)
     {
-        VoxelChunk& chunk = chunks[index];
-        chunkIndices.at(x, y, z) = index;
+        ChunkLoadRequest& request = requests[i];
+        request.slot = AIR_CHUNK_SLOT;
 
-        // Offsets for chunk
-        f32 sx = ((f32) x - (chunkIndices.dimension() / 2.0f));
-        f32 sy = ((f32) y - (chunkIndices.dimension() / 2.0f));
-        f32 sz = ((f32) z - (chunkIndices.dimension() / 2.0f));
+        // Chunks above the highest point of the terrain are always only air
+        if (ChunkCoordToPosition(request.coord).y <= maxWorldGenHeight)
+        {
+            request.slot = area.AcquireSlot(request.coord, request.lod);
+            crData.worldGenChunkList.PushBack({ nullptr, request.coord });
+        }
+    }
 
-        const Vector3 chunkPosition = Vector3(sx * CHUNK_SIZE, sy * CHUNK_SIZE, sz * CHUNK_SIZE);
-        const Vector3 worldPosition = areaPosition + chunkPosition;
+    {   // Slots can move the chunk array so pointers are taken after all of them were acquired
+        u32 genIndex = 0;
+        for (u32 i = 0; i < count; i++)
+        {
+            if (requests[i].slot != AIR_CHUNK_SLOT)
+                crData.worldGenChunkList[genIndex++].chunk = &area.chunks[requests[i].slot];
+        }
+    }
 
-        bool& onlyAir = isOnlyAir[index];
-        onlyAir = true;
+    generator.GenerateChunks(crData.worldGenChunkList.data(), (u32) crData.worldGenChunkList.size());
+
+    u32 genIndex = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        ChunkLoadRequest& request = requests[i];
 
-        if (worldPosition.y - (CHUNK_SIZE / 2.0f) <= maxHeightAmplitude)
+        if (request.slot != AIR_CHUNK_SLOT)
         {
-            for (u32 cz = 0; cz < CHUNK_SIZE; cz++)
-            for (u32 cx = 0; cx < CHUNK_SIZE; cx++)
+            area.isOnlyAir[request.slot] = crData.worldGenChunkList[genIndex++].onlyAir;
+
+            if (area.isOnlyAir[request.slot])
             {
-                const f32 fx = cx + worldPosition.x;
-                const f32 fz = cz + worldPosition.z;
-                f32 height = GetHeightAtPosition(noise, fx, fz);
-                
-                for (u32 cy = 0; cy < CHUNK_SIZE; cy++)
-                {
-                    const f32 blockheight = (cy + worldPosition.y);
-                    chunk.at(cx, cy, cz) = GetBlockTypeFromHeight(height, blockheight);
-                    onlyAir = onlyAir && (blockheight > height);
-                }
+                area.ReleaseSlot(request.slot);
+                request.slot = AIR_CHUNK_SLOT;
             }
         }
 
-        index++;
+        area.chunkMap.Place(request.coord, request.slot);
     }
+}
+
+void VoxelChunkArea::InitializeChunkArea(WorldGenerator& generator, const Vector3& position)
+{
+    centerChunk = PositionToChunkCoord(position);
+
+    crData.loadRequestList.Clear(false);
+
+    for (s32 z = centerChunk.z - loadShape.radius; z <= centerChunk.z + loadShape.radius; z++)
+    for (s32 y = loadShape.MinY(centerChunk); y <= loadShape.MaxY(centerChunk); y++)
+    for (s32 x = centerChunk.x - loadShape.radius; x <= centerChunk.x + loadShape.radius; x++)
+    {
+        const Vector3Int coord = { x, y, z };
+        if (loadShape.Contains(centerChunk, coord))
+            crData.loadRequestList.PushBack({ coord, loadShape.LODAt(centerChunk, coord), AIR_CHUNK_SLOT, NO_CHUNK_SLOT, false });
+    }
+
+    LoadChunks(*this, generator, crData.loadRequestList.data(), (u32) crData.loadRequestList.size());
 
-    for (u32 z = 0; z < chunkIndices.dimension(); z++)
-    for (u32 y = 0; y < chunkIndices.dimension(); y++)
-    for (u32 x = 0; x < chunkIndices.dimension(); x++)
+    // Every chunk is meshed below so there's no need to know which ones changed
+    LightLoadedChunks(*this, chunkCoords, (u32) chunks.size(), crData.changedLightList);
+    crData.changedLightList.Clear(false);
+
+    for (u32 i = 0; i < chunks.size(); i++)
     {
-        if (isOnlyAir[chunkIndices.at(x, y, z)])
+        if (isOnlyAir[i])
             continue;
 
-        UpdateChunkMesh(x, y, z);
+        UpdateChunkMesh(chunkCoords[i]);
     }
 
-    areaPosition = Vector3((f32) px * CHUNK_SIZE, (f32) py * CHUNK_SIZE, (f32) pz * CHUNK_SIZE);
-
     newUpdatesLeft = 0;
     surrUpdatesLeft = 0;
 }
@@ -713,7 +1041,7 @@ void VoxelChunkArea::InitializeChunkArea(const SimplexNoise& noise, const Vector
 // TODO: Updating chunk meshes is very slow. Maybe move it to a different thread?
 //       For now this function updates chunk meshes across multiple frames to maintain framerate.
 //       This works really well and can be a backup if someone doesn't want multithreading for some reason.
-void VoxelChunkArea::UpdateChunkArea(const SimplexNoise& noise, const Vector3& position)
+void VoxelChunkArea::UpdateChunkArea(WorldGenerator& generator, const Vector3& position)
 {
     if (newUpdatesLeft > 0)
     {
@@ -730,7 +1058,7 @@ void VoxelChunkArea::UpdateChunkArea(const SimplexNoise& noise, const Vector3& p
             if (isOnlyAir[data.index])
                 continue;
 
-            UpdateChunkMesh(data.x, data.y, data.z);
+            UpdateChunkMesh(data.coord);
         }
 
         newUpdatesLeft--;
@@ -752,7 +1080,7 @@ void VoxelChunkArea::UpdateChunkArea(const SimplexNoise& noise, const Vector3& p
             if (isOnlyAir[data.index])
                 continue;
 
-            UpdateChunkMesh(data.x, data.y, data.z);
+            UpdateChunkMesh(data.coord);
         }
 
         surrUpdatesLeft--;
@@ -760,112 +1088,134 @@ void VoxelChunkArea::UpdateChunkArea(const SimplexNoise& noise, const Vector3& p
     }
 
     // Only update area if player moves from one chunk to another
-    const s32 px = position.x / CHUNK_SIZE;
-    const s32 py = position.y / CHUNK_SIZE;
-    const s32 pz = position.z / CHUNK_SIZE;
+    const Vector3Int prevCenterChunk = centerChunk;
+    centerChunk = PositionToChunkCoord(position);
 
-    {   // If player is in same chunk no need to update
-        const s32 ax = areaPosition.x / CHUNK_SIZE;
-        const s32 ay = areaPosition.y / CHUNK_SIZE;
-        const s32 az = areaPosition.z / CHUNK_SIZE;
+    if (centerChunk == prevCenterChunk)
+        return;
 
-        if (px == ax && py == ay && pz == az)
-            return;
-    }
+    crData.surroundingChunkUpdateList.Clear(false);
+    crData.newChunkUpdateList.Clear(false);
+    crData.unloadChunkList.Clear(false);
+    crData.unlitChunkList.Clear(false);
 
-    // This is the position of the center chunk
-    const Vector3 prevAreaPosition = areaPosition;
-    areaPosition = Vector3((f32) px * CHUNK_SIZE, (f32) py * CHUNK_SIZE, (f32) pz * CHUNK_SIZE);
+    {   // Unload chunks that are not in the load shape anymore
+        for (auto it = chunkMap.slots.begin(); it != chunkMap.slots.end(); it++)
+        {
+            if (!loadShape.Contains(centerChunk, UnpackChunkCoord(it.key())))
+                crData.unloadChunkList.PushBack(it.key());
+        }
 
-    Vector3 displacement = (areaPosition - prevAreaPosition) / Vector3(CHUNK_SIZE); 
+        for (int i = 0; i < crData.unloadChunkList.size(); i++)
+        {
+            const ChunkKey key = crData.unloadChunkList[i];
+            const u32 slot = chunkMap.slots[key];
 
-    {   // Just to be safe, only work with 1 unit displacements in all directions
-        displacement.x = Clamp(displacement.x, -1.0f, 1.0f);
-        displacement.y = Clamp(displacement.y, -1.0f, 1.0f);
-        displacement.z = Clamp(displacement.z, -1.0f, 1.0f);
-        
-        areaPosition = prevAreaPosition + displacement * Vector3(CHUNK_SIZE);
-    }
+            if (ChunkGivesLight(*this, slot))
+                crData.unlitChunkList.PushBack(UnpackChunkCoord(key));
 
-    crData.surroundingChunkUpdateList.Clear(false);
-    crData.newChunkUpdateList.Clear(false);
+            if (IsValidChunkSlot(slot))
+                ReleaseSlot(slot);
 
-    {   // Determine which indices must be updated
-        const s32 changeX = !Math::AlmostEquals(displacement.x, 0.0f) ? ((displacement.x > 0.0f) ? (s32) chunkIndices.dimension() - 1 : 0) : -1;
-        const s32 surrX   = !Math::AlmostEquals(displacement.x, 0.0f) ? ((displacement.x > 0.0f) ? (s32) chunkIndices.dimension() - 2 : 1) : -1;
+            chunkMap.slots.Remove(key);
+        }
+    }
 
-        const s32 changeY = !Math::AlmostEquals(displacement.y, 0.0f) ? ((displacement.y > 0.0f) ? (s32) chunkIndices.dimension() - 1 : 0) : -1;
-        const s32 surrY   = !Math::AlmostEquals(displacement.y, 0.0f) ? ((displacement.y > 0.0f) ? (s32) chunkIndices.dimension() - 2 : 1) : -1;
+    {   // Load chunks that entered the load shape or moved to a ring with a different level of detail
+        const Vector3Int directions[] = {
+            {  1,  0,  0 }, { -1,  0,  0 },
+            {  0,  1,  0 }, {  0, -1,  0 },
+            {  0,  0,  1 }, {  0,  0, -1 },
+        };
 
-        const s32 changeZ = !Math::AlmostEquals(displacement.z, 0.0f) ? ((displacement.z > 0.0f) ? (s32) chunkIndices.dimension() - 1 : 0) : -1;
-        const s32 surrZ   = !Math::AlmostEquals(displacement.z, 0.0f) ? ((displacement.z > 0.0f) ? (s32) chunkIndices.dimension() - 2 : 1) : -1;
-        
-        for (s32 z = 0; z < chunkIndices.dimension(); z++)
-        for (s32 y = 0; y < chunkIndices.dimension(); y++)
-        for (s32 x = 0; x < chunkIndices.dimension(); x++)
+        crData.loadRequestList.Clear(false);
+
+        for (s32 z = centerChunk.z - loadShape.radius; z <= centerChunk.z + loadShape.radius; z++)
+        for (s32 y = loadShape.MinY(centerChunk); y <= loadShape.MaxY(centerChunk); y++)
+        for (s32 x = centerChunk.x - loadShape.radius; x <= centerChunk.x + loadShape.radius; x++)
         {
-            const s32 xi = Wrap(x - (s32) displacement.x, 0, (s32) chunkIndices.dimension());
-            const s32 yi = Wrap(y - (s32) displacement.y, 0, (s32) chunkIndices.dimension());
-            const s32 zi = Wrap(z - (s32) displacement.z, 0, (s32) chunkIndices.dimension());
+            const Vector3Int coord = { x, y, z };
+            if (!loadShape.Contains(centerChunk, coord))
+                continue;
 
-            tempIndices.at(xi, yi, zi) = chunkIndices.at(x, y, z);
-            
-            ChunkUpdateData data;
-            data.index = chunkIndices.at(x, y, z);
-            data.x = xi;
-            data.y = yi;
-            data.z = zi;
-
-            if (xi == changeX || yi == changeY || zi == changeZ)
-                AddToArrayIfNotPresent(crData.newChunkUpdateList, data);
-            else if (xi == surrX || yi == surrY || zi == surrZ)
-                AddToArrayIfNotPresent(crData.surroundingChunkUpdateList, data);
-            
-            // ChunkUpdateData is discarded if the chunk doesn't need to be updated
-        }
+            const u32 lod = loadShape.LODAt(centerChunk, coord);
+
+            const u32 loadedSlot = chunkMap.Find(coord);
+            const bool loadedChunkGaveLight = ChunkGivesLight(*this, loadedSlot);
 
-        {   // Swap index arrays
-            chunkIndices.SwapWith(tempIndices);
+            if (loadedSlot != NO_CHUNK_SLOT)
+            {
+                if (loadShape.LODAt(prevCenterChunk, coord) == lod)
+                    continue;
+
+                if (IsValidChunkSlot(loadedSlot))
+                    ReleaseSlot(loadedSlot);
+            }
+
+            crData.loadRequestList.PushBack({ coord, lod, AIR_CHUNK_SLOT, loadedSlot, loadedChunkGaveLight });
         }
-    }
 
-    {   // Update relevant chunk data
-        for (int i = 0; i < crData.newChunkUpdateList.size(); i++)
+        // All chunks are generated together so they can be spread across the job system
+        LoadChunks(*this, generator, crData.loadRequestList.data(), (u32) crData.loadRequestList.size());
+        generator.ReleaseColumns(loadShape, centerChunk);
+
+        for (u32 i = 0; i < crData.loadRequestList.size(); i++)
         {
-            ChunkUpdateData& data = crData.newChunkUpdateList[i];
+            const ChunkLoadRequest& request = crData.loadRequestList[i];
+            const Vector3Int& coord = request.coord;
+            const u32 slot = request.slot;
+
+            // Light of the chunk that was here before has to be taken away unless it's still only air
+            if (request.replacedGaveLight && !(request.replacedSlot == AIR_CHUNK_SLOT && slot == AIR_CHUNK_SLOT))
+                crData.unlitChunkList.PushBack(coord);
+
+            if (IsValidChunkSlot(slot))
+                crData.newChunkUpdateList.EmplaceBack(ChunkUpdateData { slot, coord });
+
+            // Faces of chunks that were already loaded might have changed
+            for (const Vector3Int& direction : directions)
+            {
+                const Vector3Int neighbour = coord + direction;
+
+                // New chunks and chunks that change level of detail are remeshed anyway
+                if (!loadShape.Contains(prevCenterChunk, neighbour) ||
+                    loadShape.LODAt(prevCenterChunk, neighbour) != loadShape.LODAt(centerChunk, neighbour))
+                    continue;
+
+                const u32 neighbourSlot = chunkMap.Find(neighbour);
+                if (IsValidChunkSlot(neighbourSlot))
+                    AddToArrayIfNotPresent(crData.surroundingChunkUpdateList, ChunkUpdateData { neighbourSlot, neighbour });
+            }
+        }
 
-            // Offsets for chunk
-            const f32 sx = ((f32) data.x - (chunkIndices.dimension() / 2.0f));
-            const f32 sy = ((f32) data.y - (chunkIndices.dimension() / 2.0f));
-            const f32 sz = ((f32) data.z - (chunkIndices.dimension() / 2.0f));
+        {   // Take away light that came from unloaded chunks and light the new ones.
+            // Chunks around them whose light changed have to be remeshed as well.
+            crData.changedLightList.Clear(false);
+            RemoveLightOfUnloadedChunks(*this, crData.unlitChunkList.data(), (u32) crData.unlitChunkList.size(), crData.changedLightList);
 
-            const Vector3 chunkPosition = Vector3(sx * CHUNK_SIZE, sy * CHUNK_SIZE, sz * CHUNK_SIZE);
-            const Vector3 worldPosition = areaPosition + chunkPosition;
+            crData.lightChunkList.Clear(false);
+            for (int i = 0; i < crData.newChunkUpdateList.size(); i++)
+                crData.lightChunkList.PushBack(crData.newChunkUpdateList[i].coord);
 
-            bool& onlyAir = isOnlyAir[data.index];
-            onlyAir = true;
+            LightLoadedChunks(*this, crData.lightChunkList.data(), (u32) crData.lightChunkList.size(), crData.changedLightList);
 
-            if (worldPosition.y - (CHUNK_SIZE / 2.0f) <= maxHeightAmplitude)
+            for (int i = 0; i < crData.changedLightList.size(); i++)
             {
-                for (u32 cz = 0; cz < CHUNK_SIZE; cz++)
-                for (u32 cx = 0; cx < CHUNK_SIZE; cx++)
-                {
-                    const f32 fx = cx + worldPosition.x;
-                    const f32 fz = cz + worldPosition.z;
-                    const f32 height = GetHeightAtPosition(noise, fx, fz);
-
-                    for (u32 cy = 0; cy < CHUNK_SIZE; cy++)
-                    {
-                        const f32 blockHeight = (cy + worldPosition.y);
-                        chunks[data.index].at(cx, cy, cz) = GetBlockTypeFromHeight(height, blockHeight);
-                        onlyAir = onlyAir && (blockHeight > height);
-                    }
-                }
+                const Vector3Int& coord = crData.changedLightList[i];
+                const u32 slot = chunkMap.Find(coord);
+
+                bool isNewChunk = false;
+                for (int j = 0; j < crData.newChunkUpdateList.size() && !isNewChunk; j++)
+                    isNewChunk = (crData.newChunkUpdateList[j].index == slot);
+
+                if (!isNewChunk && IsValidChunkSlot(slot))
+                    AddToArrayIfNotPresent(crData.surroundingChunkUpdateList, ChunkUpdateData { slot, coord });
             }
         }
 
-        newUpdatesLeft  = (crData.newChunkUpdateList.size() - 1) / chunkUpdatesPerFrame;
-        surrUpdatesLeft = (crData.surroundingChunkUpdateList.size() - 1) / chunkUpdatesPerFrame;
+        // Rounded up so the last few updates aren't skipped
+        newUpdatesLeft  = (crData.newChunkUpdateList.size() + chunkUpdatesPerFrame - 1) / chunkUpdatesPerFrame;
+        surrUpdatesLeft = (crData.surroundingChunkUpdateList.size() + chunkUpdatesPerFrame - 1) / chunkUpdatesPerFrame;
     }
 }
 
@@ -874,6 +1224,12 @@ namespace ChunkRenderer
 
 void Init()
 {
+    // Uniforms are set every frame so they're only looked up by name once
+    crData.viewProjectionUniform = GetUniformId("u_viewProjection");
+    crData.textureUniform = GetUniformId("u_texture");
+    crData.cameraPositionUniform = GetUniformId("u_cameraPosition");
+    crData.colorUniform = GetUniformId("u_color");
+
     // Set up common vertex array
     glGenVertexArrays(1, &crData.vao);
     glBindVertexArray(crData.vao);
@@ -890,6 +1246,8 @@ void Init()
     glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(VoxelVertex), (const void*) offsetof(VoxelVertex, texCoord));
     glEnableVertexAttribArray(3);
     glVertexAttribPointer(3, 1, GL_FLOAT, false, sizeof(VoxelVertex), (const void*) offsetof(VoxelVertex, occlusion));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 2, GL_FLOAT, false, sizeof(VoxelVertex), (const void*) offsetof(VoxelVertex, light));
 
     // Set up common index buffer
     u32* indices = (u32*) PlatformAllocate(12 * maxVerticesInBatch * sizeof(u32));
@@ -945,9 +1303,6 @@ void Init()
 
     PlatformFree(indices);
 
-    // Ambient Occlusion
-    FillOcclusionOffsetTables(crData.aoXOffsets, crData.aoYOffsets, crData.aoZOffsets);
-
     // Buffers for transparent meshes
     crData.transparentBatchBuffer = (VoxelVertex*) PlatformAllocate(transparentBatchStartSize * sizeof(VoxelFace));
     AssertWithMessage(crData.transparentBatchBuffer, "Could not allocate buffer for transparent batch!");
@@ -1049,7 +1404,7 @@ static void FlushBatch(Shader& shader, u64& batchSize, u32& batchFaceCount, Debu
         };
 
         const Vector3 color = colors[stats.batches % 7];
-        shader.SetUniform4f("u_color", color.r, color.g, color.b, 1.0f);
+        shader.SetUniform4f(crData.colorUniform, color.r, color.g, color.b, 1.0f);
     }
 
     if (settings.showWireframe)
@@ -1107,28 +1462,56 @@ static inline void CalculateFaceDistances(VoxelFace* faces, f32* distances, s64
     }
 }
 
-void RenderChunkArea(VoxelChunkArea& area, Shader& shader, DebugStats& stats, const DebugSettings& settings, bool& updateTransparentBatch)
+static void BindVoxelShader(Shader& shader, const DebugSettings& settings)
 {
-    AssertWithMessage(crData.camera != nullptr, "ChunkRenderer::Begin() not called!");
-
     shader.Bind();
-    shader.SetUniformMatrix4("u_viewProjection", crData.camera->viewProjection());
-    shader.SetUniform1i("u_texture", ATLAS_BIND_SLOT);
+    shader.SetUniformMatrix4(crData.viewProjectionUniform, crData.camera->viewProjection());
+    shader.SetUniform1i(crData.textureUniform, ATLAS_BIND_SLOT);
 
     {   // Set camera position uniform in shader
         const Vector3& cameraPos = crData.camera->position();
-        shader.SetUniform3f("u_cameraPosition", cameraPos.x, cameraPos.y, cameraPos.z);
+        shader.SetUniform3f(crData.cameraPositionUniform, cameraPos.x, cameraPos.y, cameraPos.z);
     }
 
     if (!settings.showBatches)
-        shader.SetUniform4f("u_color", 1.0f, 1.0f, 1.0f, 1.0f);
+        shader.SetUniform4f(crData.colorUniform, 1.0f, 1.0f, 1.0f, 1.0f);
 
     glBindVertexArray(crData.vao);
     glBindBuffer(GL_ARRAY_BUFFER, crData.vbo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, settings.showWireframe ? crData.iboWireframe : crData.iboMesh);
+}
+
+void RenderFarTerrain(FarTerrain& terrain, Shader& shader, DebugStats& stats, const DebugSettings& settings)
+{
+    AssertWithMessage(crData.camera != nullptr, "ChunkRenderer::Begin() not called!");
+
+    BindVoxelShader(shader, settings);
+
+    u64 batchSize = 0;
+    u32 batchFaceCount = 0;
+
+    for (u32 i = 0; i < terrain.levelCount; i++)
+    {
+        const FarTerrainLevel& level = terrain.levels[i];
+        const u64 dataSize = 4 * level.faceCount * sizeof(VoxelVertex);
+
+        if (batchSize + dataSize >= maxChunkBatchSize)
+            FlushBatch(shader, batchSize, batchFaceCount, stats, settings);
+
+        glBufferSubData(GL_ARRAY_BUFFER, batchSize, dataSize, level.meshData);
+        batchFaceCount += level.faceCount;
+        batchSize += dataSize;
+    }
+
+    if (batchSize > 0)
+        FlushBatch(shader, batchSize, batchFaceCount, stats, settings);
+}
+
+void RenderChunkArea(VoxelChunkArea& area, Shader& shader, DebugStats& stats, const DebugSettings& settings, bool& updateTransparentBatch)
+{
+    AssertWithMessage(crData.camera != nullptr, "ChunkRenderer::Begin() not called!");
 
-    stats.trianglesRendered = 0;
-    stats.batches = 0;
+    BindVoxelShader(shader, settings);
 
     u64 batchSize = 0;
     u32 batchFaceCount = 0;
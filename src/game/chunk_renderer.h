@@ -6,6 +6,7 @@
 #include "graphics/texture.h"
 #include "aabb.h"
 #include "chunk_area.h"
+#include "far_terrain.h"
 #include "voxel.h"
 
 namespace ChunkRenderer
@@ -30,6 +31,10 @@ struct DebugSettings
     bool showLighting = false;
 };
 
+// Stats are added to, so reset them before rendering a frame
 void RenderChunkArea(VoxelChunkArea& area, Shader& shader, DebugStats& stats, const DebugSettings& settings, bool& updateTransparentBatch);
 
+// Render before the chunk area so transparent chunk faces are drawn over it
+void RenderFarTerrain(FarTerrain& terrain, Shader& shader, DebugStats& stats, const DebugSettings& settings);
+
 } // namespace ChunkRenderer
\ No newline at end of file
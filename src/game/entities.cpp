@@ -0,0 +1,235 @@
+#include "entities.h"
+
+#include "core/logging.h"
+#include "platform/platform.h"
+
+static constexpr u32 ARCHETYPE_START_CAPACITY = 64;
+
+static void GrowArchetype(EntityArchetype& archetype)
+{
+    archetype.capacity = (archetype.capacity) ? archetype.capacity * 2 : ARCHETYPE_START_CAPACITY;
+
+    archetype.handles = (EntityHandle*) PlatformReallocate(archetype.handles, archetype.capacity * sizeof(EntityHandle));
+
+    if (archetype.components & ENTITY_COMPONENT_POSITION)
+        archetype.positions = (Vector3*) PlatformReallocate(archetype.positions, archetype.capacity * sizeof(Vector3));
+
+    if (archetype.components & ENTITY_COMPONENT_VELOCITY)
+        archetype.velocities = (Vector3*) PlatformReallocate(archetype.velocities, archetype.capacity * sizeof(Vector3));
+
+    if (archetype.components & ENTITY_COMPONENT_BOUNDS)
+        archetype.bounds = (AABB*) PlatformReallocate(archetype.bounds, archetype.capacity * sizeof(AABB));
+
+    if (archetype.components & ENTITY_COMPONENT_MESH)
+        archetype.meshes = (const Mesh**) PlatformReallocate(archetype.meshes, archetype.capacity * sizeof(const Mesh*));
+}
+
+void EntityWorld::Create()
+{
+    for (u32 i = 0; i < ENTITY_ARCHETYPE_COUNT; i++)
+    {
+        archetypes[i] = {};
+        archetypes[i].components = i;
+    }
+
+    slots.Clear();
+    freeSlots.Clear();
+    batches.Clear();
+    entityCount = 0;
+}
+
+void EntityWorld::Free()
+{
+    for (u32 i = 0; i < ENTITY_ARCHETYPE_COUNT; i++)
+    {
+        EntityArchetype& archetype = archetypes[i];
+
+        PlatformFree(archetype.handles);
+        PlatformFree(archetype.positions);
+        PlatformFree(archetype.velocities);
+        PlatformFree(archetype.bounds);
+        PlatformFree(archetype.meshes);
+
+        archetype = {};
+        archetype.components = i;
+    }
+
+    slots.Free();
+    freeSlots.Free();
+    batches.Free();
+    entityCount = 0;
+}
+
+EntityHandle EntityWorld::CreateEntity(u32 components)
+{
+    AssertWithMessage(components < ENTITY_ARCHETYPE_COUNT, "Unknown entity components!");
+
+    u32 index;
+    if (freeSlots.size() > 0)
+    {
+        index = freeSlots[freeSlots.size() - 1];
+        freeSlots.PopBack();
+    }
+    else
+    {
+        index = (u32) slots.size();
+        slots.PushBack({ 0, 0, 0 });
+    }
+
+    EntityArchetype& archetype = archetypes[components];
+    if (archetype.count == archetype.capacity)
+        GrowArchetype(archetype);
+
+    const u32 row = archetype.count++;
+
+    EntitySlot& slot = slots[index];
+    slot.generation++;
+    slot.archetype = components;
+    slot.row = row;
+
+    const EntityHandle handle = { index, slot.generation };
+    archetype.handles[row] = handle;
+
+    // Components start zeroed, the caller fills them in
+    if (archetype.positions)  archetype.positions[row] = Vector3(0.0f);
+    if (archetype.velocities) archetype.velocities[row] = Vector3(0.0f);
+    if (archetype.bounds)     archetype.bounds[row] = {};
+    if (archetype.meshes)     archetype.meshes[row] = nullptr;
+
+    entityCount++;
+    return handle;
+}
+
+void EntityWorld::DestroyEntity(EntityHandle entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    EntitySlot& slot = slots[entity.index];
+    EntityArchetype& archetype = archetypes[slot.archetype];
+
+    // Move the last row into the hole so the arrays stay packed
+    const u32 row = slot.row;
+    const u32 last = --archetype.count;
+
+    if (row != last)
+    {
+        archetype.handles[row] = archetype.handles[last];
+
+        if (archetype.positions)  archetype.positions[row] = archetype.positions[last];
+        if (archetype.velocities) archetype.velocities[row] = archetype.velocities[last];
+        if (archetype.bounds)     archetype.bounds[row] = archetype.bounds[last];
+        if (archetype.meshes)     archetype.meshes[row] = archetype.meshes[last];
+
+        slots[archetype.handles[row].index].row = row;
+    }
+
+    // Bumping the generation invalidates every handle to the old entity
+    slot.generation++;
+    if (slot.generation == 0)
+        slot.generation = 1;
+
+    freeSlots.PushBack(entity.index);
+    entityCount--;
+}
+
+bool EntityWorld::IsAlive(EntityHandle entity) const
+{
+    return entity.index < slots.size() && entity.generation != 0 && slots[entity.index].generation == entity.generation;
+}
+
+Vector3* EntityWorld::GetPosition(EntityHandle entity)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    const EntitySlot& slot = slots[entity.index];
+    EntityArchetype& archetype = archetypes[slot.archetype];
+    return (archetype.positions) ? &archetype.positions[slot.row] : nullptr;
+}
+
+Vector3* EntityWorld::GetVelocity(EntityHandle entity)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    const EntitySlot& slot = slots[entity.index];
+    EntityArchetype& archetype = archetypes[slot.archetype];
+    return (archetype.velocities) ? &archetype.velocities[slot.row] : nullptr;
+}
+
+AABB* EntityWorld::GetBounds(EntityHandle entity)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    const EntitySlot& slot = slots[entity.index];
+    EntityArchetype& archetype = archetypes[slot.archetype];
+    return (archetype.bounds) ? &archetype.bounds[slot.row] : nullptr;
+}
+
+const Mesh** EntityWorld::GetMesh(EntityHandle entity)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    const EntitySlot& slot = slots[entity.index];
+    EntityArchetype& archetype = archetypes[slot.archetype];
+    return (archetype.meshes) ? &archetype.meshes[slot.row] : nullptr;
+}
+
+static void EntityBatchJob(void* data)
+{
+    EntityBatch& batch = *(EntityBatch*) data;
+    batch.function(batch);
+}
+
+void ForEachEntityBatch(EntityWorld& world, u32 requiredComponents, EntityBatchFunction function, void* data, u32 batchSize)
+{
+    AssertWithMessage(batchSize > 0, "Entity batches can't be empty!");
+
+    world.batches.Clear(false);
+
+    for (u32 i = 0; i < ENTITY_ARCHETYPE_COUNT; i++)
+    {
+        EntityArchetype& archetype = world.archetypes[i];
+        if ((archetype.components & requiredComponents) != requiredComponents || archetype.count == 0)
+            continue;
+
+        for (u32 begin = 0; begin < archetype.count; begin += batchSize)
+        {
+            const u32 end = Min(begin + batchSize, archetype.count);
+            world.batches.PushBack({ &archetype, begin, end, data, function });
+        }
+    }
+
+    // Not worth waking up the workers for a single batch
+    if (world.batches.size() == 1)
+    {
+        function(world.batches[0]);
+        return;
+    }
+
+    // All batches are added before submitting so the array doesn't move while jobs read it
+    JobSystem::JobCounter counter;
+    for (u64 i = 0; i < world.batches.size(); i++)
+        JobSystem::Submit(EntityBatchJob, &world.batches[i], &counter);
+
+    JobSystem::Wait(counter);
+}
+
+static void IntegrateVelocitiesBatch(EntityBatch& batch)
+{
+    const f32 deltaTime = *(const f32*) batch.data;
+
+    Vector3* positions = batch.archetype->positions;
+    const Vector3* velocities = batch.archetype->velocities;
+
+    for (u32 row = batch.begin; row < batch.end; row++)
+        positions[row] += velocities[row] * deltaTime;
+}
+
+void IntegrateEntityVelocities(EntityWorld& world, f32 deltaTime)
+{
+    ForEachEntityBatch(world, ENTITY_COMPONENT_POSITION | ENTITY_COMPONENT_VELOCITY, IntegrateVelocitiesBatch, &deltaTime);
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "math/math.h"
+#include "engine/job_system.h"
+#include "aabb.h"
+
+/*
+
+Storage for entities (mobs, dropped items etc.)
+
+Entities are grouped into archetypes by the set of components they have.
+Every archetype stores each of its components in its own tightly packed
+array (structure of arrays), so a system only touches the memory of the
+components it uses and there's no pointer per entity to chase.
+
+Entities are referred to with handles. A handle is an index into a slot
+table plus the generation of the slot, so handles to destroyed entities
+are detected even after the slot is reused. Adding an entity appends a
+row to its archetype, destroying one moves the last row of the archetype
+into the hole, both are O(1).
+
+Systems iterate archetypes in batches of rows. Batches never share rows,
+so they can be run on the job system at the same time.
+
+*/
+
+enum EntityComponent : u32
+{
+    ENTITY_COMPONENT_POSITION = (1 << 0),
+    ENTITY_COMPONENT_VELOCITY = (1 << 1),
+    ENTITY_COMPONENT_BOUNDS   = (1 << 2),
+    ENTITY_COMPONENT_MESH     = (1 << 3),
+};
+
+constexpr u32 ENTITY_COMPONENT_COUNT = 4;
+constexpr u32 ENTITY_ARCHETYPE_COUNT = (1 << ENTITY_COMPONENT_COUNT);   // One archetype for every set of components
+
+struct EntityHandle
+{
+    u32 index;                                  // Slot in the entity world's slot table
+    u32 generation;                             // 0 is never a valid generation
+
+    bool operator==(const EntityHandle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+    bool operator!=(const EntityHandle& rhs) const { return !(*this == rhs); }
+};
+
+constexpr EntityHandle NULL_ENTITY = { 0xFFFFFFFF, 0 };
+
+struct Mesh;
+
+// Entities that have the same components. Arrays of components the archetype doesn't have stay null.
+struct EntityArchetype
+{
+    u32 components;
+    u32 count;
+    u32 capacity;
+
+    EntityHandle* handles;                      // Handle of the entity in each row
+    Vector3*      positions;
+    Vector3*      velocities;
+    AABB*         bounds;                       // Relative to the position
+    const Mesh**  meshes;                       // Meshes are shared between entities
+};
+
+struct EntitySlot
+{
+    u32 generation;
+    u32 archetype;
+    u32 row;
+};
+
+struct EntityBatch;
+
+using EntityBatchFunction = void (*)(EntityBatch& batch);
+
+// Rows [begin, end) of an archetype
+struct EntityBatch
+{
+    EntityArchetype* archetype;
+    u32 begin, end;
+    void* data;                                 // Data passed to ForEachEntityBatch
+    EntityBatchFunction function;
+};
+
+struct EntityWorld
+{
+    EntityArchetype archetypes[ENTITY_ARCHETYPE_COUNT];
+
+    DynamicArray<EntitySlot> slots;
+    DynamicArray<u32> freeSlots;                // Slots of destroyed entities that can be reused
+    u32 entityCount;
+
+    DynamicArray<EntityBatch> batches;          // Scratch space for ForEachEntityBatch
+
+    void Create();
+    void Free();
+
+    EntityHandle CreateEntity(u32 components);
+    void DestroyEntity(EntityHandle entity);
+
+    bool IsAlive(EntityHandle entity) const;
+
+    // Return nullptr if the entity is dead or doesn't have the component.
+    // The pointers are only valid until the next entity is created or destroyed.
+    Vector3*     GetPosition(EntityHandle entity);
+    Vector3*     GetVelocity(EntityHandle entity);
+    AABB*        GetBounds(EntityHandle entity);
+    const Mesh** GetMesh(EntityHandle entity);
+};
+
+// Calls function on batches of at most batchSize rows of every archetype with all of the required components.
+// Batches are run in parallel on the job system and this only returns when all of them are done.
+void ForEachEntityBatch(EntityWorld& world, u32 requiredComponents, EntityBatchFunction function, void* data, u32 batchSize = 1024);
+
+// Moves every entity with a position and velocity
+void IntegrateEntityVelocities(EntityWorld& world, f32 deltaTime);
\ No newline at end of file
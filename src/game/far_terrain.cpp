@@ -0,0 +1,198 @@
+#include "far_terrain.h"
+
+#include "core/logging.h"
+#include "platform/platform.h"
+#include "voxel.h"
+#include "voxel_renderdata.h"
+#include "world_gen.h"
+
+constexpr s32 farTerrainQuadsPerAxis = FAR_TERRAIN_GRID_SIZE - 1;
+constexpr u32 maxFarTerrainFaceCount = farTerrainQuadsPerAxis * farTerrainQuadsPerAxis;
+
+void FarTerrain::Create(u32 count, s32 spacing)
+{
+    AssertWithMessage(CHUNK_SIZE % spacing == 0, "Far terrain spacing must divide the chunk size!");
+
+    levelCount = count;
+    baseSpacing = spacing;
+    meshedCenterChunk = { 0, 0, 0 };
+
+    levels = (FarTerrainLevel*) PlatformAllocate(levelCount * sizeof(FarTerrainLevel));
+    AssertWithMessage(levels != nullptr, "Couldn't allocate far terrain levels!");
+
+    for (u32 i = 0; i < levelCount; i++)
+    {
+        FarTerrainLevel& level = levels[i];
+
+        level.heights = (f32*) PlatformAllocate(FAR_TERRAIN_GRID_SIZE * FAR_TERRAIN_GRID_SIZE * sizeof(f32));
+        level.meshData = (VoxelVertex*) PlatformAllocate(4 * maxFarTerrainFaceCount * sizeof(VoxelVertex));
+        AssertWithMessage(level.heights && level.meshData, "Couldn't allocate far terrain level data!");
+
+        level.originX = level.originZ = 0;
+        level.hasHeights = false;
+        level.faceCount = 0;
+    }
+}
+
+void FarTerrain::Free()
+{
+    for (u32 i = 0; i < levelCount; i++)
+    {
+        PlatformFree(levels[i].heights);
+        PlatformFree(levels[i].meshData);
+    }
+
+    PlatformFree(levels);
+    levelCount = 0;
+}
+
+static inline f32& HeightAt(const FarTerrainLevel& level, s32 gx, s32 gz)
+{
+    const s32 x = Wrap(gx, 0, FAR_TERRAIN_GRID_SIZE);
+    const s32 z = Wrap(gz, 0, FAR_TERRAIN_GRID_SIZE);
+    return level.heights[x + z * FAR_TERRAIN_GRID_SIZE];
+}
+
+static void UpdateHeights(FarTerrainLevel& level, s32 spacing, s32 originX, s32 originZ, const WorldGenerator& generator)
+{
+    for (s32 gz = originZ; gz < originZ + FAR_TERRAIN_GRID_SIZE; gz++)
+    for (s32 gx = originX; gx < originX + FAR_TERRAIN_GRID_SIZE; gx++)
+    {
+        // Heights that were in the old window are still valid
+        if (level.hasHeights &&
+            gx >= level.originX && gx < level.originX + FAR_TERRAIN_GRID_SIZE &&
+            gz >= level.originZ && gz < level.originZ + FAR_TERRAIN_GRID_SIZE)
+            continue;
+
+        // Use the top of the voxel column so it lines up with the voxel terrain
+        const f32 height = generator.HeightAt((f32) (gx * spacing), (f32) (gz * spacing));
+        HeightAt(level, gx, gz) = Math::Floor(height) + 1.0f;
+    }
+
+    level.originX = originX;
+    level.originZ = originZ;
+    level.hasHeights = true;
+}
+
+// Heights on the edge of a level that fall between two heights of the next level
+// are averaged so the edge lines up with the coarser level and doesn't leave cracks
+static inline f32 EdgeHeight(const FarTerrainLevel& level, s32 gx, s32 gz, bool hasOuterLevel)
+{
+    if (hasOuterLevel)
+    {
+        const bool onXEdge = (gx == level.originX || gx == level.originX + farTerrainQuadsPerAxis);
+        const bool onZEdge = (gz == level.originZ || gz == level.originZ + farTerrainQuadsPerAxis);
+
+        if (onXEdge && (gz & 1))
+            return 0.5f * (HeightAt(level, gx, gz - 1) + HeightAt(level, gx, gz + 1));
+
+        if (onZEdge && (gx & 1))
+            return 0.5f * (HeightAt(level, gx - 1, gz) + HeightAt(level, gx + 1, gz));
+    }
+
+    return HeightAt(level, gx, gz);
+}
+
+static inline Vector3 NormalAt(const FarTerrainLevel& level, s32 spacing, s32 gx, s32 gz)
+{
+    const s32 maxX = level.originX + farTerrainQuadsPerAxis;
+    const s32 maxZ = level.originZ + farTerrainQuadsPerAxis;
+
+    const f32 left  = HeightAt(level, Max(gx - 1, level.originX), gz);
+    const f32 right = HeightAt(level, Min(gx + 1, maxX), gz);
+    const f32 back  = HeightAt(level, gx, Max(gz - 1, level.originZ));
+    const f32 front = HeightAt(level, gx, Min(gz + 1, maxZ));
+
+    return Vector3(left - right, 2.0f * spacing, back - front).Normalized();
+}
+
+static void UpdateMesh(FarTerrainLevel& level, const FarTerrainLevel* innerLevel, bool hasOuterLevel, s32 spacing, const VoxelChunkArea& area)
+{
+    constexpr f32 texCoordDimension = 1.0f / TEX_PACK_DIMENSION;
+
+    // Far terrain is all grass from above
+    const u32 texIndex = voxelTypeTextureIndices[(u32) BlockType::GRASS * 6 + (u32) VoxelFaceDirection::UP];
+    const u32 atlasX = texIndex % TEX_PACK_DIMENSION;
+    const u32 atlasY = TEX_PACK_DIMENSION - (texIndex / TEX_PACK_DIMENSION);
+    const Vector4 texCoords = { atlasX * texCoordDimension, atlasY * texCoordDimension, (atlasX + 1) * texCoordDimension, (atlasY - 1) * texCoordDimension };
+
+    s32 innerMinX = 0, innerMinZ = 0, innerMaxX = 0, innerMaxZ = 0;
+    if (innerLevel)
+    {
+        const s32 innerSpacing = spacing / 2;
+        innerMinX = innerLevel->originX * innerSpacing;
+        innerMinZ = innerLevel->originZ * innerSpacing;
+        innerMaxX = (innerLevel->originX + farTerrainQuadsPerAxis) * innerSpacing;
+        innerMaxZ = (innerLevel->originZ + farTerrainQuadsPerAxis) * innerSpacing;
+    }
+
+    VoxelVertex* voxelVertexPtr = level.meshData;
+    level.faceCount = 0;
+
+    for (s32 qz = level.originZ; qz < level.originZ + farTerrainQuadsPerAxis; qz++)
+    for (s32 qx = level.originX; qx < level.originX + farTerrainQuadsPerAxis; qx++)
+    {
+        const s32 minX = qx * spacing;
+        const s32 minZ = qz * spacing;
+
+        if (innerLevel)
+        {
+            // Skip quads covered by the level inside this one
+            if (minX >= innerMinX && minX + spacing <= innerMaxX &&
+                minZ >= innerMinZ && minZ + spacing <= innerMaxZ)
+                continue;
+        }
+        else
+        {
+            // Skip quads over chunk columns the voxel area loads
+            const s32 chunkX = (s32) Math::Floor((f32) minX / CHUNK_SIZE);
+            const s32 chunkZ = (s32) Math::Floor((f32) minZ / CHUNK_SIZE);
+            if (area.loadShape.ContainsColumn(area.centerChunk, chunkX, chunkZ))
+                continue;
+        }
+
+        const f32 x0 = (f32) minX, x1 = (f32) (minX + spacing);
+        const f32 z0 = (f32) minZ, z1 = (f32) (minZ + spacing);
+
+        // Same winding as the up face of a voxel
+        voxelVertexPtr[0] = { Vector3(x0, EdgeHeight(level, qx,     qz + 1, hasOuterLevel), z1), NormalAt(level, spacing, qx,     qz + 1), { texCoords.u, texCoords.v }, 1.0f };
+        voxelVertexPtr[1] = { Vector3(x1, EdgeHeight(level, qx + 1, qz + 1, hasOuterLevel), z1), NormalAt(level, spacing, qx + 1, qz + 1), { texCoords.s, texCoords.v }, 1.0f };
+        voxelVertexPtr[2] = { Vector3(x1, EdgeHeight(level, qx + 1, qz,     hasOuterLevel), z0), NormalAt(level, spacing, qx + 1, qz),     { texCoords.s, texCoords.t }, 1.0f };
+        voxelVertexPtr[3] = { Vector3(x0, EdgeHeight(level, qx,     qz,     hasOuterLevel), z0), NormalAt(level, spacing, qx,     qz),     { texCoords.u, texCoords.t }, 1.0f };
+
+        voxelVertexPtr += 4;
+        level.faceCount++;
+    }
+}
+
+void FarTerrain::Update(const WorldGenerator& generator, const VoxelChunkArea& area, const Vector3& position)
+{
+    // The innermost level's hole follows the voxel area
+    bool innerChanged = (area.centerChunk != meshedCenterChunk);
+    meshedCenterChunk = area.centerChunk;
+
+    for (u32 i = 0; i < levelCount; i++)
+    {
+        FarTerrainLevel& level = levels[i];
+        const s32 spacing = baseSpacing << i;
+
+        // Origins are kept on even grid positions so the edges of
+        // a level land on the heights of the next level
+        s32 originX = (s32) Math::Floor(position.x / spacing) - farTerrainQuadsPerAxis / 2;
+        s32 originZ = (s32) Math::Floor(position.z / spacing) - farTerrainQuadsPerAxis / 2;
+        originX -= (originX & 1);
+        originZ -= (originZ & 1);
+
+        const bool moved = !level.hasHeights || originX != level.originX || originZ != level.originZ;
+        if (moved)
+            UpdateHeights(level, spacing, originX, originZ, generator);
+
+        if (moved || innerChanged)
+        {
+            const FarTerrainLevel* innerLevel = (i > 0) ? &levels[i - 1] : nullptr;
+            UpdateMesh(level, innerLevel, i + 1 < levelCount, spacing, area);
+        }
+
+        innerChanged = moved;
+    }
+}
\ No newline at end of file
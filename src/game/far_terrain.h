@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+
+Far terrain is drawn beyond the voxel area straight from the terrain
+heightmap, without storing any voxels.
+
+It's a clipmap: a few nested levels of height grids centered on the player
+where every level has twice the spacing of the one inside it. Each level
+skips the area covered by the level inside it, and the innermost level
+skips the chunk columns that the voxel area loads.
+
+Heights are cached in a toroidal buffer per level, so when the player moves
+only the rows and columns that came into view are sampled. All the memory
+is allocated up front in Create.
+
+*/
+
+#include "core/types.h"
+#include "math/math.h"
+#include "chunk_area.h"
+
+struct VoxelVertex;
+struct WorldGenerator;
+
+constexpr s32 FAR_TERRAIN_GRID_SIZE = 65;      // Heights along each axis of a level, must be odd
+
+struct FarTerrainLevel
+{
+    f32* heights;                               // Heights indexed by grid position wrapped to the grid size
+    s32 originX, originZ;                       // Grid position of the first cached height
+    bool hasHeights;                            // If the cached heights are valid
+
+    VoxelVertex* meshData;                      // Quads for the part of the level that is drawn
+    u32 faceCount;
+};
+
+struct FarTerrain
+{
+    FarTerrainLevel* levels;
+    u32 levelCount;
+    s32 baseSpacing;                            // Distance between heights on the innermost level
+
+    Vector3Int meshedCenterChunk;               // Voxel area center the innermost level was meshed around
+
+    // baseSpacing must divide CHUNK_SIZE so the innermost level lines up with chunks
+    void Create(u32 levelCount, s32 baseSpacing);
+    void Free();
+
+    // Samples heights that came into view and rebuilds the meshes of levels that moved
+    void Update(const WorldGenerator& generator, const VoxelChunkArea& area, const Vector3& position);
+};
\ No newline at end of file
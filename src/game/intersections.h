@@ -10,7 +10,7 @@ struct IntersectionResult
     f32 tmax =  Math::Infinity;
 };
 
-bool Intersection(const AABB& aabb, const Vector3& rayOrigin, const Vector3& invRayDir, IntersectionResult& hit, f32 maxDistance = Math::Infinity)
+inline bool Intersection(const AABB& aabb, const Vector3& rayOrigin, const Vector3& invRayDir, IntersectionResult& hit, f32 maxDistance = Math::Infinity)
 {
     {   // Check with X axis
         const f32 t1 = (aabb.min.x - rayOrigin.x) * invRayDir.x;
@@ -43,4 +43,22 @@ bool Intersection(const AABB& aabb, const Vector3& rayOrigin, const Vector3& inv
     }
 
     return hit.tmax >= Max(hit.tmin, 0.0f) && hit.tmin <= maxDistance;
+}
+
+// Boxes that only touch don't count as intersecting
+inline bool Intersection(const AABB& a, const AABB& b)
+{
+    return a.min.x < b.max.x && a.max.x > b.min.x &&
+           a.min.y < b.max.y && a.max.y > b.min.y &&
+           a.min.z < b.max.z && a.max.z > b.min.z;
+}
+
+inline bool Intersection(const AABB& aabb, const Vector3& sphereCenter, f32 sphereRadius)
+{
+    // Distance from the center of the sphere to the closest point in the box
+    const f32 dx = sphereCenter.x - Clamp(sphereCenter.x, aabb.min.x, aabb.max.x);
+    const f32 dy = sphereCenter.y - Clamp(sphereCenter.y, aabb.min.y, aabb.max.y);
+    const f32 dz = sphereCenter.z - Clamp(sphereCenter.z, aabb.min.z, aabb.max.z);
+
+    return dx * dx + dy * dy + dz * dz <= sphereRadius * sphereRadius;
 }
\ No newline at end of file
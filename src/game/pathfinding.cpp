@@ -0,0 +1,973 @@
+#include "pathfinding.h"
+
+#include "core/logging.h"
+#include "containers/darray.h"
+#include "containers/hashtable.h"
+#include "engine/job_system.h"
+#include "math/common.h"
+#include "platform/platform.h"
+#include "chunk_area.h"
+#include "voxel_physics.h"
+
+constexpr u32 CHUNK_VOXEL_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+constexpr u32 MAX_CHUNK_NODES = 64;                 // Portals past this are dropped, the chunk is just harder to get through
+constexpr u32 MAX_CHUNK_LINKS = 128;
+constexpr u32 NODE_BITS = 6;                        // Abstract node ids are (chunk index << NODE_BITS) | node
+
+constexpr u16 UNREACHABLE = 0xFFFF;
+constexpr u32 NO_NODE = 0xFFFFFFFF;
+constexpr u32 START_NODE = 0xFFFFFFFE;
+
+constexpr u32 maxChunkBuildsPerFrame = 8;
+constexpr u32 maxExpandedNodes = 16384;             // Queries give up after this many abstract nodes
+
+// Chunks a single move can end up in (one horizontal step and at most one block up or down)
+static const Vector3Int portalOffsets[] = {
+    {  1, -1,  0 }, {  1,  0,  0 }, {  1,  1,  0 },
+    { -1, -1,  0 }, { -1,  0,  0 }, { -1,  1,  0 },
+    {  0, -1,  1 }, {  0,  0,  1 }, {  0,  1,  1 },
+    {  0, -1, -1 }, {  0,  0, -1 }, {  0,  1, -1 },
+    {  0,  1,  0 }, {  0, -1,  0 },
+};
+
+static const s32 moveDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+// Move from a node to a voxel in a neighbouring chunk
+struct PathLink
+{
+    u32 node;
+    Vector3Int target;                              // World position
+};
+
+struct PathChunk
+{
+    Vector3Int coord;
+
+    u32 standable[CHUNK_SIZE * CHUNK_SIZE];         // Bit y of column x + z * CHUNK_SIZE: an agent can stand in the voxel
+    u32 jumpable[CHUNK_SIZE * CHUNK_SIZE];          // Bit y: an agent can stand in the voxel and has room to step a block up
+
+    u32 nodeCount;
+    u32 linkCount;
+    Vector3Int nodes[MAX_CHUNK_NODES];              // Position in the chunk of every portal on this side
+    PathLink links[MAX_CHUNK_LINKS];
+    u16 costs[MAX_CHUNK_NODES * MAX_CHUNK_NODES];   // Walking distance between every two nodes without leaving the chunk
+};
+
+// A move across a chunk border, a is in the first chunk and b in the second (both relative to their chunks)
+struct PathTransition
+{
+    Vector3Int a, b;
+};
+
+struct PathRequest
+{
+    PathQuery query;
+    Vector3Int start, goal;
+};
+
+// Query running on the job system. Only the job writes to it until UpdatePathfinding picks it up.
+struct PathJob
+{
+    PathQuery query;
+    Vector3Int start, goal;
+
+    PathStatus status;
+    Vector3Int* path;
+    u32 pathLength;
+
+    bool released;                                  // Result isn't wanted anymore
+};
+
+struct PathResult
+{
+    PathStatus status;
+    Vector3Int* path;
+    u32 pathLength;
+};
+
+static struct
+{
+    DynamicArray<PathChunk*> chunks;                // Null for unused indices
+    DynamicArray<u32> freeChunks;
+    HashTable<ChunkKey, u32> chunkIndices;
+
+    DynamicArray<Vector3Int> dirtyChunks;           // Chunks that had blocks changed
+    DynamicArray<Vector3Int> changedChunks;         // Chunks whose portals have to be found again
+
+    DynamicArray<PathRequest> requests;
+    DynamicArray<PathJob> jobs;
+    HashTable<u32, PathResult> results;
+    JobSystem::JobCounter jobCounter;
+    PathQuery nextQuery = 1;
+
+    // Scratch space for building chunks, only used on the main thread
+    DynamicArray<PathTransition> transitions;
+    DynamicArray<PathTransition> portals;
+    u16 transitionGrid[CHUNK_SIZE * CHUNK_SIZE];
+    u16 gridQueue[CHUNK_SIZE * CHUNK_SIZE];
+    u16 distances[CHUNK_VOXEL_COUNT];
+    u16 queue[CHUNK_VOXEL_COUNT];
+} pathData;
+
+static inline s32 FloorDivChunk(s32 a)
+{
+    return (a >= 0) ? a / (s32) CHUNK_SIZE : (a + 1) / (s32) CHUNK_SIZE - 1;
+}
+
+static inline Vector3Int WorldToChunkCoord(const Vector3Int& position)
+{
+    return Vector3Int { FloorDivChunk(position.x), FloorDivChunk(position.y), FloorDivChunk(position.z) };
+}
+
+static inline Vector3Int ChunkOrigin(const Vector3Int& coord)
+{
+    return Vector3Int { coord.x * (s32) CHUNK_SIZE, coord.y * (s32) CHUNK_SIZE, coord.z * (s32) CHUNK_SIZE };
+}
+
+static inline u16 VoxelIndex(const Vector3Int& position)
+{
+    return (u16) (position.x + position.y * CHUNK_SIZE + position.z * CHUNK_SIZE * CHUNK_SIZE);
+}
+
+static inline Vector3Int VoxelPosition(u16 index)
+{
+    return Vector3Int { (s32) (index % CHUNK_SIZE), (s32) ((index / CHUNK_SIZE) % CHUNK_SIZE), (s32) (index / (CHUNK_SIZE * CHUNK_SIZE)) };
+}
+
+static inline bool IsInChunk(const Vector3Int& position)
+{
+    return (u32) position.x < CHUNK_SIZE && (u32) position.y < CHUNK_SIZE && (u32) position.z < CHUNK_SIZE;
+}
+
+static inline bool IsStandable(const PathChunk& chunk, const Vector3Int& position)
+{
+    return (chunk.standable[position.x + position.z * CHUNK_SIZE] >> position.y) & 1;
+}
+
+static inline bool IsJumpable(const PathChunk& chunk, const Vector3Int& position)
+{
+    return (chunk.jumpable[position.x + position.z * CHUNK_SIZE] >> position.y) & 1;
+}
+
+// Moves are symmetric, stepping up needs room above the lower voxel and stepping down needs the same room
+static inline bool CanMove(const PathChunk& fromChunk, const Vector3Int& from, const PathChunk& toChunk, const Vector3Int& to, s32 dy)
+{
+    if (dy == 0)
+        return IsStandable(fromChunk, from) && IsStandable(toChunk, to);
+
+    if (dy > 0)
+        return IsJumpable(fromChunk, from) && IsStandable(toChunk, to);
+
+    return IsStandable(fromChunk, from) && IsJumpable(toChunk, to);
+}
+
+static u32 FindPathChunkIndex(const Vector3Int& coord)
+{
+    auto it = pathData.chunkIndices.Find(PackChunkCoord(coord));
+    return it ? it.value() : NO_NODE;
+}
+
+static const PathChunk* FindPathChunk(const Vector3Int& coord)
+{
+    const u32 index = FindPathChunkIndex(coord);
+    return (index != NO_NODE) ? pathData.chunks[index] : nullptr;
+}
+
+// Breadth first search inside a chunk, every move costs 1.
+// Stops early once target is reached if it's given. parents can be null if the path isn't needed.
+static void SearchChunk(const PathChunk& chunk, const Vector3Int& from, const Vector3Int* target, u16* distances, u16* parents, u16* queue)
+{
+    PlatformSetMemory(distances, 0xFF, CHUNK_VOXEL_COUNT * sizeof(u16));
+
+    if (!IsStandable(chunk, from))
+        return;
+
+    u32 head = 0, tail = 0;
+
+    const u16 fromIndex = VoxelIndex(from);
+    distances[fromIndex] = 0;
+    queue[tail++] = fromIndex;
+
+    const u16 targetIndex = (target) ? VoxelIndex(*target) : 0;
+
+    while (head < tail)
+    {
+        const u16 index = queue[head++];
+        if (target && index == targetIndex)
+            return;
+
+        const Vector3Int position = VoxelPosition(index);
+
+        for (u32 d = 0; d < 4; d++)
+        for (s32 dy = -1; dy <= 1; dy++)
+        {
+            const Vector3Int next = position + Vector3Int { moveDirections[d][0], dy, moveDirections[d][1] };
+            if (!IsInChunk(next))
+                continue;
+
+            const u16 nextIndex = VoxelIndex(next);
+            if (distances[nextIndex] != UNREACHABLE || !CanMove(chunk, position, chunk, next, dy))
+                continue;
+
+            distances[nextIndex] = distances[index] + 1;
+            if (parents)
+                parents[nextIndex] = index;
+
+            queue[tail++] = nextIndex;
+        }
+    }
+}
+
+static void ExtractStandableVoxels(PathChunk& chunk, const VoxelChunkArea& area)
+{
+    VoxelQuery query(area);
+
+    const Vector3Int origin = ChunkOrigin(chunk.coord);
+    const u32 slot = area.chunkMap.Find(chunk.coord);
+    const VoxelChunk* blocks = (IsValidChunkSlot(slot)) ? &area.chunks[slot] : nullptr;
+
+    for (u32 z = 0; z < CHUNK_SIZE; z++)
+    for (u32 x = 0; x < CHUNK_SIZE; x++)
+    {
+        // Bit i is set if the block at y = i - 1 is solid, the chunk and the blocks right below and above it
+        u64 solid = 0;
+
+        const s32 wx = origin.x + (s32) x;
+        const s32 wz = origin.z + (s32) z;
+
+        solid |= (u64) query.IsSolid(wx, origin.y - 1, wz);
+
+        if (blocks)
+        {
+            for (u32 y = 0; y < CHUNK_SIZE; y++)
+                solid |= (u64) VoxelBlockIsSolid(blocks->at(x, y, z)) << (y + 1);
+        }
+
+        for (u32 y = CHUNK_SIZE; y < CHUNK_SIZE + 3; y++)
+            solid |= (u64) query.IsSolid(wx, origin.y + (s32) y, wz) << (y + 1);
+
+        // Standing in y needs ground at y - 1 and room for the feet and the head
+        const u64 standable = solid & ~(solid >> 1) & ~(solid >> 2);
+        const u64 jumpable  = standable & ~(solid >> 3);
+
+        chunk.standable[x + z * CHUNK_SIZE] = (u32) standable;
+        chunk.jumpable[x + z * CHUNK_SIZE]  = (u32) jumpable;
+    }
+}
+
+// Finds the portals between chunk a and its neighbour b at offset.
+// Moves are grouped by where they leave chunk a and one in the middle of every connected group becomes a portal.
+static void FindPortals(const PathChunk& a, const PathChunk& b, const Vector3Int& offset, DynamicArray<PathTransition>& portals)
+{
+    DynamicArray<PathTransition>& transitions = pathData.transitions;
+    u16* grid = pathData.transitionGrid;
+
+    transitions.Clear(false);
+    PlatformSetMemory(grid, 0, sizeof(pathData.transitionGrid));
+
+    const Vector3Int shift = ChunkOrigin(offset);
+
+    // Voxels of chunk a moves to b can start from
+    const s32 minX = (offset.x > 0) ? CHUNK_SIZE - 1 : 0, maxX = (offset.x < 0) ? 0 : CHUNK_SIZE - 1;
+    const s32 minY = (offset.y > 0) ? CHUNK_SIZE - 1 : 0, maxY = (offset.y < 0) ? 0 : CHUNK_SIZE - 1;
+    const s32 minZ = (offset.z > 0) ? CHUNK_SIZE - 1 : 0, maxZ = (offset.z < 0) ? 0 : CHUNK_SIZE - 1;
+
+    for (s32 z = minZ; z <= maxZ; z++)
+    for (s32 y = minY; y <= maxY; y++)
+    for (s32 x = minX; x <= maxX; x++)
+    {
+        const Vector3Int from = { x, y, z };
+        if (!IsStandable(a, from))
+            continue;
+
+        // Moves are grouped on the face they leave through, indexed by the two axes along the face
+        const u32 key = (offset.x != 0) ? (u32) (y + z * CHUNK_SIZE)
+                      : (offset.z != 0) ? (u32) (y + x * CHUNK_SIZE)
+                      :                   (u32) (x + z * CHUNK_SIZE);
+
+        if (grid[key])
+            continue;
+
+        for (u32 d = 0; d < 4 && !grid[key]; d++)
+        for (s32 dy = -1; dy <= 1 && !grid[key]; dy++)
+        {
+            const Vector3Int to = from + Vector3Int { moveDirections[d][0], dy, moveDirections[d][1] } - shift;
+            if (!IsInChunk(to))
+                continue;
+
+            if (!CanMove(a, from, b, to, dy))
+                continue;
+
+            transitions.PushBack({ from, to });
+            grid[key] = (u16) transitions.size();
+        }
+    }
+
+    // Flood fill the face to group moves that are next to each other
+    constexpr u16 VISITED = 0x8000;
+    u16* queue = pathData.gridQueue;
+
+    for (u32 key = 0; key < CHUNK_SIZE * CHUNK_SIZE; key++)
+    {
+        if (!grid[key] || (grid[key] & VISITED))
+            continue;
+
+        u32 head = 0, tail = 0;
+        queue[tail++] = (u16) key;
+        grid[key] |= VISITED;
+
+        while (head < tail)
+        {
+            const s32 u = (s32) (queue[head] % CHUNK_SIZE);
+            const s32 v = (s32) (queue[head] / CHUNK_SIZE);
+            head++;
+
+            for (s32 dv = -1; dv <= 1; dv++)
+            for (s32 du = -1; du <= 1; du++)
+            {
+                const s32 nu = u + du, nv = v + dv;
+                if (nu < 0 || nv < 0 || nu >= (s32) CHUNK_SIZE || nv >= (s32) CHUNK_SIZE)
+                    continue;
+
+                const u32 next = (u32) (nu + nv * CHUNK_SIZE);
+                if (!grid[next] || (grid[next] & VISITED))
+                    continue;
+
+                grid[next] |= VISITED;
+                queue[tail++] = (u16) next;
+            }
+        }
+
+        // The move halfway through the group in fill order ends up somewhere in the middle of it
+        const u16 middle = grid[queue[tail / 2]] & ~VISITED;
+        portals.PushBack(transitions[middle - 1]);
+    }
+}
+
+static u32 AddNode(PathChunk& chunk, const Vector3Int& position)
+{
+    for (u32 i = 0; i < chunk.nodeCount; i++)
+    {
+        if (chunk.nodes[i] == position)
+            return i;
+    }
+
+    if (chunk.nodeCount == MAX_CHUNK_NODES)
+        return NO_NODE;
+
+    chunk.nodes[chunk.nodeCount] = position;
+    return chunk.nodeCount++;
+}
+
+// Finds the portals to every neighbouring chunk and the distances between them
+static void BuildChunkNodes(PathChunk& chunk)
+{
+    chunk.nodeCount = 0;
+    chunk.linkCount = 0;
+
+    const ChunkKey key = PackChunkCoord(chunk.coord);
+
+    for (const Vector3Int& offset : portalOffsets)
+    {
+        const PathChunk* neighbour = FindPathChunk(chunk.coord + offset);
+        if (!neighbour)
+            continue;
+
+        // Portals are always found from the chunk with the lower key so both sides agree on them
+        DynamicArray<PathTransition>& portals = pathData.portals;
+        portals.Clear(false);
+
+        const bool isLower = key < PackChunkCoord(neighbour->coord);
+        if (isLower)
+            FindPortals(chunk, *neighbour, offset, portals);
+        else
+            FindPortals(*neighbour, chunk, Vector3Int { 0, 0, 0 } - offset, portals);
+
+        const Vector3Int neighbourOrigin = ChunkOrigin(neighbour->coord);
+
+        for (u64 i = 0; i < portals.size() && chunk.linkCount < MAX_CHUNK_LINKS; i++)
+        {
+            const Vector3Int here  = (isLower) ? portals[i].a : portals[i].b;
+            const Vector3Int there = (isLower) ? portals[i].b : portals[i].a;
+
+            const u32 node = AddNode(chunk, here);
+            if (node == NO_NODE)
+                break;
+
+            chunk.links[chunk.linkCount++] = { node, neighbourOrigin + there };
+        }
+    }
+
+    for (u32 i = 0; i < chunk.nodeCount; i++)
+    {
+        SearchChunk(chunk, chunk.nodes[i], nullptr, pathData.distances, nullptr, pathData.queue);
+
+        for (u32 j = 0; j < chunk.nodeCount; j++)
+            chunk.costs[i * MAX_CHUNK_NODES + j] = pathData.distances[VoxelIndex(chunk.nodes[j])];
+    }
+}
+
+static void AddChunkAndNeighbours(DynamicArray<Vector3Int>& array, const Vector3Int& coord)
+{
+    AddIfNotPresent(array, coord);
+
+    for (const Vector3Int& offset : portalOffsets)
+        AddIfNotPresent(array, coord + offset);
+}
+
+static void RemovePathChunk(u32 index)
+{
+    PathChunk* chunk = pathData.chunks[index];
+
+    pathData.chunkIndices.Remove(PackChunkCoord(chunk->coord));
+    AddChunkAndNeighbours(pathData.changedChunks, chunk->coord);
+
+    PlatformFree(chunk);
+    pathData.chunks[index] = nullptr;
+    pathData.freeChunks.PushBack(index);
+}
+
+static void AddPathChunk(const VoxelChunkArea& area, const Vector3Int& coord)
+{
+    u32 index;
+    if (pathData.freeChunks.size() > 0)
+    {
+        index = pathData.freeChunks[pathData.freeChunks.size() - 1];
+        pathData.freeChunks.PopBack();
+    }
+    else
+    {
+        index = (u32) pathData.chunks.size();
+        pathData.chunks.PushBack(nullptr);
+    }
+
+    PathChunk* chunk = (PathChunk*) PlatformAllocate(sizeof(PathChunk));
+    chunk->coord = coord;
+    chunk->nodeCount = 0;
+    chunk->linkCount = 0;
+    ExtractStandableVoxels(*chunk, area);
+
+    pathData.chunks[index] = chunk;
+    pathData.chunkIndices.Place(PackChunkCoord(coord), index);
+    AddChunkAndNeighbours(pathData.changedChunks, coord);
+}
+
+static bool IsFullResolution(const VoxelChunkArea& area, const Vector3Int& coord)
+{
+    const u32 slot = area.chunkMap.Find(coord);
+    if (slot == NO_CHUNK_SLOT)
+        return false;
+
+    return area.loadShape.LODAt(area.centerChunk, coord) == 0 && (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() == CHUNK_SIZE);
+}
+
+static bool HasUnbuiltNeighbours(const VoxelChunkArea& area, const Vector3Int& coord)
+{
+    for (const Vector3Int& offset : portalOffsets)
+    {
+        const Vector3Int neighbour = coord + offset;
+        if (FindPathChunkIndex(neighbour) == NO_NODE && IsFullResolution(area, neighbour))
+            return true;
+    }
+
+    return false;
+}
+
+/* Queries (run on the job system) */
+
+struct OpenNode
+{
+    f32 f;
+    u32 id;
+};
+
+struct NodeState
+{
+    f32 g;
+    u32 parent;
+    bool closed;
+};
+
+// Scratch space of a query
+struct PathSearch
+{
+    u16* distances;
+    u16* parents;
+    u16* queue;
+    DynamicArray<Vector3Int> path;
+};
+
+static inline f32 PathHeuristic(const Vector3Int& a, const Vector3Int& b)
+{
+    // Every move goes one block sideways and at most one block up or down
+    const s32 horizontal = Abs(a.x - b.x) + Abs(a.z - b.z);
+    return (f32) Max(horizontal, Abs(a.y - b.y));
+}
+
+static inline Vector3Int NodeWorldPosition(u32 id)
+{
+    const PathChunk& chunk = *pathData.chunks[id >> NODE_BITS];
+    return ChunkOrigin(chunk.coord) + chunk.nodes[id & ((1 << NODE_BITS) - 1)];
+}
+
+static void PushOpen(DynamicArray<OpenNode>& heap, OpenNode node)
+{
+    u64 i = heap.size();
+    heap.PushBack(node);
+
+    while (i > 0)
+    {
+        const u64 parent = (i - 1) / 2;
+        if (heap[parent].f <= heap[i].f)
+            break;
+
+        const OpenNode temp = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = temp;
+        i = parent;
+    }
+}
+
+static OpenNode PopOpen(DynamicArray<OpenNode>& heap)
+{
+    const OpenNode top = heap[0];
+    heap[0] = heap[heap.size() - 1];
+    heap.PopBack();
+
+    u64 i = 0;
+    while (true)
+    {
+        const u64 left = 2 * i + 1, right = left + 1;
+        u64 smallest = i;
+
+        if (left < heap.size() && heap[left].f < heap[smallest].f)
+            smallest = left;
+        if (right < heap.size() && heap[right].f < heap[smallest].f)
+            smallest = right;
+
+        if (smallest == i)
+            break;
+
+        const OpenNode temp = heap[smallest];
+        heap[smallest] = heap[i];
+        heap[i] = temp;
+        i = smallest;
+    }
+
+    return top;
+}
+
+// Appends the voxels from one voxel to another in the same chunk to the path, the first one excluded
+static bool AppendChunkPath(PathSearch& search, const PathChunk& chunk, const Vector3Int& from, const Vector3Int& to)
+{
+    SearchChunk(chunk, from, &to, search.distances, search.parents, search.queue);
+
+    const u16 toIndex = VoxelIndex(to);
+    const u16 length = search.distances[toIndex];
+    if (length == UNREACHABLE)
+        return false;
+
+    // Walk back from the target and flip the voxels that were added
+    const u64 begin = search.path.size();
+    const Vector3Int origin = ChunkOrigin(chunk.coord);
+
+    for (u16 index = toIndex; search.path.size() < begin + length; index = search.parents[index])
+        search.path.PushBack(origin + VoxelPosition(index));
+
+    for (u64 i = begin, j = search.path.size() - 1; i < j; i++, j--)
+    {
+        const Vector3Int temp = search.path[i];
+        search.path[i] = search.path[j];
+        search.path[j] = temp;
+    }
+
+    return true;
+}
+
+static PathStatus FindPath(PathSearch& search, const Vector3Int& start, const Vector3Int& goal)
+{
+    const Vector3Int startCoord = WorldToChunkCoord(start);
+    const Vector3Int goalCoord  = WorldToChunkCoord(goal);
+
+    const u32 startChunkIndex = FindPathChunkIndex(startCoord);
+    const u32 goalChunkIndex  = FindPathChunkIndex(goalCoord);
+    if (startChunkIndex == NO_NODE || goalChunkIndex == NO_NODE)
+        return PathStatus::NOT_FOUND;
+
+    const PathChunk& startChunk = *pathData.chunks[startChunkIndex];
+    const PathChunk& goalChunk  = *pathData.chunks[goalChunkIndex];
+
+    const Vector3Int startLocal = start - ChunkOrigin(startCoord);
+    const Vector3Int goalLocal  = goal - ChunkOrigin(goalCoord);
+
+    if (!IsStandable(startChunk, startLocal) || !IsStandable(goalChunk, goalLocal))
+        return PathStatus::NOT_FOUND;
+
+    search.path.Clear(false);
+    search.path.PushBack(start);
+
+    // Most short paths never leave the chunk
+    if (startChunkIndex == goalChunkIndex && AppendChunkPath(search, startChunk, startLocal, goalLocal))
+        return PathStatus::FOUND;
+
+    // Distances from the goal to the nodes of its chunk
+    u16 goalCosts[MAX_CHUNK_NODES];
+    SearchChunk(goalChunk, goalLocal, nullptr, search.distances, nullptr, search.queue);
+    for (u32 i = 0; i < goalChunk.nodeCount; i++)
+        goalCosts[i] = search.distances[VoxelIndex(goalChunk.nodes[i])];
+
+    DynamicArray<OpenNode> open;
+    HashTable<u32, NodeState> states;
+
+    {   // Start from every node the start can walk to
+        SearchChunk(startChunk, startLocal, nullptr, search.distances, nullptr, search.queue);
+
+        for (u32 i = 0; i < startChunk.nodeCount; i++)
+        {
+            const u16 cost = search.distances[VoxelIndex(startChunk.nodes[i])];
+            if (cost == UNREACHABLE)
+                continue;
+
+            const u32 id = (startChunkIndex << NODE_BITS) | i;
+            states[id] = { (f32) cost, START_NODE, false };
+            PushOpen(open, { (f32) cost + PathHeuristic(NodeWorldPosition(id), goal), id });
+        }
+    }
+
+    f32 bestGoal = Math::Infinity;
+    u32 bestGoalParent = NO_NODE;
+    u32 expanded = 0;
+
+    while (open.size() > 0 && expanded < maxExpandedNodes)
+    {
+        const OpenNode current = PopOpen(open);
+        if (current.f >= bestGoal)
+            break;
+
+        NodeState& state = states[current.id];
+        if (state.closed)
+            continue;
+
+        state.closed = true;
+        expanded++;
+
+        const f32 g = state.g;
+        const u32 chunkIndex = current.id >> NODE_BITS;
+        const u32 node = current.id & ((1 << NODE_BITS) - 1);
+        const PathChunk& chunk = *pathData.chunks[chunkIndex];
+
+        if (chunkIndex == goalChunkIndex && goalCosts[node] != UNREACHABLE && g + goalCosts[node] < bestGoal)
+        {
+            bestGoal = g + goalCosts[node];
+            bestGoalParent = current.id;
+        }
+
+        // Walking to the other nodes of the chunk
+        for (u32 i = 0; i < chunk.nodeCount; i++)
+        {
+            const u16 cost = chunk.costs[node * MAX_CHUNK_NODES + i];
+            if (i == node || cost == UNREACHABLE)
+                continue;
+
+            const u32 id = (chunkIndex << NODE_BITS) | i;
+
+            auto it = states.Find(id);
+            if (it && (it.value().closed || it.value().g <= g + cost))
+                continue;
+
+            states[id] = { g + cost, current.id, false };
+            PushOpen(open, { g + cost + PathHeuristic(NodeWorldPosition(id), goal), id });
+        }
+
+        // Crossing into the neighbouring chunks
+        for (u32 i = 0; i < chunk.linkCount; i++)
+        {
+            const PathLink& link = chunk.links[i];
+            if (link.node != node)
+                continue;
+
+            const Vector3Int targetCoord = WorldToChunkCoord(link.target);
+            const u32 targetChunkIndex = FindPathChunkIndex(targetCoord);
+            if (targetChunkIndex == NO_NODE)
+                continue;
+
+            const PathChunk& targetChunk = *pathData.chunks[targetChunkIndex];
+            const Vector3Int targetLocal = link.target - ChunkOrigin(targetCoord);
+
+            u32 targetNode = NO_NODE;
+            for (u32 j = 0; j < targetChunk.nodeCount; j++)
+            {
+                if (targetChunk.nodes[j] == targetLocal)
+                {
+                    targetNode = j;
+                    break;
+                }
+            }
+
+            if (targetNode == NO_NODE)
+                continue;
+
+            const u32 id = (targetChunkIndex << NODE_BITS) | targetNode;
+
+            auto it = states.Find(id);
+            if (it && (it.value().closed || it.value().g <= g + 1.0f))
+                continue;
+
+            states[id] = { g + 1.0f, current.id, false };
+            PushOpen(open, { g + 1.0f + PathHeuristic(link.target, goal), id });
+        }
+    }
+
+    if (bestGoalParent == NO_NODE)
+        return PathStatus::NOT_FOUND;
+
+    // Nodes from the goal back to the start
+    DynamicArray<u32> nodes;
+    for (u32 id = bestGoalParent; id != START_NODE; id = states[id].parent)
+        nodes.PushBack(id);
+
+    {   // Fill in the voxels between the nodes
+        const PathChunk* previousChunk = &startChunk;
+        Vector3Int previous = startLocal;
+
+        for (u64 i = nodes.size(); i > 0; i--)
+        {
+            const u32 id = nodes[i - 1];
+            const PathChunk& chunk = *pathData.chunks[id >> NODE_BITS];
+            const Vector3Int local = chunk.nodes[id & ((1 << NODE_BITS) - 1)];
+
+            if (&chunk == previousChunk)
+            {
+                if (!AppendChunkPath(search, chunk, previous, local))
+                    return PathStatus::NOT_FOUND;
+            }
+            else
+                search.path.PushBack(ChunkOrigin(chunk.coord) + local);
+
+            previousChunk = &chunk;
+            previous = local;
+        }
+
+        if (!AppendChunkPath(search, goalChunk, previous, goalLocal))
+            return PathStatus::NOT_FOUND;
+    }
+
+    return PathStatus::FOUND;
+}
+
+static void PathJobFunction(void* data)
+{
+    PathJob& job = *(PathJob*) data;
+
+    PathSearch search;
+    search.distances = (u16*) PlatformAllocate(CHUNK_VOXEL_COUNT * sizeof(u16));
+    search.parents   = (u16*) PlatformAllocate(CHUNK_VOXEL_COUNT * sizeof(u16));
+    search.queue     = (u16*) PlatformAllocate(CHUNK_VOXEL_COUNT * sizeof(u16));
+
+    job.status = FindPath(search, job.start, job.goal);
+
+    if (job.status == PathStatus::FOUND)
+    {
+        job.pathLength = (u32) search.path.size();
+        job.path = (Vector3Int*) PlatformAllocate(job.pathLength * sizeof(Vector3Int));
+        PlatformCopyMemory(job.path, search.path.data(), job.pathLength * sizeof(Vector3Int));
+    }
+
+    PlatformFree(search.distances);
+    PlatformFree(search.parents);
+    PlatformFree(search.queue);
+}
+
+/* Interface */
+
+PathQuery RequestPath(const Vector3Int& start, const Vector3Int& goal)
+{
+    const PathQuery query = pathData.nextQuery++;
+    if (pathData.nextQuery == INVALID_PATH_QUERY)
+        pathData.nextQuery++;
+
+    pathData.requests.PushBack({ query, start, goal });
+    return query;
+}
+
+PathStatus GetPathStatus(PathQuery query)
+{
+    auto it = pathData.results.Find(query);
+    if (it)
+        return it.value().status;
+
+    for (u64 i = 0; i < pathData.requests.size(); i++)
+    {
+        if (pathData.requests[i].query == query)
+            return PathStatus::PENDING;
+    }
+
+    for (u64 i = 0; i < pathData.jobs.size(); i++)
+    {
+        if (pathData.jobs[i].query == query && !pathData.jobs[i].released)
+            return PathStatus::PENDING;
+    }
+
+    return PathStatus::INVALID;
+}
+
+bool GetPath(PathQuery query, DynamicArray<Vector3Int>& path)
+{
+    auto it = pathData.results.Find(query);
+    if (!it || it.value().status != PathStatus::FOUND)
+        return false;
+
+    const PathResult& result = it.value();
+
+    path.Clear(false);
+    for (u32 i = 0; i < result.pathLength; i++)
+        path.PushBack(result.path[i]);
+
+    return true;
+}
+
+void ReleasePath(PathQuery query)
+{
+    auto it = pathData.results.Find(query);
+    if (it)
+    {
+        PlatformFree(it.value().path);
+        pathData.results.Remove(query);
+        return;
+    }
+
+    for (u64 i = 0; i < pathData.requests.size(); i++)
+    {
+        if (pathData.requests[i].query == query)
+        {
+            pathData.requests.EraseSwap(i);
+            return;
+        }
+    }
+
+    // Running jobs can't be stopped, their result is thrown away when they're done
+    for (u64 i = 0; i < pathData.jobs.size(); i++)
+    {
+        if (pathData.jobs[i].query == query)
+            pathData.jobs[i].released = true;
+    }
+}
+
+void UpdatePathfinding(const VoxelChunkArea& area)
+{
+    {   // Pick up the queries started last frame, nothing below can change while they run
+        JobSystem::Wait(pathData.jobCounter);
+
+        for (u64 i = 0; i < pathData.jobs.size(); i++)
+        {
+            const PathJob& job = pathData.jobs[i];
+
+            if (job.released)
+                PlatformFree(job.path);
+            else
+                pathData.results[job.query] = { job.status, job.path, job.pathLength };
+        }
+
+        pathData.jobs.Clear(false);
+    }
+
+    // Forget chunks that were unloaded or aren't at full resolution anymore
+    for (u64 i = 0; i < pathData.chunks.size(); i++)
+    {
+        if (pathData.chunks[i] && !IsFullResolution(area, pathData.chunks[i]->coord))
+            RemovePathChunk((u32) i);
+    }
+
+    // Chunks that had blocks changed
+    for (u64 i = 0; i < pathData.dirtyChunks.size(); i++)
+    {
+        const u32 index = FindPathChunkIndex(pathData.dirtyChunks[i]);
+        if (index == NO_NODE)
+            continue;
+
+        ExtractStandableVoxels(*pathData.chunks[index], area);
+        AddChunkAndNeighbours(pathData.changedChunks, pathData.dirtyChunks[i]);
+    }
+
+    pathData.dirtyChunks.Clear(false);
+
+    {   // New chunks, a few every frame
+        u32 built = 0;
+
+        for (auto it = area.chunkMap.slots.begin(); it != area.chunkMap.slots.end() && built < maxChunkBuildsPerFrame; it++)
+        {
+            const Vector3Int coord = UnpackChunkCoord(it.key());
+            if (pathData.chunkIndices.Find(it.key()) || !IsFullResolution(area, coord))
+                continue;
+
+            AddPathChunk(area, coord);
+            built++;
+        }
+    }
+
+    for (u64 i = 0; i < pathData.changedChunks.size(); i++)
+    {
+        const u32 index = FindPathChunkIndex(pathData.changedChunks[i]);
+        if (index == NO_NODE)
+            continue;
+
+        // Wait for the neighbours that are still being built, they add this chunk back when they're done
+        if (HasUnbuiltNeighbours(area, pathData.changedChunks[i]))
+            continue;
+
+        BuildChunkNodes(*pathData.chunks[index]);
+    }
+
+    pathData.changedChunks.Clear(false);
+
+    {   // Start the requested queries, every job is added before any is submitted so the array doesn't move
+        for (u64 i = 0; i < pathData.requests.size(); i++)
+        {
+            const PathRequest& request = pathData.requests[i];
+            pathData.jobs.PushBack({ request.query, request.start, request.goal, PathStatus::PENDING, nullptr, 0, false });
+        }
+
+        pathData.requests.Clear(false);
+
+        for (u64 i = 0; i < pathData.jobs.size(); i++)
+            JobSystem::Submit(PathJobFunction, &pathData.jobs[i], &pathData.jobCounter);
+    }
+}
+
+void InvalidatePathsAroundBlock(const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    // A block decides if an agent can stand in the voxel above it and if the 3 voxels below have room above them
+    const Vector3Int position = ChunkOrigin(chunkIndex) + blockIndex;
+
+    AddIfNotPresent(pathData.dirtyChunks, WorldToChunkCoord(position + Vector3Int { 0,  1, 0 }));
+    AddIfNotPresent(pathData.dirtyChunks, WorldToChunkCoord(position + Vector3Int { 0, -3, 0 }));
+}
+
+void FreePathfindingData()
+{
+    JobSystem::Wait(pathData.jobCounter);
+
+    for (u64 i = 0; i < pathData.jobs.size(); i++)
+        PlatformFree(pathData.jobs[i].path);
+
+    for (auto it = pathData.results.begin(); it != pathData.results.end(); it++)
+        PlatformFree(it.value().path);
+
+    for (u64 i = 0; i < pathData.chunks.size(); i++)
+        PlatformFree(pathData.chunks[i]);
+
+    pathData.chunks.Free();
+    pathData.freeChunks.Free();
+    pathData.chunkIndices.Clear();
+
+    pathData.dirtyChunks.Free();
+    pathData.changedChunks.Free();
+
+    pathData.requests.Free();
+    pathData.jobs.Free();
+    pathData.results.Clear();
+
+    pathData.transitions.Free();
+    pathData.portals.Free();
+}
\ No newline at end of file
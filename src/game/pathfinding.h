@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "voxel.h"
+
+/*
+
+Hierarchical pathfinding (HPA*) over the loaded terrain.
+
+Agents are 2 blocks tall, walk between the 4 horizontal neighbours of a
+voxel and can step up or down one block on the way. Every full resolution
+chunk gets a copy of where an agent can stand (and where it has room to
+jump) as one bit per voxel, taken from the chunk's blocks.
+
+The abstract graph has a node for every portal between neighbouring
+chunks. Moves across a chunk border are grouped into connected runs and
+one move in the middle of every run becomes a portal. Inside a chunk the
+walking distance between every pair of its nodes is precomputed, so a
+query runs A* over portals and only searches voxels in the chunks of the
+start, the goal and the chunks the path goes through.
+
+Paths are searched on the job system. A request is started by the next
+UpdatePathfinding and its result is picked up by the one after that, so
+queries run during the rest of the frame. The graph is only changed by
+UpdatePathfinding after the running queries are done, and only for the
+chunks a changed block touches (and their neighbours' portals).
+
+*/
+
+using PathQuery = u32;
+
+constexpr PathQuery INVALID_PATH_QUERY = 0;
+
+enum struct PathStatus : u8
+{
+    INVALID,                                    // Unknown query or its result was released
+    PENDING,
+    FOUND,
+    NOT_FOUND,
+};
+
+struct VoxelChunkArea;
+
+// Start and goal are world positions of the voxels the agent's feet are in
+PathQuery RequestPath(const Vector3Int& start, const Vector3Int& goal);
+
+PathStatus GetPathStatus(PathQuery query);
+
+// Copies the voxels of a found path (start and goal included) into path. Returns false if it wasn't found (yet).
+bool GetPath(PathQuery query, DynamicArray<Vector3Int>& path);
+
+// Forgets the result of a query, also cancels queries that haven't started
+void ReleasePath(PathQuery query);
+
+// Picks up finished queries, updates the graph for the chunks that changed and starts the requested queries.
+// Call once per frame after the chunk area was updated.
+void UpdatePathfinding(const VoxelChunkArea& area);
+
+// Call after the block at a position was changed so the chunks it affects are rebuilt
+void InvalidatePathsAroundBlock(const Vector3Int& chunkIndex, const Vector3Int& blockIndex);
+
+void FreePathfindingData();
\ No newline at end of file
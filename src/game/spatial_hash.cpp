@@ -0,0 +1,232 @@
+#include "spatial_hash.h"
+
+#include "core/logging.h"
+#include "chunk_map.h"
+#include "intersections.h"
+
+static inline Vector3Int CellCoord(const SpatialHash& hash, const Vector3& position)
+{
+    return Vector3Int {
+        (s32) Math::Floor(position.x * hash.invCellSize),
+        (s32) Math::Floor(position.y * hash.invCellSize),
+        (s32) Math::Floor(position.z * hash.invCellSize)
+    };
+}
+
+static inline Vector3 MaxCorner(const Vector3& a, const Vector3& b)
+{
+    return Vector3(Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z));
+}
+
+void SpatialHash::Create(f32 size)
+{
+    AssertWithMessage(size > 0.0f, "Spatial hash cells need a size!");
+
+    cellSize = size;
+    invCellSize = 1.0f / size;
+
+    cellIndices.Clear();
+    cells.Clear();
+    cellEntries.Clear();
+    entries.Clear();
+    insertions.Clear();
+}
+
+void SpatialHash::Free()
+{
+    cellIndices.Clear();
+    cells.Free();
+    cellEntries.Free();
+    entries.Free();
+    insertions.Free();
+}
+
+void SpatialHash::Build(const EntityWorld& world)
+{
+    cellIndices.Clear();
+    cells.Clear(false);
+    entries.Clear(false);
+    insertions.Clear(false);
+
+    constexpr u32 required = ENTITY_COMPONENT_POSITION | ENTITY_COMPONENT_BOUNDS;
+
+    {   // Count the entities in every cell
+        for (u32 i = 0; i < ENTITY_ARCHETYPE_COUNT; i++)
+        {
+            const EntityArchetype& archetype = world.archetypes[i];
+            if ((archetype.components & required) != required)
+                continue;
+
+            for (u32 row = 0; row < archetype.count; row++)
+            {
+                SpatialHashEntry entry;
+                entry.handle = archetype.handles[row];
+                entry.box.min = archetype.positions[row] + archetype.bounds[row].min;
+                entry.box.max = archetype.positions[row] + archetype.bounds[row].max;
+
+                const u32 entryIndex = (u32) entries.size();
+                entries.PushBack(entry);
+
+                const Vector3Int minCell = CellCoord(*this, entry.box.min);
+                const Vector3Int maxCell = CellCoord(*this, entry.box.max);
+
+                for (s32 z = minCell.z; z <= maxCell.z; z++)
+                for (s32 y = minCell.y; y <= maxCell.y; y++)
+                for (s32 x = minCell.x; x <= maxCell.x; x++)
+                {
+                    const u64 key = PackChunkCoord(Vector3Int { x, y, z });
+
+                    u32 cellIndex;
+                    auto it = cellIndices.Find(key);
+                    if (it)
+                        cellIndex = it.value();
+                    else
+                    {
+                        cellIndex = (u32) cells.size();
+                        cellIndices.Place(key, cellIndex);
+                        cells.PushBack({ 0, 0 });
+                    }
+
+                    cells[cellIndex].count++;
+                    insertions.PushBack(((u64) cellIndex << 32) | entryIndex);
+                }
+            }
+        }
+    }
+
+    {   // Give every cell its range of the packed array, count is used to fill it in after this
+        u32 start = 0;
+        for (u64 i = 0; i < cells.size(); i++)
+        {
+            cells[i].start = start;
+            start += cells[i].count;
+            cells[i].count = 0;
+        }
+
+        if (cellEntries.size() != start)
+            cellEntries.Resize(start);
+    }
+
+    for (u64 i = 0; i < insertions.size(); i++)
+    {
+        SpatialHashCell& cell = cells[(u32) (insertions[i] >> 32)];
+        cellEntries[cell.start + cell.count++] = (u32) insertions[i];
+    }
+}
+
+struct SpatialQuery
+{
+    AABB bounds;                                // Box covering the whole query
+    bool isSphere;
+    Vector3 center;
+    f32 radius;
+};
+
+static void RunQuery(const SpatialHash& hash, const SpatialQuery& query, DynamicArray<EntityHandle>& results)
+{
+    const Vector3Int minCell = CellCoord(hash, query.bounds.min);
+    const Vector3Int maxCell = CellCoord(hash, query.bounds.max);
+
+    for (s32 z = minCell.z; z <= maxCell.z; z++)
+    for (s32 y = minCell.y; y <= maxCell.y; y++)
+    for (s32 x = minCell.x; x <= maxCell.x; x++)
+    {
+        const Vector3Int cellCoord = { x, y, z };
+
+        auto it = hash.cellIndices.Find(PackChunkCoord(cellCoord));
+        if (!it)
+            continue;
+
+        const SpatialHashCell& cell = hash.cells[it.value()];
+        for (u32 i = cell.start; i < cell.start + cell.count; i++)
+        {
+            const SpatialHashEntry& entry = hash.entries[hash.cellEntries[i]];
+
+            const bool hit = (query.isSphere) ? Intersection(entry.box, query.center, query.radius)
+                                              : Intersection(entry.box, query.bounds);
+            if (!hit)
+                continue;
+
+            // Entities in several cells are only reported by one of them
+            if (CellCoord(hash, MaxCorner(entry.box.min, query.bounds.min)) != cellCoord)
+                continue;
+
+            results.PushBack(entry.handle);
+        }
+    }
+}
+
+void SpatialHash::QueryAABB(const AABB& box, DynamicArray<EntityHandle>& results) const
+{
+    SpatialQuery query;
+    query.bounds = box;
+    query.isSphere = false;
+
+    RunQuery(*this, query, results);
+}
+
+void SpatialHash::QueryRadius(const Vector3& center, f32 radius, DynamicArray<EntityHandle>& results) const
+{
+    SpatialQuery query;
+    query.bounds.min = center - Vector3(radius);
+    query.bounds.max = center + Vector3(radius);
+    query.isSphere = true;
+    query.center = center;
+    query.radius = radius;
+
+    RunQuery(*this, query, results);
+}
+
+void SpatialHash::QueryAABBs(const AABB* boxes, u32 count, DynamicArray<u32>& resultStarts, DynamicArray<EntityHandle>& results) const
+{
+    resultStarts.Clear(false);
+
+    for (u32 i = 0; i < count; i++)
+    {
+        resultStarts.PushBack((u32) results.size());
+        QueryAABB(boxes[i], results);
+    }
+
+    resultStarts.PushBack((u32) results.size());
+}
+
+void SpatialHash::QueryRadii(const Vector3* centers, const f32* radii, u32 count, DynamicArray<u32>& resultStarts, DynamicArray<EntityHandle>& results) const
+{
+    resultStarts.Clear(false);
+
+    for (u32 i = 0; i < count; i++)
+    {
+        resultStarts.PushBack((u32) results.size());
+        QueryRadius(centers[i], radii[i], results);
+    }
+
+    resultStarts.PushBack((u32) results.size());
+}
+
+void SpatialHash::FindOverlappingPairs(DynamicArray<SpatialHashPair>& pairs) const
+{
+    for (auto it = cellIndices.begin(); it != cellIndices.end(); it++)
+    {
+        const Vector3Int cellCoord = UnpackChunkCoord(it.key());
+        const SpatialHashCell& cell = cells[it.value()];
+
+        for (u32 i = cell.start; i < cell.start + cell.count; i++)
+        {
+            const SpatialHashEntry& a = entries[cellEntries[i]];
+
+            for (u32 j = i + 1; j < cell.start + cell.count; j++)
+            {
+                const SpatialHashEntry& b = entries[cellEntries[j]];
+
+                if (!Intersection(a.box, b.box))
+                    continue;
+
+                // Pairs that share several cells are only reported by one of them
+                if (CellCoord(*this, MaxCorner(a.box.min, b.box.min)) != cellCoord)
+                    continue;
+
+                pairs.PushBack({ a.handle, b.handle });
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "containers/hashtable.h"
+#include "math/math.h"
+#include "aabb.h"
+#include "entities.h"
+
+/*
+
+Broadphase for entity overlap and proximity queries.
+
+Space is split into a uniform grid of cubic cells and every entity with a
+position and bounds is put into each cell its box touches. Only cells that
+have entities get an entry in the hash table (keyed by the packed cell
+coordinate), so the grid has no size limit and costs nothing where there
+are no entities.
+
+The hash is rebuilt from the entity world every tick. Entities are counted
+per cell first and then written into one packed array, so the entities of
+a cell are next to each other in memory and building doesn't allocate once
+the arrays have grown to fit.
+
+An entity spanning several cells is only reported once by a query: a match
+is only reported from the cell that holds the minimum corner of the region
+where the entity overlaps the query.
+
+*/
+
+struct SpatialHashCell
+{
+    u32 start;                                  // First entry of the cell in SpatialHash::cellEntries
+    u32 count;
+};
+
+struct SpatialHashEntry
+{
+    EntityHandle handle;
+    AABB box;                                   // World space bounds of the entity
+};
+
+// Two entities whose boxes overlap
+struct SpatialHashPair
+{
+    EntityHandle a, b;
+};
+
+struct SpatialHash
+{
+    f32 cellSize;
+    f32 invCellSize;
+
+    HashTable<u64, u32> cellIndices;            // Cell coordinate (packed like a chunk coordinate) -> index into cells
+    DynamicArray<SpatialHashCell> cells;
+    DynamicArray<u32> cellEntries;              // Entries of every cell packed together (indices into entries)
+    DynamicArray<SpatialHashEntry> entries;
+
+    DynamicArray<u64> insertions;               // Scratch space for building, (cell index << 32) | entry index
+
+    void Create(f32 cellSize);
+    void Free();
+
+    // Rebuilds the hash from every entity with a position and bounds
+    void Build(const EntityWorld& world);
+
+    // Appends the entities that overlap the box / are within radius of the center to results
+    void QueryAABB(const AABB& box, DynamicArray<EntityHandle>& results) const;
+    void QueryRadius(const Vector3& center, f32 radius, DynamicArray<EntityHandle>& results) const;
+
+    // Runs a query for every box (or sphere). The results of query i are results[resultStarts[i], resultStarts[i + 1]).
+    void QueryAABBs(const AABB* boxes, u32 count, DynamicArray<u32>& resultStarts, DynamicArray<EntityHandle>& results) const;
+    void QueryRadii(const Vector3* centers, const f32* radii, u32 count, DynamicArray<u32>& resultStarts, DynamicArray<EntityHandle>& results) const;
+
+    // Appends every pair of entities whose boxes overlap, each pair once
+    void FindOverlappingPairs(DynamicArray<SpatialHashPair>& pairs) const;
+};
\ No newline at end of file
@@ -11,6 +11,21 @@ struct Vector3Int
     {
         return { x + rhs.x, y + rhs.y, z + rhs.z };
     }
+
+    Vector3Int operator-(const Vector3Int& rhs) const
+    {
+        return { x - rhs.x, y - rhs.y, z - rhs.z };
+    }
+
+    bool operator==(const Vector3Int& rhs) const
+    {
+        return x == rhs.x && y == rhs.y && z == rhs.z;
+    }
+
+    bool operator!=(const Vector3Int& rhs) const
+    {
+        return !(*this == rhs);
+    }
 };
 
 enum struct BlockType : u8
@@ -36,6 +51,7 @@ enum struct BlockType : u8
     STONE,
     BEDROCK,
     OBSIDIAN,
+    GLOWSTONE,
 
     NUM_TYPES
 };
@@ -60,6 +76,7 @@ constexpr char* blockTypeNames[] = {
     "Stone",
     "Bedrock",
     "Obsidian",
+    "Glowstone",
 };
 
 enum struct VoxelFaceDirection : u32
@@ -0,0 +1,460 @@
+#include "voxel_fluid.h"
+
+#include "containers/darray.h"
+#include "containers/hashtable.h"
+#include "engine/job_system.h"
+#include "math/common.h"
+#include "platform/platform.h"
+#include "chunk_area.h"
+
+#include <new>
+
+constexpr u32 CHUNK_VOXEL_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+constexpr u32 CENTER_CHUNK = 13;                    // ChunkNeighbourhood::Index(0, 0, 0)
+
+// Horizontal directions water spreads in
+constexpr s32 fluidSideOffsets[4][2] = {
+    {  1,  0 },
+    { -1,  0 },
+    {  0,  1 },
+    {  0, -1 },
+};
+
+// Cells that look at a cell when they're simulated, they're woken up when it changes
+constexpr s32 fluidWakeOffsets[9][3] = {
+    {  0, -1,  0 },     // Below, water can fall into it
+    {  1,  0,  0 },     // Sides, water can spread into them
+    { -1,  0,  0 },
+    {  0,  0,  1 },
+    {  0,  0, -1 },
+    {  1,  1,  0 },     // Sides of the cell above, the cell is the ground they spread over
+    { -1,  1,  0 },
+    {  0,  1,  1 },
+    {  0,  1, -1 },
+};
+
+// Chunks next to a chunk, a chunk's mesh has to be rebuilt if water moved at the border it shares with it
+const Vector3Int fluidBorderOffsets[6] = {
+    {  1,  0,  0 }, { -1,  0,  0 },
+    {  0,  1,  0 }, {  0, -1,  0 },
+    {  0,  0,  1 }, {  0,  0, -1 },
+};
+
+// Cell to simulate in the next tick
+struct FluidWake
+{
+    Vector3Int coord;                               // Chunk coordinate of the chunk the cell is in
+    u16 index;                                      // Index of the voxel in the chunk
+};
+
+// Active cells of a chunk
+struct FluidChunkState
+{
+    Vector3Int coord;
+    DynamicArray<u16> cells[2];                     // Cells simulated in this tick and cells woken up for the next one
+    u64 queued[CHUNK_VOXEL_COUNT / 64];             // If a cell is already woken up for the next tick
+};
+
+struct FluidChunkJob
+{
+    VoxelChunkArea* area;
+    FluidChunkState* state;
+
+    DynamicArray<FluidWake> wakes;                  // Cells woken up in other chunks, they're added to the active set after the pass
+    u32 changedBorders;                             // Bit per fluidBorderOffsets entry, set if water moved at that border
+    bool changed;
+};
+
+// Chunk and its 26 neighbours, only the center chunk is written to
+struct FluidNeighbourhood
+{
+    VoxelChunk* chunks[27];                         // nullptr if the chunk is only air or can't hold water
+    VoxelFluidChunk* levels[27];
+    bool onlyAir[27];                               // Chunks that are only air can get storage once water flows into them
+
+    // Cell position is relative to the center chunk and can be at most 1 chunk outside it
+    static inline u32 ChunkOf(s32& x, s32& y, s32& z)
+    {
+        const s32 dx = (x < 0) ? -1 : ((x >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dy = (y < 0) ? -1 : ((y >= (s32) CHUNK_SIZE) ? 1 : 0);
+        const s32 dz = (z < 0) ? -1 : ((z >= (s32) CHUNK_SIZE) ? 1 : 0);
+
+        x -= dx * (s32) CHUNK_SIZE;
+        y -= dy * (s32) CHUNK_SIZE;
+        z -= dz * (s32) CHUNK_SIZE;
+
+        return ChunkNeighbourhood::Index(dx, dy, dz);
+    }
+
+    // Chunks that can't hold water (not loaded or at a lower level of detail) act like solid blocks
+    inline BlockType BlockAt(s32 x, s32 y, s32 z) const
+    {
+        const u32 index = ChunkOf(x, y, z);
+        if (!chunks[index])
+            return onlyAir[index] ? BlockType::NONE : BlockType::BEDROCK;
+
+        return chunks[index]->at(x, y, z);
+    }
+
+    inline u8 LevelAt(s32 x, s32 y, s32 z) const
+    {
+        const u32 index = ChunkOf(x, y, z);
+        return levels[index] ? levels[index]->at(x, y, z) : 0;
+    }
+};
+
+static struct
+{
+    DynamicArray<FluidChunkState*> activeChunks;
+    DynamicArray<FluidChunkState*> freeStates;
+    HashTable<ChunkKey, FluidChunkState*> activeChunkMap;
+
+    DynamicArray<FluidChunkJob> jobs;               // Only grows, the arrays in the jobs are reused
+
+    u32 simulatedList = 0;                          // Index of the cell list simulated in the current tick
+} fluidData;
+
+static inline u16 VoxelIndex(u32 x, u32 y, u32 z)
+{
+    return (u16) (x + y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE);
+}
+
+static inline void VoxelPosition(u16 index, s32& x, s32& y, s32& z)
+{
+    x = index % CHUNK_SIZE;
+    y = (index / CHUNK_SIZE) % CHUNK_SIZE;
+    z = index / (CHUNK_SIZE * CHUNK_SIZE);
+}
+
+// Chunk parity decides which pass of a tick the chunk is simulated in
+static inline u32 ChunkParity(const Vector3Int& coord)
+{
+    return (coord.x & 1) | ((coord.y & 1) << 1) | ((coord.z & 1) << 2);
+}
+
+static inline bool IsFluidSource(u8 level)
+{
+    return (level & FLUID_LEVEL_MASK) == FLUID_SOURCE_LEVEL;
+}
+
+static void GetFluidNeighbourhood(VoxelChunkArea& area, const Vector3Int& coord, FluidNeighbourhood& neighbours)
+{
+    for (s32 dz = -1; dz <= 1; dz++)
+    for (s32 dy = -1; dy <= 1; dy++)
+    for (s32 dx = -1; dx <= 1; dx++)
+    {
+        const u32 index = ChunkNeighbourhood::Index(dx, dy, dz);
+        const Vector3Int neighbour = coord + Vector3Int { dx, dy, dz };
+        const u32 slot = area.chunkMap.Find(neighbour);
+
+        const bool holdsWater = IsValidChunkSlot(slot) && area.chunks[slot].dimension() == CHUNK_SIZE;
+        neighbours.chunks[index]  = holdsWater ? &area.chunks[slot] : nullptr;
+        neighbours.levels[index]  = holdsWater ? &area.fluids[slot] : nullptr;
+        neighbours.onlyAir[index] = (slot == AIR_CHUNK_SLOT) && area.loadShape.LODAt(area.centerChunk, neighbour) == 0;
+    }
+}
+
+// Water spreads sideways once it can't fall any further (or if it's resting on a source)
+static inline bool FluidSpreadsSideways(const FluidNeighbourhood& neighbours, s32 x, s32 y, s32 z)
+{
+    const BlockType below = neighbours.BlockAt(x, y - 1, z);
+    if (below == BlockType::WATER)
+        return IsFluidSource(neighbours.LevelAt(x, y - 1, z));
+
+    return below != BlockType::NONE;
+}
+
+// Flow level the cell should have based on the cells around it, 0 if it should be dry
+static u8 ComputeFlowLevel(const FluidNeighbourhood& neighbours, s32 x, s32 y, s32 z)
+{
+    // Water right above always falls into the cell
+    if (neighbours.BlockAt(x, y + 1, z) == BlockType::WATER)
+        return FLUID_FALLING_FLAG | FLUID_MAX_FLOW_LEVEL;
+
+    u8 level = 0;
+
+    for (const auto& offset : fluidSideOffsets)
+    {
+        const s32 nx = x + offset[0];
+        const s32 nz = z + offset[1];
+
+        if (neighbours.BlockAt(nx, y, nz) != BlockType::WATER || !FluidSpreadsSideways(neighbours, nx, y, nz))
+            continue;
+
+        // Sources and falling water spread at full strength, everything else gets 1 level weaker
+        const u8 neighbourLevel = neighbours.LevelAt(nx, y, nz);
+        const u8 flow = neighbourLevel & FLUID_LEVEL_MASK;
+        const u8 spreadLevel = (IsFluidSource(neighbourLevel) || (neighbourLevel & FLUID_FALLING_FLAG)) ?
+                               FLUID_MAX_FLOW_LEVEL : ((flow > 0) ? flow - 1 : 0);
+
+        level = Max(level, spreadLevel);
+    }
+
+    return level;
+}
+
+// Returns true if the cell changed
+static bool SimulateFluidCell(FluidNeighbourhood& neighbours, s32 x, s32 y, s32 z)
+{
+    BlockType& type = neighbours.chunks[CENTER_CHUNK]->at(x, y, z);
+    u8& level = neighbours.levels[CENTER_CHUNK]->at(x, y, z);
+
+    // Only air and flowing water can change, sources and other blocks stay as they are
+    if ((type == BlockType::WATER) ? IsFluidSource(level) : (type != BlockType::NONE))
+        return false;
+
+    const u8 newLevel = ComputeFlowLevel(neighbours, x, y, z);
+    const BlockType newType = (newLevel > 0) ? BlockType::WATER : BlockType::NONE;
+
+    if (newType == type && newLevel == level)
+        return false;
+
+    type = newType;
+    level = newLevel;
+    return true;
+}
+
+static void QueueFluidCell(FluidChunkState& state, u16 index)
+{
+    u64& bits = state.queued[index >> 6];
+    const u64 bit = 1ull << (index & 63);
+
+    if (bits & bit)
+        return;
+
+    bits |= bit;
+    state.cells[fluidData.simulatedList ^ 1].PushBack(index);
+}
+
+static FluidChunkState& GetActiveChunk(const Vector3Int& coord)
+{
+    const ChunkKey key = PackChunkCoord(coord);
+
+    auto it = fluidData.activeChunkMap.Find(key);
+    if (it)
+        return *it.value();
+
+    // States (and the memory of their cell lists) are reused once their chunk settles
+    FluidChunkState* state;
+    if (fluidData.freeStates.size() > 0)
+        state = fluidData.freeStates.PopBack();
+    else
+    {
+        state = (FluidChunkState*) PlatformAllocate(sizeof(FluidChunkState));
+        AssertWithMessage(state, "Couldn't allocate fluid chunk state!");
+        new (state) FluidChunkState();
+    }
+
+    state->coord = coord;
+    PlatformZeroMemory(state->queued, sizeof(state->queued));
+
+    fluidData.activeChunkMap.Place(key, state);
+    fluidData.activeChunks.PushBack(state);
+    return *state;
+}
+
+// Cell position is inside the chunk at coord
+static void WakeFluidCell(VoxelChunkArea& area, const Vector3Int& coord, s32 x, s32 y, s32 z)
+{
+    const u32 slot = area.chunkMap.Find(coord);
+
+    if (slot == AIR_CHUNK_SLOT)
+    {
+        // Chunks that are only air only get storage once water actually flows into them
+        FluidNeighbourhood neighbours;
+        GetFluidNeighbourhood(area, coord, neighbours);
+
+        if (!neighbours.onlyAir[CENTER_CHUNK] || ComputeFlowLevel(neighbours, x, y, z) == 0)
+            return;
+
+        if (area.AcquireAirChunk(coord) == NO_CHUNK_SLOT)
+            return;
+    }
+    else if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+        return;
+
+    QueueFluidCell(GetActiveChunk(coord), VoxelIndex(x, y, z));
+}
+
+// Cell position is relative to the chunk at coord and can be at most 1 chunk outside it
+static void WakeFluidCellAround(VoxelChunkArea& area, const Vector3Int& coord, s32 x, s32 y, s32 z)
+{
+    const s32 dx = (x < 0) ? -1 : ((x >= (s32) CHUNK_SIZE) ? 1 : 0);
+    const s32 dy = (y < 0) ? -1 : ((y >= (s32) CHUNK_SIZE) ? 1 : 0);
+    const s32 dz = (z < 0) ? -1 : ((z >= (s32) CHUNK_SIZE) ? 1 : 0);
+
+    WakeFluidCell(area, coord + Vector3Int { dx, dy, dz }, x - dx * (s32) CHUNK_SIZE, y - dy * (s32) CHUNK_SIZE, z - dz * (s32) CHUNK_SIZE);
+}
+
+static void SimulateFluidChunkJob(void* data)
+{
+    FluidChunkJob& job = *(FluidChunkJob*) data;
+    FluidChunkState& state = *job.state;
+
+    job.wakes.Clear(false);
+    job.changedBorders = 0;
+    job.changed = false;
+
+    FluidNeighbourhood neighbours;
+    GetFluidNeighbourhood(*job.area, state.coord, neighbours);
+
+    const DynamicArray<u16>& cells = state.cells[fluidData.simulatedList];
+
+    for (u32 i = 0; i < cells.size(); i++)
+    {
+        s32 x, y, z;
+        VoxelPosition(cells[i], x, y, z);
+
+        if (!SimulateFluidCell(neighbours, x, y, z))
+            continue;
+
+        job.changed = true;
+
+        job.changedBorders |= (x == (s32) CHUNK_SIZE - 1) << 0;
+        job.changedBorders |= (x == 0)              << 1;
+        job.changedBorders |= (y == (s32) CHUNK_SIZE - 1) << 2;
+        job.changedBorders |= (y == 0)              << 3;
+        job.changedBorders |= (z == (s32) CHUNK_SIZE - 1) << 4;
+        job.changedBorders |= (z == 0)              << 5;
+
+        for (const auto& offset : fluidWakeOffsets)
+        {
+            s32 wx = x + offset[0];
+            s32 wy = y + offset[1];
+            s32 wz = z + offset[2];
+
+            const u32 chunk = FluidNeighbourhood::ChunkOf(wx, wy, wz);
+
+            // Other chunks might be simulated in this pass, so they're woken up after it's done
+            if (chunk == CENTER_CHUNK)
+                QueueFluidCell(state, VoxelIndex(wx, wy, wz));
+            else
+            {
+                const Vector3Int chunkOffset = { (s32) (chunk % 3) - 1, (s32) ((chunk / 3) % 3) - 1, (s32) (chunk / 9) - 1 };
+                job.wakes.PushBack(FluidWake { state.coord + chunkOffset, VoxelIndex(wx, wy, wz) });
+            }
+        }
+    }
+}
+
+void TickFluids(VoxelChunkArea& area, DynamicArray<Vector3Int>& changedChunks)
+{
+    // Settled water doesn't cost anything
+    if (fluidData.activeChunks.size() == 0)
+        return;
+
+    // Cells woken up since the last tick are simulated in this one
+    fluidData.simulatedList ^= 1;
+
+    for (u32 i = 0; i < fluidData.activeChunks.size(); i++)
+    {
+        FluidChunkState& state = *fluidData.activeChunks[i];
+        const DynamicArray<u16>& cells = state.cells[fluidData.simulatedList];
+
+        for (u32 j = 0; j < cells.size(); j++)
+            state.queued[cells[j] >> 6] &= ~(1ull << (cells[j] & 63));
+    }
+
+    // Chunks with the same parity aren't next to each other so they can be simulated at the same time
+    for (u32 parity = 0; parity < 8; parity++)
+    {
+        u32 jobCount = 0;
+
+        for (u32 i = 0; i < fluidData.activeChunks.size(); i++)
+        {
+            FluidChunkState& state = *fluidData.activeChunks[i];
+            if (state.cells[fluidData.simulatedList].size() == 0 || ChunkParity(state.coord) != parity)
+                continue;
+
+            // Chunk was unloaded or moved to a lower level of detail
+            const u32 slot = area.chunkMap.Find(state.coord);
+            if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+            {
+                state.cells[fluidData.simulatedList].Clear(false);
+                continue;
+            }
+
+            if (jobCount == fluidData.jobs.size())
+                fluidData.jobs.EmplaceBack();
+
+            FluidChunkJob& job = fluidData.jobs[jobCount++];
+            job.area = &area;
+            job.state = &state;
+        }
+
+        if (jobCount == 0)
+            continue;
+
+        JobSystem::JobCounter counter;
+        for (u32 i = 0; i < jobCount; i++)
+            JobSystem::Submit(SimulateFluidChunkJob, &fluidData.jobs[i], &counter);
+
+        JobSystem::Wait(counter);
+
+        for (u32 i = 0; i < jobCount; i++)
+        {
+            const FluidChunkJob& job = fluidData.jobs[i];
+
+            if (job.changed)
+            {
+                AddIfNotPresent(changedChunks, job.state->coord);
+
+                for (u32 j = 0; j < 6; j++)
+                {
+                    if (job.changedBorders & (1 << j))
+                        AddIfNotPresent(changedChunks, job.state->coord + fluidBorderOffsets[j]);
+                }
+            }
+
+            for (u32 j = 0; j < job.wakes.size(); j++)
+            {
+                s32 x, y, z;
+                VoxelPosition(job.wakes[j].index, x, y, z);
+                WakeFluidCell(area, job.wakes[j].coord, x, y, z);
+            }
+        }
+    }
+
+    // Chunks without any cells left to simulate have settled
+    for (u32 i = fluidData.activeChunks.size(); i > 0; i--)
+    {
+        FluidChunkState* state = fluidData.activeChunks[i - 1];
+        state->cells[fluidData.simulatedList].Clear(false);
+
+        if (state->cells[fluidData.simulatedList ^ 1].size() > 0)
+            continue;
+
+        fluidData.activeChunkMap.Remove(PackChunkCoord(state->coord));
+        fluidData.freeStates.PushBack(state);
+        fluidData.activeChunks.EraseSwap(i - 1);
+    }
+}
+
+void ActivateFluidAroundBlock(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    WakeFluidCell(area, chunkIndex, blockIndex.x, blockIndex.y, blockIndex.z);
+
+    for (const auto& offset : fluidWakeOffsets)
+        WakeFluidCellAround(area, chunkIndex, blockIndex.x + offset[0], blockIndex.y + offset[1], blockIndex.z + offset[2]);
+}
+
+void FreeVoxelFluidData()
+{
+    for (u32 i = 0; i < fluidData.activeChunks.size(); i++)
+    {
+        fluidData.activeChunks[i]->~FluidChunkState();
+        PlatformFree(fluidData.activeChunks[i]);
+    }
+
+    for (u32 i = 0; i < fluidData.freeStates.size(); i++)
+    {
+        fluidData.freeStates[i]->~FluidChunkState();
+        PlatformFree(fluidData.freeStates[i]);
+    }
+
+    fluidData.activeChunks.Free();
+    fluidData.freeStates.Free();
+    fluidData.activeChunkMap.Clear();
+
+    fluidData.jobs.Free();
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/array_3d.h"
+#include "containers/darray.h"
+#include "voxel.h"
+
+/*
+
+Cellular automaton for water.
+
+Every voxel of a full resolution chunk stores a flow level for the water in
+it. Water placed by the player is a source and never drains. Water flows
+down into air and then spreads sideways over solid ground, losing a level
+per block, so it runs out 7 blocks away from whatever feeds it. Water that
+isn't fed anymore dries up one block per tick.
+
+Only cells in the active set are simulated. A cell becomes active when a
+block next to it changes, so settled water costs nothing however big it is.
+Active chunks are simulated in parallel on the job system in 8 passes, one
+for every (x, y, z) parity of the chunk coordinate. Chunks simulated in the
+same pass are never next to each other, so a job can read the chunks
+around its chunk while only writing to its own. Only chunks where water
+moved (and the chunks next to them if it moved at the border) are remeshed.
+
+*/
+
+constexpr u8 FLUID_SOURCE_LEVEL = 8;
+constexpr u8 FLUID_MAX_FLOW_LEVEL = 7;
+constexpr u8 FLUID_FALLING_FLAG = 0x10;           // Water with water right above it, spreads as far as a source
+constexpr u8 FLUID_LEVEL_MASK = 0x0F;
+
+constexpr u32 FLUID_TICK_INTERVAL = 4;            // Block ticks between fluid ticks (5 per second)
+
+// Flow level of each voxel, 0 for voxels without water
+using VoxelFluidChunk = Array3D<u8>;
+
+// Height of the water surface in a voxel with this flow level
+inline f32 GetFluidSurfaceHeight(u8 level)
+{
+    if (level & FLUID_FALLING_FLAG)
+        return 1.0f;
+
+    return (f32) (level & FLUID_LEVEL_MASK) / (f32) (FLUID_SOURCE_LEVEL + 1);
+}
+
+struct VoxelChunkArea;
+
+// Call after the block at a position was changed so the water around it starts moving again
+void ActivateFluidAroundBlock(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex);
+
+// Simulates the active cells once, run by the block tick loop.
+// Chunks whose meshes have to be rebuilt because water moved are added to changedChunks.
+void TickFluids(VoxelChunkArea& area, DynamicArray<Vector3Int>& changedChunks);
+
+void FreeVoxelFluidData();
\ No newline at end of file
@@ -0,0 +1,711 @@
+#include "voxel_light.h"
+
+#include "containers/hashtable.h"
+#include "engine/job_system.h"
+#include "platform/platform.h"
+#include "chunk_area.h"
+
+constexpr u32 CHUNK_VOXEL_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// Light levels are stored in 4 bits, these shifts pick which ones
+constexpr u32 SUN_SHIFT = 4;
+constexpr u32 BLOCK_SHIFT = 0;
+
+// Indexed by VoxelFaceDirection, the opposite of direction d is 5 - d
+constexpr s32 lightOffsets[6][3] = {
+    {  0,  0,  1 },     // Front
+    {  0,  1,  0 },     // Up
+    {  1,  0,  0 },     // Right
+    { -1,  0,  0 },     // Left
+    {  0, -1,  0 },     // Down
+    {  0,  0, -1 },     // Back
+};
+
+struct LightNode
+{
+    u32 slot;
+    u16 index;                  // Index of the voxel in the chunk
+    u8  level;                  // Level the voxel had before it was removed (only used while removing light)
+};
+
+// Voxel next to another voxel, can be in a neighbouring chunk
+struct LightNeighbour
+{
+    u32 slot;                   // AIR_CHUNK_SLOT if it's in open sky, NO_CHUNK_SLOT if it doesn't store light
+    u32 index;
+    Vector3Int coord;           // Chunk coordinate of the chunk the voxel is in
+};
+
+struct ColumnLightJob
+{
+    VoxelChunkArea* area;
+    const u32* slots;           // Chunks in the column from top to bottom
+    u32 slotCount;
+};
+
+static struct
+{
+    DynamicArray<LightNode> sunQueue;
+    DynamicArray<LightNode> blockQueue;
+    DynamicArray<LightNode> removeQueue;
+
+    // Chunks whose light changed during the current update
+    bool* slotChanged = nullptr;
+    u32 slotChangedCapacity = 0;
+    DynamicArray<u32> changedSlots;
+
+    DynamicArray<u32> columnSlots;
+    DynamicArray<ColumnLightJob> columnJobs;
+} lightData;
+
+static inline u32 VoxelIndex(u32 x, u32 y, u32 z)
+{
+    return x + y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE;
+}
+
+static inline u8 GetLightLevel(u8 light, u32 shift)
+{
+    return (light >> shift) & MAX_LIGHT_LEVEL;
+}
+
+static inline void SetLightLevel(u8& light, u32 shift, u8 level)
+{
+    light = (u8) ((light & ~(MAX_LIGHT_LEVEL << shift)) | (level << shift));
+}
+
+// Level of light a voxel gives to its neighbour in a direction
+static inline u8 SpreadLightLevel(u8 level, u32 shift, u32 direction)
+{
+    // Sunlight at full strength goes straight down without getting weaker
+    if (shift == SUN_SHIFT && direction == (u32) VoxelFaceDirection::DOWN && level == MAX_LIGHT_LEVEL)
+        return MAX_LIGHT_LEVEL;
+
+    return (level > 0) ? level - 1 : 0;
+}
+
+// Slot of the chunk next to another chunk in a direction if it stores light.
+// AIR_CHUNK_SLOT if it's in open sky and NO_CHUNK_SLOT if light can't go there.
+static u32 GetLightChunkSlot(const VoxelChunkArea& area, const Vector3Int& coord, u32 direction)
+{
+    u32 slot = area.chunkMap.Find(coord);
+
+    // Chunks at lower levels of detail don't store light
+    if (IsValidChunkSlot(slot) && area.chunks[slot].dimension() != CHUNK_SIZE)
+        slot = NO_CHUNK_SLOT;
+
+    // Same as when chunks are lit, sunlight comes down from chunks above that don't store light
+    if (slot == NO_CHUNK_SLOT && direction == (u32) VoxelFaceDirection::UP)
+        slot = AIR_CHUNK_SLOT;
+
+    return slot;
+}
+
+static LightNeighbour GetLightNeighbour(const VoxelChunkArea& area, u32 slot, u32 index, u32 direction)
+{
+    const s32 x = (s32) (index % CHUNK_SIZE) + lightOffsets[direction][0];
+    const s32 y = (s32) ((index / CHUNK_SIZE) % CHUNK_SIZE) + lightOffsets[direction][1];
+    const s32 z = (s32) (index / (CHUNK_SIZE * CHUNK_SIZE)) + lightOffsets[direction][2];
+
+    LightNeighbour neighbour;
+    neighbour.index = VoxelIndex((u32) x & (CHUNK_SIZE - 1), (u32) y & (CHUNK_SIZE - 1), (u32) z & (CHUNK_SIZE - 1));
+    neighbour.coord = area.chunkCoords[slot];
+
+    if (x >= 0 && x < (s32) CHUNK_SIZE && y >= 0 && y < (s32) CHUNK_SIZE && z >= 0 && z < (s32) CHUNK_SIZE)
+    {
+        neighbour.slot = slot;
+        return neighbour;
+    }
+
+    neighbour.coord = neighbour.coord + Vector3Int { lightOffsets[direction][0], lightOffsets[direction][1], lightOffsets[direction][2] };
+    neighbour.slot = GetLightChunkSlot(area, neighbour.coord, direction);
+    return neighbour;
+}
+
+static void MarkSlotChanged(u32 slot)
+{
+    if (lightData.slotChanged[slot])
+        return;
+
+    lightData.slotChanged[slot] = true;
+    lightData.changedSlots.PushBack(slot);
+}
+
+// Meshes sample light from neighbouring chunks so those change too if the voxel is at a border
+static void MarkVoxelChanged(const VoxelChunkArea& area, u32 slot, u32 index)
+{
+    MarkSlotChanged(slot);
+
+    const u32 x = index % CHUNK_SIZE;
+    const u32 y = (index / CHUNK_SIZE) % CHUNK_SIZE;
+    const u32 z = index / (CHUNK_SIZE * CHUNK_SIZE);
+
+    const s32 dx = (x == 0) ? -1 : ((x == CHUNK_SIZE - 1) ? 1 : 0);
+    const s32 dy = (y == 0) ? -1 : ((y == CHUNK_SIZE - 1) ? 1 : 0);
+    const s32 dz = (z == 0) ? -1 : ((z == CHUNK_SIZE - 1) ? 1 : 0);
+
+    if (dx == 0 && dy == 0 && dz == 0)
+        return;
+
+    for (s32 oz = Min(dz, 0); oz <= Max(dz, 0); oz++)
+    for (s32 oy = Min(dy, 0); oy <= Max(dy, 0); oy++)
+    for (s32 ox = Min(dx, 0); ox <= Max(dx, 0); ox++)
+    {
+        if (ox == 0 && oy == 0 && oz == 0)
+            continue;
+
+        const u32 neighbourSlot = area.chunkMap.Find(area.chunkCoords[slot] + Vector3Int { ox, oy, oz });
+        if (IsValidChunkSlot(neighbourSlot))
+            MarkSlotChanged(neighbourSlot);
+    }
+}
+
+static void BeginLightUpdate(const VoxelChunkArea& area)
+{
+    if (lightData.slotChangedCapacity < area.maxChunkSlots)
+    {
+        PlatformFree(lightData.slotChanged);
+        lightData.slotChanged = (bool*) PlatformAllocate(area.maxChunkSlots * sizeof(bool));
+        AssertWithMessage(lightData.slotChanged, "Couldn't allocate changed chunk flags for lighting!");
+
+        PlatformZeroMemory(lightData.slotChanged, area.maxChunkSlots * sizeof(bool));
+        lightData.slotChangedCapacity = area.maxChunkSlots;
+    }
+}
+
+static void EndLightUpdate(const VoxelChunkArea& area, DynamicArray<Vector3Int>& changedChunks)
+{
+    for (u32 i = 0; i < lightData.changedSlots.size(); i++)
+    {
+        const u32 slot = lightData.changedSlots[i];
+        lightData.slotChanged[slot] = false;
+        changedChunks.PushBack(area.chunkCoords[slot]);
+    }
+
+    lightData.changedSlots.Clear(false);
+}
+
+// Floods light through the chunk from every voxel in the queue, doesn't leave the chunk
+static void PropagateLightInChunk(const BlockType* blocks, u8* levels, DynamicArray<u16>& queue, u32 shift)
+{
+    for (u64 head = 0; head < queue.size(); head++)
+    {
+        const u32 index = queue[head];
+        const u8 level = GetLightLevel(levels[index], shift);
+
+        const s32 x = index % CHUNK_SIZE;
+        const s32 y = (index / CHUNK_SIZE) % CHUNK_SIZE;
+        const s32 z = index / (CHUNK_SIZE * CHUNK_SIZE);
+
+        for (u32 direction = 0; direction < 6; direction++)
+        {
+            const s32 nx = x + lightOffsets[direction][0];
+            const s32 ny = y + lightOffsets[direction][1];
+            const s32 nz = z + lightOffsets[direction][2];
+
+            if (nx < 0 || nx >= (s32) CHUNK_SIZE || ny < 0 || ny >= (s32) CHUNK_SIZE || nz < 0 || nz >= (s32) CHUNK_SIZE)
+                continue;
+
+            const u32 neighbourIndex = VoxelIndex(nx, ny, nz);
+            const u8 newLevel = SpreadLightLevel(level, shift, direction);
+
+            if (!VoxelBlockPassesLight(blocks[neighbourIndex]) || GetLightLevel(levels[neighbourIndex], shift) >= newLevel)
+                continue;
+
+            SetLightLevel(levels[neighbourIndex], shift, newLevel);
+            queue.PushBack((u16) neighbourIndex);
+        }
+    }
+
+    queue.Clear(false);
+}
+
+// Lights a chunk on its own. Only sunlight from the chunk above comes in, light from the
+// other neighbours is spread in when the chunk is stitched to them.
+static void FloodChunkLight(const VoxelChunk& chunk, VoxelLightChunk& light, const VoxelLightChunk* lightAbove, DynamicArray<u16>& queue)
+{
+    const BlockType* blocks = chunk.data();
+    u8* levels = light.data();
+
+    PlatformZeroMemory(levels, CHUNK_VOXEL_COUNT);
+
+    {   // Sunlight falls down each column till it hits something
+        for (u32 z = 0; z < CHUNK_SIZE; z++)
+        for (u32 x = 0; x < CHUNK_SIZE; x++)
+        {
+            const u8 sunAbove = lightAbove ? GetSunLight(lightAbove->at(x, 0, z)) : MAX_LIGHT_LEVEL;
+            const u32 topIndex = VoxelIndex(x, CHUNK_SIZE - 1, z);
+
+            if (sunAbove == MAX_LIGHT_LEVEL)
+            {
+                for (s32 y = CHUNK_SIZE - 1; y >= 0; y--)
+                {
+                    const u32 index = VoxelIndex(x, y, z);
+                    if (!VoxelBlockPassesLight(blocks[index]))
+                        break;
+
+                    levels[index] = FULL_SUNLIGHT;
+                }
+            }
+            else if (sunAbove > 1 && VoxelBlockPassesLight(blocks[topIndex]))
+            {
+                SetLightLevel(levels[topIndex], SUN_SHIFT, sunAbove - 1);
+                queue.PushBack((u16) topIndex);
+            }
+        }
+    }
+
+    {   // Spread sunlight sideways from the lit columns
+        for (u32 z = 0; z < CHUNK_SIZE; z++)
+        for (u32 y = 0; y < CHUNK_SIZE; y++)
+        for (u32 x = 0; x < CHUNK_SIZE; x++)
+        {
+            const u32 index = VoxelIndex(x, y, z);
+            if (levels[index] != FULL_SUNLIGHT)
+                continue;
+
+            // Only the edges of the lit columns need to spread
+            const bool needsSpread = (x > 0              && levels[index - 1] != FULL_SUNLIGHT && VoxelBlockPassesLight(blocks[index - 1])) ||
+                                     (x < CHUNK_SIZE - 1 && levels[index + 1] != FULL_SUNLIGHT && VoxelBlockPassesLight(blocks[index + 1])) ||
+                                     (z > 0              && levels[index - CHUNK_SIZE * CHUNK_SIZE] != FULL_SUNLIGHT && VoxelBlockPassesLight(blocks[index - CHUNK_SIZE * CHUNK_SIZE])) ||
+                                     (z < CHUNK_SIZE - 1 && levels[index + CHUNK_SIZE * CHUNK_SIZE] != FULL_SUNLIGHT && VoxelBlockPassesLight(blocks[index + CHUNK_SIZE * CHUNK_SIZE]));
+
+            if (needsSpread)
+                queue.PushBack((u16) index);
+        }
+
+        PropagateLightInChunk(blocks, levels, queue, SUN_SHIFT);
+    }
+
+    {   // Block light from light emitting blocks
+        for (u32 index = 0; index < CHUNK_VOXEL_COUNT; index++)
+        {
+            const u8 emission = blockLightEmissions[(u32) blocks[index]];
+            if (emission == 0)
+                continue;
+
+            SetLightLevel(levels[index], BLOCK_SHIFT, emission);
+            queue.PushBack((u16) index);
+        }
+
+        PropagateLightInChunk(blocks, levels, queue, BLOCK_SHIFT);
+    }
+}
+
+static void LightColumnJob(void* data)
+{
+    ColumnLightJob& job = *(ColumnLightJob*) data;
+    const VoxelChunkArea& area = *job.area;
+
+    // Voxels can be queued again when they get brighter so this can grow past a chunk
+    DynamicArray<u16> queue(CHUNK_VOXEL_COUNT / 4);
+
+    for (u32 i = 0; i < job.slotCount; i++)
+    {
+        const u32 slot = job.slots[i];
+
+        // Chunk above is either lit already or in this column, anything else is open sky
+        const u32 slotAbove = area.chunkMap.Find(area.chunkCoords[slot] + Vector3Int { 0, 1, 0 });
+        const bool aboveHasLight = IsValidChunkSlot(slotAbove) && area.chunks[slotAbove].dimension() == CHUNK_SIZE;
+
+        FloodChunkLight(area.chunks[slot], job.area->lights[slot], aboveHasLight ? &area.lights[slotAbove] : nullptr, queue);
+    }
+
+    queue.Free();
+}
+
+static DynamicArray<LightNode>& GetLightQueue(u32 shift)
+{
+    return (shift == SUN_SHIFT) ? lightData.sunQueue : lightData.blockQueue;
+}
+
+// Air chunks are in full sunlight, this is the light they give to a voxel next to them
+static void LightFromAirChunk(VoxelChunkArea& area, u32 slot, u32 index, u32 directionToAir, u32 shift)
+{
+    if (shift != SUN_SHIFT || !VoxelBlockPassesLight(area.chunks[slot].data()[index]))
+        return;
+
+    const u8 newLevel = SpreadLightLevel(MAX_LIGHT_LEVEL, SUN_SHIFT, 5 - directionToAir);
+    u8& light = area.lights[slot].data()[index];
+
+    if (GetSunLight(light) >= newLevel)
+        return;
+
+    SetLightLevel(light, SUN_SHIFT, newLevel);
+    MarkVoxelChanged(area, slot, index);
+    lightData.sunQueue.PushBack(LightNode { slot, (u16) index, newLevel });
+}
+
+// Spreads light from the queued voxels across chunks till it runs out
+static void PropagateLightIncrease(VoxelChunkArea& area, u32 shift)
+{
+    DynamicArray<LightNode>& queue = GetLightQueue(shift);
+
+    for (u64 head = 0; head < queue.size(); head++)
+    {
+        const LightNode node = queue[head];
+        const u8 level = GetLightLevel(area.lights[node.slot].data()[node.index], shift);
+        if (level <= 1)
+            continue;
+
+        for (u32 direction = 0; direction < 6; direction++)
+        {
+            LightNeighbour neighbour = GetLightNeighbour(area, node.slot, node.index, direction);
+            if (neighbour.slot == NO_CHUNK_SLOT)
+                continue;
+
+            if (neighbour.slot == AIR_CHUNK_SLOT)
+            {
+                // Air chunks are in full sunlight already, only block light can make them brighter
+                if (shift == SUN_SHIFT || area.chunkMap.Find(neighbour.coord) != AIR_CHUNK_SLOT)
+                    continue;
+
+                neighbour.slot = area.AcquireAirChunk(neighbour.coord);
+                if (neighbour.slot == NO_CHUNK_SLOT)
+                    continue;
+            }
+
+            const u8 newLevel = SpreadLightLevel(level, shift, direction);
+            u8& neighbourLight = area.lights[neighbour.slot].data()[neighbour.index];
+
+            if (!VoxelBlockPassesLight(area.chunks[neighbour.slot].data()[neighbour.index]) || GetLightLevel(neighbourLight, shift) >= newLevel)
+                continue;
+
+            SetLightLevel(neighbourLight, shift, newLevel);
+            MarkVoxelChanged(area, neighbour.slot, neighbour.index);
+            queue.PushBack(LightNode { neighbour.slot, (u16) neighbour.index, newLevel });
+        }
+    }
+
+    queue.Clear(false);
+}
+
+// Darkens every voxel that was lit by the queued voxels. Voxels at the edge of the
+// darkened region that are lit by something else are queued to spread light back in.
+static void PropagateLightDecrease(VoxelChunkArea& area, u32 shift)
+{
+    DynamicArray<LightNode>& queue = lightData.removeQueue;
+    DynamicArray<LightNode>& increaseQueue = GetLightQueue(shift);
+
+    for (u64 head = 0; head < queue.size(); head++)
+    {
+        const LightNode node = queue[head];
+
+        for (u32 direction = 0; direction < 6; direction++)
+        {
+            const LightNeighbour neighbour = GetLightNeighbour(area, node.slot, node.index, direction);
+            if (neighbour.slot == NO_CHUNK_SLOT)
+                continue;
+
+            if (neighbour.slot == AIR_CHUNK_SLOT)
+            {
+                LightFromAirChunk(area, node.slot, node.index, direction, shift);
+                continue;
+            }
+
+            u8& neighbourLight = area.lights[neighbour.slot].data()[neighbour.index];
+            const u8 neighbourLevel = GetLightLevel(neighbourLight, shift);
+            if (neighbourLevel == 0)
+                continue;
+
+            const bool litByNode = neighbourLevel < node.level ||
+                                   (shift == SUN_SHIFT && direction == (u32) VoxelFaceDirection::DOWN && node.level == MAX_LIGHT_LEVEL);
+
+            if (!litByNode)
+            {
+                increaseQueue.PushBack(LightNode { neighbour.slot, (u16) neighbour.index, neighbourLevel });
+                continue;
+            }
+
+            SetLightLevel(neighbourLight, shift, 0);
+            MarkVoxelChanged(area, neighbour.slot, neighbour.index);
+            queue.PushBack(LightNode { neighbour.slot, (u16) neighbour.index, neighbourLevel });
+
+            // Light emitting blocks light themselves back up
+            const u8 emission = (shift == BLOCK_SHIFT) ? blockLightEmissions[(u32) area.chunks[neighbour.slot].data()[neighbour.index]] : 0;
+            if (emission > 0)
+            {
+                SetLightLevel(neighbourLight, shift, emission);
+                increaseQueue.PushBack(LightNode { neighbour.slot, (u16) neighbour.index, emission });
+            }
+        }
+    }
+
+    queue.Clear(false);
+}
+
+// Spreads light both ways across the borders of a chunk that was just lit
+static void StitchChunkLight(VoxelChunkArea& area, u32 slot)
+{
+    u8* levels = area.lights[slot].data();
+    const BlockType* blocks = area.chunks[slot].data();
+
+    for (u32 direction = 0; direction < 6; direction++)
+    {
+        const s32* offset = lightOffsets[direction];
+        const Vector3Int neighbourCoord = area.chunkCoords[slot] + Vector3Int { offset[0], offset[1], offset[2] };
+        const u32 neighbourSlot = GetLightChunkSlot(area, neighbourCoord, direction);
+        if (neighbourSlot == NO_CHUNK_SLOT)
+            continue;
+
+        const u32 edge = (offset[0] + offset[1] + offset[2] > 0) ? CHUNK_SIZE - 1 : 0;
+        const u32 neighbourEdge = CHUNK_SIZE - 1 - edge;
+
+        for (u32 b = 0; b < CHUNK_SIZE; b++)
+        for (u32 a = 0; a < CHUNK_SIZE; a++)
+        {
+            const u32 x = offset[0] ? edge : a;
+            const u32 y = offset[1] ? edge : (offset[0] ? a : b);
+            const u32 z = offset[2] ? edge : b;
+            const u32 index = VoxelIndex(x, y, z);
+
+            if (neighbourSlot == AIR_CHUNK_SLOT)
+            {
+                LightFromAirChunk(area, slot, index, direction, SUN_SHIFT);
+                continue;
+            }
+
+            const u32 neighbourIndex = VoxelIndex(offset[0] ? neighbourEdge : x, offset[1] ? neighbourEdge : y, offset[2] ? neighbourEdge : z);
+            u8& neighbourLight = area.lights[neighbourSlot].data()[neighbourIndex];
+
+            const bool passesLight = VoxelBlockPassesLight(blocks[index]);
+            const bool neighbourPassesLight = VoxelBlockPassesLight(area.chunks[neighbourSlot].data()[neighbourIndex]);
+
+            for (u32 shift = 0; shift <= SUN_SHIFT; shift += SUN_SHIFT)
+            {
+                const u8 level = GetLightLevel(levels[index], shift);
+                const u8 neighbourLevel = GetLightLevel(neighbourLight, shift);
+
+                const u8 levelOut = SpreadLightLevel(level, shift, direction);
+                const u8 levelIn  = SpreadLightLevel(neighbourLevel, shift, 5 - direction);
+
+                if (neighbourPassesLight && levelOut > neighbourLevel)
+                {
+                    SetLightLevel(neighbourLight, shift, levelOut);
+                    MarkVoxelChanged(area, neighbourSlot, neighbourIndex);
+                    GetLightQueue(shift).PushBack(LightNode { neighbourSlot, (u16) neighbourIndex, levelOut });
+                }
+                else if (passesLight && levelIn > level)
+                {
+                    SetLightLevel(levels[index], shift, levelIn);
+                    MarkVoxelChanged(area, slot, index);
+                    GetLightQueue(shift).PushBack(LightNode { slot, (u16) index, levelIn });
+                }
+            }
+        }
+    }
+}
+
+void LightLoadedChunks(VoxelChunkArea& area, const Vector3Int* coords, u32 count, DynamicArray<Vector3Int>& changedChunks)
+{
+    BeginLightUpdate(area);
+
+    lightData.columnSlots.Clear(false);
+    lightData.columnJobs.Clear(false);
+
+    {   // Group the chunks into columns, everything under a new chunk is relit
+        HashTable<ChunkKey, s32> columnTops;
+        DynamicArray<Vector3Int> columns;
+
+        for (u32 i = 0; i < count; i++)
+        {
+            const u32 slot = area.chunkMap.Find(coords[i]);
+            if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+                continue;
+
+            const ChunkKey key = PackChunkCoord(Vector3Int { coords[i].x, 0, coords[i].z });
+            auto it = columnTops.Find(key);
+            if (!it)
+            {
+                columnTops.Place(key, coords[i].y);
+                columns.PushBack(Vector3Int { coords[i].x, 0, coords[i].z });
+            }
+            else if (it.value() < coords[i].y)
+                it.value() = coords[i].y;
+        }
+
+        const s32 bottomY = area.loadShape.MinY(area.centerChunk);
+
+        for (u32 i = 0; i < columns.size(); i++)
+        {
+            const s32 topY = columnTops[PackChunkCoord(columns[i])];
+
+            ColumnLightJob job;
+            job.area = &area;
+            job.slots = nullptr;            // Set once the slot list stops growing
+            job.slotCount = 0;
+
+            for (s32 y = topY; y >= bottomY; y--)
+            {
+                const u32 slot = area.chunkMap.Find(Vector3Int { columns[i].x, y, columns[i].z });
+                if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+                    continue;
+
+                lightData.columnSlots.PushBack(slot);
+                job.slotCount++;
+            }
+
+            lightData.columnJobs.PushBack(job);
+        }
+
+        columns.Free();
+    }
+
+    {   // Light each column on the job system
+        const u32* slots = lightData.columnSlots.data();
+        for (u32 i = 0; i < lightData.columnJobs.size(); i++)
+        {
+            lightData.columnJobs[i].slots = slots;
+            slots += lightData.columnJobs[i].slotCount;
+        }
+
+        JobSystem::JobCounter counter;
+        for (u32 i = 0; i < lightData.columnJobs.size(); i++)
+            JobSystem::Submit(LightColumnJob, &lightData.columnJobs[i], &counter);
+
+        JobSystem::Wait(counter);
+    }
+
+    {   // Spread light between the new chunks and the chunks around them
+        for (u32 i = 0; i < lightData.columnSlots.size(); i++)
+        {
+            MarkSlotChanged(lightData.columnSlots[i]);
+            StitchChunkLight(area, lightData.columnSlots[i]);
+        }
+
+        PropagateLightIncrease(area, SUN_SHIFT);
+        PropagateLightIncrease(area, BLOCK_SHIFT);
+    }
+
+    EndLightUpdate(area, changedChunks);
+}
+
+void RemoveLightOfUnloadedChunks(VoxelChunkArea& area, const Vector3Int* coords, u32 count, DynamicArray<Vector3Int>& changedChunks)
+{
+    if (count == 0)
+        return;
+
+    BeginLightUpdate(area);
+
+    for (u32 shift = 0; shift <= SUN_SHIFT; shift += SUN_SHIFT)
+    {
+        for (u32 i = 0; i < count; i++)
+        for (u32 direction = 0; direction < 6; direction++)
+        {
+            const s32* offset = lightOffsets[direction];
+            const u32 slot = area.chunkMap.Find(coords[i] + Vector3Int { offset[0], offset[1], offset[2] });
+
+            if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+                continue;
+
+            // Face of the neighbour that touched the unloaded chunk
+            const u32 edge = (offset[0] + offset[1] + offset[2] > 0) ? 0 : CHUNK_SIZE - 1;
+            u8* levels = area.lights[slot].data();
+
+            for (u32 b = 0; b < CHUNK_SIZE; b++)
+            for (u32 a = 0; a < CHUNK_SIZE; a++)
+            {
+                const u32 x = offset[0] ? edge : a;
+                const u32 y = offset[1] ? edge : (offset[0] ? a : b);
+                const u32 z = offset[2] ? edge : b;
+                const u32 index = VoxelIndex(x, y, z);
+
+                const u8 level = GetLightLevel(levels[index], shift);
+                if (level == 0)
+                    continue;
+
+                // Light that came from somewhere else is spread back in
+                SetLightLevel(levels[index], shift, 0);
+                MarkVoxelChanged(area, slot, index);
+                lightData.removeQueue.PushBack(LightNode { slot, (u16) index, level });
+
+                const u8 emission = (shift == BLOCK_SHIFT) ? blockLightEmissions[(u32) area.chunks[slot].data()[index]] : 0;
+                if (emission > 0)
+                {
+                    SetLightLevel(levels[index], shift, emission);
+                    GetLightQueue(shift).PushBack(LightNode { slot, (u16) index, emission });
+                }
+            }
+        }
+
+        PropagateLightDecrease(area, shift);
+        PropagateLightIncrease(area, shift);
+    }
+
+    EndLightUpdate(area, changedChunks);
+}
+
+void UpdateLightAfterBlockChange(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, DynamicArray<Vector3Int>& changedChunks)
+{
+    const u32 slot = area.chunkMap.Find(chunkIndex);
+    if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+        return;
+
+    BeginLightUpdate(area);
+
+    const u32 index = VoxelIndex(blockIndex.x, blockIndex.y, blockIndex.z);
+    const BlockType type = area.chunks[slot].data()[index];
+
+    for (u32 shift = 0; shift <= SUN_SHIFT; shift += SUN_SHIFT)
+    {
+        u8& light = area.lights[slot].data()[index];
+        const u8 level = GetLightLevel(light, shift);
+
+        // Take away the light the block had and everything that came from it
+        if (level > 0)
+        {
+            SetLightLevel(light, shift, 0);
+            lightData.removeQueue.PushBack(LightNode { slot, (u16) index, level });
+        }
+
+        // Let the light around the block back in
+        if (VoxelBlockPassesLight(type))
+        {
+            for (u32 direction = 0; direction < 6; direction++)
+            {
+                const LightNeighbour neighbour = GetLightNeighbour(area, slot, index, direction);
+
+                if (neighbour.slot == AIR_CHUNK_SLOT)
+                    LightFromAirChunk(area, slot, index, direction, shift);
+                else if (neighbour.slot != NO_CHUNK_SLOT)
+                    GetLightQueue(shift).PushBack(LightNode { neighbour.slot, (u16) neighbour.index, 0 });
+            }
+        }
+
+        const u8 emission = (shift == BLOCK_SHIFT) ? blockLightEmissions[(u32) type] : 0;
+        if (emission > 0)
+        {
+            SetLightLevel(light, shift, emission);
+            GetLightQueue(shift).PushBack(LightNode { slot, (u16) index, emission });
+        }
+
+        MarkVoxelChanged(area, slot, index);
+        PropagateLightDecrease(area, shift);
+        PropagateLightIncrease(area, shift);
+    }
+
+    EndLightUpdate(area, changedChunks);
+}
+
+u8 GetLightAtPosition(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    const u32 slot = area.chunkMap.Find(chunkIndex);
+    if (!IsValidChunkSlot(slot) || area.chunks[slot].dimension() != CHUNK_SIZE)
+        return FULL_SUNLIGHT;
+
+    return area.lights[slot].at(blockIndex.x, blockIndex.y, blockIndex.z);
+}
+
+void FreeVoxelLightData()
+{
+    lightData.sunQueue.Free();
+    lightData.blockQueue.Free();
+    lightData.removeQueue.Free();
+
+    PlatformFree(lightData.slotChanged);
+    lightData.slotChanged = nullptr;
+    lightData.slotChangedCapacity = 0;
+    lightData.changedSlots.Free();
+
+    lightData.columnSlots.Free();
+    lightData.columnJobs.Free();
+}
\ No newline at end of file
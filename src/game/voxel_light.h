@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/array_3d.h"
+#include "containers/darray.h"
+#include "voxel.h"
+
+/*
+
+Voxel light engine.
+
+Every voxel of a full resolution chunk stores a sunlight and a block light
+level in [0, 15]. Both are flood filled (BFS) through blocks that light can
+pass through, getting 1 level weaker with every step. Sunlight at full
+strength doesn't get weaker when it goes straight down.
+
+New chunks are lit in parallel on the job system, one job per column of
+chunks so sunlight can be carried down from the chunk above. Light is then
+spread across the borders of the new chunks. Block changes only undo and
+redo the light around the changed block, so an edit costs as much as the
+amount of light it changes.
+
+Chunks that are only air don't store light, they're always in full sunlight.
+Chunks at lower levels of detail don't store light either.
+
+*/
+
+constexpr u8 MAX_LIGHT_LEVEL = 15;
+constexpr u8 FULL_SUNLIGHT = MAX_LIGHT_LEVEL << 4;
+
+// High 4 bits are the sunlight level, low 4 bits are the block light level
+using VoxelLightChunk = Array3D<u8>;
+
+inline u8 GetSunLight(u8 light)
+{
+    return light >> 4;
+}
+
+inline u8 GetBlockLight(u8 light)
+{
+    return light & 0x0F;
+}
+
+// Block light level given off by each block type
+constexpr u8 blockLightEmissions[] = {
+    0,  // None
+
+    0,  // Glass
+    0,  // Water
+
+    0,  // Dirt
+    0,  // Grass
+    0,  // Sand
+    0,  // Sand Stone
+    0,  // Gravel
+    0,  // Wood
+    0,  // Wooden Plank
+    0,  // Clay
+    0,  // Bricks
+    0,  // Cobble Stone
+    0,  // Mossy Cobble Stone
+    0,  // Stone
+    0,  // Bedrock
+    0,  // Obsidian
+    MAX_LIGHT_LEVEL,   // Glowstone
+};
+
+inline bool VoxelBlockPassesLight(BlockType type)
+{
+    return VoxelBlockHasTransparency(type);
+}
+
+struct VoxelChunkArea;
+
+// Lights chunks that were just loaded along with the chunks below them (since sunlight comes down from the top).
+// Chunks whose light changed are added to changedChunks, including the ones that were lit.
+void LightLoadedChunks(VoxelChunkArea& area, const Vector3Int* coords, u32 count, DynamicArray<Vector3Int>& changedChunks);
+
+// Takes away the light that came from chunks that were unloaded (or moved to a lower level of detail).
+// Call after the chunks are out of the chunk map. Chunks whose light changed are added to changedChunks.
+void RemoveLightOfUnloadedChunks(VoxelChunkArea& area, const Vector3Int* coords, u32 count, DynamicArray<Vector3Int>& changedChunks);
+
+// Call after the block at a position was changed. Chunks whose light changed are added to changedChunks.
+void UpdateLightAfterBlockChange(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, DynamicArray<Vector3Int>& changedChunks);
+
+// Returns FULL_SUNLIGHT if the chunk doesn't store light
+u8 GetLightAtPosition(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex);
+
+void FreeVoxelLightData();
\ No newline at end of file
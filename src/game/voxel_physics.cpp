@@ -17,23 +17,18 @@ bool RayIntersectionWithBlock(const VoxelChunkArea& area, const Vector3& rayOrig
     {   // Check for intersecting chunk
         IntersectionResult blockClosestHit = {};
 
-        const u32 halfDim = area.chunkIndices.dimension() / 2;
-        for (u32 cz = halfDim - 1; cz <= halfDim + 1; cz++)
-        for (u32 cy = halfDim - 1; cy <= halfDim + 1; cy++)
-        for (u32 cx = halfDim - 1; cx <= halfDim + 1; cx++)
+        for (s32 cz = -1; cz <= 1; cz++)
+        for (s32 cy = -1; cy <= 1; cy++)
+        for (s32 cx = -1; cx <= 1; cx++)
         {
-            u32 index = area.chunkIndices.at(cx, cy, cz);
-            
+            const Vector3Int chunkIndex = area.centerChunk + Vector3Int { cx, cy, cz };
+            const u32 index = area.chunkMap.Find(chunkIndex);
+
             // Don't check for intersections in empty chunks
-            if (area.isOnlyAir[index] || (area.opaqueFaceCounts[index] == 0 && area.transparentFaceCounts == 0))
+            if (!IsValidChunkSlot(index) || area.isOnlyAir[index] || (area.opaqueFaceCounts[index] == 0 && area.transparentFaceCounts[index] == 0))
                 continue;
 
-            // Offsets for chunk
-            const f32 sx = ((f32) cx - halfDim);
-            const f32 sy = ((f32) cy - halfDim);
-            const f32 sz = ((f32) cz - halfDim);
-
-            const Vector3 chunkPosition = area.areaPosition + Vector3(sx * CHUNK_SIZE, sy * CHUNK_SIZE, sz * CHUNK_SIZE);
+            const Vector3 chunkPosition = ChunkCoordToPosition(chunkIndex);
 
             AABB chunkAABB;
             {   // Fill AABB
@@ -65,7 +60,7 @@ bool RayIntersectionWithBlock(const VoxelChunkArea& area, const Vector3& rayOrig
                         if (blockHit.tmax < blockClosestHit.tmax)
                         {
                             blockClosestHit = blockHit;
-                            hit.chunkIndex = Vector3Int { (s32) cx, (s32) cy, (s32) cz };
+                            hit.chunkIndex = chunkIndex;
                             hit.blockIndex = Vector3Int { (s32) x, (s32) y, (s32) z };
                             hit.t = blockHit.tmin;
                         }
@@ -81,16 +76,9 @@ bool RayIntersectionWithBlock(const VoxelChunkArea& area, const Vector3& rayOrig
     return hit.t < Math::Infinity;
 }
 
-AABB GetBlockAABB(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+AABB GetBlockAABB(const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
 {
-    const u32 halfDim = area.chunkIndices.dimension() / 2;
-    
-    // Offsets for chunk
-    const f32 sx = ((f32) chunkIndex.x - halfDim);
-    const f32 sy = ((f32) chunkIndex.y - halfDim);
-    const f32 sz = ((f32) chunkIndex.z - halfDim);
-
-    const Vector3 chunkPosition = area.areaPosition + Vector3(sx * CHUNK_SIZE, sy * CHUNK_SIZE, sz * CHUNK_SIZE);
+    const Vector3 chunkPosition = ChunkCoordToPosition(chunkIndex);
 
     AABB blockAABB;
     {
@@ -101,9 +89,9 @@ AABB GetBlockAABB(const VoxelChunkArea& area, const Vector3Int& chunkIndex, cons
     return blockAABB;
 }
 
-Vector3Int GetHitNormal(const VoxelChunkArea& area, const RayHitResult& hit)
+Vector3Int GetHitNormal(const RayHitResult& hit)
 {
-    AABB blockAABB = GetBlockAABB(area, hit.chunkIndex, hit.blockIndex);
+    AABB blockAABB = GetBlockAABB(hit.chunkIndex, hit.blockIndex);
 
     // Find normal of the hit. This is done by finding the hit position of the ray on the cube.
     // Reference: https://blog.johnnovak.net/2016/10/22/the-nim-ray-tracer-project-part-4-calculating-box-normals/
@@ -111,4 +99,135 @@ Vector3Int GetHitNormal(const VoxelChunkArea& area, const RayHitResult& hit)
     const Vector3 normal = 1.001f * hitOnAABB / Vector3(0.5f);
 
     return Vector3Int { (s32) normal.x, (s32) normal.y, (s32) normal.z };
+}
+
+// Keeps boxes that touch a block face from counting as overlapping it
+constexpr f32 SWEEP_EPSILON = 1e-4f;
+
+// Moves the box along an axis until it hits a solid block. Only the layers of voxels between the leading
+// face of the box and where it would end up are checked. Returns true if the box hit something,
+// distance is changed to how far it actually moved.
+static bool SweepAxis(VoxelQuery& query, AABB& box, u32 axis, f32& distance)
+{
+    if (distance == 0.0f)
+        return false;
+
+    const u32 axisU = (axis + 1) % 3;
+    const u32 axisV = (axis + 2) % 3;
+
+    // Voxels the box covers on the other two axes
+    const s32 minU = (s32) Math::Floor(box.min[axisU] + SWEEP_EPSILON);
+    const s32 maxU = (s32) Math::Floor(box.max[axisU] - SWEEP_EPSILON);
+    const s32 minV = (s32) Math::Floor(box.min[axisV] + SWEEP_EPSILON);
+    const s32 maxV = (s32) Math::Floor(box.max[axisV] - SWEEP_EPSILON);
+
+    const f32 size = box.max[axis] - box.min[axis];
+
+    const s32 direction = (distance > 0.0f) ? 1 : -1;
+    const f32 front     = (distance > 0.0f) ? box.max[axis] : box.min[axis];
+
+    // First and last layer of voxels the leading face passes into
+    const s32 firstLayer = (distance > 0.0f) ? (s32) Math::Floor(front - SWEEP_EPSILON) + 1
+                                             : (s32) Math::Floor(front + SWEEP_EPSILON) - 1;
+    const s32 lastLayer  = (distance > 0.0f) ? (s32) Math::Floor(front + distance - SWEEP_EPSILON)
+                                             : (s32) Math::Floor(front + distance + SWEEP_EPSILON);
+
+    for (s32 layer = firstLayer; layer * direction <= lastLayer * direction; layer += direction)
+    {
+        bool hit = false;
+
+        for (s32 v = minV; v <= maxV && !hit; v++)
+        for (s32 u = minU; u <= maxU && !hit; u++)
+        {
+            s32 voxel[3];
+            voxel[axis]  = layer;
+            voxel[axisU] = u;
+            voxel[axisV] = v;
+
+            hit = query.IsSolid(voxel[0], voxel[1], voxel[2]);
+        }
+
+        if (hit)
+        {
+            // Snap the box flush against the block so it can rest on it without drifting
+            if (direction > 0)
+            {
+                distance = Max((f32) layer - front, 0.0f);
+                box.max[axis] = Max((f32) layer, front);
+                box.min[axis] = box.max[axis] - size;
+            }
+            else
+            {
+                distance = Min((f32) (layer + 1) - front, 0.0f);
+                box.min[axis] = Min((f32) (layer + 1), front);
+                box.max[axis] = box.min[axis] + size;
+            }
+
+            return true;
+        }
+    }
+
+    box.min[axis] += distance;
+    box.max[axis] += distance;
+
+    return false;
+}
+
+void StepPhysicsBody(const VoxelChunkArea& area, PhysicsBody& body)
+{
+    VoxelQuery query(area);
+
+    body.previousPosition = body.position;
+
+    body.velocity.y = Max(body.velocity.y - PHYSICS_GRAVITY * PHYSICS_TIME_STEP, -PHYSICS_TERMINAL_VELOCITY);
+
+    const Vector3 move = body.velocity * PHYSICS_TIME_STEP;
+
+    AABB box = GetBodyAABB(body);
+
+    {   // Vertical movement goes first so a body lands before it's moved sideways
+        f32 distance = move.y;
+        const bool hit = SweepAxis(query, box, 1, distance);
+
+        body.onGround = hit && move.y < 0.0f;
+
+        if (hit)
+            body.velocity.y = 0.0f;
+    }
+
+    const AABB landedBox = box;
+
+    f32 moveX = move.x, moveZ = move.z;
+    bool hitX = SweepAxis(query, box, 0, moveX);
+    bool hitZ = SweepAxis(query, box, 2, moveZ);
+
+    if ((hitX || hitZ) && body.onGround && body.stepHeight > 0.0f)
+    {   // Try the move again from stepHeight higher, then put the body back down, and keep it if it got further
+        AABB stepped = landedBox;
+
+        f32 up = body.stepHeight;
+        SweepAxis(query, stepped, 1, up);
+
+        f32 stepX = move.x, stepZ = move.z;
+        const bool stepHitX = SweepAxis(query, stepped, 0, stepX);
+        const bool stepHitZ = SweepAxis(query, stepped, 2, stepZ);
+
+        f32 down = -up;
+        SweepAxis(query, stepped, 1, down);
+
+        if (stepX * stepX + stepZ * stepZ > moveX * moveX + moveZ * moveZ)
+        {
+            box = stepped;
+            hitX = stepHitX;
+            hitZ = stepHitZ;
+        }
+    }
+
+    if (hitX)
+        body.velocity.x = 0.0f;
+
+    if (hitZ)
+        body.velocity.z = 0.0f;
+
+    body.position = Vector3((box.min.x + box.max.x) * 0.5f, box.min.y, (box.min.z + box.max.z) * 0.5f);
 }
\ No newline at end of file
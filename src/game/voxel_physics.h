@@ -2,6 +2,11 @@
 
 #include "chunk_renderer.h"
 #include "voxel.h"
+#include "aabb.h"
+
+constexpr f32 PHYSICS_TIME_STEP = 1.0f / 60.0f;   // Bodies are simulated 60 times a second
+constexpr f32 PHYSICS_GRAVITY = 32.0f;            // Blocks per second squared
+constexpr f32 PHYSICS_TERMINAL_VELOCITY = 78.0f;  // Blocks per second
 
 struct RayHitResult
 {
@@ -14,4 +19,75 @@ struct RayHitResult
 bool RayIntersectionWithBlock(const VoxelChunkArea& area, const Vector3& rayOrigin, const Vector3& rayDirection,
                               RayHitResult& hit, f32 maxDistance = Math::Infinity);
 
-Vector3Int GetHitNormal(const VoxelChunkArea& area, const RayHitResult& hit);
\ No newline at end of file
+Vector3Int GetHitNormal(const RayHitResult& hit);
+
+// Box that moves through the voxel grid without entering solid blocks
+struct PhysicsBody
+{
+    Vector3 position;                           // Center of the bottom of the box
+    Vector3 previousPosition;                   // Position before the last step, for interpolating between steps
+    Vector3 velocity;
+
+    f32 halfWidth = 0.3f;
+    f32 height = 1.8f;
+    f32 stepHeight = 0.6f;                      // Highest ledge the body walks up without jumping
+
+    bool onGround = false;
+};
+
+// Water and air don't stop bodies
+inline bool VoxelBlockIsSolid(BlockType type)
+{
+    return type != BlockType::NONE && type != BlockType::WATER;
+}
+
+inline AABB GetBodyAABB(const PhysicsBody& body)
+{
+    AABB box;
+    box.min = body.position - Vector3(body.halfWidth, 0.0f, body.halfWidth);
+    box.max = body.position + Vector3(body.halfWidth, body.height, body.halfWidth);
+    return box;
+}
+
+// Looks up if blocks are solid by world position. Lookups are usually close together so the last chunk is cached.
+// Blocks in chunks that aren't loaded at full resolution count as solid.
+struct VoxelQuery
+{
+    const VoxelChunkArea& area;
+    Vector3Int cachedCoord = { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF };
+    u32 cachedSlot = NO_CHUNK_SLOT;
+
+    VoxelQuery(const VoxelChunkArea& area) : area(area) {}
+
+    bool IsSolid(s32 x, s32 y, s32 z)
+    {
+        const Vector3Int coord = {
+            (x >= 0) ? x / (s32) CHUNK_SIZE : (x + 1) / (s32) CHUNK_SIZE - 1,
+            (y >= 0) ? y / (s32) CHUNK_SIZE : (y + 1) / (s32) CHUNK_SIZE - 1,
+            (z >= 0) ? z / (s32) CHUNK_SIZE : (z + 1) / (s32) CHUNK_SIZE - 1
+        };
+
+        if (coord != cachedCoord)
+        {
+            cachedCoord = coord;
+            cachedSlot = area.chunkMap.Find(coord);
+        }
+
+        if (cachedSlot == AIR_CHUNK_SLOT)
+            return false;
+
+        // Don't let bodies fall out of the loaded world or into chunks that are only stored at a lower detail
+        if (cachedSlot == NO_CHUNK_SLOT || area.chunks[cachedSlot].dimension() != CHUNK_SIZE)
+            return true;
+
+        const BlockType type = area.chunks[cachedSlot].at(x - coord.x * (s32) CHUNK_SIZE,
+                                                          y - coord.y * (s32) CHUNK_SIZE,
+                                                          z - coord.z * (s32) CHUNK_SIZE);
+        return VoxelBlockIsSolid(type);
+    }
+};
+
+// Simulates the body for one PHYSICS_TIME_STEP. Gravity is applied, and the body is moved along one axis at a time
+// so it slides along the blocks it hits. Only the voxels the moving box passes through are looked at.
+// Blocks in chunks that aren't loaded at full resolution count as solid.
+void StepPhysicsBody(const VoxelChunkArea& area, PhysicsBody& body);
\ No newline at end of file
@@ -1,10 +1,20 @@
 #pragma once
 
 #include "core/types.h"
+#include "math/math.h"
 
 constexpr u32 TEX_PACK_DIMENSION = 16;
 constexpr s32 ATLAS_BIND_SLOT = 0;
 
+struct VoxelVertex
+{
+    Vector3 position;
+    Vector3 normal;
+    Vector2 texCoord;
+    float occlusion;
+    Vector2 light = Vector2(1.0f, 0.0f);    // Sunlight and block light levels in [0, 1]
+};
+
 #define UV(x, y) (y * 16 + x)
 
 // Indices are in the order: Front, Up, Right, Left, Down, Back
@@ -59,6 +69,9 @@ const u32 voxelTypeTextureIndices[] = {
 
     // Obsidian
     UV( 5,  2), UV( 5,  2), UV( 5,  2), UV( 5,  2), UV( 5,  2), UV( 5,  2),
+
+    // Glowstone
+    UV( 9,  6), UV( 9,  6), UV( 9,  6), UV( 9,  6), UV( 9,  6), UV( 9,  6),
 };
 
 #undef UV
\ No newline at end of file
@@ -0,0 +1,422 @@
+#include "voxel_ticks.h"
+
+#include "containers/darray.h"
+#include "containers/hash.h"
+#include "containers/hashtable.h"
+#include "math/common.h"
+#include "platform/platform.h"
+#include "chunk_area.h"
+#include "voxel_fluid.h"
+#include "voxel_light.h"
+
+constexpr u32 CHUNK_VOXEL_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+constexpr u32 WHEEL_SLOT_BITS = 6;
+constexpr u32 WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+constexpr u32 WHEEL_SLOT_MASK = WHEEL_SLOTS - 1;
+constexpr u32 WHEEL_LEVELS = 2;
+
+// Ticks any further out could land in a slot of the upper level that comes around before they're due
+constexpr u32 maxTickDelay = WHEEL_SLOTS * (WHEEL_SLOTS - 1);
+
+constexpr u32 NO_SCHEDULED_TICK = 0xFFFFFFFF;
+
+constexpr u32 maxBlockTicksPerFrame = 3;            // Ticks that couldn't run in a frame are dropped so a slow frame doesn't make the next one slower
+constexpr u32 maxScheduledTicksPerTick = 512;       // The rest are pushed to the next tick
+constexpr u32 randomTicksPerChunk = 24;             // 3 for every 16x16x16 blocks
+
+constexpr u32 fallDelay = 2;                        // Ticks between a falling block losing its support and moving down
+constexpr u8  minGrassSpreadLight = 9;
+
+struct ScheduledTick
+{
+    u32 dueTick;
+    u32 next;                                       // Next tick in the same wheel slot (or the next free tick)
+    u16 index;                                      // Index of the voxel in the chunk
+};
+
+// Timing wheel of a chunk, every slot is a linked list of scheduled ticks
+struct BlockTickWheel
+{
+    Vector3Int coord;
+    u32 slots[WHEEL_LEVELS][WHEEL_SLOTS];           // Level 0 slots are 1 tick apart, level 1 slots are 64 ticks apart
+    u32 tickCount;
+};
+
+// Scheduled tick that's run in the current tick
+struct DueTick
+{
+    Vector3Int coord;
+    u16 index;
+};
+
+static struct
+{
+    DynamicArray<ScheduledTick> ticks;              // Scheduled ticks of every wheel
+    u32 freeTick = NO_SCHEDULED_TICK;               // List of unused entries in ticks
+
+    DynamicArray<BlockTickWheel> wheels;
+    HashTable<ChunkKey, u32> wheelIndices;
+    u32 wheelCursor = 0;                            // Wheel the tick budget starts at, rotates so no chunk is starved
+
+    DynamicArray<DueTick> dueTicks;
+    DynamicArray<Vector3Int> changedChunks;
+
+    u32 currentTick = 0;
+    f32 timer = 0.0f;
+    u64 randomState = 0x9E3779B97F4A7C15ull;
+} tickData;
+
+static inline u16 VoxelIndex(u32 x, u32 y, u32 z)
+{
+    return (u16) (x + y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE);
+}
+
+static inline Vector3Int VoxelPosition(u16 index)
+{
+    return Vector3Int { (s32) (index % CHUNK_SIZE), (s32) ((index / CHUNK_SIZE) % CHUNK_SIZE), (s32) (index / (CHUNK_SIZE * CHUNK_SIZE)) };
+}
+
+// wyrand, one multiply per number
+static inline u64 RandomU64()
+{
+    tickData.randomState += HashInternal::secret[0];
+    return HashInternal::Mix(tickData.randomState, tickData.randomState ^ HashInternal::secret[1]);
+}
+
+// Block position of the block offset from a block, chunkIndex is moved to the chunk it's in.
+// Offsets have to be smaller than a chunk.
+static Vector3Int OffsetBlock(Vector3Int& chunkIndex, const Vector3Int& blockIndex, const Vector3Int& offset)
+{
+    Vector3Int block = blockIndex + offset;
+    s32* blockAxes[3] = { &block.x, &block.y, &block.z };
+    s32* chunkAxes[3] = { &chunkIndex.x, &chunkIndex.y, &chunkIndex.z };
+
+    for (u32 i = 0; i < 3; i++)
+    {
+        if (*blockAxes[i] < 0)
+        {
+            *blockAxes[i] += CHUNK_SIZE;
+            (*chunkAxes[i])--;
+        }
+        else if (*blockAxes[i] >= (s32) CHUNK_SIZE)
+        {
+            *blockAxes[i] -= CHUNK_SIZE;
+            (*chunkAxes[i])++;
+        }
+    }
+
+    return block;
+}
+
+static inline bool IsFullResolutionChunk(const VoxelChunkArea& area, u32 slot)
+{
+    return IsValidChunkSlot(slot) && area.chunks[slot].dimension() == CHUNK_SIZE;
+}
+
+static BlockTickWheel& GetWheel(const Vector3Int& coord)
+{
+    const ChunkKey key = PackChunkCoord(coord);
+
+    auto it = tickData.wheelIndices.Find(key);
+    if (it)
+        return tickData.wheels[it.value()];
+
+    BlockTickWheel& wheel = tickData.wheels.EmplaceBack();
+    wheel.coord = coord;
+    wheel.tickCount = 0;
+    PlatformSetMemory(wheel.slots, 0xFF, sizeof(wheel.slots));
+
+    tickData.wheelIndices.Place(key, (u32) tickData.wheels.size() - 1);
+    return wheel;
+}
+
+static void InsertTick(BlockTickWheel& wheel, u32 tickIndex)
+{
+    ScheduledTick& tick = tickData.ticks[tickIndex];
+    const u32 delay = tick.dueTick - tickData.currentTick;
+
+    u32& head = (delay < WHEEL_SLOTS) ? wheel.slots[0][tick.dueTick & WHEEL_SLOT_MASK] :
+                                        wheel.slots[1][(tick.dueTick >> WHEEL_SLOT_BITS) & WHEEL_SLOT_MASK];
+
+    tick.next = head;
+    head = tickIndex;
+}
+
+void ScheduleBlockTick(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, u32 delay)
+{
+    // Only full resolution chunks can be edited
+    if (!IsFullResolutionChunk(area, area.chunkMap.Find(chunkIndex)))
+        return;
+
+    const u32 dueTick = tickData.currentTick + Clamp(delay, 1u, maxTickDelay);
+    const u16 index = VoxelIndex(blockIndex.x, blockIndex.y, blockIndex.z);
+
+    BlockTickWheel& wheel = GetWheel(chunkIndex);
+
+    {   // Don't schedule the same block twice for the same tick
+        const u32 delayFromNow = dueTick - tickData.currentTick;
+        u32 tickIndex = (delayFromNow < WHEEL_SLOTS) ? wheel.slots[0][dueTick & WHEEL_SLOT_MASK] :
+                                                       wheel.slots[1][(dueTick >> WHEEL_SLOT_BITS) & WHEEL_SLOT_MASK];
+
+        for (; tickIndex != NO_SCHEDULED_TICK; tickIndex = tickData.ticks[tickIndex].next)
+        {
+            if (tickData.ticks[tickIndex].index == index && tickData.ticks[tickIndex].dueTick == dueTick)
+                return;
+        }
+    }
+
+    u32 tickIndex = tickData.freeTick;
+    if (tickIndex != NO_SCHEDULED_TICK)
+        tickData.freeTick = tickData.ticks[tickIndex].next;
+    else
+    {
+        tickIndex = (u32) tickData.ticks.size();
+        tickData.ticks.EmplaceBack();
+    }
+
+    tickData.ticks[tickIndex].dueTick = dueTick;
+    tickData.ticks[tickIndex].index = index;
+
+    InsertTick(wheel, tickIndex);
+    wheel.tickCount++;
+}
+
+void ScheduleTicksAroundBlock(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    // The block itself and the block resting on it might have to fall
+    const Vector3Int offsets[] = {
+        { 0, 0, 0 },
+        { 0, 1, 0 },
+    };
+
+    for (const Vector3Int& offset : offsets)
+    {
+        Vector3Int chunk = chunkIndex;
+        const Vector3Int block = OffsetBlock(chunk, blockIndex, offset);
+
+        if (VoxelBlockFalls(GetBlockAtPosition(area, chunk, block)))
+            ScheduleBlockTick(area, chunk, block, fallDelay);
+    }
+}
+
+// Falling blocks move through air and water
+static bool CanFallInto(const VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    const u32 slot = area.chunkMap.Find(chunkIndex);
+
+    if (slot == AIR_CHUNK_SLOT)
+        return area.loadShape.LODAt(area.centerChunk, chunkIndex) == 0;
+
+    if (!IsFullResolutionChunk(area, slot))
+        return false;
+
+    const BlockType type = area.chunks[slot].at(blockIndex.x, blockIndex.y, blockIndex.z);
+    return type == BlockType::NONE || type == BlockType::WATER;
+}
+
+static void TickFallingBlock(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, BlockType type)
+{
+    Vector3Int belowChunk = chunkIndex;
+    const Vector3Int below = OffsetBlock(belowChunk, blockIndex, Vector3Int { 0, -1, 0 });
+
+    if (!CanFallInto(area, belowChunk, below))
+        return;
+
+    // Block moves down a cell, setting it there schedules its next fall
+    SetBlockAtPosition(area, chunkIndex, blockIndex, BlockType::NONE, tickData.changedChunks);
+    SetBlockAtPosition(area, belowChunk, below, type, tickData.changedChunks);
+}
+
+static void TickGrass(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex)
+{
+    Vector3Int aboveChunk = chunkIndex;
+    const Vector3Int above = OffsetBlock(aboveChunk, blockIndex, Vector3Int { 0, 1, 0 });
+
+    // Grass dies under opaque blocks
+    if (!VoxelBlockHasTransparency(GetBlockAtPosition(area, aboveChunk, above)))
+    {
+        SetBlockAtPosition(area, chunkIndex, blockIndex, BlockType::DIRT, tickData.changedChunks);
+        return;
+    }
+
+    // Spreads to a random dirt block around it (from 3 blocks below to 1 block above) that has light above it
+    const u64 random = RandomU64();
+    const Vector3Int offset = {
+        (s32) (random % 3) - 1,
+        (s32) ((random >> 16) % 5) - 3,
+        (s32) ((random >> 32) % 3) - 1
+    };
+
+    Vector3Int targetChunk = chunkIndex;
+    const Vector3Int target = OffsetBlock(targetChunk, blockIndex, offset);
+
+    if (GetBlockAtPosition(area, targetChunk, target) != BlockType::DIRT)
+        return;
+
+    Vector3Int targetAboveChunk = targetChunk;
+    const Vector3Int targetAbove = OffsetBlock(targetAboveChunk, target, Vector3Int { 0, 1, 0 });
+
+    if (!VoxelBlockHasTransparency(GetBlockAtPosition(area, targetAboveChunk, targetAbove)))
+        return;
+
+    const u8 light = GetLightAtPosition(area, targetAboveChunk, targetAbove);
+    if (Max(GetSunLight(light), GetBlockLight(light)) < minGrassSpreadLight)
+        return;
+
+    SetBlockAtPosition(area, targetChunk, target, BlockType::GRASS, tickData.changedChunks);
+}
+
+static void RunScheduledTicks(VoxelChunkArea& area)
+{
+    tickData.dueTicks.Clear(false);
+
+    const u32 slot = tickData.currentTick & WHEEL_SLOT_MASK;
+    const u32 wheelCount = (u32) tickData.wheels.size();
+
+    // Ticks are collected first since running them can schedule more ticks and add wheels
+    for (u32 i = 0; i < wheelCount; i++)
+    {
+        BlockTickWheel& wheel = tickData.wheels[(tickData.wheelCursor + i) % wheelCount];
+
+        if (slot == 0)
+        {
+            // Ticks in the next slot of the upper level are due in the next 64 ticks
+            u32& upperSlot = wheel.slots[1][(tickData.currentTick >> WHEEL_SLOT_BITS) & WHEEL_SLOT_MASK];
+            u32 tickIndex = upperSlot;
+            upperSlot = NO_SCHEDULED_TICK;
+
+            while (tickIndex != NO_SCHEDULED_TICK)
+            {
+                const u32 next = tickData.ticks[tickIndex].next;
+                InsertTick(wheel, tickIndex);
+                tickIndex = next;
+            }
+        }
+
+        u32 tickIndex = wheel.slots[0][slot];
+        wheel.slots[0][slot] = NO_SCHEDULED_TICK;
+
+        while (tickIndex != NO_SCHEDULED_TICK)
+        {
+            ScheduledTick& tick = tickData.ticks[tickIndex];
+            const u32 next = tick.next;
+
+            if (tickData.dueTicks.size() < maxScheduledTicksPerTick)
+            {
+                tickData.dueTicks.PushBack(DueTick { wheel.coord, tick.index });
+
+                tick.next = tickData.freeTick;
+                tickData.freeTick = tickIndex;
+                wheel.tickCount--;
+            }
+            else
+            {
+                // Over budget, it runs in the next tick instead
+                tick.dueTick = tickData.currentTick + 1;
+                InsertTick(wheel, tickIndex);
+            }
+
+            tickIndex = next;
+        }
+    }
+
+    tickData.wheelCursor = (wheelCount > 0) ? (tickData.wheelCursor + 1) % wheelCount : 0;
+
+    for (u32 i = 0; i < tickData.dueTicks.size(); i++)
+    {
+        const DueTick& due = tickData.dueTicks[i];
+
+        // Chunk might have been unloaded or moved to a lower level of detail
+        const u32 chunkSlot = area.chunkMap.Find(due.coord);
+        if (!IsFullResolutionChunk(area, chunkSlot))
+            continue;
+
+        const Vector3Int blockIndex = VoxelPosition(due.index);
+        const BlockType type = area.chunks[chunkSlot].at(blockIndex.x, blockIndex.y, blockIndex.z);
+
+        if (VoxelBlockFalls(type))
+            TickFallingBlock(area, due.coord, blockIndex, type);
+    }
+
+    // Wheels without any ticks left are removed, the last wheel is moved into their place
+    for (u32 i = (u32) tickData.wheels.size(); i > 0; i--)
+    {
+        if (tickData.wheels[i - 1].tickCount > 0)
+            continue;
+
+        tickData.wheelIndices.Remove(PackChunkCoord(tickData.wheels[i - 1].coord));
+        tickData.wheels.EraseSwap(i - 1);
+
+        if (i - 1 < tickData.wheels.size())
+            tickData.wheelIndices[PackChunkCoord(tickData.wheels[i - 1].coord)] = i - 1;
+    }
+}
+
+static void RunRandomTicks(VoxelChunkArea& area)
+{
+    // Slots taken while ticking are ticked from the next tick on
+    const u32 slotCount = (u32) area.chunks.size();
+
+    for (u32 slot = 0; slot < slotCount; slot++)
+    {
+        // Free slots are marked as only air too
+        if (area.isOnlyAir[slot] || area.chunks[slot].dimension() != CHUNK_SIZE)
+            continue;
+
+        const Vector3Int coord = area.chunkCoords[slot];
+
+        // Every random number picks 4 voxels
+        for (u32 i = 0; i < randomTicksPerChunk; i += 4)
+        {
+            u64 random = RandomU64();
+
+            for (u32 j = 0; j < 4; j++, random >>= 16)
+            {
+                const Vector3Int blockIndex = VoxelPosition((u16) (random & (CHUNK_VOXEL_COUNT - 1)));
+                const BlockType type = area.chunks[slot].at(blockIndex.x, blockIndex.y, blockIndex.z);
+
+                if (type == BlockType::GRASS)
+                    TickGrass(area, coord, blockIndex);
+            }
+        }
+    }
+}
+
+bool UpdateBlockTicks(VoxelChunkArea& area, f32 deltaTime)
+{
+    tickData.timer += deltaTime;
+    tickData.changedChunks.Clear(false);
+
+    for (u32 tick = 0; tick < maxBlockTicksPerFrame && tickData.timer >= BLOCK_TICK_TIME; tick++)
+    {
+        tickData.timer -= BLOCK_TICK_TIME;
+        tickData.currentTick++;
+
+        RunScheduledTicks(area);
+        RunRandomTicks(area);
+
+        if (tickData.currentTick % FLUID_TICK_INTERVAL == 0)
+            TickFluids(area, tickData.changedChunks);
+    }
+
+    tickData.timer = Min(tickData.timer, BLOCK_TICK_TIME);
+
+    // Chunks are remeshed once even if they changed in multiple ticks
+    for (u32 i = 0; i < tickData.changedChunks.size(); i++)
+        area.UpdateChunkMesh(tickData.changedChunks[i]);
+
+    return tickData.changedChunks.size() > 0;
+}
+
+void FreeBlockTickData()
+{
+    tickData.ticks.Free();
+    tickData.freeTick = NO_SCHEDULED_TICK;
+
+    tickData.wheels.Free();
+    tickData.wheelIndices.Clear();
+
+    tickData.dueTicks.Free();
+    tickData.changedChunks.Free();
+}
\ No newline at end of file
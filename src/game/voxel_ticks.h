@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/types.h"
+#include "voxel.h"
+
+/*
+
+Block ticks, the fixed timestep simulation of the world.
+
+The world ticks 20 times a second no matter what the frame rate is. Every
+tick runs two kinds of block updates:
+
+- Scheduled ticks: a block asks to be updated a number of ticks from now
+  (sand and gravel check if they should fall 2 ticks after something next
+  to them changes). Every chunk with scheduled ticks gets a hierarchical
+  timing wheel, 64 slots of 1 tick each and 64 slots of 64 ticks each, so
+  scheduling and running a tick is O(1) however many are waiting.
+- Random ticks: a few random voxels of every full resolution chunk are
+  updated each tick (grass spreads onto dirt next to it and dies under
+  opaque blocks). Positions are picked with a small wyrand style PRNG.
+
+Scheduled ticks that don't fit in a tick's budget are pushed to the next
+tick, so a big pile of falling sand can't stall a frame. Water is ticked
+by the same loop every FLUID_TICK_INTERVAL ticks.
+
+*/
+
+constexpr f32 BLOCK_TICK_TIME = 0.05f;            // 20 ticks per second
+
+struct VoxelChunkArea;
+
+inline bool VoxelBlockFalls(BlockType type)
+{
+    return type == BlockType::SAND || type == BlockType::GRAVEL;
+}
+
+// Schedules a tick for the block at a position delay ticks from now (at least 1)
+void ScheduleBlockTick(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex, u32 delay);
+
+// Call after the block at a position was changed so the blocks that react to it get a scheduled tick
+void ScheduleTicksAroundBlock(VoxelChunkArea& area, const Vector3Int& chunkIndex, const Vector3Int& blockIndex);
+
+// Runs the ticks that are due since the last frame and remeshes the chunks that changed.
+// Returns true if any chunk mesh changed.
+bool UpdateBlockTicks(VoxelChunkArea& area, f32 deltaTime);
+
+void FreeBlockTickData();
\ No newline at end of file
@@ -0,0 +1,612 @@
+#include "world_gen.h"
+
+#include "containers/hash.h"
+#include "core/logging.h"
+#include "engine/job_system.h"
+#include "platform/platform.h"
+
+constexpr f32 heightFrequency   = 0.0078125f;
+constexpr f32 moistureFrequency = 0.001953125f;
+constexpr u32 heightOctaves     = 4;
+constexpr u32 moistureOctaves   = 2;
+constexpr f32 caveFrequency     = 0.025f;
+constexpr f32 caveVerticalScale = 1.6f;         // Caves are squashed vertically so they're more walkable
+constexpr f32 caveRadius        = 0.12f;        // Voxels where both cave noises are this close to 0 are carved out
+constexpr u32 caveLatticeSpacing = 4;           // Blocks between the points the cave noises are sampled at
+
+constexpr f32 rockyHeight = 9.0f;               // Columns higher than this are bare rock
+constexpr f32 desertMoisture = -0.3f;           // Columns drier than this are desert
+
+// Depths (below the surface height) where the layers of a biome end
+constexpr f32 topLayerDepth    = 1.0f;
+constexpr f32 fillerLayerDepth = 4.0f;
+constexpr f32 underLayerDepth  = 7.0f;
+
+struct BiomeLayers
+{
+    BlockType top, filler, under;               // Blocks below these layers are stone
+};
+
+// Indexed by BiomeType
+constexpr BiomeLayers biomeLayers[] = {
+    { BlockType::GRASS, BlockType::DIRT, BlockType::STONE },            // Plains
+    { BlockType::SAND,  BlockType::SAND, BlockType::SAND_STONE },       // Desert
+    { BlockType::STONE, BlockType::STONE, BlockType::STONE },           // Rocky
+};
+
+struct OreType
+{
+    BlockType type;
+    u32 attemptsPerChunk;
+    f32 minRadius, maxRadius;
+    f32 maxY;                                   // Pockets only start below this height
+};
+
+// Ore pockets only replace stone
+constexpr OreType oreTypes[] = {
+    { BlockType::GRAVEL,    6, 1.5f, 2.5f,  12.0f },
+    { BlockType::CLAY,      3, 1.0f, 2.0f,   0.0f },
+    { BlockType::GLOWSTONE, 2, 0.5f, 1.5f, -16.0f },
+    { BlockType::OBSIDIAN,  1, 1.0f, 1.5f, -32.0f },
+};
+
+constexpr u32 oreTypeCount = sizeof(oreTypes) / sizeof(OreType);
+constexpr f32 maxOreRadius = 2.5f;
+
+constexpr s32 boulderCellSize = 16;             // At most one boulder is placed in each cell of columns
+constexpr u32 boulderChancePercent = 12;
+constexpr f32 boulderMinRadius = 1.2f;
+constexpr f32 boulderMaxRadius = 2.2f;
+
+// Salts keep the hashes of different kinds of features at the same position apart
+constexpr u32 SALT_NOISE_OFFSET = 0;
+constexpr u32 SALT_BOULDER      = 1;
+constexpr u32 SALT_ORE          = 2;           // One salt per ore type and attempt starting here
+
+struct ColumnJob
+{
+    const WorldGenerator* generator;
+    WorldGenColumn* column;
+    s32 x, z;                                   // Chunk coordinates of the column
+};
+
+struct ChunkJob
+{
+    const WorldGenerator* generator;
+    WorldGenChunk* chunk;
+};
+
+static struct
+{
+    DynamicArray<ColumnJob> columnJobs;
+    DynamicArray<ChunkJob> chunkJobs;
+    DynamicArray<u64> releasedColumns;
+} genData;
+
+static inline u64 FeatureHash(u64 seed, const Vector3Int& position, u32 salt)
+{
+    return HashInteger(seed ^ HashInteger(PackChunkCoord(position) + salt * 0x9E3779B97F4A7C15ull));
+}
+
+// Picks one of 4 numbers in [0, 1) out of a hash
+static inline f32 HashToUnit(u64 hash, u32 index)
+{
+    return (f32) ((hash >> (16 * index)) & 0xFFFF) * (1.0f / 65536.0f);
+}
+
+static inline u64 PackColumnCoord(s32 x, s32 z)
+{
+    return PackChunkCoord(Vector3Int { x, 0, z });
+}
+
+void WorldGenerator::Create(u64 worldSeed)
+{
+    seed = worldSeed;
+    noise = SimplexNoise();
+
+    // The noise repeats every 256 units so any offset past that is the same as a smaller one
+    for (u32 i = 0; i < (u32) WorldGenNoise::NUM_TYPES; i++)
+    {
+        const u64 hash = FeatureHash(seed, Vector3Int { (s32) i, 0, 0 }, SALT_NOISE_OFFSET);
+        noiseOffsets[i] = Vector3(HashToUnit(hash, 0), HashToUnit(hash, 1), HashToUnit(hash, 2)) * 256.0f;
+    }
+
+    columns.Clear();
+    freeColumns.Clear();
+}
+
+void WorldGenerator::Free()
+{
+    for (auto it = columns.begin(); it != columns.end(); it++)
+        PlatformFree(it.value());
+
+    for (u64 i = 0; i < freeColumns.size(); i++)
+        PlatformFree(freeColumns[i]);
+
+    columns.Clear();
+    freeColumns.Free();
+
+    genData.columnJobs.Free();
+    genData.chunkJobs.Free();
+    genData.releasedColumns.Free();
+}
+
+// Stage 1: Heightmap
+f32 WorldGenerator::HeightAt(f32 x, f32 z) const
+{
+    const Vector3& offset = noiseOffsets[(u32) WorldGenNoise::HEIGHT];
+    return maxHeightAmplitude * noise.fractal(heightOctaves, x * heightFrequency + offset.x, z * heightFrequency + offset.z);
+}
+
+// Stage 2: Biome
+static inline BiomeType PickBiome(f32 height, f32 moisture)
+{
+    if (height > rockyHeight)
+        return BiomeType::ROCKY;
+
+    return (moisture < desertMoisture) ? BiomeType::DESERT : BiomeType::PLAINS;
+}
+
+BiomeType WorldGenerator::BiomeAt(f32 x, f32 z, f32 height) const
+{
+    if (height > rockyHeight)
+        return BiomeType::ROCKY;
+
+    const Vector3& offset = noiseOffsets[(u32) WorldGenNoise::MOISTURE];
+    const f32 moisture = noise.fractal(moistureOctaves, x * moistureFrequency + offset.x, z * moistureFrequency + offset.z);
+
+    return PickBiome(height, moisture);
+}
+
+// Stage 3: Surface
+static inline BlockType SurfaceBlockAt(BiomeType biome, f32 height, f32 blockHeight)
+{
+    const f32 depth = height - blockHeight;
+    const BiomeLayers& layers = biomeLayers[(u32) biome];
+
+    if (depth < 0.0f)
+        return BlockType::NONE;
+
+    if (depth < topLayerDepth)
+        return layers.top;
+
+    if (depth < fillerLayerDepth)
+        return layers.filler;
+
+    return (depth < underLayerDepth) ? layers.under : BlockType::STONE;
+}
+
+// Stage 4: Caves. Tunnels follow the lines where two noises are both close to 0.
+
+// Points of the cave lattice along each axis of a chunk, the last ones are shared with the next chunk
+constexpr u32 caveLatticePoints = CHUNK_SIZE / caveLatticeSpacing + 1;
+
+// Lattices are only sampled up to the rows the carved cells need, rows is how many there are
+static inline u32 CaveLatticeIndex(u32 x, u32 y, u32 z, u32 rows)
+{
+    return x + y * caveLatticePoints + z * caveLatticePoints * rows;
+}
+
+// Samples one cave noise on the lattice of a chunk with the batch noise
+static void SampleCaveLattice(const Vector3& worldPosition, const Vector3& offset, u32 rows, f32* lattice)
+{
+    f32 xs[caveLatticePoints], ys[caveLatticePoints], zs[caveLatticePoints];
+
+    for (u32 i = 0; i < caveLatticePoints; i++)
+    {
+        const f32 step = (f32) (i * caveLatticeSpacing);
+        xs[i] = (worldPosition.x + step) * caveFrequency + offset.x;
+        ys[i] = (worldPosition.y + step) * caveFrequency * caveVerticalScale + offset.y;
+        zs[i] = (worldPosition.z + step) * caveFrequency + offset.z;
+    }
+
+    SimplexNoise::noiseGrid(xs, caveLatticePoints, ys, rows, zs, caveLatticePoints, lattice);
+}
+
+static inline f32 Lerp(f32 a, f32 b, f32 t)
+{
+    return a + (b - a) * t;
+}
+
+// Carves caves out of a full resolution chunk and returns the number of blocks that were removed.
+// The cave noises are only sampled on a coarse lattice and interpolated in between. Lattice points
+// sit on world positions that are multiples of the spacing, so chunks next to each other agree
+// on the points they share and tunnels line up across chunk borders.
+static u32 CarveCaves(const WorldGenerator& generator, VoxelChunk& chunk, const Vector3& worldPosition, f32 maxHeight)
+{
+    constexpr u32 cellsPerAxis = CHUNK_SIZE / caveLatticeSpacing;
+    constexpr f32 invSpacing = 1.0f / caveLatticeSpacing;
+
+    // Layers of cells that start above the terrain only have air to carve
+    const s32 cellLayers = Min((s32) Math::Floor((maxHeight - worldPosition.y) * invSpacing) + 1, (s32) cellsPerAxis);
+    if (cellLayers <= 0)
+        return 0;
+
+    const u32 latticeRows = (u32) cellLayers + 1;
+
+    f32 latticeA[caveLatticePoints * caveLatticePoints * caveLatticePoints];
+    f32 latticeB[caveLatticePoints * caveLatticePoints * caveLatticePoints];
+
+    SampleCaveLattice(worldPosition, generator.noiseOffsets[(u32) WorldGenNoise::CAVE_A], latticeRows, latticeA);
+    SampleCaveLattice(worldPosition, generator.noiseOffsets[(u32) WorldGenNoise::CAVE_B], latticeRows, latticeB);
+
+    u32 carvedCount = 0;
+
+    for (u32 cz = 0; cz < cellsPerAxis; cz++)
+    for (u32 cy = 0; cy < (u32) cellLayers; cy++)
+    for (u32 cx = 0; cx < cellsPerAxis; cx++)
+    {
+        f32 a[8], b[8];
+        f32 minA = 1.0f, maxA = -1.0f, minB = 1.0f, maxB = -1.0f;
+
+        for (u32 corner = 0; corner < 8; corner++)
+        {
+            const u32 index = CaveLatticeIndex(cx + (corner & 1), cy + ((corner >> 1) & 1), cz + (corner >> 2), latticeRows);
+            a[corner] = latticeA[index];
+            b[corner] = latticeB[index];
+
+            minA = Min(minA, a[corner]); maxA = Max(maxA, a[corner]);
+            minB = Min(minB, b[corner]); maxB = Max(maxB, b[corner]);
+        }
+
+        // Interpolated values stay between the corners, so if either noise can't get close
+        // enough to 0 inside the cell there's no tunnel in it and its blocks are skipped
+        if (minA >= caveRadius || maxA <= -caveRadius || minB >= caveRadius || maxB <= -caveRadius)
+            continue;
+
+        for (u32 vz = 0; vz < caveLatticeSpacing; vz++)
+        for (u32 vy = 0; vy < caveLatticeSpacing; vy++)
+        for (u32 vx = 0; vx < caveLatticeSpacing; vx++)
+        {
+            const u32 x = cx * caveLatticeSpacing + vx;
+            const u32 y = cy * caveLatticeSpacing + vy;
+            const u32 z = cz * caveLatticeSpacing + vz;
+
+            BlockType& block = chunk.at(x, y, z);
+            if (block == BlockType::NONE)
+                continue;
+
+            const f32 tx = vx * invSpacing;
+            const f32 ty = vy * invSpacing;
+            const f32 tz = vz * invSpacing;
+
+            const f32 a00 = Lerp(a[0], a[1], tx), a10 = Lerp(a[2], a[3], tx);
+            const f32 a01 = Lerp(a[4], a[5], tx), a11 = Lerp(a[6], a[7], tx);
+            const f32 b00 = Lerp(b[0], b[1], tx), b10 = Lerp(b[2], b[3], tx);
+            const f32 b01 = Lerp(b[4], b[5], tx), b11 = Lerp(b[6], b[7], tx);
+
+            const f32 va = Lerp(Lerp(a00, a10, ty), Lerp(a01, a11, ty), tz);
+            const f32 vb = Lerp(Lerp(b00, b10, ty), Lerp(b01, b11, ty), tz);
+
+            if (va * va + vb * vb < caveRadius * caveRadius)
+            {
+                block = BlockType::NONE;
+                carvedCount++;
+            }
+        }
+    }
+
+    return carvedCount;
+}
+
+// Stages 1 and 2 for a whole column with the batch noise, the results are the same as HeightAt and BiomeAt
+static void GenerateColumn(const WorldGenerator& generator, WorldGenColumn& column, s32 chunkX, s32 chunkZ)
+{
+    const Vector3& heightOffset = generator.noiseOffsets[(u32) WorldGenNoise::HEIGHT];
+    const Vector3& moistureOffset = generator.noiseOffsets[(u32) WorldGenNoise::MOISTURE];
+
+    f32 heightXs[CHUNK_SIZE], heightZs[CHUNK_SIZE];
+    f32 moistureXs[CHUNK_SIZE], moistureZs[CHUNK_SIZE];
+
+    for (u32 i = 0; i < CHUNK_SIZE; i++)
+    {
+        const f32 x = (f32) (chunkX * (s32) CHUNK_SIZE + (s32) i);
+        const f32 z = (f32) (chunkZ * (s32) CHUNK_SIZE + (s32) i);
+
+        heightXs[i] = x * heightFrequency + heightOffset.x;
+        heightZs[i] = z * heightFrequency + heightOffset.z;
+        moistureXs[i] = x * moistureFrequency + moistureOffset.x;
+        moistureZs[i] = z * moistureFrequency + moistureOffset.z;
+    }
+
+    f32 moisture[CHUNK_SIZE * CHUNK_SIZE];
+    generator.noise.fractalGrid(heightOctaves, heightXs, CHUNK_SIZE, heightZs, CHUNK_SIZE, column.heights);
+    generator.noise.fractalGrid(moistureOctaves, moistureXs, CHUNK_SIZE, moistureZs, CHUNK_SIZE, moisture);
+
+    column.maxHeight = -maxHeightAmplitude;
+
+    for (u32 i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+    {
+        const f32 height = maxHeightAmplitude * column.heights[i];
+        column.heights[i] = height;
+        column.biomes[i] = PickBiome(height, moisture[i]);
+        column.maxHeight = Max(column.maxHeight, height);
+    }
+}
+
+// Fills a sphere of blocks inside the chunk, only replacing blocks of type replace
+static void FillSphere(VoxelChunk& chunk, const Vector3& chunkPosition, const Vector3& center, f32 radius, BlockType type, BlockType replace)
+{
+    // Voxels whose center is inside the sphere, clipped to the chunk
+    const s32 minX = Max((s32) Math::Floor(center.x - radius - chunkPosition.x), 0);
+    const s32 minY = Max((s32) Math::Floor(center.y - radius - chunkPosition.y), 0);
+    const s32 minZ = Max((s32) Math::Floor(center.z - radius - chunkPosition.z), 0);
+    const s32 maxX = Min((s32) Math::Floor(center.x + radius - chunkPosition.x), (s32) CHUNK_SIZE - 1);
+    const s32 maxY = Min((s32) Math::Floor(center.y + radius - chunkPosition.y), (s32) CHUNK_SIZE - 1);
+    const s32 maxZ = Min((s32) Math::Floor(center.z + radius - chunkPosition.z), (s32) CHUNK_SIZE - 1);
+
+    for (s32 z = minZ; z <= maxZ; z++)
+    for (s32 y = minY; y <= maxY; y++)
+    for (s32 x = minX; x <= maxX; x++)
+    {
+        const Vector3 offset = chunkPosition + Vector3((f32) x + 0.5f, (f32) y + 0.5f, (f32) z + 0.5f) - center;
+        if (offset.SqrLength() > radius * radius)
+            continue;
+
+        BlockType& block = chunk.at(x, y, z);
+        if (block == replace)
+            block = type;
+    }
+}
+
+// Stage 5: Decoration. Features of the chunks (or cells of columns) around this one can reach into it.
+static void DecorateChunk(const WorldGenerator& generator, VoxelChunk& chunk, const Vector3Int& coord)
+{
+    const Vector3 chunkPosition = ChunkCoordToPosition(coord);
+
+    {   // Boulders sitting on the surface
+        const s32 minCellX = (s32) Math::Floor((chunkPosition.x - boulderMaxRadius) / boulderCellSize);
+        const s32 minCellZ = (s32) Math::Floor((chunkPosition.z - boulderMaxRadius) / boulderCellSize);
+        const s32 maxCellX = (s32) Math::Floor((chunkPosition.x + CHUNK_SIZE + boulderMaxRadius) / boulderCellSize);
+        const s32 maxCellZ = (s32) Math::Floor((chunkPosition.z + CHUNK_SIZE + boulderMaxRadius) / boulderCellSize);
+
+        for (s32 cz = minCellZ; cz <= maxCellZ; cz++)
+        for (s32 cx = minCellX; cx <= maxCellX; cx++)
+        {
+            const u64 hash = FeatureHash(generator.seed, Vector3Int { cx, 0, cz }, SALT_BOULDER);
+            if ((u32) (hash >> 48) % 100 >= boulderChancePercent)
+                continue;
+
+            const f32 x = (f32) (cx * boulderCellSize) + HashToUnit(hash, 0) * boulderCellSize;
+            const f32 z = (f32) (cz * boulderCellSize) + HashToUnit(hash, 1) * boulderCellSize;
+            const f32 height = generator.HeightAt(x, z);
+
+            const BiomeType biome = generator.BiomeAt(x, z, height);
+            if (biome == BiomeType::DESERT)
+                continue;
+
+            const f32 radius = boulderMinRadius + HashToUnit(hash, 2) * (boulderMaxRadius - boulderMinRadius);
+            const Vector3 center = Vector3(x, Math::Floor(height) + 1.0f, z);
+
+            if (center.y - radius >= chunkPosition.y + CHUNK_SIZE || center.y + radius < chunkPosition.y)
+                continue;
+
+            const BlockType type = (biome == BiomeType::ROCKY) ? BlockType::COBBLE_STONE : BlockType::MOSSY_COBBLE_STONE;
+            FillSphere(chunk, chunkPosition, center, radius, type, BlockType::NONE);
+        }
+    }
+
+    {   // Ore pockets, started from random points in every chunk
+        for (s32 dz = -1; dz <= 1; dz++)
+        for (s32 dy = -1; dy <= 1; dy++)
+        for (s32 dx = -1; dx <= 1; dx++)
+        {
+            const Vector3Int source = coord + Vector3Int { dx, dy, dz };
+            const Vector3 sourcePosition = ChunkCoordToPosition(source);
+
+            for (u32 ore = 0; ore < oreTypeCount; ore++)
+            for (u32 attempt = 0; attempt < oreTypes[ore].attemptsPerChunk; attempt++)
+            {
+                const OreType& oreType = oreTypes[ore];
+
+                const u64 hash = FeatureHash(generator.seed, source, SALT_ORE + ore * 64 + attempt);
+                const Vector3 center = sourcePosition + Vector3(HashToUnit(hash, 0), HashToUnit(hash, 1), HashToUnit(hash, 2)) * (f32) CHUNK_SIZE;
+
+                if (center.y > oreType.maxY)
+                    continue;
+
+                // Only pockets close to this chunk can reach into it
+                if (center.x < chunkPosition.x - maxOreRadius || center.x > chunkPosition.x + CHUNK_SIZE + maxOreRadius ||
+                    center.y < chunkPosition.y - maxOreRadius || center.y > chunkPosition.y + CHUNK_SIZE + maxOreRadius ||
+                    center.z < chunkPosition.z - maxOreRadius || center.z > chunkPosition.z + CHUNK_SIZE + maxOreRadius)
+                    continue;
+
+                const f32 radius = oreType.minRadius + HashToUnit(hash, 3) * (oreType.maxRadius - oreType.minRadius);
+                FillSphere(chunk, chunkPosition, center, radius, oreType.type, BlockType::STONE);
+            }
+        }
+    }
+}
+
+// Runs stages 3 and 4 on a full resolution chunk, returns true if it's only air
+static bool GenerateChunkTerrain(const WorldGenerator& generator, VoxelChunk& chunk, const Vector3Int& coord, const WorldGenColumn& column)
+{
+    const Vector3 worldPosition = ChunkCoordToPosition(coord);
+
+    if (worldPosition.y > column.maxHeight)
+    {
+        PlatformSetMemory(chunk.data(), 0, chunk.totalSize() * sizeof(BlockType));
+        return true;
+    }
+
+    u32 solidCount = 0;
+
+    for (u32 cz = 0; cz < CHUNK_SIZE; cz++)
+    for (u32 cx = 0; cx < CHUNK_SIZE; cx++)
+    {
+        const f32 height = column.heights[cx + cz * CHUNK_SIZE];
+        const BiomeType biome = column.biomes[cx + cz * CHUNK_SIZE];
+
+        for (u32 cy = 0; cy < CHUNK_SIZE; cy++)
+        {
+            const BlockType type = SurfaceBlockAt(biome, height, cy + worldPosition.y);
+            chunk.at(cx, cy, cz) = type;
+            solidCount += (type != BlockType::NONE);
+        }
+    }
+
+    solidCount -= CarveCaves(generator, chunk, worldPosition, column.maxHeight);
+    return solidCount == 0;
+}
+
+// Runs stage 3 on a lower level of detail chunk. Each voxel takes the most common block type
+// among the full resolution blocks it covers. It's air if at least half of those blocks are air.
+static bool GenerateChunkLOD(VoxelChunk& chunk, const Vector3Int& coord, const WorldGenColumn& column)
+{
+    const Vector3 worldPosition = ChunkCoordToPosition(coord);
+    const u32 voxelSize = 1 << GetChunkLOD(chunk);
+    const u32 blocksPerVoxel = voxelSize * voxelSize * voxelSize;
+
+    if (worldPosition.y > column.maxHeight)
+    {
+        PlatformSetMemory(chunk.data(), 0, chunk.totalSize() * sizeof(BlockType));
+        return true;
+    }
+
+    bool onlyAir = true;
+
+    for (u32 cz = 0; cz < chunk.dimension(); cz++)
+    for (u32 cx = 0; cx < chunk.dimension(); cx++)
+    for (u32 cy = 0; cy < chunk.dimension(); cy++)
+    {
+        u32 counts[(u32) BlockType::NUM_TYPES] = {};
+
+        for (u32 sz = 0; sz < voxelSize; sz++)
+        for (u32 sx = 0; sx < voxelSize; sx++)
+        {
+            const u32 columnIndex = (cx * voxelSize + sx) + (cz * voxelSize + sz) * CHUNK_SIZE;
+            const f32 height = column.heights[columnIndex];
+            const BiomeType biome = column.biomes[columnIndex];
+
+            for (u32 sy = 0; sy < voxelSize; sy++)
+            {
+                const f32 blockHeight = (cy * voxelSize + sy + worldPosition.y);
+                counts[(u32) SurfaceBlockAt(biome, height, blockHeight)]++;
+            }
+        }
+
+        BlockType type = BlockType::NONE;
+        if (2 * counts[(u32) BlockType::NONE] < blocksPerVoxel)
+        {
+            u32 maxCount = 0;
+            for (u32 t = (u32) BlockType::NONE + 1; t < (u32) BlockType::NUM_TYPES; t++)
+            {
+                if (counts[t] > maxCount)
+                {
+                    maxCount = counts[t];
+                    type = (BlockType) t;
+                }
+            }
+        }
+
+        chunk.at(cx, cy, cz) = type;
+        onlyAir = onlyAir && (type == BlockType::NONE);
+    }
+
+    return onlyAir;
+}
+
+static void ColumnJobFunction(void* data)
+{
+    ColumnJob& job = *(ColumnJob*) data;
+    GenerateColumn(*job.generator, *job.column, job.x, job.z);
+}
+
+static void ChunkJobFunction(void* data)
+{
+    ChunkJob& job = *(ChunkJob*) data;
+    WorldGenChunk& gen = *job.chunk;
+
+    if (gen.chunk->dimension() != CHUNK_SIZE)
+    {
+        gen.onlyAir = GenerateChunkLOD(*gen.chunk, gen.coord, *gen.column);
+        return;
+    }
+
+    gen.onlyAir = GenerateChunkTerrain(*job.generator, *gen.chunk, gen.coord, *gen.column);
+
+    // Decoration from the columns around can reach into chunks above the terrain as well
+    DecorateChunk(*job.generator, *gen.chunk, gen.coord);
+
+    if (gen.onlyAir)
+    {
+        const BlockType* blocks = gen.chunk->data();
+        for (u32 i = 0; i < gen.chunk->totalSize() && gen.onlyAir; i++)
+            gen.onlyAir = (blocks[i] == BlockType::NONE);
+    }
+}
+
+void WorldGenerator::GenerateChunks(WorldGenChunk* chunks, u32 count)
+{
+    genData.columnJobs.Clear(false);
+    genData.chunkJobs.Clear(false);
+
+    {   // Find the cached columns and queue the ones that are missing
+        for (u32 i = 0; i < count; i++)
+        {
+            WorldGenChunk& gen = chunks[i];
+            const u64 key = PackColumnCoord(gen.coord.x, gen.coord.z);
+
+            auto it = columns.Find(key);
+            if (it)
+            {
+                gen.column = it.value();
+                continue;
+            }
+
+            WorldGenColumn* column;
+            if (freeColumns.size() > 0)
+            {
+                column = freeColumns[freeColumns.size() - 1];
+                freeColumns.PopBack();
+            }
+            else
+            {
+                column = (WorldGenColumn*) PlatformAllocate(sizeof(WorldGenColumn));
+                AssertWithMessage(column != nullptr, "Couldn't allocate world generation column!");
+            }
+
+            columns.Place(key, column);
+            genData.columnJobs.PushBack({ this, column, gen.coord.x, gen.coord.z });
+            gen.column = column;
+        }
+    }
+
+    {   // Columns first since every chunk needs its column. Jobs are added before submitting so the arrays don't move.
+        JobSystem::JobCounter counter;
+        for (u64 i = 0; i < genData.columnJobs.size(); i++)
+            JobSystem::Submit(ColumnJobFunction, &genData.columnJobs[i], &counter);
+
+        JobSystem::Wait(counter);
+    }
+
+    {   // Every chunk only writes its own blocks
+        for (u32 i = 0; i < count; i++)
+            genData.chunkJobs.PushBack({ this, &chunks[i] });
+
+        JobSystem::JobCounter counter;
+        for (u64 i = 0; i < genData.chunkJobs.size(); i++)
+            JobSystem::Submit(ChunkJobFunction, &genData.chunkJobs[i], &counter);
+
+        JobSystem::Wait(counter);
+    }
+}
+
+void WorldGenerator::ReleaseColumns(const ChunkLoadShape& shape, const Vector3Int& centerChunk)
+{
+    genData.releasedColumns.Clear(false);
+
+    for (auto it = columns.begin(); it != columns.end(); it++)
+    {
+        const Vector3Int coord = UnpackChunkCoord(it.key());
+        if (!shape.ContainsColumn(centerChunk, coord.x, coord.z))
+            genData.releasedColumns.PushBack(it.key());
+    }
+
+    for (u64 i = 0; i < genData.releasedColumns.size(); i++)
+    {
+        const u64 key = genData.releasedColumns[i];
+        freeColumns.PushBack(columns[key]);
+        columns.Remove(key);
+    }
+}
\ No newline at end of file
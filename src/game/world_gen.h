@@ -0,0 +1,114 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "containers/hashtable.h"
+#include "math/math.h"
+#include "chunk_area.h"
+#include "chunk_map.h"
+#include "voxel.h"
+
+#include <SimplexNoise.h>
+
+/*
+
+World generation.
+
+Terrain is made by a fixed pipeline of stages where every stage only reads
+the world seed, the position and the output of the stages before it:
+
+    1. Heightmap    Height of the terrain for every block column (2D noise)
+    2. Biome        Picked per column from a moisture noise and the height
+    3. Surface      Block type of every voxel from its depth below the surface
+                    and the layers of the column's biome
+    4. Caves        Voxels below the surface are carved out by 3D noise that
+                    is sampled on a coarse lattice and interpolated
+    5. Decoration   Boulders on the surface and pockets of ores in stone
+
+Stages 1 and 2 only depend on the column, so they run once per chunk column
+and are cached for every chunk in it. Stages 3 to 5 run per chunk and write
+straight into the chunk, the chunk itself is their cache.
+
+Every stage is a pure function of the seed and the position. Features that
+cross chunk borders (boulders, ore pockets) are placed from hashes of where
+they start, and every chunk places the parts of all features that reach
+into it, so a chunk never reads or writes another chunk. Columns and chunks
+run on the job system and always come out bit identical no matter how many
+threads there are or in which order they finish.
+
+SimplexNoise can't be seeded, so each noise layer is offset by an amount
+picked from the seed instead. The noise repeats every 256 units so the
+offsets are kept below that.
+
+Chunks at a lower level of detail only run stages 1 to 3, caves and
+decoration are too small to show up in them.
+
+*/
+
+enum struct BiomeType : u8
+{
+    PLAINS,
+    DESERT,
+    ROCKY,
+
+    NUM_TYPES
+};
+
+// Noise layers that get their own offset from the seed
+enum struct WorldGenNoise : u8
+{
+    HEIGHT,
+    MOISTURE,
+    CAVE_A,
+    CAVE_B,
+
+    NUM_TYPES
+};
+
+constexpr f32 maxHeightAmplitude = 16.0f;
+constexpr f32 maxDecorationHeight = 4.0f;      // How far decoration can stick out above the terrain
+
+// Chunks starting above this are always only air
+constexpr f32 maxWorldGenHeight = maxHeightAmplitude + maxDecorationHeight;
+
+// Output of the column stages for one column of chunks
+struct WorldGenColumn
+{
+    f32 heights[CHUNK_SIZE * CHUNK_SIZE];       // Terrain height of every block column, indexed by x + z * CHUNK_SIZE
+    BiomeType biomes[CHUNK_SIZE * CHUNK_SIZE];
+    f32 maxHeight;                              // Highest height in the column
+};
+
+// Chunk to run the pipeline for
+struct WorldGenChunk
+{
+    VoxelChunk* chunk = nullptr;                // Allocated by the caller, the dimension picks the level of detail
+    Vector3Int coord = {};
+
+    // Set by GenerateChunks
+    const WorldGenColumn* column = nullptr;
+    bool onlyAir = false;
+};
+
+struct WorldGenerator
+{
+    u64 seed;
+    SimplexNoise noise;
+    Vector3 noiseOffsets[(u32) WorldGenNoise::NUM_TYPES];
+
+    HashTable<u64, WorldGenColumn*> columns;    // Packed column coordinate (y is 0) -> cached column stages
+    DynamicArray<WorldGenColumn*> freeColumns;  // Allocated columns that aren't cached anymore
+
+    void Create(u64 seed);
+    void Free();
+
+    // Stages 1 and 2 for a single block column, for things that need the terrain outside the cached columns
+    f32 HeightAt(f32 x, f32 z) const;
+    BiomeType BiomeAt(f32 x, f32 z, f32 height) const;
+
+    // Runs the pipeline for every chunk on the job system. Columns that aren't cached yet are generated first.
+    void GenerateChunks(WorldGenChunk* chunks, u32 count);
+
+    // Forgets the cached columns of chunk columns the load shape doesn't cover anymore
+    void ReleaseColumns(const ChunkLoadShape& shape, const Vector3Int& centerChunk);
+};
\ No newline at end of file
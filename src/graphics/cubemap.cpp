@@ -3,15 +3,34 @@
 #include "core/types.h"
 #include "containers/stringview.h"
 #include "containers/hashtable.h"
+#include "texture_source.h"
 
-#include <stb_image.h>
 #include <glad/glad.h>
 
 static HashTable<String, Cubemap> loadedCubemaps;
 
-// Pixels should be in this order:
+// In the same order as the pixels
+static const GLenum cubemapFaceTargets[6] = {
+    GL_TEXTURE_CUBE_MAP_POSITIVE_X,     // Right
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_X,     // Left
+    GL_TEXTURE_CUBE_MAP_POSITIVE_Y,     // Top
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,     // Bottom
+    GL_TEXTURE_CUBE_MAP_POSITIVE_Z,     // Front
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,     // Back
+};
+
+static void InternalCubemapSetup(const CubemapSettings& settings)
+{
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, (GLint) settings.minFilter);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, (GLint) settings.maxFilter);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, (GLint) settings.wrapS);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, (GLint) settings.wrapT);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, (GLint) settings.wrapR);
+}
+
+// Uploads to the bound cubemap, pixels should be in this order:
 //      right, left, top, bottom, front, back
-static void InternalCubemapLoadPixels(Cubemap& cbm, u8* pixels[6], s32 width[6], s32 height[6], s32 bytesPP, const CubemapSettings& settings)
+static void InternalCubemapUploadPixels(u8* pixels[6], s32 width[6], s32 height[6], s32 bytesPP)
 {
     GLint internalFormat, format;
     switch (bytesPP)
@@ -34,9 +53,6 @@ static void InternalCubemapLoadPixels(Cubemap& cbm, u8* pixels[6], s32 width[6],
         } break;
     }
 
-    glGenTextures(1, &cbm.cbmID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cbm.cbmID);
-
     {   // Send all 6 faces to the GPU
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, internalFormat, width[0], height[0], 0, format, GL_UNSIGNED_BYTE, pixels[0]);    // Right
         glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, internalFormat, width[1], height[1], 0, format, GL_UNSIGNED_BYTE, pixels[1]);    // Left
@@ -47,12 +63,6 @@ static void InternalCubemapLoadPixels(Cubemap& cbm, u8* pixels[6], s32 width[6],
     }
 
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, (GLint) settings.minFilter);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, (GLint) settings.maxFilter);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, (GLint) settings.wrapS);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, (GLint) settings.wrapT);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, (GLint) settings.wrapR);
 }
 
 // Give this a name so I can keep track of this
@@ -65,15 +75,17 @@ void Cubemap::LoadPixels(StringView name, u8* pixels[6], s32 width[6], s32 heigh
         return;
     }
 
-    InternalCubemapLoadPixels(*this, pixels, width, height, bytesPP, settings);
+    glGenTextures(1, &cbmID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cbmID);
+
+    InternalCubemapUploadPixels(pixels, width, height, bytesPP);
+    InternalCubemapSetup(settings);
 
     loadedCubemaps[name] = *this;
 }
 
 void Cubemap::Load(StringView name, const StringView filepath[6], const CubemapSettings& settings)
 {
-    stbi_set_flip_vertically_on_load(false);
-    
     auto tex = loadedCubemaps.Find(name);
     if (tex)
     {
@@ -81,19 +93,29 @@ void Cubemap::Load(StringView name, const StringView filepath[6], const CubemapS
         return;
     }
 
-    u8* pixels[6];
-    s32 bytesPP, width[6], height[6];
-    
-    for (s32 index = 0; index < 6; index++)
+    TextureSource source;
+    bool decoded = DecodeTextureSource(source, filepath, 6, false);
+    AssertWithMessage(decoded, "Image couldn't be loaded!");
+
+    LoadSource(name, source, settings);
+
+    FreeTextureSource(source);
+}
+
+void Cubemap::LoadSource(StringView name, const TextureSource& source, const CubemapSettings& settings)
+{
+    auto tex = loadedCubemaps.Find(name);
+    if (tex)
     {
-        pixels[index] = stbi_load(filepath[index].cstr(), width + index, height + index, &bytesPP, 0);
-        AssertWithMessage(pixels, "Image couldn't be loaded!");
+        cbmID = (*tex).value.cbmID;
+        return;
     }
 
-    InternalCubemapLoadPixels(*this, pixels, width, height, bytesPP, settings);
+    glGenTextures(1, &cbmID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cbmID);
 
-    for (s32 i = 0; i < 6; i++)
-        stbi_image_free(pixels[i]);
+    UploadTextureSource(source, GL_TEXTURE_CUBE_MAP, cubemapFaceTargets);
+    InternalCubemapSetup(settings);
 
     loadedCubemaps[name] = *this;
 }
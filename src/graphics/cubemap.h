@@ -32,6 +32,8 @@ struct CubemapSettings
     static CubemapSettings Default() { return CubemapSettings(); }
 };
 
+struct TextureSource;
+
 // Faces should be in this order:
 //      right, left, top, bottom, front, back
 struct Cubemap
@@ -39,6 +41,7 @@ struct Cubemap
     u32 cbmID;
 
     void Load(StringView name, const StringView filepath[6], const CubemapSettings& settings);
+    void LoadSource(StringView name, const TextureSource& source, const CubemapSettings& settings);   // Uploads already decoded faces
     void LoadPixels(StringView name, u8* pixels[6], s32 width[6], s32 height[6], s32 bytesPP, const CubemapSettings& settings);
     void Free();
 
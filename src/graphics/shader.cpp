@@ -4,23 +4,30 @@
 #include "core/logging.h"
 #include "containers/stringview.h"
 #include "containers/string.h"
-#include "containers/hashtable.h"
+#include "containers/hash.h"
 #include "math/math.h"
 #include "fileio/fileio.h"
+#include "shader_cache.h"
 
+#include <cstring>
 #include <glad/glad.h>
 
 bool Shader::CompileFromFile(StringView filepath, Type type)
+{
+    // Load shader file
+    String source;
+    LoadFileToString(filepath, source);
+
+    return CompileSource(source, type);
+}
+
+bool Shader::CompileSource(StringView source, Type type)
 {
     // Since I just know fragment and vertex shaders, this works lol
     GLenum glShaderType = GL_FRAGMENT_SHADER + (int) type;
 
     u32 shader = glCreateShader(glShaderType);
 
-    // Load shader file
-    String source;
-    LoadFileToString(filepath, source);
-
     const char* srcCstr = source.cstr();
     glShaderSource(shader, 1, &srcCstr, nullptr);
     glCompileShader(shader);
@@ -46,43 +53,86 @@ bool Shader::CompileFromFile(StringView filepath, Type type)
     return true;
 }
 
-bool Shader::CompileSource(StringView source, Type type)
-{
-    // Since I just know fragment and vertex shaders, this works lol
-    GLenum glShaderType = GL_FRAGMENT_SHADER + (int) type;
+static constexpr u32 maxUniformNameLength = 64;
 
-    u32 shader = glCreateShader(glShaderType);
+// Names are compared by hash first, the name itself is only compared when the hashes match
+static struct
+{
+    Hash hashes[maxUniformIds];
+    char names[maxUniformIds][maxUniformNameLength];
+    u32 count;
+} uniformIdData;
 
-    const char* srcCstr = source.cstr();
-    glShaderSource(shader, 1, &srcCstr, nullptr);
-    glCompileShader(shader);
+UniformId GetUniformId(StringView uniformName)
+{
+    const u64 length = uniformName.size();
+    AssertWithMessage(length < maxUniformNameLength, "Uniform name is too long!");
 
-#ifdef GN_DEBUG
+    const Hash hash = HashCharBuffer(uniformName.cstr(), length);
 
-    GLint compileStatus;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-    
-    if (compileStatus != GL_TRUE)
+    for (u32 i = 0; i < uniformIdData.count; i++)
     {
-        GLsizei logLength = 0;
-        GLchar message[1024];
-        glGetShaderInfoLog(shader, 1024, &logLength, message);
-        std::cout << message << '\n';
+        const char* name = uniformIdData.names[i];
 
-        return false;
+        if (uniformIdData.hashes[i] == hash && name[length] == '\0' && memcmp(name, uniformName.cstr(), length) == 0)
+            return UniformId { i };
     }
 
-#endif // GN_DEBUG
+    AssertWithMessage(uniformIdData.count < maxUniformIds, "Too many uniform names!");
 
-    shaderIDs[(int) type] = shader;
-    return true;
+    char* name = uniformIdData.names[uniformIdData.count];
+    PlatformCopyMemory(name, uniformName.cstr(), length);
+    name[length] = '\0';
+
+    uniformIdData.hashes[uniformIdData.count] = hash;
+    return UniformId { uniformIdData.count++ };
 }
 
-bool Shader::Link()
+static void FindUniformLocations(Shader& shader)
+{
+    for (u32 i = 0; i < maxUniformIds; i++)
+        shader.uniformLocations[i] = -1;
+
+    GLint uniformCount = 0;
+    glGetProgramiv(shader.program, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+    for (GLint i = 0; i < uniformCount; i++)
+    {
+        GLchar name[256];
+        GLsizei length = 0;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(shader.program, i, sizeof(name), &length, &size, &type, name);
+
+        // Uniforms in blocks don't have a location
+        const GLint location = glGetUniformLocation(shader.program, name);
+        if (location < 0)
+            continue;
+
+        // Arrays are listed as their first element, the rest of the elements come after its location
+        if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+        {
+            length -= 3;
+            name[length] = '\0';
+        }
+
+        const UniformId uniform = GetUniformId(name);
+        shader.uniformLocations[uniform.index] = location;
+    }
+}
+
+static bool LinkProgram(Shader& shader, bool retrievable)
 {
+    u32& program = shader.program;
+    const u32* shaderIDs = shader.shaderIDs;
+
     program = glCreateProgram();
     glAttachShader(program, shaderIDs[0]);
     glAttachShader(program, shaderIDs[1]);
+
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glLinkProgram(program);
 
 #ifdef GN_DEBUG
@@ -104,76 +154,194 @@ bool Shader::Link()
     glDeleteShader(shaderIDs[0]);
     glDeleteShader(shaderIDs[1]);
 
+    FindUniformLocations(shader);
     return true;
 }
 
-void Shader::Bind() const
+bool Shader::Link()
 {
-    glUseProgram(program);
+    return LinkProgram(*this, false);
 }
 
-static inline int GetUniformLocation(Shader* shader, StringView uniformName)
+static void SaveProgramBinary(u32 program, StringView cachepath, Hash key)
 {
-    return glGetUniformLocation(shader->program, uniformName.cstr());
-    
-    /* TODO: Need to fix HashTables first
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+    // Drivers without any binary formats can't cache programs
+    if (size <= 0)
+        return;
 
-    if (shader->uniformLocations.Find(uniformName))
-        return shader->uniformLocations[uniformName];
-        
-    int uniformLocation = glGetUniformLocation(shader->program, uniformName.cstr());
-    shader->uniformLocations[uniformName] = uniformLocation;
-    return uniformLocation;
+    void* data = PlatformAllocate(size);
 
-    */
+    GLenum format;
+    GLsizei length = 0;
+    glGetProgramBinary(program, size, &length, &format, data);
+
+    // Not being able to write the cache only means the program is compiled again next time
+    bool saved = length > 0 && SaveShaderCache(cachepath, key, format, data, length);
+    WarnIf(!saved, "Couldn't write the shader cache!");
+
+    PlatformFree(data);
+}
+
+bool Shader::LoadFromFiles(StringView vertexPath, StringView fragmentPath)
+{
+    String vertexSource, fragmentSource;
+    LoadFileToString(vertexPath, vertexSource);
+    LoadFileToString(fragmentPath, fragmentSource);
+
+    Hash key;
+    {   // The binary is only valid for the same sources on the same driver
+        const StringView parts[] = {
+            vertexSource,
+            fragmentSource,
+            (const char*) glGetString(GL_VENDOR),
+            (const char*) glGetString(GL_RENDERER),
+            (const char*) glGetString(GL_VERSION),
+        };
+
+        key = GetShaderCacheKey(parts, 5);
+    }
+
+    String cachepath(vertexPath.cstr());
+    cachepath += ".program.cache";
+
+    ShaderCacheBinary binary;
+    if (LoadShaderCache(cachepath, key, binary))
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, binary.format, binary.data, (GLsizei) binary.size);
+        FreeShaderCache(binary);
+
+        GLint linkStatus;
+        glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+        if (linkStatus == GL_TRUE)
+        {
+            FindUniformLocations(*this);
+            return true;
+        }
+
+        // Drivers can refuse their own binaries (after an update with the same version string etc.)
+        glDeleteProgram(program);
+    }
+
+    if (!CompileSource(vertexSource, Type::VERTEX_SHADER) ||
+        !CompileSource(fragmentSource, Type::FRAGMENT_SHADER) ||
+        !LinkProgram(*this, true))
+        return false;
+
+    SaveProgramBinary(program, cachepath, key);
+    return true;
+}
+
+void Shader::Bind() const
+{
+    glUseProgram(program);
+}
+
+static inline int GetUniformLocation(Shader* shader, UniformId uniform)
+{
+    AssertWithMessage(uniform.index < maxUniformIds, "Invalid uniform id!");
+    return shader->uniformLocations[uniform.index];
 }
 
 void Shader::SetUniform1f(StringView uniformName, f32 value)
 {
-    glUniform1f(GetUniformLocation(this, uniformName), value);
+    SetUniform1f(GetUniformId(uniformName), value);
 }
 
 void Shader::SetUniform1i(StringView uniformName, s32 value)
 {
-    glUniform1i(GetUniformLocation(this, uniformName), value);
+    SetUniform1i(GetUniformId(uniformName), value);
 }
 
 void Shader::SetUniform1iv(StringView uniformName, u32 count, s32* data)
 {
-    glUniform1iv(GetUniformLocation(this, uniformName), count, data);
+    SetUniform1iv(GetUniformId(uniformName), count, data);
 }
 
 void Shader::SetUniform2f(StringView uniformName, f32 v0, f32 v1)
 {
-    glUniform2f(GetUniformLocation(this, uniformName), v0, v1);
+    SetUniform2f(GetUniformId(uniformName), v0, v1);
 }
 
 void Shader::SetUniform2fv(StringView uniformName, int count, f32* vs)
 {
-    glUniform2fv(GetUniformLocation(this, uniformName), count, vs);
+    SetUniform2fv(GetUniformId(uniformName), count, vs);
 }
 
 void Shader::SetUniform3f(StringView uniformName, f32 v0, f32 v1, f32 v2)
 {
-    glUniform3f(GetUniformLocation(this, uniformName), v0, v1, v2);
+    SetUniform3f(GetUniformId(uniformName), v0, v1, v2);
 }
 
 void Shader::SetUniform3fv(StringView uniformName, int count, f32* vs)
 {
-    glUniform3fv(GetUniformLocation(this, uniformName), count, vs);
+    SetUniform3fv(GetUniformId(uniformName), count, vs);
 }
 
 void Shader::SetUniform4f(StringView uniformName, f32 v0, f32 v1, f32 v2, f32 v3)
 {
-    glUniform4f(GetUniformLocation(this, uniformName), v0, v1, v2, v3);
+    SetUniform4f(GetUniformId(uniformName), v0, v1, v2, v3);
 }
 
 void Shader::SetUniform4fv(StringView uniformName, int count, f32* vs)
 {
-    glUniform4fv(GetUniformLocation(this, uniformName), count, vs);
+    SetUniform4fv(GetUniformId(uniformName), count, vs);
 }
 
 void Shader::SetUniformMatrix4(StringView uniformName, const Matrix4& mat)
 {
-    glUniformMatrix4fv(GetUniformLocation(this, uniformName), 1, false, (f32*) mat.data);
+    SetUniformMatrix4(GetUniformId(uniformName), mat);
+}
+
+void Shader::SetUniform1f(UniformId uniform, f32 value)
+{
+    glUniform1f(GetUniformLocation(this, uniform), value);
+}
+
+void Shader::SetUniform1i(UniformId uniform, s32 value)
+{
+    glUniform1i(GetUniformLocation(this, uniform), value);
+}
+
+void Shader::SetUniform1iv(UniformId uniform, u32 count, s32* data)
+{
+    glUniform1iv(GetUniformLocation(this, uniform), count, data);
+}
+
+void Shader::SetUniform2f(UniformId uniform, f32 v0, f32 v1)
+{
+    glUniform2f(GetUniformLocation(this, uniform), v0, v1);
+}
+
+void Shader::SetUniform2fv(UniformId uniform, int count, f32* vs)
+{
+    glUniform2fv(GetUniformLocation(this, uniform), count, vs);
+}
+
+void Shader::SetUniform3f(UniformId uniform, f32 v0, f32 v1, f32 v2)
+{
+    glUniform3f(GetUniformLocation(this, uniform), v0, v1, v2);
+}
+
+void Shader::SetUniform3fv(UniformId uniform, int count, f32* vs)
+{
+    glUniform3fv(GetUniformLocation(this, uniform), count, vs);
+}
+
+void Shader::SetUniform4f(UniformId uniform, f32 v0, f32 v1, f32 v2, f32 v3)
+{
+    glUniform4f(GetUniformLocation(this, uniform), v0, v1, v2, v3);
+}
+
+void Shader::SetUniform4fv(UniformId uniform, int count, f32* vs)
+{
+    glUniform4fv(GetUniformLocation(this, uniform), count, vs);
+}
+
+void Shader::SetUniformMatrix4(UniformId uniform, const Matrix4& mat)
+{
+    glUniformMatrix4fv(GetUniformLocation(this, uniform), 1, false, (f32*) mat.data);
 }
\ No newline at end of file
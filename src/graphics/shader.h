@@ -3,9 +3,31 @@
 #include "core/types.h"
 #include "containers/stringview.h"
 #include "containers/string.h"
-#include "containers/hashtable.h"
 #include "math/math.h"
 
+/*
+
+Uniforms can be set by name or by UniformId. Names are looked up every time
+they're used, so anything set every frame should get an id once and use that.
+
+An id is the same for a name in every shader. Each shader finds the locations
+of all its active uniforms when it's linked and keeps them in an array indexed
+by id, so setting a uniform through an id never asks the driver for anything.
+Uniforms the shader doesn't have (or the compiler removed) are at location -1,
+which OpenGL quietly ignores.
+
+*/
+
+struct UniformId
+{
+    u32 index;
+};
+
+constexpr u32 maxUniformIds = 64;
+
+// Interns the name, array uniforms are named without the [0]
+UniformId GetUniformId(StringView uniformName);
+
 struct Shader
 {
     enum class Type
@@ -19,6 +41,10 @@ struct Shader
     bool CompileSource(StringView source, Type type);
     bool Link();
 
+    // Compiles and links both files, or loads the driver's binary of the program from a cache
+    // written the last time they were linked on the same driver
+    bool LoadFromFiles(StringView vertexPath, StringView fragmentPath);
+
     void Bind() const;
 
     void SetUniform1f(StringView uniformName, f32 value);
@@ -36,7 +62,22 @@ struct Shader
 
     void SetUniformMatrix4(StringView uniformName, const Matrix4& mat);
 
+    void SetUniform1f(UniformId uniform, f32 value);
+    void SetUniform1i(UniformId uniform, s32 value);
+    void SetUniform1iv(UniformId uniform, u32 count, s32* data);
+
+    void SetUniform2f(UniformId uniform, f32 v0, f32 v1);
+    void SetUniform2fv(UniformId uniform, int count, f32* vs);
+
+    void SetUniform3f(UniformId uniform, f32 v0, f32 v1, f32 v2);
+    void SetUniform3fv(UniformId uniform, int count, f32* vs);
+
+    void SetUniform4f(UniformId uniform, f32 v0, f32 v1, f32 v2, f32 v3);
+    void SetUniform4fv(UniformId uniform, int count, f32* vs);
+
+    void SetUniformMatrix4(UniformId uniform, const Matrix4& mat);
+
     u32 shaderIDs[(u64) Type::NUM_TYPES];
     u32 program;
-    HashTable<String, s32> uniformLocations;
+    s32 uniformLocations[maxUniformIds];
 };
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "shader_cache.h"
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "containers/hash.h"
+#include "fileio/fileio.h"
+#include "platform/platform.h"
+
+static constexpr u32 shaderCacheMagic = 0x43534E47;     // "GNSC"
+static constexpr u32 shaderCacheVersion = 1;
+
+struct ShaderCacheHeader
+{
+    u32 magic;
+    u32 version;
+    Hash key;
+
+    u32 format;
+    u32 reserved;
+    u64 size;
+
+    Hash binaryHash;            // A corrupt binary could take the driver down with it
+};
+
+Hash GetShaderCacheKey(const StringView parts[], u32 count)
+{
+    Hash key = shaderCacheVersion;
+
+    // Sizes are mixed in so text can't move from one part to the next without changing the key
+    for (u32 i = 0; i < count; i++)
+        key = HashCharBuffer(parts[i].cstr(), parts[i].size(), key ^ parts[i].size());
+
+    return key;
+}
+
+bool LoadShaderCache(StringView cachepath, Hash key, ShaderCacheBinary& binary)
+{
+    if (!PlatformMapFile(binary.file, cachepath.cstr()))
+        return false;
+
+    ShaderCacheHeader header = {};
+    bool valid = (binary.file.size >= sizeof(ShaderCacheHeader));
+
+    if (valid)
+    {
+        PlatformCopyMemory(&header, binary.file.data, sizeof(ShaderCacheHeader));
+
+        valid = header.magic == shaderCacheMagic &&
+                header.version == shaderCacheVersion &&
+                header.key == key &&
+                header.size > 0 &&
+                binary.file.size == sizeof(ShaderCacheHeader) + header.size;
+    }
+
+    const char* data = (const char*) binary.file.data + sizeof(ShaderCacheHeader);
+
+    if (valid)
+        valid = (HashCharBuffer(data, header.size) == header.binaryHash);
+
+    if (!valid)
+    {
+        FreeShaderCache(binary);
+        return false;
+    }
+
+    binary.format = header.format;
+    binary.data = data;
+    binary.size = header.size;
+    return true;
+}
+
+void FreeShaderCache(ShaderCacheBinary& binary)
+{
+    PlatformUnmapFile(binary.file);
+
+    binary.format = 0;
+    binary.data = nullptr;
+    binary.size = 0;
+}
+
+bool SaveShaderCache(StringView cachepath, Hash key, u32 format, const void* data, u64 size)
+{
+    char* blob = (char*) PlatformAllocate(sizeof(ShaderCacheHeader) + size);
+
+    ShaderCacheHeader header = {};
+    header.magic = shaderCacheMagic;
+    header.version = shaderCacheVersion;
+    header.key = key;
+    header.format = format;
+    header.size = size;
+    header.binaryHash = HashCharBuffer((const char*) data, size);
+
+    PlatformCopyMemory(blob, &header, sizeof(ShaderCacheHeader));
+    PlatformCopyMemory(blob + sizeof(ShaderCacheHeader), data, size);
+
+    const bool saved = SaveBytesToFile(cachepath, blob, sizeof(ShaderCacheHeader) + size);
+
+    PlatformFree(blob);
+    return saved;
+}
\ No newline at end of file
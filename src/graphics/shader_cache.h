@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "containers/hash.h"
+#include "platform/platform.h"
+
+/*
+
+Linked shader programs cached on disk as the driver's program binaries, so
+the sources don't have to be compiled and linked every time the game starts.
+
+A binary can only be loaded by the driver that made it, so the key hashes the
+driver's vendor, renderer and version strings along with every source. Drivers
+can still refuse a binary, in which case the program is compiled from source
+and the cache is written again.
+
+None of this needs OpenGL, the binary and its format are just bytes here.
+
+*/
+
+struct ShaderCacheBinary
+{
+    PlatformMappedFile file;
+
+    u32 format;                 // The GLenum from glGetProgramBinary
+    const void* data;
+    u64 size;
+};
+
+// Hashes the sources of a program and the strings identifying the driver, in that order
+Hash GetShaderCacheKey(const StringView parts[], u32 count);
+
+// Maps the cache, false if there's no cache, it's corrupt or it was made for another key
+bool LoadShaderCache(StringView cachepath, Hash key, ShaderCacheBinary& binary);
+void FreeShaderCache(ShaderCacheBinary& binary);
+
+bool SaveShaderCache(StringView cachepath, Hash key, u32 format, const void* data, u64 size);
\ No newline at end of file
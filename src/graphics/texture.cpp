@@ -3,8 +3,8 @@
 #include "core/types.h"
 #include "containers/stringview.h"
 #include "containers/hashtable.h"
+#include "texture_source.h"
 
-#include <stb_image.h>
 #include <glad/glad.h>
 
 static HashTable<String, Texture> loadedTextures;
@@ -23,7 +23,20 @@ struct TextureData
 constexpr u32 maxLoadedTextures = 100;
 static TextureData textureDataTable[maxLoadedTextures] = {};
 
-static void InternalTextureLoadPixels(StringView name, Texture& tex, u8* pixels, s32 width, s32 height, s32 bytesPP, const TextureSettings& settings)
+static void InternalTextureSetup(StringView name, Texture& tex, s32 width, s32 height, const TextureSettings& settings)
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) settings.minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) settings.maxFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLint) settings.wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) settings.wrapT);
+
+    textureDataTable[tex.texID].width = width;
+    textureDataTable[tex.texID].height = height;
+    textureDataTable[tex.texID].name = name;
+}
+
+// Uploads to the bound texture
+static void InternalTextureUploadPixels(u8* pixels, s32 width, s32 height, s32 bytesPP)
 {
     GLint internalFormat, format;
     switch (bytesPP)
@@ -46,39 +59,44 @@ static void InternalTextureLoadPixels(StringView name, Texture& tex, u8* pixels,
         } break;
     }
 
-    glGenTextures(1, &tex.texID);
-    glBindTexture(GL_TEXTURE_2D, tex.texID);
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
     glGenerateMipmap(GL_TEXTURE_2D);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) settings.minFilter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) settings.maxFilter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLint) settings.wrapS);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) settings.wrapT);
+void Texture::Load(StringView filepath, const TextureSettings& settings)
+{
+    auto tex = loadedTextures.Find(filepath);
+    if (tex)
+    {
+        texID = (*tex).value.texID;
+        return;
+    }
 
-    textureDataTable[tex.texID].width = width;
-    textureDataTable[tex.texID].height = height;
-    textureDataTable[tex.texID].name = name;
+    TextureSource source;
+    bool decoded = DecodeTextureSource(source, &filepath, 1, true);
+    AssertWithMessage(decoded, "Image couldn't be loaded!");
+
+    LoadSource(filepath, source, settings);
+
+    FreeTextureSource(source);
 }
 
-void Texture::Load(StringView filepath, const TextureSettings& settings)
+void Texture::LoadSource(StringView filepath, const TextureSource& source, const TextureSettings& settings)
 {
-    stbi_set_flip_vertically_on_load(true);
-    
     auto tex = loadedTextures.Find(filepath);
     if (tex)
     {
         texID = (*tex).value.texID;
         return;
     }
-    
-    s32 bytesPP, width, height;
-    u8* pixels = stbi_load(filepath.cstr(), &width, &height, &bytesPP, 0);
-    AssertWithMessage(pixels, "Image couldn't be loaded!");
 
-    InternalTextureLoadPixels(filepath, *this, pixels, width, height, bytesPP, settings);
+    const GLenum faceTarget = GL_TEXTURE_2D;
 
-    stbi_image_free(pixels);
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    UploadTextureSource(source, GL_TEXTURE_2D, &faceTarget);
+    InternalTextureSetup(filepath, *this, source.info.width, source.info.height, settings);
 
     loadedTextures[filepath] = *this;
 }
@@ -93,7 +111,11 @@ void Texture::LoadPixels(StringView name, u8* pixels, s32 width, s32 height, s32
         return;
     }
 
-    InternalTextureLoadPixels(name, *this, pixels, width, height, bytesPP, settings);
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    InternalTextureUploadPixels(pixels, width, height, bytesPP);
+    InternalTextureSetup(name, *this, width, height, settings);
 
     loadedTextures[name] = *this;
 }
@@ -31,11 +31,14 @@ struct TextureSettings
     static TextureSettings Default() { return TextureSettings(); }
 };
 
+struct TextureSource;
+
 struct Texture
 {
     u32 texID;
 
     void Load(StringView filepath, const TextureSettings& settings);
+    void LoadSource(StringView filepath, const TextureSource& source, const TextureSettings& settings);   // Uploads an already decoded image
     void LoadPixels(StringView name, u8* pixels, s32 width, s32 height, s32 bytesPP, const TextureSettings& settings);
     void Free();
 
@@ -0,0 +1,197 @@
+#include "texture_cache.h"
+
+#include "core/types.h"
+#include "core/logging.h"
+#include "containers/stringview.h"
+#include "containers/hash.h"
+#include "fileio/fileio.h"
+#include "math/common.h"
+#include "platform/platform.h"
+
+static constexpr u32 textureCacheMagic = 0x43544E47;    // "GNTC"
+static constexpr u32 textureCacheVersion = 1;
+
+struct TextureCacheHeader
+{
+    u32 magic;
+    u32 version;
+    u64 key;
+
+    s32 width, height;
+    s32 bytesPP;
+
+    u32 faceCount;
+    u32 levelCount;
+    u32 reserved;
+};
+
+static void GetPixelFormat(s32 bytesPP, GLint& internalFormat, GLenum& format)
+{
+    switch (bytesPP)
+    {
+        case 3:
+        {
+            internalFormat = GL_RGB8;
+            format = GL_RGB;
+        } break;
+
+        case 4:
+        {
+            internalFormat = GL_RGBA8;
+            format = GL_RGBA;
+        } break;
+
+        default:
+        {
+            AssertNotImplemented();
+        } break;
+    }
+}
+
+// Number of levels in a full mip chain
+static u32 GetLevelCount(s32 width, s32 height)
+{
+    u32 levelCount = 1;
+    for (s32 size = Max(width, height); size > 1; size >>= 1)
+        levelCount++;
+
+    return levelCount;
+}
+
+static u64 GetLevelSize(const TextureCacheInfo& info, u32 level)
+{
+    const u64 width = Max(info.width >> level, 1);
+    const u64 height = Max(info.height >> level, 1);
+
+    return width * height * info.bytesPP;
+}
+
+static u64 GetFaceSize(const TextureCacheInfo& info)
+{
+    const u32 levelCount = GetLevelCount(info.width, info.height);
+
+    u64 size = 0;
+    for (u32 level = 0; level < levelCount; level++)
+        size += GetLevelSize(info, level);
+
+    return size;
+}
+
+bool GetTextureCacheKey(const StringView filepaths[], u32 count, u64& key)
+{
+    key = textureCacheVersion;
+
+    for (u32 i = 0; i < count; i++)
+    {
+        u64 writeTime;
+        if (!PlatformGetFileWriteTime(filepaths[i].cstr(), writeTime))
+            return false;
+
+        key = HashCharBuffer(filepaths[i].cstr(), filepaths[i].size(), key ^ writeTime);
+    }
+
+    return true;
+}
+
+bool MapTextureCache(StringView cachepath, u64 key, u32 faceCount, PlatformMappedFile& file, TextureCacheInfo& info)
+{
+    if (!PlatformMapFile(file, cachepath.cstr()))
+        return false;
+
+    TextureCacheHeader header = {};
+    bool valid = (file.size >= sizeof(TextureCacheHeader));
+
+    if (valid)
+    {
+        PlatformCopyMemory(&header, file.data, sizeof(TextureCacheHeader));
+
+        valid = header.magic == textureCacheMagic &&
+                header.version == textureCacheVersion &&
+                header.key == key &&
+                header.faceCount == faceCount &&
+                header.width > 0 && header.height > 0 &&
+                (header.bytesPP == 3 || header.bytesPP == 4) &&
+                header.levelCount == GetLevelCount(header.width, header.height);
+    }
+
+    const TextureCacheInfo cachedInfo = { header.width, header.height, header.bytesPP };
+
+    if (valid)
+        valid = (file.size == sizeof(TextureCacheHeader) + faceCount * GetFaceSize(cachedInfo));
+
+    if (valid)
+        info = cachedInfo;
+    else
+        PlatformUnmapFile(file);
+
+    return valid;
+}
+
+void UploadTextureCache(const PlatformMappedFile& file, u32 faceCount, const GLenum faceTargets[], const TextureCacheInfo& info)
+{
+    GLint internalFormat;
+    GLenum format;
+    GetPixelFormat(info.bytesPP, internalFormat, format);
+
+    // Levels are tightly packed, even the ones with rows of 1 or 2 pixels
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    const u32 levelCount = GetLevelCount(info.width, info.height);
+    const u8* pixels = (const u8*) file.data + sizeof(TextureCacheHeader);
+
+    for (u32 face = 0; face < faceCount; face++)
+    {
+        for (u32 level = 0; level < levelCount; level++)
+        {
+            const s32 width = Max(info.width >> level, 1);
+            const s32 height = Max(info.height >> level, 1);
+
+            glTexImage2D(faceTargets[face], level, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+            pixels += GetLevelSize(info, level);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void SaveTextureCache(StringView cachepath, u64 key, u32 faceCount, const GLenum faceTargets[], const TextureCacheInfo& info)
+{
+    const u64 size = sizeof(TextureCacheHeader) + faceCount * GetFaceSize(info);
+    u8* blob = (u8*) PlatformAllocate(size);
+
+    TextureCacheHeader header = {};
+    header.magic = textureCacheMagic;
+    header.version = textureCacheVersion;
+    header.key = key;
+    header.width = info.width;
+    header.height = info.height;
+    header.bytesPP = info.bytesPP;
+    header.faceCount = faceCount;
+    header.levelCount = GetLevelCount(info.width, info.height);
+
+    PlatformCopyMemory(blob, &header, sizeof(TextureCacheHeader));
+
+    GLint internalFormat;
+    GLenum format;
+    GetPixelFormat(info.bytesPP, internalFormat, format);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    u8* pixels = blob + sizeof(TextureCacheHeader);
+    for (u32 face = 0; face < faceCount; face++)
+    {
+        for (u32 level = 0; level < header.levelCount; level++)
+        {
+            glGetTexImage(faceTargets[face], level, format, GL_UNSIGNED_BYTE, pixels);
+            pixels += GetLevelSize(info, level);
+        }
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // Not being able to write the cache only means the images are decoded again next time
+    bool saved = SaveBytesToFile(cachepath, blob, size);
+    WarnIf(!saved, "Couldn't write the texture cache!");
+
+    PlatformFree(blob);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "platform/platform.h"
+
+#include <glad/glad.h>
+
+/*
+
+Decoded images cached on disk with all their mip levels, so they don't have
+to be decoded or have mipmaps generated every time the game starts.
+
+A cache holds 1 face for textures or 6 for cubemaps, each with its full mip
+chain tightly packed. The levels are read back from the driver after
+glGenerateMipmap the first time the images are loaded, so a texture loaded
+from the cache is the same as one that wasn't. Later loads memory map the
+cache and upload the levels straight from the mapping. Mapping and checking
+the cache doesn't need OpenGL, only the upload does.
+
+A cache is only used if it was made from the same source files with the same
+write times. It's checked by its size and not a hash, so loading doesn't have
+to read through the pixels twice.
+
+*/
+
+struct TextureCacheInfo
+{
+    s32 width, height;          // Of the first mip level
+    s32 bytesPP;
+};
+
+// Identifies the source images by their paths and write times, false if one of them doesn't exist
+bool GetTextureCacheKey(const StringView filepaths[], u32 count, u64& key);
+
+// Maps the cache, false if there's no cache or it wasn't made from the same source images
+bool MapTextureCache(StringView cachepath, u64 key, u32 faceCount, PlatformMappedFile& file, TextureCacheInfo& info);
+
+// Uploads every level of every face in a mapped cache to the bound texture
+void UploadTextureCache(const PlatformMappedFile& file, u32 faceCount, const GLenum faceTargets[], const TextureCacheInfo& info);
+
+// Reads back every level of every face of the bound texture and writes them to the cache
+void SaveTextureCache(StringView cachepath, u64 key, u32 faceCount, const GLenum faceTargets[], const TextureCacheInfo& info);
\ No newline at end of file
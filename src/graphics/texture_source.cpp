@@ -0,0 +1,125 @@
+#include "texture_source.h"
+
+#include "core/types.h"
+#include "core/logging.h"
+#include "containers/stringview.h"
+#include "platform/platform.h"
+
+#include <cstring>
+#include <stb_image.h>
+
+static constexpr u64 mappedPageSize = 4096;
+
+static bool GetCachePath(TextureSource& source, StringView filepath)
+{
+    // Cubemaps get their own extension in case the first face is also loaded as a texture
+    const char* extension = (source.faceCount == 1) ? ".cache" : ".cubemap.cache";
+    const u64 extensionLength = strlen(extension);
+
+    if (filepath.size() + extensionLength >= maxTextureSourcePathLength)
+        return false;
+
+    PlatformCopyMemory(source.cachepath, filepath.cstr(), filepath.size());
+    PlatformCopyMemory(source.cachepath + filepath.size(), extension, extensionLength + 1);
+    return true;
+}
+
+bool DecodeTextureSource(TextureSource& source, const StringView filepaths[], u32 faceCount, bool flipVertically)
+{
+    AssertWithMessage(faceCount > 0 && faceCount <= maxTextureSourceFaces, "Texture source has too many faces!");
+
+    PlatformZeroMemory(&source, sizeof(TextureSource));
+    source.faceCount = faceCount;
+
+    if (!GetTextureCacheKey(filepaths, faceCount, source.cacheKey))
+        return false;
+
+    const bool hasCachePath = GetCachePath(source, filepaths[0]);
+    WarnIf(!hasCachePath, "Image path is too long to be cached!");
+
+    if (hasCachePath && MapTextureCache(source.cachepath, source.cacheKey, faceCount, source.cache, source.info))
+    {
+        // Touch every page so the file is read here and not in the middle of the upload
+        const volatile u8* bytes = (const volatile u8*) source.cache.data;
+
+        u8 touched = 0;
+        for (u64 offset = 0; offset < source.cache.size; offset += mappedPageSize)
+            touched ^= bytes[offset];
+
+        return true;
+    }
+
+    // The global flag would be shared with images decoded on other threads
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    for (u32 face = 0; face < faceCount; face++)
+    {
+        s32 width, height, bytesPP;
+        source.pixels[face] = stbi_load(filepaths[face].cstr(), &width, &height, &bytesPP, 0);
+
+        bool valid = (source.pixels[face] != nullptr);
+        if (valid && face == 0)
+            source.info = { width, height, bytesPP };
+        else if (valid)
+            valid = width == source.info.width && height == source.info.height && bytesPP == source.info.bytesPP;
+
+        if (!valid)
+        {
+            FreeTextureSource(source);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void UploadTextureSource(const TextureSource& source, GLenum target, const GLenum faceTargets[])
+{
+    if (source.cache.data)
+    {
+        UploadTextureCache(source.cache, source.faceCount, faceTargets, source.info);
+        return;
+    }
+
+    GLint internalFormat, format;
+    switch (source.info.bytesPP)
+    {
+        case 3:
+        {
+            internalFormat = GL_RGB8;
+            format = GL_RGB;
+        } break;
+
+        case 4:
+        {
+            internalFormat = GL_RGBA8;
+            format = GL_RGBA;
+        } break;
+
+        default:
+        {
+            AssertNotImplemented();
+        } break;
+    }
+
+    for (u32 face = 0; face < source.faceCount; face++)
+        glTexImage2D(faceTargets[face], 0, internalFormat, source.info.width, source.info.height, 0, format, GL_UNSIGNED_BYTE, source.pixels[face]);
+
+    glGenerateMipmap(target);
+
+    if (source.cachepath[0])
+        SaveTextureCache(source.cachepath, source.cacheKey, source.faceCount, faceTargets, source.info);
+}
+
+void FreeTextureSource(TextureSource& source)
+{
+    PlatformUnmapFile(source.cache);
+
+    for (u32 face = 0; face < source.faceCount; face++)
+    {
+        if (source.pixels[face])
+            stbi_image_free(source.pixels[face]);
+
+        source.pixels[face] = nullptr;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "platform/platform.h"
+#include "texture_cache.h"
+
+#include <glad/glad.h>
+
+/*
+
+Images of a texture or cubemap before they're sent to the GPU.
+
+Loading is split in two so the slow part can run on any thread. Decoding
+reads the images (or maps and reads their cache) without touching OpenGL,
+uploading sends them to the bound texture on the thread with the context.
+
+*/
+
+constexpr u32 maxTextureSourceFaces = 6;
+constexpr u32 maxTextureSourcePathLength = 260;
+
+struct TextureSource
+{
+    TextureCacheInfo info;
+    u32 faceCount;
+
+    u64  cacheKey;
+    char cachepath[maxTextureSourcePathLength];
+
+    PlatformMappedFile cache;                   // Every level of every face, if the cache could be used
+    u8* pixels[maxTextureSourceFaces];          // Otherwise the first level of each face
+};
+
+// Faces of a cubemap have to be the same size. Returns false if an image couldn't be loaded.
+bool DecodeTextureSource(TextureSource& source, const StringView filepaths[], u32 faceCount, bool flipVertically);
+
+// Uploads every level of every face to the bound texture, the cache is written if the images
+// had to be decoded
+void UploadTextureSource(const TextureSource& source, GLenum target, const GLenum faceTargets[]);
+
+void FreeTextureSource(TextureSource& source);
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "core/application.h"
 #include "core/input.h"
+#include "engine/asset_loader.h"
 #include "engine/imgui.h"
 #include "engine/camera.h"
 #include "engine/renderer3d.h"
@@ -7,17 +8,24 @@
 #include "engine/skybox.h"
 #include "game/chunk_area.h"
 #include "game/chunk_renderer.h"
+#include "game/entities.h"
+#include "game/far_terrain.h"
+#include "game/pathfinding.h"
+#include "game/spatial_hash.h"
 #include "game/voxel_physics.h"
+#include "game/voxel_ticks.h"
 #include "game/voxel.h"
+#include "game/world_gen.h"
 #include "graphics/texture.h"
 #include "math/math.h"
 
-#include <SimplexNoise.h>
-
 struct SceneData
 {
     // Data
     VoxelChunkArea area;
+    FarTerrain farTerrain;
+    EntityWorld entities;
+    SpatialHash entityHash;             // Broadphase for entity overlap and proximity queries
 
     // Gameplay
     BlockType currentBlockType = (BlockType) 1;
@@ -32,13 +40,22 @@ struct SceneData
     Skybox skybox;
 
     // World Generation
-    SimplexNoise noise;
+    WorldGenerator worldGen;
+    u64 worldSeed = 20230815;           // Same seed always generates the same world
 
     // Camera
     Camera camera;
     f32 cameraMoveSpeed = 10.5f;
     f32 cameraLookSpeed = 0.5f;
 
+    // Player
+    PhysicsBody player;
+    bool  flying = true;                // Fly through everything instead of walking with collisions
+    f32   playerWalkSpeed = 4.3f;
+    f32   playerJumpSpeed = 8.5f;
+    f32   playerEyeHeight = 1.62f;
+    f32   physicsTimeAccumulator = 0.0f;
+
     // UI
     Imgui::Font  font;
     Imgui::Image crosshair;
@@ -64,7 +81,7 @@ void OnInit(Application& app)
 
     {   // Camera
         const f32 aspectRatio = (f32) app.window.width / (f32) app.window.height;
-        scene.camera = Camera::Perspective(45, aspectRatio, 0.1f, 1000.0f);
+        scene.camera = Camera::Perspective(45, aspectRatio, 0.1f, 2000.0f);
         scene.camera.position() = Vector3(-4, 3, 3);
         scene.camera.forward() = (-scene.camera.position()).Normalized();
         scene.camera.up() = Vector3::up;
@@ -73,33 +90,65 @@ void OnInit(Application& app)
         scene.camera.UpdateViewMatrix();
     }
 
-    {   // Compile Shader
-        AssertWithMessage(
-            scene.voxelShader.CompileFromFile(voxelVertShaderPath, Shader::Type::VERTEX_SHADER),
-            "Failed to compile Voxel Vertex Shader"
-        );
+    // Decoded on the job system while the shaders compile and the world is generated
+    AssetLoader::AssetHandle assets[4];
 
-        AssertWithMessage(
-            scene.voxelShader.CompileFromFile(voxelFragShaderPath, Shader::Type::FRAGMENT_SHADER),
-            "Failed to compile Voxel Fragment Shader"
-        );
+    {   // Start loading assets
+        TextureSettings settings = TextureSettings::Default();
+        settings.minFilter = settings.maxFilter = TextureSettings::Filter::NEAREST;
+
+        assets[0] = AssetLoader::LoadTexture(scene.voxelTextureAtlas, "assets/art/atlas/Minecraft Atlas.png", settings);
+        assets[1] = AssetLoader::LoadTexture(scene.crosshair, "assets/art/ui/crosshair.png", settings);
+        assets[2] = AssetLoader::LoadFont(scene.font, "assets/fonts/bell.font.png", "assets/fonts/bell.font.json");
 
+        // Skybox cubemap
+        const StringView filepaths[] = {
+            "assets/art/skybox/simple/side.jpg",
+            "assets/art/skybox/simple/side.jpg",
+            "assets/art/skybox/simple/top.jpg",
+            "assets/art/skybox/simple/bottom.jpg",
+            "assets/art/skybox/simple/side.jpg",
+            "assets/art/skybox/simple/side.jpg",
+        };
+
+        assets[3] = AssetLoader::LoadCubemap(scene.skybox.cubemap, "Skybox Default", filepaths, CubemapSettings::Default());
+    }
+
+    {   // Compile Shader
         AssertWithMessage(
-            scene.voxelShader.Link(),
-            "Failed to link Voxel Shader"
+            scene.voxelShader.LoadFromFiles(voxelVertShaderPath, voxelFragShaderPath),
+            "Failed to load Voxel Shader"
         );
     }
 
     {   // Init voxel chunk area data
-        scene.area.Create(120.0f);
-        scene.area.InitializeChunkArea(scene.noise, scene.camera.position());
+        // Only load a flat band of chunks around the terrain so the view distance can be pushed out
+        ChunkLoadShape shape;
+        shape.type = ChunkLoadShape::Type::CYLINDER;
+        shape.radius = 12;
+        shape.useBand = true;
+        shape.bandMinY = -2;
+        shape.bandMaxY = 0;
+
+        // Use coarser meshes for rings further away
+        shape.lodDistances[0] = 4;
+        shape.lodDistances[1] = 7;
+        shape.lodDistances[2] = 10;
+
+        scene.worldGen.Create(scene.worldSeed);
+
+        scene.area.Create(shape);
+        scene.area.InitializeChunkArea(scene.worldGen, scene.camera.position());
+
+        // Heightmap only terrain out to the horizon past the voxel area
+        scene.farTerrain.Create(3, 16);
+        scene.farTerrain.Update(scene.worldGen, scene.area, scene.camera.position());
     }
 
-    {   // Load Texture Atlas
-        TextureSettings settings = TextureSettings::Default();
-        settings.minFilter = settings.maxFilter = TextureSettings::Filter::NEAREST;
-        scene.voxelTextureAtlas.Load("assets/art/atlas/Minecraft Atlas.png", settings);
+    scene.entities.Create();
+    scene.entityHash.Create(8.0f);      // About the range of a mob's interactions
 
+    {   // White texture for debugging lighting
         if (!Texture::Exists("White Texture", scene.whiteTexture))
         {
             constexpr u32 dimension = 2;
@@ -110,36 +159,17 @@ void OnInit(Application& app)
             settings.minFilter = settings.maxFilter = TextureSettings::Filter::NEAREST;
             scene.whiteTexture.LoadPixels("White Texture", pixels, dimension, dimension, 4, settings);
         }
-
-        scene.currentTexture = (scene.debugSettings.showLighting) ? scene.whiteTexture : scene.voxelTextureAtlas;
     }
 
-    {   // UI Stuff
-    
-        // Font
-        scene.font.Load("assets/fonts/bell.font.png", "assets/fonts/bell.font.json");
+    {   // Finish loading assets
+        AssetLoader::WaitAll();
 
-        {   // Crosshair
-            TextureSettings settings = TextureSettings::Default();
-            settings.minFilter = settings.maxFilter = TextureSettings::Filter::NEAREST;
-            scene.crosshair.Load("assets/art/ui/crosshair.png", settings);
-        }
+        for (u32 i = 0; i < 4; i++)
+            AssertWithMessage(AssetLoader::IsReady(assets[i]), "Asset couldn't be loaded!");
 
-    }
-
-    {   // Load images for skybox cubemap
-        Cubemap& cubemap = scene.skybox.cubemap;
+        AssetLoader::Clear();
 
-        const StringView filepaths[] = {
-            "assets/art/skybox/simple/side.jpg",
-            "assets/art/skybox/simple/side.jpg",
-            "assets/art/skybox/simple/top.jpg",
-            "assets/art/skybox/simple/bottom.jpg",
-            "assets/art/skybox/simple/side.jpg",
-            "assets/art/skybox/simple/side.jpg",
-        };
-
-        cubemap.Load("Skybox Default", filepaths, CubemapSettings::Default());
+        scene.currentTexture = (scene.debugSettings.showLighting) ? scene.whiteTexture : scene.voxelTextureAtlas;
     }
 
     Input::CenterMouse(scene.freeLook);
@@ -191,11 +221,27 @@ void OnUpdate(Application& app)
 
     #endif // GN_DEBUG
 
+    if (Input::GetKeyDown(Key::F))
+    {
+        scene.flying = !scene.flying;
+
+        if (!scene.flying)
+        {   // Start walking from where the camera is
+            scene.player.position = scene.camera.position() - Vector3(0.0f, scene.playerEyeHeight, 0.0f);
+            scene.player.previousPosition = scene.player.position;
+            scene.player.velocity = Vector3(0.0f);
+            scene.physicsTimeAccumulator = 0.0f;
+        }
+    }
+
     {   // Player Interactions
-        bool cameraMoved = MoveCamera(scene.camera, scene.cameraLookSpeed, scene.cameraMoveSpeed, app.deltaTime, scene.freeLook);
+        bool cameraMoved = (scene.flying)
+                         ? MoveCamera(scene.camera, scene.cameraLookSpeed, scene.cameraMoveSpeed, app.deltaTime, scene.freeLook)
+                         : RotateCamera(scene.camera, scene.cameraLookSpeed, app.deltaTime, scene.freeLook);
         bool placedOrRemovedTransparentBlock = false;
         
-        scene.area.UpdateChunkArea(scene.noise, scene.camera.position());
+        scene.area.UpdateChunkArea(scene.worldGen, scene.camera.position());
+        scene.farTerrain.Update(scene.worldGen, scene.area, scene.camera.position());
 
         // Remove blocks
         if (Input::GetMouseButtonDown(MouseButton::LEFT))
@@ -203,8 +249,7 @@ void OnUpdate(Application& app)
             RayHitResult hit;
             if (RayIntersectionWithBlock(scene.area, scene.camera.position(), scene.camera.forward(), hit, scene.maxInteractDistance))
             {
-                u32 index = scene.area.chunkIndices.at(hit.chunkIndex.x, hit.chunkIndex.y, hit.chunkIndex.z);
-                BlockType removedBlockType = scene.area.chunks[index].at(hit.blockIndex.x, hit.blockIndex.y, hit.blockIndex.z);
+                BlockType removedBlockType = GetBlockAtPosition(scene.area, hit.chunkIndex, hit.blockIndex);
 
                 PlaceBlockAtPosition(scene.area, hit.chunkIndex, hit.blockIndex, BlockType::NONE);
 
@@ -219,7 +264,7 @@ void OnUpdate(Application& app)
             RayHitResult hit;
             if (RayIntersectionWithBlock(scene.area, scene.camera.position(), scene.camera.forward(), hit, scene.maxInteractDistance))
             {
-                const Vector3Int normal = GetHitNormal(scene.area, hit);
+                const Vector3Int normal = GetHitNormal(hit);
 
                 Vector3Int blockIndex = hit.blockIndex + normal;
                 Vector3Int chunkIndex = hit.chunkIndex;
@@ -235,8 +280,66 @@ void OnUpdate(Application& app)
         scene.updateTransparentBatch = cameraMoved || placedOrRemovedTransparentBlock;
     }
 
-    {   // Physics
-        // TODO: Add Physics
+    // Paths requested this frame are searched while the rest of the frame runs
+    UpdatePathfinding(scene.area);
+
+    {   // Block ticks (and water) run at a fixed rate separate from rendering
+        if (UpdateBlockTicks(scene.area, app.deltaTime))
+            scene.updateTransparentBatch = true;
+    }
+
+    {   // Physics runs at a fixed rate, the camera is put between the last two steps
+        PhysicsBody& player = scene.player;
+
+        scene.physicsTimeAccumulator = Min(scene.physicsTimeAccumulator + app.deltaTime, 5.0f * PHYSICS_TIME_STEP);
+
+        while (scene.physicsTimeAccumulator >= PHYSICS_TIME_STEP)
+        {
+            if (!scene.flying)
+            {
+                Vector3 forward = scene.camera.forward();
+                forward.y = 0.0f;
+                forward = (forward.SqrLength() > 0.0f) ? forward.Normalized() : Vector3(0.0f);
+
+                Vector3 right = scene.camera.right();
+                right.y = 0.0f;
+                right = (right.SqrLength() > 0.0f) ? right.Normalized() : Vector3(0.0f);
+
+                const f32 forwardInput = (f32) Input::GetKey(Key::W) - (f32) Input::GetKey(Key::S);
+                const f32 rightInput   = (f32) Input::GetKey(Key::D) - (f32) Input::GetKey(Key::A);
+
+                Vector3 walk = forward * forwardInput + right * rightInput;
+                if (walk.SqrLength() > 0.0f)
+                    walk = walk.Normalized() * scene.playerWalkSpeed;
+
+                player.velocity.x = walk.x;
+                player.velocity.z = walk.z;
+
+                if (player.onGround && Input::GetKey(Key::SPACE))
+                    player.velocity.y = scene.playerJumpSpeed;
+
+                StepPhysicsBody(scene.area, player);
+            }
+
+            IntegrateEntityVelocities(scene.entities, PHYSICS_TIME_STEP);
+            scene.entityHash.Build(scene.entities);
+
+            scene.physicsTimeAccumulator -= PHYSICS_TIME_STEP;
+        }
+
+        if (!scene.flying)
+        {
+            const f32 alpha = scene.physicsTimeAccumulator / PHYSICS_TIME_STEP;
+            const Vector3 position = player.previousPosition + (player.position - player.previousPosition) * alpha;
+            const Vector3 eyePosition = position + Vector3(0.0f, scene.playerEyeHeight, 0.0f);
+
+            if (eyePosition != scene.camera.position())
+            {
+                scene.camera.position() = eyePosition;
+                scene.camera.UpdateViewMatrix();
+                scene.updateTransparentBatch = true;
+            }
+        }
     }
 }
 
@@ -249,10 +352,31 @@ void OnRender(Application& app)
     // Render Skybox
     R3D::RenderSkybox(scene.skybox);
 
+    // Render entity meshes
+    for (u32 i = 0; i < ENTITY_ARCHETYPE_COUNT; i++)
+    {
+        const EntityArchetype& archetype = scene.entities.archetypes[i];
+        if (!archetype.positions || !archetype.meshes)
+            continue;
+
+        for (u32 row = 0; row < archetype.count; row++)
+        {
+            if (!archetype.meshes[row])
+                continue;
+
+            Transform transform(archetype.positions[row]);
+            R3D::RenderMesh(*archetype.meshes[row], transform);
+        }
+    }
+
     R3D::End();
     
     ChunkRenderer::Begin(scene.camera, scene.currentTexture);
 
+    scene.debugStats.trianglesRendered = 0;
+    scene.debugStats.batches = 0;
+
+    ChunkRenderer::RenderFarTerrain(scene.farTerrain, scene.voxelShader, scene.debugStats, scene.debugSettings);
     ChunkRenderer::RenderChunkArea(scene.area, scene.voxelShader, scene.debugStats, scene.debugSettings, scene.updateTransparentBatch);
 
     ChunkRenderer::End();
@@ -298,7 +422,7 @@ void OnWindowResize(Application& app)
 {
     SceneData& scene = *(SceneData*) app.data;
     const f32 aspectRatio = (f32) app.window.width / (f32) app.window.height;
-    scene.camera.SetProjection(Matrix4::Perspective(45, aspectRatio, 0.1f, 1000.0f));
+    scene.camera.SetProjection(Matrix4::Perspective(45, aspectRatio, 0.1f, 2000.0f));
 }
 
 void OnShutdown(Application& app)
@@ -306,6 +430,10 @@ void OnShutdown(Application& app)
     SceneData& scene = *(SceneData*) app.data;
 
     scene.area.Free();
+    scene.farTerrain.Free();
+    scene.worldGen.Free();
+    scene.entities.Free();
+    scene.entityHash.Free();
     
     PlatformFree(app.data);     // Not really necessary
 }
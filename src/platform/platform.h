@@ -29,6 +29,56 @@ bool PlatformCompareMemory(const void* ptr1, const void* ptr2, u64 size);
 // In Seconds
 f64 PlatformGetTime();
 
+// File Stuff
+
+struct PlatformMappedFile
+{
+    const void* data;
+    u64 size;
+
+    void* fileHandle;
+    void* mappingHandle;
+};
+
+// Maps a whole file read only, fails for files that don't exist or are empty
+bool PlatformMapFile(PlatformMappedFile& file, const char* filepath);
+void PlatformUnmapFile(PlatformMappedFile& file);
+
+// Last time the file was written to, only meant to be compared with other write times
+bool PlatformGetFileWriteTime(const char* filepath, u64& time);
+
+// CPU Features
+
+// True if the CPU has AVX2 and the OS saves the AVX registers
+bool PlatformCpuSupportsAVX2();
+
+// Threading Stuff
+
+struct PlatformThread    { void* handle; };
+struct PlatformMutex     { void* handle; };
+struct PlatformSemaphore { void* handle; };
+
+using PlatformThreadFunction = void (*)(void* data);
+
+bool PlatformThreadCreate(PlatformThread& thread, PlatformThreadFunction function, void* data);
+void PlatformThreadJoin(PlatformThread& thread);
+u32  PlatformGetProcessorCount();
+void PlatformThreadYield();
+
+void PlatformMutexCreate(PlatformMutex& mutex);
+void PlatformMutexDestroy(PlatformMutex& mutex);
+void PlatformMutexLock(PlatformMutex& mutex);
+void PlatformMutexUnlock(PlatformMutex& mutex);
+
+void PlatformSemaphoreCreate(PlatformSemaphore& semaphore, u32 maxCount);
+void PlatformSemaphoreDestroy(PlatformSemaphore& semaphore);
+void PlatformSemaphoreSignal(PlatformSemaphore& semaphore, u32 count = 1);
+void PlatformSemaphoreWait(PlatformSemaphore& semaphore);
+
+// Return the new value
+s32 PlatformAtomicIncrement(volatile s32* value);
+s32 PlatformAtomicDecrement(volatile s32* value);
+
 // Input Things
 void PlatformGetMousePosition(s32& x, s32& y);
 void PlatformSetMousePosition(s32 x, s32 y);
@@ -13,6 +13,7 @@
 #include <windows.h>
 #include <windowsx.h>   // For param input extraction
 #include <psapi.h>      // For memory usage data
+#include <intrin.h>     // For cpuid
 
 // Clock Stuff
 static f64 clockFrequency;
@@ -185,6 +186,197 @@ f64 PlatformGetTime()
     return (f64) (nowTime.QuadPart - startTime.QuadPart) * clockFrequency; 
 }
 
+bool PlatformMapFile(PlatformMappedFile& file, const char* filepath)
+{
+    file = {};
+
+    HANDLE fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    file.data = data;
+    file.size = size.QuadPart;
+    file.fileHandle = fileHandle;
+    file.mappingHandle = mappingHandle;
+
+    return true;
+}
+
+void PlatformUnmapFile(PlatformMappedFile& file)
+{
+    if (file.data)
+        UnmapViewOfFile(file.data);
+
+    if (file.mappingHandle)
+        CloseHandle((HANDLE) file.mappingHandle);
+
+    if (file.fileHandle)
+        CloseHandle((HANDLE) file.fileHandle);
+
+    file = {};
+}
+
+bool PlatformGetFileWriteTime(const char* filepath, u64& time)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filepath, GetFileExInfoStandard, &attributes))
+        return false;
+
+    time = ((u64) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+static bool Win32DetectAVX2()
+{
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+
+    // AVX and OSXSAVE, then check the OS saves the XMM and YMM registers
+    __cpuid(regs, 1);
+    if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0)
+        return false;
+
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+}
+
+bool PlatformCpuSupportsAVX2()
+{
+    static const bool supported = Win32DetectAVX2();
+    return supported;
+}
+
+struct Win32ThreadStart
+{
+    PlatformThreadFunction function;
+    void* data;
+};
+
+static DWORD WINAPI Win32ThreadProc(LPVOID param)
+{
+    Win32ThreadStart start = *(Win32ThreadStart*) param;
+    PlatformFree(param);
+
+    start.function(start.data);
+    return 0;
+}
+
+bool PlatformThreadCreate(PlatformThread& thread, PlatformThreadFunction function, void* data)
+{
+    // Freed by the thread once it has started
+    Win32ThreadStart* start = (Win32ThreadStart*) PlatformAllocate(sizeof(Win32ThreadStart));
+    start->function = function;
+    start->data = data;
+
+    thread.handle = CreateThread(0, 0, Win32ThreadProc, start, 0, 0);
+    if (!thread.handle)
+    {
+        PlatformFree(start);
+        return false;
+    }
+
+    return true;
+}
+
+void PlatformThreadJoin(PlatformThread& thread)
+{
+    WaitForSingleObject((HANDLE) thread.handle, INFINITE);
+    CloseHandle((HANDLE) thread.handle);
+    thread.handle = nullptr;
+}
+
+u32 PlatformGetProcessorCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (u32) info.dwNumberOfProcessors;
+}
+
+void PlatformThreadYield()
+{
+    SwitchToThread();
+}
+
+// SRWLOCK is the size of a pointer so it's stored directly in the handle
+void PlatformMutexCreate(PlatformMutex& mutex)
+{
+    InitializeSRWLock((PSRWLOCK) &mutex.handle);
+}
+
+void PlatformMutexDestroy(PlatformMutex& mutex)
+{
+    // SRW locks don't need to be destroyed
+    mutex.handle = nullptr;
+}
+
+void PlatformMutexLock(PlatformMutex& mutex)
+{
+    AcquireSRWLockExclusive((PSRWLOCK) &mutex.handle);
+}
+
+void PlatformMutexUnlock(PlatformMutex& mutex)
+{
+    ReleaseSRWLockExclusive((PSRWLOCK) &mutex.handle);
+}
+
+void PlatformSemaphoreCreate(PlatformSemaphore& semaphore, u32 maxCount)
+{
+    semaphore.handle = CreateSemaphoreA(0, 0, (LONG) maxCount, 0);
+}
+
+void PlatformSemaphoreDestroy(PlatformSemaphore& semaphore)
+{
+    CloseHandle((HANDLE) semaphore.handle);
+    semaphore.handle = nullptr;
+}
+
+void PlatformSemaphoreSignal(PlatformSemaphore& semaphore, u32 count)
+{
+    ReleaseSemaphore((HANDLE) semaphore.handle, (LONG) count, 0);
+}
+
+void PlatformSemaphoreWait(PlatformSemaphore& semaphore)
+{
+    WaitForSingleObject((HANDLE) semaphore.handle, INFINITE);
+}
+
+s32 PlatformAtomicIncrement(volatile s32* value)
+{
+    return (s32) InterlockedIncrement((volatile LONG*) value);
+}
+
+s32 PlatformAtomicDecrement(volatile s32* value)
+{
+    return (s32) InterlockedDecrement((volatile LONG*) value);
+}
+
 #ifdef GN_DEBUG
 u64 PlatformGetMemoryAllocated()
 {
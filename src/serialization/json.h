@@ -1,4 +1,6 @@
 #pragma once
 
 #include "json/document.h"
-#include "json/parser.h"
\ No newline at end of file
+#include "json/parser.h"
+#include "json/reader.h"
+#include "json/writer.h"
\ No newline at end of file
@@ -1,34 +1,92 @@
 #include "document.h"
 
+#include "math/common.h"
+
 namespace json
 {
 
+void Document::Reset(u64 capacity)
+{
+    capacity = Max(capacity, (u64) sizeof(Node));
+
+    if (arenaCapacity < capacity)
+    {
+        arena = (u8*) PlatformReallocate(arena, capacity);
+        arenaCapacity = capacity;
+    }
+
+    arenaSize = 0;
+    root = 0;
+
+    // This is the null element
+    // If user tries to access an object property that wasn't in the file,
+    // then the value will point to this element
+    Node& null = NodeAt(Allocate(sizeof(Node)));
+    null = {};
+    null.type = NodeType::NONE;
+}
+
+void Document::Free()
+{
+    PlatformFree(arena);
+
+    arena = nullptr;
+    arenaSize = 0;
+    arenaCapacity = 0;
+    root = 0;
+}
+
+u64 Document::Allocate(u64 size)
+{
+    size = (size + 7) & ~(u64) 7;
+
+    if (arenaSize + size > arenaCapacity)
+    {
+        u64 capacity = Max(arenaSize + size, arenaCapacity + arenaCapacity / 2);
+        arena = (u8*) PlatformReallocate(arena, capacity);
+        arenaCapacity = capacity;
+    }
+
+    u64 offset = arenaSize;
+    arenaSize += size;
+
+    return offset;
+}
+
 Value Document::Start() const
 {
-    return Value(*this, 1);
+    AssertWithMessage(arena != nullptr, "Document was never parsed!");
+    return Value(*this, root);
 }
 
 Value Array::operator[](size_t index) const
 {
-    auto& node = _document.dependencyTree[_treeIndex];
-    return Value(_document, node._array[index]);
+    auto& node = _document.NodeAt(_nodeOffset);
+    AssertWithMessage(index < node.count, "Array index out of range!");
+
+    return Value(_document, node._offset + index * sizeof(Node));
 }
 
 Value Array::iterator::operator*() const
 {
-    return Value(_array->_document, *_arrayIt);
+    return Value(_array->_document, _elementOffset);
 }
 
-Value Object::operator[](const String& key) const
+Value Object::operator[](StringView key) const
 {
-    auto& node = _document.dependencyTree[_treeIndex];
-    auto val = node._object.Find(key);
+    auto& node = _document.NodeAt(_nodeOffset);
 
-    // Return null value if key is not found
-    if (val == node._object.end())
-        return Value(_document, 0);
+    // Searched from the back so the last one wins if a key shows up more than once
+    for (u64 pair = node.count; pair > 0; pair--)
+    {
+        const u64 keyOffset = node._offset + (pair - 1) * 2 * sizeof(Node);
 
-    return Value(_document, (*val).value);
+        if (_document.StringOf(_document.NodeAt(keyOffset)) == key)
+            return Value(_document, keyOffset + sizeof(Node));
+    }
+
+    // Return null value if key is not found
+    return Value(_document, 0);
 }
 
 } // namespace json
\ No newline at end of file
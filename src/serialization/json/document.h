@@ -1,172 +1,147 @@
 #pragma once
 
 #include "core/types.h"
+#include "core/logging.h"
 #include "containers/stringview.h"
-#include "containers/darray.h"
-#include "containers/hashtable.h"
 #include "platform/platform.h"
 
+/*
+
+A parsed document lives in a single arena.
+
+Every value is a 16 byte Node. The children of arrays are stored next to
+each other in the arena, objects are the same but every value is preceded
+by the node of its key. Freeing a document is a single release of the arena.
+
+Strings without escape characters point straight into the parsed source
+instead of being copied, so the source must outlive the document. Strings
+that had escapes are written unescaped into the arena.
+
+The arena grows while parsing and can move, so nodes are referred to by
+their offset in the arena instead of pointers. The node at offset 0 is the
+null value, it's what missing keys resolve to.
+
+*/
+
 namespace json
 {
 
-using ResourceIndex = u64;
-using ArrayNode = DynamicArray<ResourceIndex>;
-using ObjectNode = HashTable<String, ResourceIndex>;
-
-struct Resource
+enum class NodeType : u8
 {
-    enum class Type
-    {
-        NONE,
-        BOOLEAN,
-        INTEGER,
-        FLOAT,
-        STRING
-    };
+    NONE,
+    BOOLEAN,
+    INTEGER,
+    FLOAT,
+    STRING,
+    ARRAY,
+    OBJECT
+};
 
-    Type type;
+struct Node
+{
+    NodeType type;
+    bool inArena;               // Strings only, set if the characters were unescaped into the arena
+    u32 count;                  // Characters of a string, elements of an array or key value pairs of an object
 
     union
     {
-        bool   _boolean;
-        s64    _integer;
-        f64    _float;
-        String _string;
+        bool        _boolean;
+        s64         _integer;
+        f64         _float;
+        const char* _chars;     // Strings pointing into the source
+        u64         _offset;    // Strings in the arena and the first child of arrays and objects
     };
+};
 
-    Resource()
-    :   type(Type::NONE)
-    {
-    }
+static_assert(sizeof(Node) == 16, "JSON nodes are expected to be 16 bytes!");
 
-    Resource(bool _boolean)
-    :   type(Type::BOOLEAN)
-    ,   _boolean(_boolean)
-    {
-    }
+struct Value;
 
-    Resource(s64 _integer)
-    :   type(Type::INTEGER)
-    ,   _integer(_integer)
-    {
-    }
+struct Document
+{
+    u8* arena = nullptr;
+    u64 arenaSize = 0;
+    u64 arenaCapacity = 0;
 
-    Resource(f64 _float)
-    :   type(Type::FLOAT)
-    ,   _float(_float)
-    {
-    }
+    u64 root = 0;               // Offset of the top level value, the null node until something is parsed
 
-    Resource(String&& _string)
-    :   type(Type::STRING)
-    ,   _string(std::move(_string))
-    {
-    }
+    Document() = default;
+    Document(const Document& other) = delete;
 
-    ~Resource()
+    ~Document()
     {
-        if (type == Type::STRING)
-            _string.~String();
+        Free();
     }
-};
 
-struct DependencyNode
-{
-    enum class Type
-    {
-        DIRECT,
-        ARRAY,
-        OBJECT
-    };
+    // Drops all values and makes sure the arena can hold at least capacity bytes without growing
+    void Reset(u64 capacity);
+    void Free();
 
-    Type type;
+    // Returns the offset of size bytes in the arena, aligned to 8 bytes.
+    // The arena can move, so pointers into it are invalid after this.
+    u64 Allocate(u64 size);
 
-    union
+    inline Node& NodeAt(u64 offset)
     {
-        ResourceIndex _index;
-        ArrayNode     _array;
-        ObjectNode    _object;
-    };
+        return *(Node*) (arena + offset);
+    }
 
-    DependencyNode(Type type)
-    :   type(type)
+    inline const Node& NodeAt(u64 offset) const
     {
-        switch (type)
-        {
-            case Type::ARRAY:
-                _array.ManualInit();
-                break;
-            
-            case Type::OBJECT:
-                _object.ManualInit();
-                break;
-        }
+        return *(const Node*) (arena + offset);
     }
 
-    ~DependencyNode()
+    inline StringView StringOf(const Node& node) const
     {
-        switch (type)
-        {
-            case Type::ARRAY:
-                _array.~DynamicArray();
-                break;
-            
-            case Type::OBJECT:
-                _object.~HashTable();
-                break;
-        }
-    }
-};
+        AssertWithMessage(node.type == NodeType::STRING, "Value is not a string!");
 
-struct Value;
+        if (node.inArena)
+            return StringView((const char*) (arena + node._offset), node.count);
 
-struct Document
-{
-    DynamicArray<DependencyNode> dependencyTree;
-    DynamicArray<Resource> resources;
+        return StringView(node._chars, node.count);
+    }
 
     Value Start() const;
 };
 
-
 struct Array
 {
     const Document& _document;
-    size_t _treeIndex;
+    u64 _nodeOffset;
 
-    Array(const Document& document, size_t index)
-    :   _document(document), _treeIndex(index)
+    Array(const Document& document, u64 offset)
+    :   _document(document), _nodeOffset(offset)
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::ARRAY, "Value is not an array!");
+        auto& node = _document.NodeAt(_nodeOffset);
+        AssertWithMessage(node.type == NodeType::ARRAY, "Value is not an array!");
     }
 
     Value operator[](size_t index) const;
 
     size_t size() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        return node._array.size();
+        auto& node = _document.NodeAt(_nodeOffset);
+        return node.count;
     }
 
     struct iterator
     {
         const Array* _array;
-        ArrayNode::iterator _arrayIt;
+        u64 _elementOffset;
 
-        iterator(const Array* _array, ArrayNode::iterator _arrayIt)
-        :   _array(_array), _arrayIt(_arrayIt) {}
+        iterator(const Array* _array, u64 _elementOffset)
+        :   _array(_array), _elementOffset(_elementOffset) {}
 
         iterator& operator++(int)
         {
-            _arrayIt++;
+            _elementOffset += sizeof(Node);
             return *this;
         }
-        
+
         iterator operator++()
         {
             iterator it = *this;
-            _arrayIt++;
+            _elementOffset += sizeof(Node);
             return it;
         }
 
@@ -175,147 +150,117 @@ struct Array
         bool operator==(const iterator& other) const
         {
             return _array == other._array &&
-                   _arrayIt == other._arrayIt;
+                   _elementOffset == other._elementOffset;
         }
 
         bool operator!=(const iterator& other) const
         {
             return _array != other._array ||
-                   _arrayIt != other._arrayIt;
+                   _elementOffset != other._elementOffset;
         }
     };
 
     iterator begin() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        return iterator(this, node._array.begin());
+        auto& node = _document.NodeAt(_nodeOffset);
+        return iterator(this, node._offset);
     }
 
     iterator end() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        return iterator(this, node._array.end());
+        auto& node = _document.NodeAt(_nodeOffset);
+        return iterator(this, node._offset + node.count * sizeof(Node));
     }
 };
 
 struct Object
 {
     const Document& _document;
-    size_t _treeIndex;
+    u64 _nodeOffset;
+
+    Object(const Document& document, u64 offset)
+    :   _document(document), _nodeOffset(offset)
+    {
+        auto& node = _document.NodeAt(_nodeOffset);
+        AssertWithMessage(node.type == NodeType::OBJECT, "Value is not an object!");
+    }
 
-    Object(const Document& document, size_t index)
-    :   _document(document), _treeIndex(index)
+    size_t size() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::OBJECT, "Value is not an object!");
+        auto& node = _document.NodeAt(_nodeOffset);
+        return node.count;
     }
 
     // Returns null if key isn't found
-    Value operator[](const String& key) const;
+    Value operator[](StringView key) const;
 };
 
 struct Value
 {
     const Document& _document;
-    size_t _treeIndex;
+    u64 _nodeOffset;
 
-    Value(const Document& document, size_t index)
-    :   _document(document), _treeIndex(index) {}
+    Value(const Document& document, u64 offset)
+    :   _document(document), _nodeOffset(offset) {}
 
     const int64_t int64() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::DIRECT, "Value is not an integer!");
+        auto& node = _document.NodeAt(_nodeOffset);
+        AssertWithMessage(node.type == NodeType::INTEGER, "Value is not an integer!");
 
-        auto& resource = _document.resources[node._index];
-        AssertWithMessage(resource.type == Resource::Type::INTEGER, "Value is not an integer!");
-
-        return resource._integer;
+        return node._integer;
     }
 
     const f64 float64() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::DIRECT, "Value is not a float!");
-
-        auto& resource = _document.resources[node._index];
-        AssertWithMessage(resource.type == Resource::Type::FLOAT || resource.type == Resource::Type::INTEGER, "Value is not a float!");
+        auto& node = _document.NodeAt(_nodeOffset);
+        AssertWithMessage(node.type == NodeType::FLOAT || node.type == NodeType::INTEGER, "Value is not a float!");
 
-        if (resource.type == Resource::Type::FLOAT)
-            return resource._float;
+        if (node.type == NodeType::FLOAT)
+            return node._float;
         else
-            return (f64) resource._integer;
+            return (f64) node._integer;
     }
 
     const bool boolean() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::DIRECT, "Value is not a bool!");
+        auto& node = _document.NodeAt(_nodeOffset);
+        AssertWithMessage(node.type == NodeType::BOOLEAN, "Value is not a bool!");
 
-        auto& resource = _document.resources[node._index];
-        AssertWithMessage(resource.type == Resource::Type::BOOLEAN, "Value is not a bool!");
-
-        return resource._boolean;
+        return node._boolean;
     }
 
-    const String& string() const
+    // Points into the source or the document, copy it to keep it around longer than either of them
+    StringView string() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::DIRECT, "Value is not a string!");
-
-        auto& resource = _document.resources[node._index];
-        AssertWithMessage(resource.type == Resource::Type::STRING, "Value is not a string!");
-
-        return resource._string;
+        return _document.StringOf(_document.NodeAt(_nodeOffset));
     }
 
     Array array() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::ARRAY, "Value is not an array!");
-
-        return Array(_document, _treeIndex);
+        return Array(_document, _nodeOffset);
     }
 
     Value operator[](size_t index) const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::ARRAY, "Value is not an array!");
-
-        return Value(_document, node._array[index]);
+        return Array(_document, _nodeOffset)[index];
     }
 
     Object object() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::OBJECT, "Value is not an object!");
-
-        return Object(_document, _treeIndex);
+        return Object(_document, _nodeOffset);
     }
-    
+
     // Returns null if key isn't found
-    Value operator[](const String& key) const
+    Value operator[](StringView key) const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        AssertWithMessage(node.type == DependencyNode::Type::OBJECT, "Value is not an object!");
-
-        auto val = node._object.Find(key);
-
-        // Return null value if key is not found
-        if (val == node._object.end())
-            return Value(_document, 0);
-
-        return Value(_document, (*val).value);
+        return Object(_document, _nodeOffset)[key];
     }
 
     bool IsNull() const
     {
-        auto& node = _document.dependencyTree[_treeIndex];
-        if (node.type != DependencyNode::Type::DIRECT)
-            return false;
-
-        auto& resource = _document.resources[node._index];
-        return resource.type == Resource::Type::NONE;
+        auto& node = _document.NodeAt(_nodeOffset);
+        return node.type == NodeType::NONE;
     }
 };
 
@@ -3,8 +3,6 @@
 constexpr char lexerErrorStrings[][64] = {
     "No Error Encountered",
     "String was never closed!",
-    "- sign can only be used at the start of the number!",
-    ". can only be used once in a number!",
 };
 
 constexpr char parserErrorStrings[][64] = {
@@ -20,4 +18,13 @@ constexpr char parserErrorStrings[][64] = {
     "Array was never closed with a ]",
     "End of file expected!",
     "Unexpected escape character!",
+    "- sign can only be used at the start of the number!",
+    ". can only be used once in a number!",
+    "Numbers can only have digits, a . and a leading - sign!",
+
+    // Only reported by the Reader
+    "String was never closed!",
+    "Value doesn't fit in the reader's buffer!",
+    "Arrays and objects are nested too deep!",
+    "File could not be opened!",
 };
\ No newline at end of file
@@ -4,131 +4,159 @@
 #include <iostream>
 #endif
 
+#include <emmintrin.h>
+#include <immintrin.h>
+
 #include "error_strings.h"
 #include "core/types.h"
+#include "core/compiler_utils.h"
+#include "core/logging.h"
+#include "core/utils.h"
 #include "containers/darray.h"
 #include "containers/stringview.h"
+#include "platform/platform.h"
 
 namespace json
 {
 
+constexpr u64 BLOCK_SIZE = 64;
+
+// Bit i of every mask is set if byte i of the block is one of those characters
+struct BlockMasks
+{
+    u64 quotes;
+    u64 backslashes;
+    u64 punctuation;
+    u64 whitespace;
+    u64 newlines;
+};
+
+using ClassifyBlockFunction = void (*)(const char* block, BlockMasks& masks);
+
 Lexer::Lexer(StringView content)
 :   content(content)
 {
 }
 
-inline static bool IsWhitespace(char ch)
+inline static u64 MatchSSE2(__m128i chars, char ch)
 {
-    return ch == ' '  ||
-           ch == '\t' ||
-           ch == '\r' ||
-           ch == '\n';
+    return (u64) (u16) _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(ch)));
 }
 
-inline static bool IsAlphabet(char ch)
+static void ClassifyBlockSSE2(const char* block, BlockMasks& masks)
 {
-    return ((ch >= 'a') && (ch <= 'z')) ||
-           ((ch >= 'A') && (ch <= 'Z'));
-}
+    masks = {};
 
-inline static bool IsDigit(char ch)
-{
-    return (ch >= '0') && (ch <= '9');
+    for (u64 i = 0; i < BLOCK_SIZE; i += 16)
+    {
+        const __m128i chars = _mm_loadu_si128((const __m128i*) (block + i));
+
+        // [ and { (and ] and }) only differ in the 6th bit
+        const __m128i brackets = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+
+        const u64 newlines = MatchSSE2(chars, '\n');
+
+        masks.quotes      |= MatchSSE2(chars, '\"') << i;
+        masks.backslashes |= MatchSSE2(chars, '\\') << i;
+        masks.newlines    |= newlines << i;
+
+        masks.punctuation |= (MatchSSE2(brackets, '{') |
+                              MatchSSE2(brackets, '}') |
+                              MatchSSE2(chars, ':')    |
+                              MatchSSE2(chars, ',')) << i;
+
+        masks.whitespace  |= (MatchSSE2(chars, ' ')  |
+                              MatchSSE2(chars, '\t') |
+                              MatchSSE2(chars, '\r') |
+                              newlines) << i;
+    }
 }
 
-inline static void EatSpaces(Lexer& lexer)
+GN_TARGET_AVX2 inline static u64 MatchAVX2(__m256i chars, char ch)
 {
-    while (lexer.currentIndex < lexer.content.size() && IsWhitespace(lexer.content[lexer.currentIndex]))
-    {
-        lexer.currentLine = (lexer.content[lexer.currentIndex] == '\n');
-        lexer.currentIndex++;
-    }
+    return (u64) (u32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(ch)));
 }
 
-static inline StringView GetStringToken(Lexer& lexer, StringView& contentView)
+GN_TARGET_AVX2 static void ClassifyBlockAVX2(const char* block, BlockMasks& masks)
 {
-    // Skip the 1st '"'
-    if (contentView[lexer.currentIndex] == '\"')
-        lexer.currentIndex++;
-    
-    u64 start = lexer.currentIndex;
-    while (contentView[lexer.currentIndex] != '\"')
+    masks = {};
+
+    for (u64 i = 0; i < BLOCK_SIZE; i += 32)
     {
-        if (contentView[lexer.currentIndex] == '\n' ||
-            contentView[lexer.currentIndex] == '\0')
-        {
-            lexer.errorLineNumber = lexer.currentLine;
-            lexer.errorCode = 1;
-            break;
-        }
+        const __m256i chars = _mm256_loadu_si256((const __m256i*) (block + i));
+        const __m256i brackets = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
 
-        lexer.currentIndex += (contentView[lexer.currentIndex] == '\\');
-        lexer.currentIndex++;
-    }
+        const u64 newlines = MatchAVX2(chars, '\n');
+
+        masks.quotes      |= MatchAVX2(chars, '\"') << i;
+        masks.backslashes |= MatchAVX2(chars, '\\') << i;
+        masks.newlines    |= newlines << i;
+
+        masks.punctuation |= (MatchAVX2(brackets, '{') |
+                              MatchAVX2(brackets, '}') |
+                              MatchAVX2(chars, ':')    |
+                              MatchAVX2(chars, ',')) << i;
 
-    // Skip the 2nd '"'
-    lexer.currentIndex++;
+        masks.whitespace  |= (MatchAVX2(chars, ' ')  |
+                              MatchAVX2(chars, '\t') |
+                              MatchAVX2(chars, '\r') |
+                              newlines) << i;
+    }
 
-    return contentView.SubString(start, lexer.currentIndex - start - 1);
+    // Avoids the penalty of switching back to the legacy SSE encoding
+    _mm256_zeroupper();
 }
 
-static inline StringView GetNumberToken(Lexer& lexer, const StringView& contentView, Token::Type& type)
+static ClassifyBlockFunction PickClassifyBlockFunction()
 {
-    bool isNegative = (contentView[lexer.currentIndex] == '-');
-    bool dotEncountered = false;
-
-    u64 start = lexer.currentIndex;
+    return (PlatformCpuSupportsAVX2()) ? ClassifyBlockAVX2 : ClassifyBlockSSE2;
+}
 
-    lexer.currentIndex += isNegative;
+// Characters that come right after a backslash that isn't escaped itself.
+// Backslashes are rare so they're walked one by one. carry is set when the
+// previous block ended in a backslash that escapes the first character of this one.
+inline static u64 FindEscaped(u64 backslashes, u64& carry)
+{
+    u64 escaped = carry;
+    carry = 0;
 
-    // Also checking for - in between a number for error checking
-    while (IsDigit(contentView[lexer.currentIndex]) ||
-           contentView[lexer.currentIndex] == '.'   ||
-           contentView[lexer.currentIndex] == '-')
+    while (backslashes)
     {
-        if (contentView[lexer.currentIndex] == '-')
-        {
-            lexer.errorLineNumber = lexer.currentLine;
-            lexer.errorCode = 2;
-            break;
-        }
+        const u32 index = LowestSetBitIndex64(backslashes);
+        backslashes &= backslashes - 1;
 
-        if (contentView[lexer.currentIndex] == '.')
-        {
-            if (dotEncountered)
-            {
-                lexer.errorLineNumber = lexer.currentLine;
-                lexer.errorCode = 3;
-                break;
-            }
-
-            dotEncountered = true;
-        }
-        lexer.currentIndex++;
-    }
+        if (escaped & (1ULL << index))
+            continue;
 
-    type = (dotEncountered) ? Token::Type::FLOAT : Token::Type::INTEGER;
+        if (index == BLOCK_SIZE - 1)
+            carry = 1;
+        else
+            escaped |= 1ULL << (index + 1);
+    }
 
-    return contentView.SubString(start, lexer.currentIndex - start);
+    return escaped;
 }
 
-static inline StringView GetIdentifierToken(Lexer& lexer, const StringView& contentView)
+// Every bit becomes the xor of itself and all bits below it, so the bits from an
+// opening quote up to (not including) its closing quote end up set
+inline static u64 PrefixXor(u64 mask)
 {
-    u64 start = lexer.currentIndex;
-
-    while (IsAlphabet(contentView[lexer.currentIndex]))
-        lexer.currentIndex++;
-
-    return contentView.SubString(start, lexer.currentIndex - start);
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+    return mask;
 }
 
 #ifdef GN_DEBUG
 static void DebugOutput(const Lexer& lexer)
 {
     std::cout << "LEXER OUTPUT\n";
-    for (auto token : lexer.tokens)
+    for (u32 offset : lexer.structurals)
     {
-        std::cout << token.value << '\n';
+        std::cout << offset << ": " << lexer.content[offset] << '\n';
     }
     std::cout << "\n";
 }
@@ -136,65 +164,64 @@ static void DebugOutput(const Lexer& lexer)
 
 void Lexer::Lex()
 {
-    currentIndex = 0;
-    currentLine  = 1;
-
     errorLineNumber = 0;
     errorCode = 0;
 
-    tokens.Clear();
-    tokens.Reserve(std::max((size_t) 2, content.size() / 3)); // Just an estimate
+    AssertWithMessage(content.size() < 0xFFFFFFFF, "JSON content is too large to be lexed!");
 
-    StringView view = content;
+    structurals.Clear();
+    structurals.Reserve(std::max((size_t) 2, content.size() / 3)); // Just an estimate
 
-    bool keepLexing = true;
-    while (keepLexing && errorCode == 0)
+    static const ClassifyBlockFunction classifyBlock = PickClassifyBlockFunction();
+
+    u64 escapeCarry = 0;
+    u64 inStringCarry = 0;      // All bits set when the previous block ended inside a string
+    u64 scalarCarry = 0;        // Set when the previous block ended in the middle of a number or identifier
+
+    for (u64 blockStart = 0; blockStart < content.size(); blockStart += BLOCK_SIZE)
     {
-        EatSpaces(*this);
+        BlockMasks masks;
+
+        if (blockStart + BLOCK_SIZE <= content.size())
+            classifyBlock(content.cstr() + blockStart, masks);
+        else
+        {   // The last block is padded with spaces so nothing is read past the content
+            char padded[BLOCK_SIZE];
+            PlatformSetMemory(padded, ' ', BLOCK_SIZE);
+            PlatformCopyMemory(padded, content.cstr() + blockStart, content.size() - blockStart);
+            classifyBlock(padded, masks);
+        }
 
-        if (currentIndex >= content.size())
-            break;
+        const u64 quotes = masks.quotes & ~FindEscaped(masks.backslashes, escapeCarry);
+        const u64 inString = PrefixXor(quotes) ^ inStringCarry;
+        inStringCarry = (u64) ((s64) inString >> 63);
 
-        switch (content[currentIndex])
+        const u64 newlinesInStrings = masks.newlines & inString;
+        if (newlinesInStrings)
         {
-            case '\0':
-            {
-                keepLexing = false;
-            } break;
-
-            // Punctuations
-            case (char) Token::Type::SQUARE_BRACKET_OPEN:
-            case (char) Token::Type::SQUARE_BRACKET_CLOSE:
-            case (char) Token::Type::CURLY_BRACKET_OPEN:
-            case (char) Token::Type::CURLY_BRACKET_CLOSE:
-            case (char) Token::Type::COLON:
-            case (char) Token::Type::COMMA:
-            {
-                auto type = (Token::Type) content[currentIndex];
-                tokens.EmplaceBack(type, currentLine, view.SubString(currentIndex, 1));
-                currentIndex++;
-            } break;
-
-            // Strings
-            case '\"':
-            {
-                tokens.EmplaceBack(Token::Type::STRING, currentLine, GetStringToken(*this, view));
-            } break;
-
-            default:
-            {
-                char startChar = content[currentIndex];
-                if (startChar == '-' || startChar == '.' || IsDigit(startChar))
-                {
-                    Token::Type type;
-                    StringView numView = GetNumberToken(*this, view, type);
-                    tokens.EmplaceBack(type, currentLine, std::move(numView));
-                }
-                else
-                    tokens.EmplaceBack(Token::Type::IDENTIFIER, currentLine, GetIdentifierToken(*this, view));
-
-            } break;
+            errorLineNumber = LineNumberAt(content, blockStart + LowestSetBitIndex64(newlinesInStrings));
+            errorCode = 1;
+            return;
         }
+
+        // Numbers and identifiers are anything else outside strings, only their first character is a structural
+        const u64 scalars = ~(masks.punctuation | masks.whitespace | quotes | inString);
+        const u64 scalarStarts = scalars & ~((scalars << 1) | scalarCarry);
+        scalarCarry = scalars >> 63;
+
+        u64 starts = (masks.punctuation & ~inString) | quotes | scalarStarts;
+        while (starts)
+        {
+            structurals.PushBack((u32) (blockStart + LowestSetBitIndex64(starts)));
+            starts &= starts - 1;
+        }
+    }
+
+    if (inStringCarry)
+    {
+        // Nothing inside a string is a structural, so the last one is the opening quote
+        errorLineNumber = LineNumberAt(content, structurals[structurals.size() - 1]);
+        errorCode = 1;
     }
 
 #   ifdef GN_DEBUG
@@ -208,4 +235,14 @@ const char* Lexer::GetErrorMessage() const
     return lexerErrorStrings[errorCode];
 }
 
+u64 LineNumberAt(StringView content, u64 offset)
+{
+    u64 line = 1;
+
+    for (u64 i = 0; i < offset && i < content.size(); i++)
+        line += (content[i] == '\n');
+
+    return line;
+}
+
 } // namespace json
\ No newline at end of file
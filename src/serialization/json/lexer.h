@@ -4,6 +4,23 @@
 #include "containers/darray.h"
 #include "containers/stringview.h"
 
+/*
+
+JSON is parsed in two stages.
+
+The lexer is stage 1. It classifies the input 64 bytes at a time with SSE2
+(or AVX2 when the CPU has it) into bit masks of quotes, backslashes,
+punctuation and whitespace. Escaped quotes are removed, a prefix xor of the
+quotes marks what's inside strings, and the positions of everything that
+starts a token end up in the structural index: punctuation outside strings,
+both quotes of every string and the first character of every number and
+identifier.
+
+The parser is stage 2. It walks the structural index and builds the
+Document, only reading the characters of the tokens themselves.
+
+*/
+
 namespace json
 {
 
@@ -31,11 +48,11 @@ struct Token
     };
 
     Type type = Type::NONE ;
-    u64 lineNumber;
+    u64 offset;                                 // Offset of the token in the content, line numbers are worked out from it on errors
     StringView value;
 
-    Token(Type type, u64 lineNumber, StringView& value)
-    :   type(type), lineNumber(lineNumber), value(value)
+    Token(Type type, u64 offset, StringView value)
+    :   type(type), offset(offset), value(value)
     {
     }
 };
@@ -43,10 +60,7 @@ struct Token
 struct Lexer
 {
     StringView content;
-    DynamicArray<Token> tokens;
-
-    u64 currentIndex;
-    u64 currentLine;
+    DynamicArray<u32> structurals;              // Offsets of where tokens start, strings have their closing quote too
 
     u64 errorLineNumber;
     s32 errorCode;
@@ -58,4 +72,7 @@ struct Lexer
     const char* GetErrorMessage() const;
 };
 
+// Line (starting at 1) of an offset in the content
+u64 LineNumberAt(StringView content, u64 offset);
+
 } // namespace json
\ No newline at end of file
@@ -7,326 +7,381 @@
 #include "error_strings.h"
 #include "document.h"
 #include "lexer.h"
+#include "scalars.h"
+
+#include <cstring>
 
 namespace json
 {
 
 #ifdef GN_DEBUG
 
-static u64 PrintNodeInfo(const Document& document, ResourceIndex nodeIndex)
+static void PrintNodeInfo(const Document& document, u64 offset)
 {
-    auto& node = document.dependencyTree[nodeIndex];
-
-    u64 offset = 1;
+    auto& node = document.NodeAt(offset);
 
     switch (node.type)
     {
-        case DependencyNode::Type::DIRECT:
-        {
-            auto& resource = document.resources[node._index];
-            switch (resource.type)
-            {
-                case Resource::Type::STRING:
-                std::cout << resource._string << '\n';
-                break;
+        case NodeType::STRING:
+        std::cout << document.StringOf(node) << '\n';
+        break;
 
-                case Resource::Type::INTEGER:
-                std::cout << resource._integer << '\n';
-                break;
+        case NodeType::INTEGER:
+        std::cout << node._integer << '\n';
+        break;
 
-                case Resource::Type::FLOAT:
-                std::cout << resource._float << '\n';
-                break;
-                
-                case Resource::Type::BOOLEAN:
-                std::cout << resource._boolean << '\n';
-                break;
+        case NodeType::FLOAT:
+        std::cout << node._float << '\n';
+        break;
+        
+        case NodeType::BOOLEAN:
+        std::cout << node._boolean << '\n';
+        break;
 
-                case Resource::Type::NONE:
-                std::cout << "null\n";
-                break;
-            }
-        } break;
+        case NodeType::NONE:
+        std::cout << "null\n";
+        break;
 
-        case DependencyNode::Type::ARRAY:
+        case NodeType::ARRAY:
         {
             std::cout << "::Array Start::\n";
             
-            for (size_t index : node._array)
-                offset += PrintNodeInfo(document, index);
+            for (u64 i = 0; i < node.count; i++)
+                PrintNodeInfo(document, node._offset + i * sizeof(Node));
 
             std::cout << "::Array End::\n";
         } break;
 
-        case DependencyNode::Type::OBJECT:
+        case NodeType::OBJECT:
         {
             std::cout << "::Object Start::\n";
             
-            for (auto& pair : node._object)
+            for (u64 i = 0; i < node.count; i++)
             {
-                std::cout << pair.key << ":\n";
-                offset += PrintNodeInfo(document, pair.value);
+                const u64 keyOffset = node._offset + i * 2 * sizeof(Node);
+
+                std::cout << document.StringOf(document.NodeAt(keyOffset)) << ":\n";
+                PrintNodeInfo(document, keyOffset + sizeof(Node));
             }
 
             std::cout << "::Object End::\n";
         } break;
     }
-
-    return offset;
 }
 
 static void DebugOutput(const Document& document)
 {
     std::cout << "PARSER OUTPUT" << std::endl;
-
-    for (size_t index = 1; index < document.dependencyTree.size(); index++)
-    {
-        index += PrintNodeInfo(document, index);
-    }
+    PrintNodeInfo(document, document.root);
 }
 
 #endif
 
-static String EscapeToken(Parser& parser, const Token& token)
+inline static char StructuralAt(const Lexer& lexer, u64 index)
+{
+    return lexer.content[lexer.structurals[index]];
+}
+
+// Line of the structural at index, errors past the end use the last structural
+static s32 ErrorLineAt(const Lexer& lexer, u64 index)
 {
-    String escaped(token.value.size());
+    if (lexer.structurals.size() == 0)
+        return 1;
 
-    auto& view = token.value;
+    if (index >= lexer.structurals.size())
+        index = lexer.structurals.size() - 1;
 
-    for (size_t i = 0; i < view.size() && parser.errorCode == 0; i++)
+    return (s32) LineNumberAt(lexer.content, lexer.structurals[index]);
+}
+
+static Token::Type GetNumberType(Parser& parser, const Lexer& lexer, const StringView& value, u64 offset)
+{
+    const Token::Type type = GetNumberType(value, parser.errorCode);
+
+    if (parser.errorCode != 0)
+        parser.errorLineNumber = (s32) LineNumberAt(lexer.content, offset);
+
+    return type;
+}
+
+// Reads the token at the current structural. For strings the current structural moves to the closing quote.
+static Token ReadToken(Parser& parser, const Lexer& lexer)
+{
+    const u64 start = lexer.structurals[parser.currentTokenIndex];
+    const char startChar = lexer.content[start];
+
+    switch (startChar)
     {
-        if (view[i] == '\\')
+        // Punctuations
+        case (char) Token::Type::SQUARE_BRACKET_OPEN:
+        case (char) Token::Type::SQUARE_BRACKET_CLOSE:
+        case (char) Token::Type::CURLY_BRACKET_OPEN:
+        case (char) Token::Type::CURLY_BRACKET_CLOSE:
+        case (char) Token::Type::COLON:
+        case (char) Token::Type::COMMA:
+            return Token((Token::Type) startChar, start, lexer.content.SubString(start, 1));
+
+        // Strings, the lexer made sure the closing quote is the next structural
+        case '\"':
         {
-            i++;
-            switch (view[i])
-            {
-                case 'b' : escaped.PushBack('\b'); break;
-                case 'f' : escaped.PushBack('\f'); break;
-                case 'n' : escaped.PushBack('\n'); break;
-                case 'r' : escaped.PushBack('\r'); break;
-                case 't' : escaped.PushBack('\t'); break;
-                case '\"': escaped.PushBack('\"'); break;
-                case '\\': escaped.PushBack('\\'); break;
-                default:
-                {
-                    parser.errorCode = 11;
-                    parser.errorLineNumber = token.lineNumber;
-                } break;
-            }
-
-            continue;
+            parser.currentTokenIndex++;
+            const u64 end = lexer.structurals[parser.currentTokenIndex];
+            return Token(Token::Type::STRING, start, lexer.content.SubString(start + 1, end - start - 1));
         }
-        
-        escaped.PushBack(view[i]);
     }
 
-    return std::move(escaped);
+    u64 end = start + 1;
+    while (end < lexer.content.size() && !EndsScalar(lexer.content[end]))
+        end++;
+
+    const StringView value = lexer.content.SubString(start, end - start);
+
+    if (StartsNumber(startChar))
+        return Token(GetNumberType(parser, lexer, value, start), start, value);
+
+    return Token(Token::Type::IDENTIFIER, start, value);
+}
+
+// Strings without escape characters point into the source, the rest are unescaped into the document
+static Node MakeStringNode(Parser& parser, const Lexer& lexer, const Token& token, Document& out)
+{
+    Node node = {};
+    node.type = NodeType::STRING;
+
+    auto& view = token.value;
+
+    if (memchr(view.cstr(), '\\', view.size()) == nullptr)
+    {
+        node._chars = view.cstr();
+        node.count = (u32) view.size();
+        return node;
+    }
+
+    // Unescaping never makes a string longer
+    node.inArena = true;
+    node._offset = out.Allocate(view.size());
+    node.count = (u32) UnescapeString(view, (char*) (out.arena + node._offset), parser.errorCode);
+
+    if (parser.errorCode != 0)
+        parser.errorLineNumber = (s32) LineNumberAt(lexer.content, token.offset);
+
+    return node;
+}
+
+// Moves the nodes from start to the top of the node stack into the document as one span
+static u64 PopNodes(Parser& parser, u64 start, Document& out)
+{
+    const u64 count = parser.nodeStack.size() - start;
+    const u64 offset = out.Allocate(count * sizeof(Node));
+
+    PlatformCopyMemory(out.arena + offset, parser.nodeStack.data() + start, count * sizeof(Node));
+
+    while (parser.nodeStack.size() > start)
+        parser.nodeStack.PopBack();
+
+    return offset;
 }
 
 static void ParseNext(Parser& parser, const Lexer& lexer, Document& out);
 
 static void ParseArray(Parser& parser, const Lexer& lexer, Document& out)
 {
-    size_t myIndex = out.dependencyTree.size();
-    out.dependencyTree.EmplaceBack(DependencyNode::Type::ARRAY);
+    const u64 stackStart = parser.nodeStack.size();
 
     // Skip the first [
     parser.currentTokenIndex++;
 
     while (parser.errorCode == 0)
     {
-        if (parser.currentTokenIndex >= lexer.tokens.size())
+        if (parser.currentTokenIndex >= lexer.structurals.size())
         {
             parser.errorCode = 9;
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex - 1].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex - 1);
             break;
         }
 
-        if (lexer.tokens[parser.currentTokenIndex].type == Token::Type::SQUARE_BRACKET_CLOSE)
+        if (StructuralAt(lexer, parser.currentTokenIndex) == (char) Token::Type::SQUARE_BRACKET_CLOSE)
             break;
         
-        auto& node = out.dependencyTree[myIndex];
-        node._array.EmplaceBack(out.dependencyTree.size());
         ParseNext(parser, lexer, out);
 
         if (parser.errorCode != 0)
             break;
 
-        if (parser.currentTokenIndex >= lexer.tokens.size())
+        if (parser.currentTokenIndex >= lexer.structurals.size())
         {
             parser.errorCode = 8;
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex - 1].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex - 1);
             break;
         }
 
-        if (lexer.tokens[parser.currentTokenIndex].type == Token::Type::SQUARE_BRACKET_CLOSE)
+        if (StructuralAt(lexer, parser.currentTokenIndex) == (char) Token::Type::SQUARE_BRACKET_CLOSE)
             break;
 
-        if (lexer.tokens[parser.currentTokenIndex].type != Token::Type::COMMA)
+        if (StructuralAt(lexer, parser.currentTokenIndex) != (char) Token::Type::COMMA)
         {
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex);
             parser.errorCode = 2;
             break;
         }
 
         parser.currentTokenIndex++;
     }
+
+    if (parser.errorCode != 0)
+        return;
+
+    Node node = {};
+    node.type = NodeType::ARRAY;
+    node.count = (u32) (parser.nodeStack.size() - stackStart);
+    node._offset = PopNodes(parser, stackStart, out);
+
+    parser.nodeStack.PushBack(node);
 }
 
 static void ParseObject(Parser& parser, const Lexer& lexer, Document& out)
 {
-    size_t myIndex = out.dependencyTree.size();
-    out.dependencyTree.EmplaceBack(DependencyNode::Type::OBJECT);
+    const u64 stackStart = parser.nodeStack.size();
 
     // Skip the first {
     parser.currentTokenIndex++;
     
     while (parser.errorCode == 0)
     {
-        if (parser.currentTokenIndex >= lexer.tokens.size())
+        if (parser.currentTokenIndex >= lexer.structurals.size())
         {
             parser.errorCode = 8;
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex - 1].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex - 1);
             break;
         }
 
-        if (lexer.tokens[parser.currentTokenIndex].type == Token::Type::CURLY_BRACKET_CLOSE)
+        if (StructuralAt(lexer, parser.currentTokenIndex) == (char) Token::Type::CURLY_BRACKET_CLOSE)
             break;
 
-        auto& node = out.dependencyTree[myIndex];
+        const Token keyToken = ReadToken(parser, lexer);
+        parser.currentTokenIndex++;
+
+        if (parser.errorCode != 0)
+            break;
 
-        auto& keyToken = lexer.tokens[parser.currentTokenIndex++];
         if (keyToken.type != Token::Type::STRING)
         {
-            parser.errorLineNumber = keyToken.lineNumber;
+            parser.errorLineNumber = (s32) LineNumberAt(lexer.content, keyToken.offset);
             parser.errorCode = 4;
             break;
         }
 
         {   // Check for semi colon
-            auto& token = lexer.tokens[parser.currentTokenIndex++];
-            if (token.type != Token::Type::COLON)
+            if (parser.currentTokenIndex >= lexer.structurals.size() ||
+                StructuralAt(lexer, parser.currentTokenIndex) != (char) Token::Type::COLON)
             {
-                parser.errorLineNumber = token.lineNumber;
+                parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex);
                 parser.errorCode = 5;
                 break;
             }
+
+            parser.currentTokenIndex++;
         }
 
-        String keyString = EscapeToken(parser, keyToken);
+        parser.nodeStack.PushBack(MakeStringNode(parser, lexer, keyToken, out));
         if (parser.errorCode != 0)
             break;
 
-        node._object[keyString] = out.dependencyTree.size(); 
         ParseNext(parser, lexer, out);
 
         if (parser.errorCode != 0)
             break;
 
-        if (parser.currentTokenIndex >= lexer.tokens.size())
+        if (parser.currentTokenIndex >= lexer.structurals.size())
         {
             parser.errorCode = 8;
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex - 1].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex - 1);
             break;
         }
 
-        if (lexer.tokens[parser.currentTokenIndex].type == Token::Type::CURLY_BRACKET_CLOSE)
+        if (StructuralAt(lexer, parser.currentTokenIndex) == (char) Token::Type::CURLY_BRACKET_CLOSE)
             break;
 
-        if (lexer.tokens[parser.currentTokenIndex].type != Token::Type::COMMA)
+        if (StructuralAt(lexer, parser.currentTokenIndex) != (char) Token::Type::COMMA)
         {
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex].lineNumber;
+            parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex);
             parser.errorCode = 3;
             break;
         }
 
         parser.currentTokenIndex++;
     }
+
+    if (parser.errorCode != 0)
+        return;
+
+    // Keys and values alternate in the span
+    Node node = {};
+    node.type = NodeType::OBJECT;
+    node.count = (u32) ((parser.nodeStack.size() - stackStart) / 2);
+    node._offset = PopNodes(parser, stackStart, out);
+
+    parser.nodeStack.PushBack(node);
 }
 
 static void ParseNext(Parser& parser, const Lexer& lexer, Document& out)
 {
-    if (parser.currentTokenIndex >= lexer.tokens.size())
+    if (parser.currentTokenIndex >= lexer.structurals.size())
     {
         parser.errorCode = 6;
-        parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex - 1].lineNumber;
+        parser.errorLineNumber = ErrorLineAt(lexer, parser.currentTokenIndex - 1);
         return;
     }
 
-    auto& token = lexer.tokens[parser.currentTokenIndex];
+    const Token token = ReadToken(parser, lexer);
+    if (parser.errorCode != 0)
+        return;
 
     switch (token.type)
     {
         case Token::Type::STRING:
         {
-            size_t resourceIndex = out.resources.size();
-
-            {   // Push Resource
-                String value = EscapeToken(parser, token);
-                out.resources.EmplaceBack(std::move(value));
-            }
-
-            {   // Push Node
-                auto& node = out.dependencyTree.EmplaceBack(DependencyNode::Type::DIRECT);
-                node._index = resourceIndex;
-            }
+            parser.nodeStack.PushBack(MakeStringNode(parser, lexer, token, out));
         } break;
 
         case Token::Type::INTEGER:
         {
-            size_t resourceIndex = out.resources.size();
-
-            {   // Push Resource
-                String numString = token.value;
-                int64_t value = _atoi64(numString.cstr());
-                out.resources.EmplaceBack(value);
-            }
-
-            {   // Push Node
-                auto& node = out.dependencyTree.EmplaceBack(DependencyNode::Type::DIRECT);
-                node._index = resourceIndex;
-            }
+            Node& node = parser.nodeStack.EmplaceBack();
+            node.type = NodeType::INTEGER;
+            node._integer = ParseInteger(token.value);
         } break;
 
         case Token::Type::FLOAT:
         {
-            size_t resourceIndex = out.resources.size();
-
-            {   // Push Resource
-                String numString = token.value;
-                double value = atof(numString.cstr());
-                out.resources.EmplaceBack(value);
-            }
-
-            {   // Push Node
-                auto& node = out.dependencyTree.EmplaceBack(DependencyNode::Type::DIRECT);
-                node._index = resourceIndex;
-            }
+            Node& node = parser.nodeStack.EmplaceBack();
+            node.type = NodeType::FLOAT;
+            node._float = ParseFloat(token.value);
         } break;
 
         case Token::Type::IDENTIFIER:
         {
-            size_t resourceIndex = out.resources.size();
-            
-            {   // Push Resource
-                if (token.value == "true")
-                    out.resources.EmplaceBack(true);
-                else if (token.value == "false")
-                    out.resources.EmplaceBack(false);
-                else if (token.value == "null")
-                    resourceIndex = 0;    // Set to the common null resource
-                else
-                {
-                    parser.errorLineNumber = token.lineNumber;
-                    parser.errorCode = 1;
-                    break;
-                }
+            Node node = {};
+
+            if (token.value == "true")
+            {
+                node.type = NodeType::BOOLEAN;
+                node._boolean = true;
             }
-            
-            {   // Push Node
-                auto& node = out.dependencyTree.EmplaceBack(DependencyNode::Type::DIRECT);
-                node._index = resourceIndex;
+            else if (token.value == "false")
+            {
+                node.type = NodeType::BOOLEAN;
+                node._boolean = false;
             }
+            else if (token.value == "null")
+                node.type = NodeType::NONE;
+            else
+            {
+                parser.errorLineNumber = (s32) LineNumberAt(lexer.content, token.offset);
+                parser.errorCode = 1;
+                break;
+            }
+
+            parser.nodeStack.PushBack(node);
         } break;
 
         // Array
@@ -344,7 +399,7 @@ static void ParseNext(Parser& parser, const Lexer& lexer, Document& out)
         default:
         {
             parser.errorCode = 7;
-            parser.errorLineNumber = lexer.tokens[parser.currentTokenIndex].lineNumber;
+            parser.errorLineNumber = (s32) LineNumberAt(lexer.content, token.offset);
         } break;
     }
 
@@ -356,24 +411,26 @@ void Parser::ParseLexedOutput(const Lexer& lexer, Document& out)
     currentTokenIndex = 0;
     errorCode = 0;
 
-    out.dependencyTree.Clear();
-    out.resources.Clear();
+    // Every value takes at least one structural, so the arena only grows for unescaped strings
+    out.Reset((lexer.structurals.size() + 1) * sizeof(Node));
 
-    // This is a null element
-    // If user tries to access an object property that wasn't in the file,
-    // then the value will point to this element
-    auto& node = out.dependencyTree.EmplaceBack(DependencyNode::Type::DIRECT);
-    node._index = 0;
-    out.resources.EmplaceBack();
+    nodeStack.Clear();
+    nodeStack.Reserve(lexer.structurals.size() + 2);
 
-    if (lexer.tokens.size() > 0)
+    if (lexer.structurals.size() > 0)
     {
         ParseNext(*this, lexer, out);
 
+        if (errorCode == 0)
+        {   // The top level value goes in the arena like any other
+            const u64 offset = PopNodes(*this, 0, out);
+            out.root = offset;
+        }
+
         // Check if more tokens are remaining after parsing
-        if (errorCode == 0 && currentTokenIndex < lexer.tokens.size())
+        if (errorCode == 0 && currentTokenIndex < lexer.structurals.size())
         {
-            errorLineNumber = lexer.tokens[currentTokenIndex].lineNumber;
+            errorLineNumber = ErrorLineAt(lexer, currentTokenIndex);
             errorCode = 10;
         }
     }
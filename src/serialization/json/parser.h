@@ -1,6 +1,7 @@
 #pragma once
 
 #include "containers/stringview.h"
+#include "containers/darray.h"
 #include "document.h"
 #include "lexer.h"
 
@@ -10,6 +11,8 @@ namespace json
 struct Parser
 {
     u64 currentTokenIndex;
+    DynamicArray<Node> nodeStack;       // Children of the arrays and objects being parsed, moved into the document once they're closed
+
     void ParseLexedOutput(const Lexer& lexer, Document& out);
 
     s32 errorCode;
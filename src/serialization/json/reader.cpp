@@ -0,0 +1,456 @@
+#include "reader.h"
+
+#include "error_strings.h"
+#include "scalars.h"
+#include "core/logging.h"
+#include "platform/platform.h"
+
+namespace json
+{
+
+constexpr s32 END_OF_FILE = -1;
+
+// Moves what wasn't read yet to the front of the buffer and fills the rest from the file.
+// Returns false if nothing more could be read, either because the file ended or the buffer is full.
+static bool Refill(Reader& reader)
+{
+    if (reader.endOfFile)
+        return false;
+
+    if (reader.position > 0)
+    {
+        memmove(reader.buffer, reader.buffer + reader.position, reader.end - reader.position);
+        reader.end -= reader.position;
+        reader.position = 0;
+    }
+
+    if (reader.end == reader.bufferSize)
+        return false;
+
+    const u64 read = fread(reader.buffer + reader.end, sizeof(char), reader.bufferSize - reader.end, reader.file);
+    reader.end += read;
+
+    if (read == 0)
+    {
+        reader.endOfFile = true;
+        return false;
+    }
+
+    return true;
+}
+
+inline static bool BufferIsFull(const Reader& reader)
+{
+    return reader.end - reader.position == reader.bufferSize;
+}
+
+static Reader::Event Fail(Reader& reader, s32 errorCode)
+{
+    reader.errorCode = errorCode;
+    reader.errorLineNumber = reader.lineNumber;
+    reader.event = Reader::Event::INVALID;
+
+    return reader.event;
+}
+
+// Returns the next character that isn't whitespace without reading it, or END_OF_FILE
+static s32 PeekNonWhitespace(Reader& reader)
+{
+    while (true)
+    {
+        while (reader.position < reader.end)
+        {
+            const char ch = reader.buffer[reader.position];
+
+            if (ch == '\n')
+                reader.lineNumber++;
+            else if (ch != ' ' && ch != '\t' && ch != '\r')
+                return ch;
+
+            reader.position++;
+        }
+
+        if (!Refill(reader))
+            return END_OF_FILE;
+    }
+}
+
+// Reads the string starting at the position, escape characters are removed in place
+static bool ReadString(Reader& reader)
+{
+    u64 length = 1;     // Including the opening quote
+    bool escaped = false;
+    bool hasEscapes = false;
+
+    while (true)
+    {
+        if (reader.position + length >= reader.end)
+        {
+            if (!Refill(reader))
+            {
+                Fail(reader, (BufferIsFull(reader)) ? 16 : 15);
+                return false;
+            }
+
+            continue;
+        }
+
+        const char ch = reader.buffer[reader.position + length];
+
+        if (escaped)
+            escaped = false;
+        else if (ch == '\\')
+            escaped = hasEscapes = true;
+        else if (ch == '\"')
+            break;
+        else if (ch == '\n')
+        {
+            Fail(reader, 15);
+            return false;
+        }
+
+        length++;
+    }
+
+    char* chars = reader.buffer + reader.position + 1;
+    u64 count = length - 1;
+
+    if (hasEscapes)
+    {
+        count = UnescapeString(StringView(chars, count), chars, reader.errorCode);
+        if (reader.errorCode != 0)
+        {
+            Fail(reader, reader.errorCode);
+            return false;
+        }
+    }
+
+    reader._chars = chars;
+    reader._length = count;
+    reader.position += length + 1;
+
+    return true;
+}
+
+static Reader::Event ReadScalar(Reader& reader)
+{
+    u64 length = 1;
+
+    while (true)
+    {
+        if (reader.position + length >= reader.end)
+        {
+            if (Refill(reader))
+                continue;
+
+            if (BufferIsFull(reader))
+                return Fail(reader, 16);
+
+            break;
+        }
+
+        if (EndsScalar(reader.buffer[reader.position + length]))
+            break;
+
+        length++;
+    }
+
+    const StringView value(reader.buffer + reader.position, length);
+    reader.position += length;
+    reader.expectingSeparator = true;
+
+    if (StartsNumber(value[0]))
+    {
+        const Token::Type type = GetNumberType(value, reader.errorCode);
+
+        if (type == Token::Type::INTEGER)
+        {
+            reader._integer = ParseInteger(value);
+            return reader.event = Reader::Event::INTEGER;
+        }
+
+        if (type == Token::Type::FLOAT)
+        {
+            reader._float = ParseFloat(value);
+            return reader.event = Reader::Event::FLOAT;
+        }
+
+        return Fail(reader, reader.errorCode);
+    }
+
+    if (value == "true" || value == "false")
+    {
+        reader._boolean = (value[0] == 't');
+        return reader.event = Reader::Event::BOOLEAN;
+    }
+
+    if (value == "null")
+        return reader.event = Reader::Event::NULL_VALUE;
+
+    return Fail(reader, 1);
+}
+
+static Reader::Event ReadValue(Reader& reader, s32 ch)
+{
+    switch (ch)
+    {
+        case '{':
+        case '[':
+        {
+            if (reader.depth == Reader::MAX_DEPTH)
+                return Fail(reader, 17);
+
+            reader.position++;
+            reader.expectingSeparator = false;
+            reader.scopes[reader.depth++] = (ch == '{') ? Reader::Event::OBJECT_START : Reader::Event::ARRAY_START;
+
+            return reader.event = reader.scopes[reader.depth - 1];
+        }
+
+        case '\"':
+        {
+            if (!ReadString(reader))
+                return reader.event;
+
+            reader.expectingSeparator = true;
+            return reader.event = Reader::Event::STRING;
+        }
+
+        case ']':
+        case '}':
+        case ':':
+        case ',':
+            return Fail(reader, 7);
+    }
+
+    return ReadScalar(reader);
+}
+
+static Reader::Event EndScope(Reader& reader)
+{
+    reader.position++;
+    reader.depth--;
+    reader.expectingSeparator = true;
+
+    const bool object = (reader.scopes[reader.depth] == Reader::Event::OBJECT_START);
+    return reader.event = (object) ? Reader::Event::OBJECT_END : Reader::Event::ARRAY_END;
+}
+
+bool Reader::Open(StringView filepath, u64 bufferSize)
+{
+    Close();
+
+    endOfFile = false;
+    position = 0;
+    end = 0;
+
+    event = Event::NONE;
+    depth = 0;
+    expectingSeparator = false;
+    expectingColon = false;
+
+    errorCode = 0;
+    errorLineNumber = 0;
+    lineNumber = 1;
+
+    file = fopen(filepath.cstr(), "rb");
+    if (file == nullptr)
+    {
+        Fail(*this, 18);
+        return false;
+    }
+
+    this->bufferSize = bufferSize;
+    buffer = (char*) PlatformAllocate(bufferSize);
+
+    return true;
+}
+
+void Reader::Close()
+{
+    if (file)
+        fclose(file);
+
+    PlatformFree(buffer);
+
+    file = nullptr;
+    buffer = nullptr;
+}
+
+Reader::Event Reader::Next()
+{
+    if (event == Event::INVALID || event == Event::END_OF_DOCUMENT)
+        return event;
+
+    s32 ch = PeekNonWhitespace(*this);
+
+    if (depth == 0)
+    {
+        // The top level value was read
+        if (expectingSeparator)
+        {
+            if (ch != END_OF_FILE)
+                return Fail(*this, 10);
+
+            return event = Event::END_OF_DOCUMENT;
+        }
+
+        // Empty files are an empty document, same as the Parser
+        if (ch == END_OF_FILE)
+            return event = Event::END_OF_DOCUMENT;
+
+        return ReadValue(*this, ch);
+    }
+
+    const bool inObject = (scopes[depth - 1] == Event::OBJECT_START);
+    const char closingBracket = (inObject) ? '}' : ']';
+
+    if (expectingColon)
+    {
+        if (ch != ':')
+            return Fail(*this, 5);
+
+        position++;
+        expectingColon = false;
+
+        ch = PeekNonWhitespace(*this);
+        if (ch == END_OF_FILE)
+            return Fail(*this, 6);
+
+        return ReadValue(*this, ch);
+    }
+
+    if (expectingSeparator)
+    {
+        if (ch == closingBracket)
+            return EndScope(*this);
+
+        if (ch == END_OF_FILE)
+            return Fail(*this, (inObject) ? 8 : 9);
+
+        if (ch != ',')
+            return Fail(*this, (inObject) ? 3 : 2);
+
+        position++;
+        expectingSeparator = false;
+
+        ch = PeekNonWhitespace(*this);
+    }
+
+    // A trailing comma is allowed, same as the Parser
+    if (ch == closingBracket)
+        return EndScope(*this);
+
+    if (ch == END_OF_FILE)
+        return Fail(*this, (inObject) ? 8 : 9);
+
+    if (inObject)
+    {
+        if (ch != '\"')
+            return Fail(*this, 4);
+
+        if (!ReadString(*this))
+            return event;
+
+        expectingColon = true;
+        return event = Event::KEY;
+    }
+
+    return ReadValue(*this, ch);
+}
+
+void Reader::Skip()
+{
+    if (event == Event::KEY)
+        Next();
+
+    if (event != Event::OBJECT_START && event != Event::ARRAY_START)
+        return;
+
+    // Only strings and brackets matter to find where the value ends
+    u32 nesting = 1;
+    bool inString = false;
+    bool escaped = false;
+
+    while (nesting > 0)
+    {
+        if (position >= end)
+        {
+            if (!Refill(*this))
+            {
+                Fail(*this, (scopes[depth - 1] == Event::OBJECT_START) ? 8 : 9);
+                return;
+            }
+
+            continue;
+        }
+
+        const char ch = buffer[position++];
+
+        if (inString)
+        {
+            if (escaped)
+                escaped = false;
+            else if (ch == '\\')
+                escaped = true;
+            else if (ch == '\"')
+                inString = false;
+            else if (ch == '\n')
+            {
+                Fail(*this, 15);
+                return;
+            }
+
+            continue;
+        }
+
+        switch (ch)
+        {
+            case '\"': inString = true;  break;
+            case '\n': lineNumber++;     break;
+            case '{' :
+            case '[' : nesting++;        break;
+            case '}' :
+            case ']' : nesting--;        break;
+        }
+    }
+
+    // The closing bracket was already read
+    position--;
+    EndScope(*this);
+}
+
+StringView Reader::string() const
+{
+    AssertWithMessage(event == Event::KEY || event == Event::STRING, "Value is not a string!");
+    return StringView(_chars, _length);
+}
+
+s64 Reader::int64() const
+{
+    AssertWithMessage(event == Event::INTEGER, "Value is not an integer!");
+    return _integer;
+}
+
+f64 Reader::float64() const
+{
+    AssertWithMessage(event == Event::FLOAT || event == Event::INTEGER, "Value is not a float!");
+
+    if (event == Event::FLOAT)
+        return _float;
+    else
+        return (f64) _integer;
+}
+
+bool Reader::boolean() const
+{
+    AssertWithMessage(event == Event::BOOLEAN, "Value is not a bool!");
+    return _boolean;
+}
+
+const char* Reader::GetErrorMessage() const
+{
+    return parserErrorStrings[errorCode];
+}
+
+} // namespace json
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdio>
+
+#include "core/types.h"
+#include "containers/stringview.h"
+
+/*
+
+Pull reader for JSON files that are too big to be loaded or parsed at once.
+
+The file is read through a fixed size buffer and every call to Next returns
+the next event. Keys and values are read from the reader after their event
+and stay valid until the next call to Next or Skip. Skip jumps over a value
+and everything in it without looking at scalars, only brackets and strings
+are followed.
+
+Memory stays bounded by the buffer size no matter how big the file is. A
+single key or value has to fit in the buffer and arrays and objects can only
+be nested MAX_DEPTH deep.
+
+    json::Reader reader;
+    reader.Open("file.json");
+
+    reader.Next();                              // OBJECT_START
+    while (reader.Next() == json::Reader::Event::KEY)
+    {
+        if (reader.string() == "name")
+        {
+            reader.Next();                      // STRING
+            Log(reader.string());
+        }
+        else
+            reader.Skip();
+    }
+
+*/
+
+namespace json
+{
+
+struct Reader
+{
+    enum class Event : u8
+    {
+        NONE,
+
+        OBJECT_START,
+        OBJECT_END,
+        ARRAY_START,
+        ARRAY_END,
+        KEY,
+
+        // Values
+        STRING,
+        INTEGER,
+        FLOAT,
+        BOOLEAN,
+        NULL_VALUE,
+
+        END_OF_DOCUMENT,
+        INVALID                     // The file isn't valid JSON, see errorCode
+    };
+
+    static constexpr u64 DEFAULT_BUFFER_SIZE = 64 * 1024;
+    static constexpr u32 MAX_DEPTH = 256;
+
+    FILE* file = nullptr;
+    bool endOfFile;
+
+    char* buffer = nullptr;
+    u64 bufferSize;
+    u64 position;                   // Next character to read
+    u64 end;                        // End of the characters read from the file
+
+    Event event;
+
+    // Arrays and objects the reader is in, the current one is at depth - 1
+    Event scopes[MAX_DEPTH];
+    u32 depth;
+
+    bool expectingSeparator;        // A value was finished in the current scope, so a , or the end of the scope comes next
+    bool expectingColon;            // A key was just read
+
+    // Of the current event
+    const char* _chars;
+    u64 _length;
+
+    union
+    {
+        bool _boolean;
+        s64  _integer;
+        f64  _float;
+    };
+
+    s32 errorCode;
+    s32 errorLineNumber;
+    s32 lineNumber;
+
+    Reader() = default;
+    Reader(const Reader& other) = delete;
+
+    ~Reader()
+    {
+        Close();
+    }
+
+    bool Open(StringView filepath, u64 bufferSize = DEFAULT_BUFFER_SIZE);
+    void Close();
+
+    // Returns INVALID and stops if the file isn't valid, END_OF_DOCUMENT after the top level value
+    Event Next();
+
+    // Skips the value of a KEY, or the rest of the array or object an ARRAY_START or OBJECT_START started
+    void Skip();
+
+    // Keys and strings, valid until the next call to Next or Skip
+    StringView string() const;
+
+    s64 int64() const;
+    f64 float64() const;
+    bool boolean() const;
+
+    const char* GetErrorMessage() const;
+};
+
+} // namespace json
\ No newline at end of file
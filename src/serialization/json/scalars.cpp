@@ -0,0 +1,636 @@
+#include "scalars.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "number_tables.h"
+#include "core/utils.h"
+#include "core/logging.h"
+#include "containers/string.h"
+#include "platform/platform.h"
+
+namespace json
+{
+
+constexpr u64 F64_MANTISSA_BITS = 52;
+constexpr u64 F64_EXPONENT_MASK = 0x7FF;
+constexpr u64 F64_INFINITY_BITS = F64_EXPONENT_MASK << F64_MANTISSA_BITS;
+
+// Powers of 10 that are exact as doubles
+constexpr f64 exactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+constexpr char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+Token::Type GetNumberType(StringView value, s32& errorCode)
+{
+    bool dotEncountered = false;
+
+    for (u64 i = (value[0] == '-'); i < value.size() && errorCode == 0; i++)
+    {
+        if (value[i] == '-')
+            errorCode = 12;
+        else if (value[i] == '.')
+        {
+            if (dotEncountered)
+                errorCode = 13;
+
+            dotEncountered = true;
+        }
+        else if (!IsDigit(value[i]))
+            errorCode = 14;
+    }
+
+    if (errorCode != 0)
+        return Token::Type::ILLEGAL;
+
+    return (dotEncountered) ? Token::Type::FLOAT : Token::Type::INTEGER;
+}
+
+inline static u64 LoadEightChars(const char* chars)
+{
+    u64 chunk;
+    memcpy(&chunk, chars, sizeof(chunk));
+    return chunk;
+}
+
+// SWAR check that all 8 characters packed in the chunk are digits
+inline static bool IsEightDigits(u64 chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+            (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+}
+
+// SWAR conversion of 8 digits, the first one is in the lowest byte
+inline static u32 ParseEightDigits(u64 chunk)
+{
+    constexpr u64 mask = 0x000000FF000000FF;
+    constexpr u64 mul1 = 0x000F424000000064;    // 100 + (1000000 << 32)
+    constexpr u64 mul2 = 0x0000271000000001;    // 1 + (10000 << 32)
+
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);        // Pairs of digits
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+
+    return (u32) chunk;
+}
+
+// Adds the digits from chars to the number, returns where the digits end.
+// Wraps around if there are too many digits, the callers check for that.
+inline static const char* ParseDigits(const char* chars, const char* end, u64& number)
+{
+    while (end - chars >= 8)
+    {
+        const u64 chunk = LoadEightChars(chars);
+        if (!IsEightDigits(chunk))
+            break;
+
+        number = number * 100000000 + ParseEightDigits(chunk);
+        chars += 8;
+    }
+
+    while (chars < end && IsDigit(*chars))
+    {
+        number = number * 10 + (u64) (*chars - '0');
+        chars++;
+    }
+
+    return chars;
+}
+
+s64 ParseInteger(StringView value)
+{
+    const char* chars = value.cstr();
+    const char* end = chars + value.size();
+
+    const bool negative = (chars < end && *chars == '-');
+    chars += negative;
+
+    while (chars < end && *chars == '0')
+        chars++;
+
+    u64 number = 0;
+    const char* digitsStart = chars;
+    chars = ParseDigits(chars, end, number);
+
+    // Saturates like _atoi64, 19 digits always fit in a u64
+    const u64 limit = (negative) ? (1ULL << 63) : (1ULL << 63) - 1;
+    if (chars - digitsStart > 19 || number > limit)
+        return (negative) ? (s64) (1ULL << 63) : (s64) limit;
+
+    return (negative) ? (s64) (0 - number) : (s64) number;
+}
+
+// Converts w * 10^q to the bits of the closest double with the Eisel-Lemire algorithm
+static u64 EiselLemire(u64 w, s64 q)
+{
+    if (w == 0 || q < SMALLEST_POWER_OF_FIVE)
+        return 0;
+
+    if (q > LARGEST_POWER_OF_FIVE)
+        return F64_INFINITY_BITS;
+
+    const s32 leadingZeros = (s32) LeadingZeroCount64(w);
+    w <<= leadingZeros;
+
+    // w * 5^q with enough precision to round correctly, only needs the lower half of 5^q sometimes
+    const u64* power = powersOfFive128[q - SMALLEST_POWER_OF_FIVE];
+
+    u64 high;
+    u64 low = Multiply128(w, power[1], high);
+
+    if ((high & 0x1FF) == 0x1FF)
+    {
+        u64 secondHigh;
+        Multiply128(w, power[0], secondHigh);
+
+        low += secondHigh;
+        high += (secondHigh > low);
+    }
+
+    const u64 upperBit = high >> 63;
+    u64 mantissa = high >> (upperBit + 9);
+
+    // floor(log2(10^q)) from a fixed point approximation
+    s32 power2 = (s32) ((((152170 + 65536) * q) >> 16) + 63 + upperBit - leadingZeros + 1023);
+
+    if (power2 <= 0)
+    {   // Subnormals
+        if (-power2 + 1 >= 64)
+            return 0;
+
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+
+        power2 = (mantissa < (1ULL << F64_MANTISSA_BITS)) ? 0 : 1;
+        return mantissa | ((u64) power2 << F64_MANTISSA_BITS);
+    }
+
+    // Exactly halfway between two doubles, only possible for small q. Rounds to even.
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1)
+    {
+        if ((mantissa << (upperBit + 9)) == high)
+            mantissa &= ~1ULL;
+    }
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+
+    if (mantissa >= (2ULL << F64_MANTISSA_BITS))
+    {
+        mantissa = (1ULL << F64_MANTISSA_BITS);
+        power2++;
+    }
+
+    mantissa &= ~(1ULL << F64_MANTISSA_BITS);
+
+    if (power2 >= (s32) F64_EXPONENT_MASK)
+        return F64_INFINITY_BITS;
+
+    return mantissa | ((u64) power2 << F64_MANTISSA_BITS);
+}
+
+// For the rare numbers that can't be rounded from their first 19 digits
+static f64 ParseFloatSlow(StringView value)
+{
+    char digits[64];
+
+    if (value.size() < sizeof(digits))
+    {
+        PlatformCopyMemory(digits, value.cstr(), value.size());
+        digits[value.size()] = '\0';
+        return atof(digits);
+    }
+
+    String numString = value;
+    return atof(numString.cstr());
+}
+
+f64 ParseFloat(StringView value)
+{
+    const char* chars = value.cstr();
+    const char* end = chars + value.size();
+
+    const bool negative = (chars < end && *chars == '-');
+    chars += negative;
+
+    const char* digitsStart = chars;
+
+    u64 mantissa = 0;
+    chars = ParseDigits(chars, end, mantissa);
+
+    const char* integerEnd = chars;
+    const char* fractionStart = chars;
+    s64 exponent = 0;
+
+    if (chars < end && *chars == '.')
+    {
+        fractionStart = ++chars;
+        chars = ParseDigits(chars, end, mantissa);
+        exponent = -(chars - fractionStart);
+    }
+
+    s64 digitCount = (integerEnd - digitsStart) + (chars - fractionStart);
+    bool truncated = false;
+
+    // Same as atof for "." and "-."
+    if (digitCount == 0)
+        return 0.0;
+
+    if (digitCount > 19)
+    {
+        // Leading zeros don't count
+        const char* significant = digitsStart;
+        while (significant < end && (*significant == '0' || *significant == '.'))
+        {
+            digitCount -= (*significant == '0');
+            significant++;
+        }
+
+        if (digitCount > 19)
+        {   // Only the first 19 digits go in the mantissa, the rest is rounded by checking both neighbours
+            mantissa = 0;
+            u32 taken = 0;
+
+            const char* next = significant;
+            for (; taken < 19; next++)
+            {
+                if (*next == '.')
+                    continue;
+
+                mantissa = mantissa * 10 + (u64) (*next - '0');
+                taken++;
+            }
+
+            exponent = (next <= integerEnd) ? (integerEnd - next) : -(next - fractionStart);
+
+            for (; next < end && !truncated; next++)
+                truncated = (*next != '0' && *next != '.');
+        }
+    }
+
+    if (!truncated && exponent >= -22 && exponent <= 22 && mantissa <= (1ULL << 53))
+    {   // Both are exact as doubles, so a single operation rounds correctly
+        f64 result = (f64) mantissa;
+        result = (exponent < 0) ? result / exactPowersOfTen[-exponent] : result * exactPowersOfTen[exponent];
+        return (negative) ? -result : result;
+    }
+
+    u64 bits = EiselLemire(mantissa, exponent);
+
+    if (truncated && bits != EiselLemire(mantissa + 1, exponent))
+        return ParseFloatSlow(value);
+
+    bits |= (u64) negative << 63;
+
+    f64 result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+u64 UnescapeString(StringView value, char* out, s32& errorCode)
+{
+    u64 length = 0;
+
+    for (u64 i = 0; i < value.size() && errorCode == 0; i++)
+    {
+        if (value[i] == '\\')
+        {
+            i++;
+            switch (value[i])
+            {
+                case 'b' : out[length++] = '\b'; break;
+                case 'f' : out[length++] = '\f'; break;
+                case 'n' : out[length++] = '\n'; break;
+                case 'r' : out[length++] = '\r'; break;
+                case 't' : out[length++] = '\t'; break;
+                case '\"': out[length++] = '\"'; break;
+                case '\\': out[length++] = '\\'; break;
+                default  : errorCode = 11;       break;
+            }
+
+            continue;
+        }
+
+        out[length++] = value[i];
+    }
+
+    return length;
+}
+
+// Writes the digits of number to the end of out, returns the number of digits
+static u32 WriteDigits(u64 number, char* out, u32 digitCount)
+{
+    char* chars = out + digitCount;
+
+    while (number >= 100)
+    {
+        const u64 pair = (number % 100) * 2;
+        number /= 100;
+
+        chars -= 2;
+        chars[0] = digitPairs[pair];
+        chars[1] = digitPairs[pair + 1];
+    }
+
+    if (number >= 10)
+    {
+        chars -= 2;
+        chars[0] = digitPairs[number * 2];
+        chars[1] = digitPairs[number * 2 + 1];
+    }
+    else
+        *--chars = (char) ('0' + number);
+
+    return digitCount;
+}
+
+inline static u32 DigitCount(u64 number)
+{
+    u32 count = 1;
+    for (u64 limit = 10; count < 20 && number >= limit; limit *= 10)
+        count++;
+
+    return count;
+}
+
+u32 WriteInteger(s64 value, char* out)
+{
+    const bool negative = (value < 0);
+    const u64 number = (negative) ? 0 - (u64) value : (u64) value;
+
+    if (negative)
+        *out = '-';
+
+    return negative + WriteDigits(number, out + negative, DigitCount(number));
+}
+
+// Ryu, shortest digits that still convert back to the same double
+
+inline static u32 Pow5Bits(s32 e)
+{
+    return (u32) (((e * 1217359) >> 19) + 1);
+}
+
+inline static u32 Log10Pow2(s32 e)
+{
+    return (u32) ((e * 78913) >> 18);
+}
+
+inline static u32 Log10Pow5(s32 e)
+{
+    return (u32) ((e * 732923) >> 20);
+}
+
+inline static bool MultipleOfPowerOf5(u64 value, u32 p)
+{
+    u32 count = 0;
+    for (; value % 5 == 0; value /= 5)
+        count++;
+
+    return count >= p;
+}
+
+inline static bool MultipleOfPowerOf2(u64 value, u32 p)
+{
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128 bit number and 64 < j < 128
+inline static u64 MulShift64(u64 m, const u64* mul, s32 j)
+{
+    u64 high0;
+    Multiply128(m, mul[0], high0);
+
+    u64 high1;
+    const u64 low1 = Multiply128(m, mul[1], high1);
+
+    const u64 sum = high0 + low1;
+    high1 += (sum < high0);
+
+    const s32 shift = j - 64;
+    return (high1 << (64 - shift)) | (sum >> shift);
+}
+
+static u64 ShortestDigits(u64 ieeeMantissa, u32 ieeeExponent, s32& exponent10)
+{
+    s32 e2;
+    u64 m2;
+
+    if (ieeeExponent == 0)
+    {
+        e2 = 1 - 1023 - (s32) F64_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    }
+    else
+    {
+        e2 = (s32) ieeeExponent - 1023 - (s32) F64_MANTISSA_BITS - 2;
+        m2 = (1ULL << F64_MANTISSA_BITS) | ieeeMantissa;
+    }
+
+    const bool acceptBounds = (m2 & 1) == 0;
+
+    // The interval of numbers that round to this double is (mm, mp), scaled by 4
+    const u64 mv = 4 * m2;
+    const u32 mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1);
+
+    u64 vr, vp, vm;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+
+    if (e2 >= 0)
+    {
+        const u32 q = Log10Pow2(e2) - (e2 > 3);
+        exponent10 = (s32) q;
+
+        const s32 k = 125 + (s32) Pow5Bits((s32) q) - 1;
+        const s32 i = -e2 + (s32) q + k;
+
+        vr = MulShift64(4 * m2, pow5InvSplit[q], i);
+        vp = MulShift64(4 * m2 + 2, pow5InvSplit[q], i);
+        vm = MulShift64(4 * m2 - 1 - mmShift, pow5InvSplit[q], i);
+
+        if (q <= 21)
+        {
+            if (mv % 5 == 0)
+                vrIsTrailingZeros = MultipleOfPowerOf5(mv, q);
+            else if (acceptBounds)
+                vmIsTrailingZeros = MultipleOfPowerOf5(mv - 1 - mmShift, q);
+            else
+                vp -= MultipleOfPowerOf5(mv + 2, q);
+        }
+    }
+    else
+    {
+        const u32 q = Log10Pow5(-e2) - (-e2 > 1);
+        exponent10 = (s32) q + e2;
+
+        const s32 i = -e2 - (s32) q;
+        const s32 k = (s32) Pow5Bits(i) - 125;
+        const s32 j = (s32) q - k;
+
+        vr = MulShift64(4 * m2, pow5Split[i], j);
+        vp = MulShift64(4 * m2 + 2, pow5Split[i], j);
+        vm = MulShift64(4 * m2 - 1 - mmShift, pow5Split[i], j);
+
+        if (q <= 1)
+        {
+            vrIsTrailingZeros = true;
+
+            if (acceptBounds)
+                vmIsTrailingZeros = (mmShift == 1);
+            else
+                vp--;
+        }
+        else if (q < 63)
+            vrIsTrailingZeros = MultipleOfPowerOf2(mv, q);
+    }
+
+    // Removes digits while the interval still has a number with fewer digits
+    s32 removed = 0;
+    u8 lastRemovedDigit = 0;
+    u64 output;
+
+    if (vmIsTrailingZeros || vrIsTrailingZeros)
+    {   // Rare, the bounds or the value itself might be exact
+        while (vp / 10 > vm / 10)
+        {
+            vmIsTrailingZeros &= (vm % 10 == 0);
+            vrIsTrailingZeros &= (lastRemovedDigit == 0);
+            lastRemovedDigit = (u8) (vr % 10);
+
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        if (vmIsTrailingZeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vrIsTrailingZeros &= (lastRemovedDigit == 0);
+                lastRemovedDigit = (u8) (vr % 10);
+
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+
+        // Round to even if the exact number is .....50..0
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+            lastRemovedDigit = 4;
+
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    }
+    else
+    {
+        bool roundUp = false;
+
+        if (vp / 100 > vm / 100)
+        {   // Two digits at a time first, most numbers have lots to remove
+            roundUp = (vr % 100 >= 50);
+
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10)
+        {
+            roundUp = (vr % 10 >= 5);
+
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        output = vr + (vr == vm || roundUp);
+    }
+
+    exponent10 += removed;
+    return output;
+}
+
+u32 WriteFloat(f64 value, char* out)
+{
+    u64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const u64 ieeeMantissa = bits & ((1ULL << F64_MANTISSA_BITS) - 1);
+    const u32 ieeeExponent = (u32) ((bits >> F64_MANTISSA_BITS) & F64_EXPONENT_MASK);
+
+    AssertWithMessage(ieeeExponent != F64_EXPONENT_MASK, "Infinity and NaN can't be written as JSON numbers!");
+
+    char* chars = out;
+
+    if (bits >> 63)
+        *chars++ = '-';
+
+    if (ieeeExponent == 0 && ieeeMantissa == 0)
+    {
+        chars[0] = '0';
+        chars[1] = '.';
+        chars[2] = '0';
+        return (u32) (chars + 3 - out);
+    }
+
+    s32 exponent10;
+    const u64 digits = ShortestDigits(ieeeMantissa, ieeeExponent, exponent10);
+    const u32 digitCount = DigitCount(digits);
+
+    // The parser doesn't read exponents, so everything is written out in full.
+    // The dot is always written so the number is read back as a float.
+    const s32 dotPosition = (s32) digitCount + exponent10;
+
+    if (exponent10 >= 0)
+    {
+        chars += WriteDigits(digits, chars, digitCount);
+
+        PlatformSetMemory(chars, '0', exponent10);
+        chars += exponent10;
+
+        *chars++ = '.';
+        *chars++ = '0';
+    }
+    else if (dotPosition > 0)
+    {
+        WriteDigits(digits, chars + 1, digitCount);
+
+        // Moves the integer digits in front of the dot
+        memmove(chars, chars + 1, dotPosition);
+        chars[dotPosition] = '.';
+        chars += digitCount + 1;
+    }
+    else
+    {
+        *chars++ = '0';
+        *chars++ = '.';
+
+        PlatformSetMemory(chars, '0', -dotPosition);
+        chars += -dotPosition;
+
+        chars += WriteDigits(digits, chars, digitCount);
+    }
+
+    return (u32) (chars - out);
+}
+
+} // namespace json
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "lexer.h"
+
+/*
+
+Conversion of scalar values, shared by the Parser, the Reader and the Writer.
+Errors are reported with the parser's error codes.
+
+Integers are parsed 8 digits at a time with SWAR. Floats are parsed with the
+Eisel-Lemire algorithm from the first 19 digits, numbers with more digits
+that it can't round fall back to atof. Floats are written with Ryu, as the
+shortest digits that convert back to the same double.
+
+*/
+
+namespace json
+{
+
+inline bool IsDigit(char ch)
+{
+    return (ch >= '0') && (ch <= '9');
+}
+
+// Numbers and identifiers run until one of these
+inline bool EndsScalar(char ch)
+{
+    return ch == ' '  || ch == '\t' || ch == '\r' || ch == '\n' ||
+           ch == '['  || ch == ']'  || ch == '{'  || ch == '}'  ||
+           ch == ':'  || ch == ','  || ch == '\"';
+}
+
+inline bool StartsNumber(char ch)
+{
+    return ch == '-' || ch == '.' || IsDigit(ch);
+}
+
+// INTEGER or FLOAT, or ILLEGAL with errorCode set if the number isn't valid
+Token::Type GetNumberType(StringView value, s32& errorCode);
+
+// The value must be a number GetNumberType accepted
+s64 ParseInteger(StringView value);
+f64 ParseFloat(StringView value);
+
+// Longest a number can be when written
+constexpr u32 MAX_INTEGER_CHARS = 20;
+constexpr u32 MAX_FLOAT_CHARS = 330;
+
+// Return the number of characters written to out. Floats must be finite.
+u32 WriteInteger(s64 value, char* out);
+u32 WriteFloat(f64 value, char* out);
+
+// Writes the characters of a string without its escape characters to out, which
+// must hold at least value.size() characters (out can be value itself).
+// Returns the number of characters written.
+u64 UnescapeString(StringView value, char* out, s32& errorCode);
+
+} // namespace json
\ No newline at end of file
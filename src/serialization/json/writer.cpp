@@ -0,0 +1,246 @@
+#include "writer.h"
+
+#include "scalars.h"
+#include "core/logging.h"
+#include "platform/platform.h"
+
+namespace json
+{
+
+// Makes sure count more characters fit in the buffer
+static void Reserve(Writer& writer, u64 count)
+{
+    if (writer.size + count <= writer.capacity)
+        return;
+
+    u64 capacity = (writer.capacity > 0) ? writer.capacity : 256;
+    while (capacity < writer.size + count)
+        capacity += capacity / 2;
+
+    writer.buffer = (char*) PlatformReallocate(writer.buffer, capacity);
+    writer.capacity = capacity;
+}
+
+inline static void Put(Writer& writer, char ch)
+{
+    Reserve(writer, 1);
+    writer.buffer[writer.size++] = ch;
+}
+
+inline static void Put(Writer& writer, const char* chars, u64 count)
+{
+    Reserve(writer, count);
+    PlatformCopyMemory(writer.buffer + writer.size, chars, count);
+    writer.size += count;
+}
+
+static void NewLine(Writer& writer)
+{
+    if (writer.indentSize == 0)
+        return;
+
+    const u64 spaces = (u64) writer.indentSize * writer.depth;
+    Reserve(writer, spaces + 1);
+
+    writer.buffer[writer.size++] = '\n';
+    PlatformSetMemory(writer.buffer + writer.size, ' ', spaces);
+    writer.size += spaces;
+}
+
+// Puts the comma and indentation before a key or a value that isn't after a key
+static void Separate(Writer& writer)
+{
+    if (writer.expectingSeparator)
+        Put(writer, ',');
+
+    NewLine(writer);
+}
+
+static void BeginValue(Writer& writer)
+{
+    if (writer.depth == 0)
+    {
+        AssertWithMessage(!writer.expectingSeparator, "JSON document already has a value!");
+        return;
+    }
+
+    if (writer.afterKey)
+    {
+        writer.afterKey = false;
+        return;
+    }
+
+    AssertWithMessage(writer.scopes[writer.depth - 1] == '[', "Values in objects need a key!");
+    Separate(writer);
+}
+
+static void PutString(Writer& writer, StringView value)
+{
+    // Escaping can double the size at most
+    Reserve(writer, 2 * value.size() + 2);
+
+    char* out = writer.buffer + writer.size;
+    *out++ = '\"';
+
+    for (u64 i = 0; i < value.size(); i++)
+    {
+        const char ch = value[i];
+        char escaped = 0;
+
+        switch (ch)
+        {
+            case '\"': escaped = '\"'; break;
+            case '\\': escaped = '\\'; break;
+            case '\b': escaped = 'b';  break;
+            case '\f': escaped = 'f';  break;
+            case '\n': escaped = 'n';  break;
+            case '\r': escaped = 'r';  break;
+            case '\t': escaped = 't';  break;
+        }
+
+        if (escaped)
+        {
+            *out++ = '\\';
+            *out++ = escaped;
+        }
+        else
+            *out++ = ch;
+    }
+
+    *out++ = '\"';
+    writer.size = out - writer.buffer;
+}
+
+static void StartScope(Writer& writer, char bracket)
+{
+    BeginValue(writer);
+    AssertWithMessage(writer.depth < Writer::MAX_DEPTH, "Arrays and objects are nested too deep!");
+
+    Put(writer, bracket);
+    writer.scopes[writer.depth++] = bracket;
+    writer.expectingSeparator = false;
+}
+
+static void EndScope(Writer& writer, char bracket)
+{
+    AssertWithMessage(writer.depth > 0 && writer.scopes[writer.depth - 1] == bracket,
+                      "Ending an array or object that wasn't started!");
+    AssertWithMessage(!writer.afterKey, "Key doesn't have a value!");
+
+    writer.depth--;
+
+    // Empty scopes stay on one line
+    if (writer.expectingSeparator)
+        NewLine(writer);
+
+    Put(writer, (bracket == '{') ? '}' : ']');
+    writer.expectingSeparator = true;
+}
+
+void Writer::Clear()
+{
+    size = 0;
+    depth = 0;
+    expectingSeparator = false;
+    afterKey = false;
+}
+
+void Writer::Free()
+{
+    PlatformFree(buffer);
+
+    buffer = nullptr;
+    capacity = 0;
+    Clear();
+}
+
+void Writer::StartObject()
+{
+    StartScope(*this, '{');
+}
+
+void Writer::EndObject()
+{
+    EndScope(*this, '{');
+}
+
+void Writer::StartArray()
+{
+    StartScope(*this, '[');
+}
+
+void Writer::EndArray()
+{
+    EndScope(*this, '[');
+}
+
+void Writer::Key(StringView key)
+{
+    AssertWithMessage(depth > 0 && scopes[depth - 1] == '{', "Keys can only be written in objects!");
+    AssertWithMessage(!afterKey, "Previous key doesn't have a value!");
+
+    Separate(*this);
+    PutString(*this, key);
+
+    if (indentSize > 0)
+        Put(*this, ": ", 2);
+    else
+        Put(*this, ':');
+
+    afterKey = true;
+}
+
+void Writer::StringValue(StringView value)
+{
+    BeginValue(*this);
+    PutString(*this, value);
+    expectingSeparator = true;
+}
+
+void Writer::IntegerValue(s64 value)
+{
+    BeginValue(*this);
+
+    Reserve(*this, MAX_INTEGER_CHARS);
+    size += WriteInteger(value, buffer + size);
+
+    expectingSeparator = true;
+}
+
+void Writer::FloatValue(f64 value)
+{
+    // value - value is only 0 for finite values
+    if (value - value != 0.0)
+    {
+        NullValue();
+        return;
+    }
+
+    BeginValue(*this);
+
+    Reserve(*this, MAX_FLOAT_CHARS);
+    size += WriteFloat(value, buffer + size);
+
+    expectingSeparator = true;
+}
+
+void Writer::BooleanValue(bool value)
+{
+    BeginValue(*this);
+
+    if (value)
+        Put(*this, "true", 4);
+    else
+        Put(*this, "false", 5);
+
+    expectingSeparator = true;
+}
+
+void Writer::NullValue()
+{
+    BeginValue(*this);
+    Put(*this, "null", 4);
+    expectingSeparator = true;
+}
+
+} // namespace json
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "core/types.h"
+#include "containers/stringview.h"
+
+/*
+
+Writes JSON straight into a growable buffer.
+
+Values are written in order with calls that mirror the Reader's events, the
+writer puts in the commas, colons and (optionally) indentation. Floats are
+written with the shortest digits that read back as the same double and
+always with a dot, so they're read back as floats. The parser doesn't read
+exponents, so very big or small floats are written out in full.
+
+    json::Writer writer;
+
+    writer.StartObject();
+        writer.Key("name");
+        writer.StringValue("Steve");
+        writer.Key("position");
+        writer.StartArray();
+            writer.FloatValue(1.5);
+            writer.FloatValue(64.0);
+        writer.EndArray();
+    writer.EndObject();
+
+    StringView json = writer.output();
+
+*/
+
+namespace json
+{
+
+struct Writer
+{
+    static constexpr u32 MAX_DEPTH = 256;
+
+    char* buffer = nullptr;
+    u64 size = 0;
+    u64 capacity = 0;
+
+    u32 indentSize = 0;             // Spaces per level, 0 writes everything on a single line
+
+    // Arrays and objects being written, the current one is at depth - 1
+    char scopes[MAX_DEPTH];
+    u32 depth = 0;
+
+    bool expectingSeparator = false; // A value was written in the current scope
+    bool afterKey = false;
+
+    Writer() = default;
+    Writer(const Writer& other) = delete;
+
+    ~Writer()
+    {
+        Free();
+    }
+
+    // Starts over, keeping the buffer
+    void Clear();
+    void Free();
+
+    void StartObject();
+    void EndObject();
+    void StartArray();
+    void EndArray();
+
+    void Key(StringView key);
+
+    void StringValue(StringView value);
+    void IntegerValue(s64 value);
+    void FloatValue(f64 value);     // Infinity and NaN are written as null
+    void BooleanValue(bool value);
+    void NullValue();
+
+    inline StringView output() const
+    {
+        return StringView(buffer, size);
+    }
+};
+
+} // namespace json
\ No newline at end of file
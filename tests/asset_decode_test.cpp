@@ -0,0 +1,217 @@
+/*
+
+Runs the decoding half of asset loading without an OpenGL context.
+
+Images are decoded, texture caches are mapped and checked, and font data is
+read, all without a window. Assets that can't be loaded have to fail
+cleanly, and a font request with a missing atlas or data file has to end up
+FAILED instead of stopping the job that was decoding it. Font data with
+values a font can't have fails the same way.
+
+*/
+
+#include "test.h"
+
+#include "core/types.h"
+#include "containers/stringview.h"
+#include "engine/asset_loader.h"
+#include "engine/imgui.h"
+#include "engine/job_system.h"
+#include "fileio/fileio.h"
+#include "graphics/texture_cache.h"
+#include "graphics/texture_source.h"
+#include "platform/platform.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const StringView imagePath = "assets/art/ui/crosshair.png";
+static const StringView fontAtlasPath = "assets/fonts/bell.font.png";
+static const StringView fontDataPath = "assets/fonts/bell.font.json";
+static const StringView missingPath = "assets/missing.png";
+static const StringView missingFontDataPath = "assets/fonts/missing.font.json";
+
+static const char textureCachePath[] = "asset_decode_test.cache";
+static const char brokenFontDataPath[] = "asset_decode_test.font.json";
+
+// Never rendered with, so their atlases are never loaded and they don't need Font::Free
+static Imgui::Font font;
+static Imgui::Font requestFonts[2];
+
+// Same layout as the header in texture_cache.cpp
+struct TestTextureCacheHeader
+{
+    u32 magic;
+    u32 version;
+    u64 key;
+
+    s32 width, height;
+    s32 bytesPP;
+
+    u32 faceCount;
+    u32 levelCount;
+    u32 reserved;
+};
+
+static void TestDecodeImage()
+{
+    TextureSource source;
+    Check(DecodeTextureSource(source, &imagePath, 1, true));
+
+    Check(source.faceCount == 1);
+    Check(source.info.width > 0 && source.info.height > 0);
+    Check(source.info.bytesPP == 3 || source.info.bytesPP == 4);
+
+    // Either the cache was mapped or the image was decoded
+    Check(source.cache.data != nullptr || source.pixels[0] != nullptr);
+
+    FreeTextureSource(source);
+}
+
+static void TestDecodeMissingImage()
+{
+    TextureSource source;
+    Check(!DecodeTextureSource(source, &missingPath, 1, true));
+    Check(source.cache.data == nullptr && source.pixels[0] == nullptr);
+
+    u64 key;
+    Check(!GetTextureCacheKey(&missingPath, 1, key));
+}
+
+// A 2x2 RGBA texture has 2 levels, 16 bytes for the first one and 4 for the second
+static bool WriteTextureCache(u64 key, u32 magic, u64 pixelBytes)
+{
+    u8 blob[sizeof(TestTextureCacheHeader) + 20] = {};
+
+    TestTextureCacheHeader header = {};
+    header.magic = magic;
+    header.version = 1;
+    header.key = key;
+    header.width = 2;
+    header.height = 2;
+    header.bytesPP = 4;
+    header.faceCount = 1;
+    header.levelCount = 2;
+
+    PlatformCopyMemory(blob, &header, sizeof(TestTextureCacheHeader));
+    return SaveBytesToFile(textureCachePath, blob, sizeof(TestTextureCacheHeader) + pixelBytes);
+}
+
+static void TestMapTextureCache()
+{
+    static constexpr u32 textureCacheMagic = 0x43544E47;
+
+    u64 key = 0;
+    Check(GetTextureCacheKey(&imagePath, 1, key));
+
+    PlatformMappedFile file;
+    TextureCacheInfo info = {};
+
+    {   // Valid cache
+        Check(WriteTextureCache(key, textureCacheMagic, 20));
+        Check(MapTextureCache(textureCachePath, key, 1, file, info));
+        Check(info.width == 2 && info.height == 2 && info.bytesPP == 4);
+        Check(file.size == sizeof(TestTextureCacheHeader) + 20);
+
+        PlatformUnmapFile(file);
+
+        // Made from other images, or for a cubemap
+        Check(!MapTextureCache(textureCachePath, key + 1, 1, file, info));
+        Check(!MapTextureCache(textureCachePath, key, 6, file, info));
+    }
+
+    {   // Wrong magic
+        Check(WriteTextureCache(key, textureCacheMagic + 1, 20));
+        Check(!MapTextureCache(textureCachePath, key, 1, file, info));
+    }
+
+    {   // Missing the last level
+        Check(WriteTextureCache(key, textureCacheMagic, 16));
+        Check(!MapTextureCache(textureCachePath, key, 1, file, info));
+    }
+
+    remove(textureCachePath);
+    Check(!MapTextureCache(textureCachePath, key, 1, file, info));
+}
+
+static void TestLoadFontData()
+{
+    // The atlas size only scales the glyph bounds, so any size works here
+    Check(font.LoadData(fontDataPath, 512, 512));
+    Check(font.size > 0);
+    Check(font.lineHeight > 0.0f);
+    Check(font.kerningCount > 0);
+
+    // Loaded a second time from the cache written by the first
+    const u32 kerningCount = font.kerningCount;
+    Check(font.LoadData(fontDataPath, 512, 512));
+    Check(font.kerningCount == kerningCount);
+
+    Check(!font.LoadData(missingFontDataPath, 512, 512));
+    Check(font.kerningCount == 0);
+}
+
+// Data that's valid JSON but not a valid font has to fail too, and never write outside the glyph table
+static void TestBrokenFontData()
+{
+    const char* brokenData[] = {
+        "{ \"glyphs\": [ { \"unicode\": 20000, \"advance\": 0.5 } ] }",
+        "{ \"glyphs\": [ { \"unicode\": -5, \"advance\": 0.5 } ] }",
+        "{ \"glyphs\": [ { \"advance\": 0.5 } ] }",
+        "{ \"glyphs\": [ { \"unicode\": \"A\", \"advance\": 0.5 } ] }",
+        "{ \"glyphs\": [ { \"unicode\": 65, \"planeBounds\": 1 } ] }",
+        "{ \"metrics\": { \"lineHeight\": \"tall\" } }",
+        "{ \"kerning\": [ { \"unicode1\": 65, \"unicode2\": 300, \"advance\": -0.1 } ] }",
+        "{ \"atlas\": { \"size\": 48.5 } }",
+        "{ \"glyphs\": [ { \"unicode\": 65, \"advance\": 0.5 }",
+        "[ 1, 2, 3 ]",
+    };
+
+    for (const char* data : brokenData)
+    {
+        Check(SaveBytesToFile(brokenFontDataPath, data, strlen(data)));
+        Check(!font.LoadData(brokenFontDataPath, 512, 512));
+    }
+
+    {   // The same shape with valid values loads
+        const char data[] = "{ \"atlas\": { \"size\": 48 }, \"glyphs\": [ { \"unicode\": 65, \"advance\": 0.5 } ], "
+                            "\"kerning\": [ { \"unicode1\": 65, \"unicode2\": 86, \"advance\": -0.1 } ] }";
+
+        Check(SaveBytesToFile(brokenFontDataPath, data, sizeof(data) - 1));
+        Check(font.LoadData(brokenFontDataPath, 512, 512));
+        Check(font.size == 48 && font.kerningCount == 1);
+    }
+
+    remove(brokenFontDataPath);
+    remove("asset_decode_test.font.json.cache");
+}
+
+static void TestFailedFontRequests()
+{
+    // Failed requests are never uploaded, so they don't need OpenGL either
+    const AssetLoader::AssetHandle missingAtlas = AssetLoader::LoadFont(requestFonts[0], missingPath, fontDataPath);
+    const AssetLoader::AssetHandle missingData = AssetLoader::LoadFont(requestFonts[1], fontAtlasPath, missingFontDataPath);
+    AssetLoader::WaitAll();
+
+    Check(AssetLoader::GetState(missingAtlas) == AssetLoader::AssetState::FAILED);
+    Check(AssetLoader::GetState(missingData) == AssetLoader::AssetState::FAILED);
+
+    AssetLoader::Clear();
+}
+
+int main()
+{
+    JobSystem::Init();
+
+    TestDecodeImage();
+    TestDecodeMissingImage();
+    TestMapTextureCache();
+    TestLoadFontData();
+    TestBrokenFontData();
+    TestFailedFontRequests();
+
+    AssetLoader::Shutdown();
+    JobSystem::Shutdown();
+
+    return FinishTests("asset_decode_test");
+}
\ No newline at end of file
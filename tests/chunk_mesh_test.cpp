@@ -0,0 +1,129 @@
+/*
+
+Meshes a lit chunk without OpenGL and checks the light in its vertices.
+
+The chunk is flat ground with open sky above it and a glowstone sitting on
+the ground. Every vertex of an up face in the open should be in full
+sunlight, and smooth block light should get brighter towards the glowstone
+across a face instead of being the same at all four vertices.
+
+*/
+
+#include "test.h"
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "engine/job_system.h"
+#include "game/chunk_area.h"
+#include "game/voxel_light.h"
+#include "game/voxel_renderdata.h"
+#include "math/math.h"
+
+static constexpr u32 groundHeight = 4;         // Blocks at y <= groundHeight are stone
+static constexpr f32 lightEpsilon = 0.001f;
+
+static const Vector3Int chunkCoord = { 0, 0, 0 };
+static const Vector3Int glowstoneIndex = { 8, groundHeight + 1, 8 };
+
+static u32 LoadTestChunk(VoxelChunkArea& area)
+{
+    const u32 slot = area.AcquireSlot(chunkCoord, 0);
+    VoxelChunk& chunk = area.chunks[slot];
+
+    for (u32 z = 0; z < CHUNK_SIZE; z++)
+    for (u32 y = 0; y < CHUNK_SIZE; y++)
+    for (u32 x = 0; x < CHUNK_SIZE; x++)
+        chunk.at(x, y, z) = (y <= groundHeight) ? BlockType::STONE : BlockType::NONE;
+
+    chunk.at(glowstoneIndex.x, glowstoneIndex.y, glowstoneIndex.z) = BlockType::GLOWSTONE;
+    area.chunkMap.Place(chunkCoord, slot);
+
+    DynamicArray<Vector3Int> changedChunks;
+    LightLoadedChunks(area, &chunkCoord, 1, changedChunks);
+    changedChunks.Free();
+
+    area.UpdateChunkMesh(chunkCoord);
+    return slot;
+}
+
+// Up face of the ground block at (x, groundHeight, z), nullptr if it wasn't meshed
+static const VoxelVertex* FindUpFace(const VoxelChunkArea& area, u32 slot, u32 x, u32 z)
+{
+    const VoxelVertex* vertices = area.opaqueMeshData[slot];
+
+    for (u32 face = 0; face < area.opaqueFaceCounts[slot]; face++)
+    {
+        const VoxelVertex* v = vertices + 4 * face;
+        if (v[0].normal.y < 0.5f || v[0].position.y != (f32) (groundHeight + 1))
+            continue;
+
+        f32 minX = v[0].position.x, minZ = v[0].position.z;
+        for (u32 i = 1; i < 4; i++)
+        {
+            minX = Min(minX, v[i].position.x);
+            minZ = Min(minZ, v[i].position.z);
+        }
+
+        if (minX == (f32) x && minZ == (f32) z)
+            return v;
+    }
+
+    return nullptr;
+}
+
+static void TestOpenSkyIsFullSunlight(const VoxelChunkArea& area, u32 slot)
+{
+    // Far enough from the glowstone and the edges of the chunk to only see the sky
+    const VoxelVertex* face = FindUpFace(area, slot, 3, 3);
+    Check(face != nullptr);
+
+    if (face)
+    {
+        for (u32 i = 0; i < 4; i++)
+            Check(face[i].light.x > 1.0f - lightEpsilon);
+    }
+}
+
+static void TestBlockLightIsSmooth(const VoxelChunkArea& area, u32 slot)
+{
+    // Two blocks in front of the glowstone along -x. The edge of the face closer to the
+    // glowstone (x = 7) sees more block light than the edge further away (x = 6).
+    const VoxelVertex* face = FindUpFace(area, slot, glowstoneIndex.x - 2, glowstoneIndex.z);
+    Check(face != nullptr);
+
+    if (!face)
+        return;
+
+    f32 nearLight = 1.0f, farLight = 0.0f;
+    for (u32 i = 0; i < 4; i++)
+    {
+        if (face[i].position.x == (f32) (glowstoneIndex.x - 1))
+            nearLight = Min(nearLight, face[i].light.y);
+        else
+            farLight = Max(farLight, face[i].light.y);
+    }
+
+    Check(farLight > 0.0f);
+    Check(nearLight > farLight + lightEpsilon);
+}
+
+int main()
+{
+    JobSystem::Init();
+
+    ChunkLoadShape shape;
+    shape.radius = 2;
+    shape.verticalRadius = 2;
+
+    VoxelChunkArea area = {};
+    area.Create(shape);
+
+    const u32 slot = LoadTestChunk(area);
+    TestOpenSkyIsFullSunlight(area, slot);
+    TestBlockLightIsSmooth(area, slot);
+
+    area.Free();
+    JobSystem::Shutdown();
+
+    return FinishTests("chunk_mesh_test");
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+/*
+
+Keys, saving and loading of the shader cache, which don't need OpenGL.
+
+The key has to change whenever a source (as read from its file) or the
+driver changes, including when text only moves from one part to the next. A
+saved cache has to load back the same binary, and a cache that was made for
+another key or was damaged on disk has to be rejected so the program is
+compiled instead.
+
+*/
+
+#include "test.h"
+
+#include "core/types.h"
+#include "containers/darray.h"
+#include "containers/hash.h"
+#include "containers/string.h"
+#include "containers/stringview.h"
+#include "fileio/fileio.h"
+#include "graphics/shader_cache.h"
+#include "platform/platform.h"
+
+#include <cstddef>
+#include <cstdio>
+
+static const char cachePath[] = "shader_cache_test.cache";
+static const char sourcePaths[2][32] = { "shader_cache_test.0.cache", "shader_cache_test.1.cache" };
+
+static constexpr u32 binaryFormat = 0x8741;
+static constexpr u64 binarySize = 1000;
+
+// Same layout as the header in shader_cache.cpp
+struct TestShaderCacheHeader
+{
+    u32 magic;
+    u32 version;
+    Hash key;
+
+    u32 format;
+    u32 reserved;
+    u64 size;
+
+    Hash binaryHash;
+};
+
+static u8 binary[binarySize];
+
+static void TestKey()
+{
+    const StringView parts[] = { "vertex source", "fragment source", "vendor", "renderer", "4.6.0 driver" };
+    const Hash key = GetShaderCacheKey(parts, 5);
+
+    Check(GetShaderCacheKey(parts, 5) == key);
+
+    {   // A source changed
+        const StringView changed[] = { "vertex source", "fragment source!", "vendor", "renderer", "4.6.0 driver" };
+        Check(GetShaderCacheKey(changed, 5) != key);
+    }
+
+    {   // The driver was updated
+        const StringView changed[] = { "vertex source", "fragment source", "vendor", "renderer", "4.6.1 driver" };
+        Check(GetShaderCacheKey(changed, 5) != key);
+    }
+
+    {   // Same text, but some of it moved to the next part
+        const StringView moved[] = { "vertex sourcef", "ragment source", "vendor", "renderer", "4.6.0 driver" };
+        Check(GetShaderCacheKey(moved, 5) != key);
+
+        const StringView joined[] = { "vertex sourcefragment source", "", "vendor", "renderer", "4.6.0 driver" };
+        Check(GetShaderCacheKey(joined, 5) != key);
+    }
+}
+
+// Shaders are keyed by sources read from their files, so the key has to see what was read
+static void TestKeyFromFiles()
+{
+    char source[] = "void main() { gl_Position = vec4(0.0); }";
+    const u64 sourceLength = sizeof(source) - 1;
+
+    Check(SaveBytesToFile(sourcePaths[0], source, sourceLength));
+    source[sourceLength - 5] = '1';
+    Check(SaveBytesToFile(sourcePaths[1], source, sourceLength));
+
+    String sources[2];
+    Hash keys[2];
+
+    for (u32 i = 0; i < 2; i++)
+    {
+        LoadFileToString(sourcePaths[i], sources[i]);
+        Check(sources[i].size() == sourceLength);
+
+        const StringView parts[] = { sources[i], "vendor", "renderer", "4.6.0 driver" };
+        keys[i] = GetShaderCacheKey(parts, 4);
+
+        remove(sourcePaths[i]);
+    }
+
+    Check(keys[0] != keys[1]);
+}
+
+static void TestRoundTrip(Hash key)
+{
+    Check(SaveShaderCache(cachePath, key, binaryFormat, binary, binarySize));
+
+    ShaderCacheBinary loaded;
+    Check(LoadShaderCache(cachePath, key, loaded));
+
+    Check(loaded.format == binaryFormat);
+    Check(loaded.size == binarySize);
+
+    if (loaded.data && loaded.size == binarySize)
+    {
+        bool same = true;
+        for (u64 i = 0; i < binarySize; i++)
+            same = same && ((const u8*) loaded.data)[i] == binary[i];
+
+        Check(same);
+    }
+
+    FreeShaderCache(loaded);
+    Check(loaded.data == nullptr && loaded.size == 0);
+}
+
+// Saves a valid cache, changes one byte of it on disk and tries to load it
+static bool LoadsWithChangedByte(Hash key, u64 offset)
+{
+    Check(SaveShaderCache(cachePath, key, binaryFormat, binary, binarySize));
+
+    DynamicArray<u8> bytes;
+    LoadFileToBytes(cachePath, bytes);
+    bytes[offset] ^= 0x10;
+    Check(SaveBytesToFile(cachePath, bytes.data(), bytes.size()));
+
+    ShaderCacheBinary loaded;
+    const bool valid = LoadShaderCache(cachePath, key, loaded);
+
+    if (valid)
+        FreeShaderCache(loaded);
+
+    return valid;
+}
+
+static void TestRejected(Hash key)
+{
+    ShaderCacheBinary loaded;
+
+    {   // Made for another key
+        Check(SaveShaderCache(cachePath, key, binaryFormat, binary, binarySize));
+        Check(!LoadShaderCache(cachePath, key + 1, loaded));
+    }
+
+    {   // Wrong magic, corrupt binary hash and corrupt binary
+        Check(!LoadsWithChangedByte(key, offsetof(TestShaderCacheHeader, magic)));
+        Check(!LoadsWithChangedByte(key, offsetof(TestShaderCacheHeader, binaryHash)));
+        Check(!LoadsWithChangedByte(key, sizeof(TestShaderCacheHeader) + binarySize / 2));
+    }
+
+    {   // Truncated
+        Check(SaveShaderCache(cachePath, key, binaryFormat, binary, binarySize));
+
+        DynamicArray<u8> bytes;
+        LoadFileToBytes(cachePath, bytes);
+        Check(SaveBytesToFile(cachePath, bytes.data(), bytes.size() - 1));
+        Check(!LoadShaderCache(cachePath, key, loaded));
+
+        Check(SaveBytesToFile(cachePath, bytes.data(), sizeof(TestShaderCacheHeader) - 1));
+        Check(!LoadShaderCache(cachePath, key, loaded));
+    }
+
+    remove(cachePath);
+    Check(!LoadShaderCache(cachePath, key, loaded));
+}
+
+int main()
+{
+    for (u64 i = 0; i < binarySize; i++)
+        binary[i] = (u8) (i * 37 + 11);
+
+    TestKey();
+    TestKeyFromFiles();
+
+    const StringView parts[] = { "vertex source", "fragment source" };
+    const Hash key = GetShaderCacheKey(parts, 2);
+
+    TestRoundTrip(key);
+    TestRejected(key);
+
+    return FinishTests("shader_cache_test");
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+
+Helpers shared by the tests.
+
+Each test is a small program that runs without a window or an OpenGL
+context. Checks print where they failed and keep going so one run shows
+every failure, and the exit code is the number of failed checks.
+
+*/
+
+#include "core/types.h"
+
+#include <cstdio>
+
+inline u32 testFailures = 0;
+
+#define Check(x)  if (!(x)) { printf("CHECK FAILED: %s\nFile: %s\nLine: %d\n", #x, __FILE__, __LINE__); testFailures++; }
+
+inline int FinishTests(const char* name)
+{
+    printf("%s: %s (%u failed)\n", name, (testFailures == 0) ? "passed" : "FAILED", testFailures);
+    return (int) testFailures;
+}
\ No newline at end of file